@@ -0,0 +1,294 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref Util::AtomicBitArray class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project ineutil */
+
+#ifndef UTIL_ATOMIC_BIT_ARRAY_H
+#define UTIL_ATOMIC_BIT_ARRAY_H
+
+#include <cstdint>
+#include <atomic>
+
+#include "util_common.h"
+#include "util_bit_array.h"
+
+namespace Util {
+    /**
+     * Class that can be used to maintain a fixed size array of bits that can be safely updated from multiple threads
+     * without locks.  Every operation is atomic with respect to the 64-bit word holding the bit.  Unlike
+     * \ref Util::BitArray, this class is not implicitly shared and can not be copied or resized.
+     *
+     * The class is intended for slot allocation tables.  Use \ref Util::AtomicBitArray::claimFirstClearedBit to
+     * allocate a slot and \ref Util::AtomicBitArray::testAndClear or \ref Util::AtomicBitArray::clearBit to release
+     * it.
+     */
+    class UTIL_PUBLIC_API AtomicBitArray {
+        public:
+            /**
+             * Type used to represent a bit index.
+             */
+            typedef BitArray::Index Index;
+
+            /**
+             * Type used to represent a single word of bits.
+             */
+            typedef std::uint64_t Word;
+
+            /**
+             * Value that represents an invalid bit index.
+             */
+            static constexpr Index invalidIndex = BitArray::invalidIndex;
+
+            /**
+             * The number of bits held in each word.
+             */
+            static constexpr unsigned bitsPerWord = 64;
+
+            /**
+             * Constructor.  All bits are initially cleared.
+             *
+             * \param[in] numberBits The array length, in bits.  The length can not be changed.
+             */
+            AtomicBitArray(Index numberBits);
+
+            ~AtomicBitArray();
+
+            AtomicBitArray(const AtomicBitArray& other) = delete;
+
+            AtomicBitArray& operator=(const AtomicBitArray& other) = delete;
+
+            /**
+             * Method you can use to determine the size of the array, in bits.
+             *
+             * \return Returns the array size, in bits.
+             */
+            Index size() const;
+
+            /**
+             * Method you can use to determine the size of the array, in bits.
+             *
+             * \return Returns the array size, in bits.
+             */
+            Index length() const;
+
+            /**
+             * Method you can use to determine the number of words holding the array.
+             *
+             * \return Returns the number of words.
+             */
+            Index wordCount() const;
+
+            /**
+             * Method you can use to determine the number of set bits.  The value is a snapshot and may be stale if
+             * other threads are updating the array.
+             *
+             * \return Returns the number of set bits.
+             */
+            Index popcount() const;
+
+            /**
+             * Method you can use to determine if a bit is set.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be checked.
+             *
+             * \return Returns true if the bit is set.
+             */
+            bool isSet(Index bitIndex) const;
+
+            /**
+             * Method you can use to determine if a bit is cleared.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be checked.
+             *
+             * \return Returns true if the bit is cleared.
+             */
+            bool isClear(Index bitIndex) const;
+
+            /**
+             * Method you can use to atomically set a bit.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be set.
+             */
+            void setBit(Index bitIndex);
+
+            /**
+             * Method you can use to atomically clear a bit.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be cleared.
+             */
+            void clearBit(Index bitIndex);
+
+            /**
+             * Method you can use to atomically set a bit and obtain its previous value.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be set.
+             *
+             * \return Returns true if the bit was already set.  Returns false if this call set the bit.
+             */
+            bool testAndSet(Index bitIndex);
+
+            /**
+             * Method you can use to atomically clear a bit and obtain its previous value.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be cleared.
+             *
+             * \return Returns true if this call cleared the bit.  Returns false if the bit was already cleared.
+             */
+            bool testAndClear(Index bitIndex);
+
+            /**
+             * Method you can use to atomically OR a mask into a word.  Bits past the end of the array are ignored.
+             *
+             * \param[in] wordIndex The zero based index of the word to be updated.
+             *
+             * \param[in] mask      The mask of bits to be set.
+             *
+             * \return Returns the previous word value.
+             */
+            Word fetchOr(Index wordIndex, Word mask);
+
+            /**
+             * Method you can use to atomically AND a mask into a word.
+             *
+             * \param[in] wordIndex The zero based index of the word to be updated.
+             *
+             * \param[in] mask      The mask of bits to be kept.  All other bits are cleared.
+             *
+             * \return Returns the previous word value.
+             */
+            Word fetchAnd(Index wordIndex, Word mask);
+
+            /**
+             * Method you can use to atomically exclusive OR a mask into a word.  Bits past the end of the array are
+             * ignored.
+             *
+             * \param[in] wordIndex The zero based index of the word to be updated.
+             *
+             * \param[in] mask      The mask of bits to be toggled.
+             *
+             * \return Returns the previous word value.
+             */
+            Word fetchXor(Index wordIndex, Word mask);
+
+            /**
+             * Method you can use to read a word.
+             *
+             * \param[in] wordIndex The zero based index of the word to be read.
+             *
+             * \return Returns the current word value.
+             */
+            Word word(Index wordIndex) const;
+
+            /**
+             * Method you can use to set a range of bits.  Each word is updated atomically but the range as a whole is
+             * not.
+             *
+             * \param[in] startingIndex The zero based index of the first bit to be set.
+             *
+             * \param[in] endingIndex   The zero based index of the last bit to be set.
+             */
+            void setBits(Index startingIndex, Index endingIndex);
+
+            /**
+             * Method you can use to clear a range of bits.  Each word is updated atomically but the range as a whole
+             * is not.
+             *
+             * \param[in] startingIndex The zero based index of the first bit to be cleared.
+             *
+             * \param[in] endingIndex   The zero based index of the last bit to be cleared.
+             */
+            void clearBits(Index startingIndex, Index endingIndex);
+
+            /**
+             * Method you can use to locate the first cleared bit without claiming it.
+             *
+             * \param[in] startingIndex The zero based index to start the search at.
+             *
+             * \return Returns the zero based index of the first cleared bit.  The value
+             *         \ref Util::AtomicBitArray::invalidIndex is returned if every bit is set.
+             */
+            Index firstClearedBit(Index startingIndex = 0) const;
+
+            /**
+             * Method you can use to atomically locate and set a cleared bit.  The method is lock-free and never
+             * claims a bit that another thread has claimed.  Threads can reduce contention by starting their searches
+             * at different indexes and, on failure, retrying from index 0.
+             *
+             * \param[in] startingIndex The zero based index to start the search at.
+             *
+             * \return Returns the zero based index of the bit that was claimed.  The value
+             *         \ref Util::AtomicBitArray::invalidIndex is returned if every bit at or after the starting index
+             *         is set.
+             */
+            Index claimFirstClearedBit(Index startingIndex = 0);
+
+        private:
+            /**
+             * Method that returns the mask of valid bits in a word.
+             *
+             * \param[in] wordIndex The zero based word index.
+             *
+             * \return Returns a mask with every bit inside the array set.
+             */
+            inline Word validMask(Index wordIndex) const {
+                return wordIndex + 1 == numberWords ? lastWordMask : static_cast<Word>(-1);
+            }
+
+            /**
+             * Method that sets or clears a range of bits, one word at a time.
+             *
+             * \param[in] startingIndex The zero based index of the first bit in the range.
+             *
+             * \param[in] endingIndex   The zero based index of the last bit in the range.
+             *
+             * \param[in] nowSet        If true, the bits are set.  If false, the bits are cleared.
+             */
+            void updateBits(Index startingIndex, Index endingIndex, bool nowSet);
+
+            /**
+             * The array words.
+             */
+            std::atomic<Word>* words;
+
+            /**
+             * The number of words in the array.
+             */
+            Index numberWords;
+
+            /**
+             * The array length, in bits.
+             */
+            Index bitLength;
+
+            /**
+             * The mask of valid bits in the last word.
+             */
+            Word lastWordMask;
+    };
+}
+
+#endif
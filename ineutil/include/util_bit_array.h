@@ -32,14 +32,25 @@
 
 #include <QSharedDataPointer>
 #include <QSharedData>
+#include <QString>
 
 #include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <vector>
 
 #include "util_common.h"
+#include "util_bit_functions.h"
+#include "util_hash_functions.h"
+#include "util_bit_array_allocator.h"
+
+class QIODevice;
+class QDataStream;
 
 namespace Util {
     /**
-     * Class that can be used to maintain a searchable array of bits.
+     * Class that can be used to maintain a searchable array of bits.  Arrays of up to 128 bits are held inline
+     * without any heap allocation or reference counting.  Larger arrays share their storage between copies.
      */
     class UTIL_PUBLIC_API BitArray {
         public:
@@ -53,6 +64,337 @@ namespace Util {
              */
             static constexpr Index invalidIndex = static_cast<Index>(-1);
 
+            /**
+             * Enumeration of supported compression modes used when writing an array to a device.
+             */
+            enum class Compression {
+                /**
+                 * Indicates that every word is written as-is.
+                 */
+                NONE = 0,
+
+                /**
+                 * Indicates that runs of all-zero and all-one words are replaced by a single run length record.
+                 * Mostly empty or mostly full arrays shrink by orders of magnitude.
+                 */
+                RUN_LENGTH = 1
+            };
+
+            /**
+             * Enumeration of execution modes supported by bulk operations.
+             */
+            enum class Execution {
+                /**
+                 * Indicates that the operation runs on the calling thread.
+                 */
+                SEQUENTIAL,
+
+                /**
+                 * Indicates that the operation is split into cache line aligned chunks that are processed
+                 * concurrently on the global thread pool.  Arrays shorter than about eight million bits are still
+                 * processed on the calling thread.
+                 */
+                PARALLEL
+            };
+
+            /**
+             * Forward iterator over the indexes of the set bits in a \ref Util::BitArray.  The iterator holds the
+             * current word in a register and steps from one set bit to the next without revisiting the array.  The
+             * iterator is invalidated by any modification to the array.
+             */
+            class SetBitIterator {
+                public:
+                    typedef std::forward_iterator_tag iterator_category;
+                    typedef Index                     value_type;
+                    typedef std::ptrdiff_t            difference_type;
+                    typedef const Index*              pointer;
+                    typedef Index                     reference;
+
+                    SetBitIterator() {
+                        words       = nullptr;
+                        numberWords = 0;
+                        wordIndex   = 0;
+                        currentWord = 0;
+                    }
+
+                    /**
+                     * Constructor.
+                     *
+                     * \param[in] words       The words to iterate over.
+                     *
+                     * \param[in] numberWords The number of words.
+                     *
+                     * \param[in] wordIndex   The index of the word to start at.
+                     */
+                    SetBitIterator(const std::uint64_t* words, Index numberWords, Index wordIndex) {
+                        this->words       = words;
+                        this->numberWords = numberWords;
+                        this->wordIndex   = wordIndex;
+
+                        if (wordIndex < numberWords) {
+                            currentWord = words[wordIndex];
+                            if (currentWord == 0) {
+                                advance();
+                            }
+                        } else {
+                            currentWord = 0;
+                        }
+                    }
+
+                    /**
+                     * Dereference operator.
+                     *
+                     * \return Returns the index of the current set bit.
+                     */
+                    inline Index operator*() const {
+                        return 64 * wordIndex + static_cast<Index>(lsbLocation64(currentWord));
+                    }
+
+                    /**
+                     * Prefix increment operator.
+                     *
+                     * \return Returns a reference to this instance.
+                     */
+                    inline SetBitIterator& operator++() {
+                        currentWord &= currentWord - 1;
+                        if (currentWord == 0) {
+                            advance();
+                        }
+
+                        return *this;
+                    }
+
+                    /**
+                     * Postfix increment operator.
+                     *
+                     * \param[in] dummy Dummy parameter, unused.
+                     *
+                     * \return Returns a copy of this instance prior to the increment operation.
+                     */
+                    inline SetBitIterator operator++(int dummy) {
+                        (void) dummy;
+
+                        SetBitIterator oldValue(*this);
+                        operator++();
+
+                        return oldValue;
+                    }
+
+                    /**
+                     * Comparison operator.
+                     *
+                     * \param[in] other The instance to be compared against.
+                     *
+                     * \return Returns true if the iterators point to the same bit.
+                     */
+                    inline bool operator==(const SetBitIterator& other) const {
+                        return wordIndex == other.wordIndex && currentWord == other.currentWord;
+                    }
+
+                    /**
+                     * Comparison operator.
+                     *
+                     * \param[in] other The instance to be compared against.
+                     *
+                     * \return Returns true if the iterators point to different bits.
+                     */
+                    inline bool operator!=(const SetBitIterator& other) const {
+                        return wordIndex != other.wordIndex || currentWord != other.currentWord;
+                    }
+
+                private:
+                    /**
+                     * Method that moves to the next non-zero word, skipping runs of zero words.
+                     */
+                    inline void advance() {
+                        ++wordIndex;
+                        while (wordIndex < numberWords && words[wordIndex] == 0) {
+                            ++wordIndex;
+                        }
+
+                        currentWord = wordIndex < numberWords ? words[wordIndex] : 0;
+                    }
+
+                    /**
+                     * The words being iterated over.
+                     */
+                    const std::uint64_t* words;
+
+                    /**
+                     * The number of words being iterated over.
+                     */
+                    Index numberWords;
+
+                    /**
+                     * The index of the current word.
+                     */
+                    Index wordIndex;
+
+                    /**
+                     * The unvisited set bits in the current word.
+                     */
+                    std::uint64_t currentWord;
+            };
+
+            /**
+             * Range over the indexes of the set bits in a \ref Util::BitArray, suitable for use in range based for
+             * loops.
+             */
+            class SetBitRange {
+                public:
+                    /**
+                     * Constructor.
+                     *
+                     * \param[in] words       The words to iterate over.
+                     *
+                     * \param[in] numberWords The number of words.
+                     */
+                    SetBitRange(const std::uint64_t* words, Index numberWords) {
+                        this->words       = words;
+                        this->numberWords = numberWords;
+                    }
+
+                    /**
+                     * Method that returns an iterator to the first set bit.
+                     *
+                     * \return Returns an iterator to the first set bit.
+                     */
+                    inline SetBitIterator begin() const {
+                        return SetBitIterator(words, numberWords, 0);
+                    }
+
+                    /**
+                     * Method that returns an iterator past the last set bit.
+                     *
+                     * \return Returns the end iterator.
+                     */
+                    inline SetBitIterator end() const {
+                        return SetBitIterator(words, numberWords, numberWords);
+                    }
+
+                private:
+                    /**
+                     * The words being iterated over.
+                     */
+                    const std::uint64_t* words;
+
+                    /**
+                     * The number of words being iterated over.
+                     */
+                    Index numberWords;
+            };
+
+            /**
+             * Class that provides unchecked, bulk write access to a \ref Util::BitArray.  The array is detached from
+             * any shared, viewed or mapped storage once, on construction, so that tight loops can update bits
+             * without reference count checks.  The array must not be resized, copied or otherwise modified while
+             * an instance of this class exists.  Bits past the end of the array must remain cleared.
+             */
+            class UTIL_PUBLIC_API Mutator {
+                public:
+                    /**
+                     * Constructor.
+                     *
+                     * \param[in] array The array to be updated.  The array must outlive this instance.
+                     */
+                    Mutator(BitArray& array);
+
+                    Mutator(const Mutator& other) = delete;
+
+                    ~Mutator();
+
+                    Mutator& operator=(const Mutator& other) = delete;
+
+                    /**
+                     * Method you can use to determine the length of the array.
+                     *
+                     * \return Returns the array length, in bits.
+                     */
+                    inline Index size() const {
+                        return currentLength;
+                    }
+
+                    /**
+                     * Method you can use to determine the number of words holding the array contents.
+                     *
+                     * \return Returns the number of words holding the array contents.
+                     */
+                    inline Index numberWords() const {
+                        return (currentLength + 63) / 64;
+                    }
+
+                    /**
+                     * Method you can use to access the underlying words.  Bits are ordered LSB first.  Bits at or
+                     * above \ref BitArray::Mutator::size in the last word must read as zero for equality, population
+                     * counts and hashing to be correct.  Any such bits set through this pointer are cleared when the
+                     * mutator is destroyed.
+                     *
+                     * \return Returns a pointer to the underlying words.
+                     */
+                    inline std::uint64_t* words() const {
+                        return currentWords;
+                    }
+
+                    /**
+                     * Method you can use to determine if a bit is set.  The index is not checked.
+                     *
+                     * \param[in] bitIndex The zero based index of the bit to be tested.
+                     *
+                     * \return Returns true if the bit is set.  Returns false if the bit is cleared.
+                     */
+                    inline bool isSet(Index bitIndex) const {
+                        return (currentWords[bitIndex / 64] >> (bitIndex % 64)) & 1;
+                    }
+
+                    /**
+                     * Method you can use to set a bit.  The index is not checked.
+                     *
+                     * \param[in] bitIndex The zero based index of the bit to be set.
+                     */
+                    inline void setBit(Index bitIndex) {
+                        currentWords[bitIndex / 64] |= static_cast<std::uint64_t>(1) << (bitIndex % 64);
+                    }
+
+                    /**
+                     * Method you can use to clear a bit.  The index is not checked.
+                     *
+                     * \param[in] bitIndex The zero based index of the bit to be cleared.
+                     */
+                    inline void clearBit(Index bitIndex) {
+                        currentWords[bitIndex / 64] &= ~(static_cast<std::uint64_t>(1) << (bitIndex % 64));
+                    }
+
+                    /**
+                     * Method you can use to set or clear a bit.  The index is not checked.
+                     *
+                     * \param[in] bitIndex The zero based index of the bit to be updated.
+                     *
+                     * \param[in] nowSet   If true, the bit will be set.  If false, the bit will be cleared.
+                     */
+                    inline void setBit(Index bitIndex, bool nowSet) {
+                        std::uint64_t mask = static_cast<std::uint64_t>(1) << (bitIndex % 64);
+                        std::uint64_t word = currentWords[bitIndex / 64];
+
+                        currentWords[bitIndex / 64] = nowSet ? word | mask : word & ~mask;
+                    }
+
+                private:
+                    /**
+                     * The array being updated.
+                     */
+                    BitArray& array;
+
+                    /**
+                     * The words holding the array contents.
+                     */
+                    std::uint64_t* currentWords;
+
+                    /**
+                     * The array length, in bits.
+                     */
+                    Index currentLength;
+            };
+
             BitArray();
 
             /**
@@ -65,7 +407,21 @@ namespace Util {
             BitArray(Index numberBits, bool value = false);
 
             /**
-             * Constructor, constructs an array of bits from an array of bytes.
+             * Constructor, constructs an array of bits of a fixed size that obtains word storage from a specific
+             * allocator.  Arrays derived from this array, such as the results of operators or slices, use the
+             * default allocator.
+             *
+             * \param[in] numberBits The desired initial length of the array, in bits.
+             *
+             * \param[in] value      The value to assign to all the bits in the array.
+             *
+             * \param[in] allocator  The allocator used to obtain word storage.  The allocator must outlive the array.
+             */
+            BitArray(Index numberBits, bool value, BitArrayAllocator* allocator);
+
+            /**
+             * Constructor, constructs an array of bits from an array of boolean values, one bit per value.  Values
+             * are packed a vector at a time where the processor supports it.
              *
              * \param[in] rawData    Raw data to use to create an array of bits.
              *
@@ -116,8 +472,156 @@ namespace Util {
              */
             BitArray(const BitArray& other);
 
+            /**
+             * Move constructor.  The other instance is left as an empty array.
+             *
+             * \param[in] other The instance to be moved.
+             */
+            BitArray(BitArray&& other);
+
             ~BitArray();
 
+            /**
+             * Method that creates an array that references caller memory rather than a copy of it.  The caller
+             * memory is copied the first time the array is modified.  If any bits past the end of the array are set
+             * in the caller memory, a copy is made immediately.
+             *
+             * \param[in] rawData    The caller memory.  Bits are ordered LSB first.  The memory must be aligned to a
+             *                       64-bit boundary and must remain valid and unchanged for the lifetime of the array
+             *                       and any copies made from it.
+             *
+             * \param[in] numberBits The array length, in bits.
+             *
+             * \return Returns an array referencing the caller memory.
+             */
+            static BitArray fromRawData(const std::uint64_t* rawData, Index numberBits);
+
+            /**
+             * Method that creates an array from an array of bytes, one bit per byte.  A bit is set if its byte is
+             * non-zero.  Note that this differs from the std::uint8_t constructor which treats the bytes as packed
+             * bits.
+             *
+             * \param[in] values     The byte values.
+             *
+             * \param[in] numberBits The number of bytes, and the array length in bits.
+             *
+             * \return Returns the newly created array.
+             */
+            static BitArray fromBytes(const std::uint8_t* values, Index numberBits);
+
+            /**
+             * Method that creates an array from a list of set bit indexes.
+             *
+             * \param[in] indexes    The indexes of the bits to be set, in ascending order.
+             *
+             * \param[in] numberBits The array length, in bits.  The value must exceed every index.  A value of
+             *                       \ref Util::BitArray::invalidIndex makes the array just long enough to hold the
+             *                       last index.
+             *
+             * \return Returns the newly created array.
+             */
+            static BitArray fromIndexList(const std::vector<Index>& indexes, Index numberBits = invalidIndex);
+
+            /**
+             * Method you can use to copy the array into caller memory as boolean values, one value per bit.
+             *
+             * \param[out] destination The caller memory.  The memory must hold \ref Util::BitArray::size values.
+             */
+            void toBools(bool* destination) const;
+
+            /**
+             * Method you can use to copy the array into caller memory as bytes, one byte per bit.  Each byte is set
+             * to 1 if its bit is set and 0 if its bit is cleared.
+             *
+             * \param[out] destination The caller memory.  The memory must hold \ref Util::BitArray::size bytes.
+             */
+            void toBytes(std::uint8_t* destination) const;
+
+            /**
+             * Method you can use to obtain the indexes of every set bit.
+             *
+             * \return Returns the set bit indexes, in ascending order.
+             */
+            std::vector<Index> toIndexList() const;
+
+            /**
+             * Method you can use to determine if this array references external memory, either caller memory or a
+             * memory mapped file.
+             *
+             * \return Returns true if the array references external memory.  Returns false if the array owns its
+             *         storage.
+             */
+            bool isView() const;
+
+            /**
+             * Method you can use to replace the array contents with a memory mapped file written by
+             * \ref Util::BitArray::saveFile.  Pages are loaded on demand and are shared with other processes mapping
+             * the same file.  The file contents are copied the first time the array is modified.
+             *
+             * \param[in] filename The name of the file to map.
+             *
+             * \return Returns true on success.  Returns false if the file could not be opened or is not a valid bit
+             *         array file.  The array is left unchanged on error.
+             */
+            bool mapFile(const QString& filename);
+
+            /**
+             * Method you can use to save the array contents to a file that can later be loaded using
+             * \ref Util::BitArray::mapFile.  The file holds a 24 byte header followed by the array contents as little
+             * endian 64-bit words.
+             *
+             * \param[in] filename The name of the file to write.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool saveFile(const QString& filename) const;
+
+            /**
+             * Method you can use to write the array contents to a device.  The array is written as a versioned header
+             * followed by a series of bounded size records so that no second copy of the array is ever made.
+             *
+             * \param[in] device      The device to write to.  The device must be open for writing.
+             *
+             * \param[in] compression The compression mode to use.
+             *
+             * \return Returns true on success.  Returns false if the device reported an error.
+             */
+            bool write(QIODevice* device, Compression compression = Compression::RUN_LENGTH) const;
+
+            /**
+             * Method you can use to replace the array contents with data written by \ref Util::BitArray::write.  For
+             * sequential devices, the method will wait for data to become available.
+             *
+             * \param[in] device The device to read from.  The device must be open for reading.
+             *
+             * \return Returns true on success.  Returns false if the data could not be read or is invalid.  The array
+             *         is left unchanged on error.
+             */
+            bool read(QIODevice* device);
+
+            /**
+             * Method you can use to write the array contents to a data stream.  The format is identical to the format
+             * used by \ref Util::BitArray::write.  The stream status is set to QDataStream::WriteFailed on error.
+             *
+             * \param[in] stream      The stream to write to.
+             *
+             * \param[in] compression The compression mode to use.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool write(QDataStream& stream, Compression compression = Compression::RUN_LENGTH) const;
+
+            /**
+             * Method you can use to replace the array contents with data read from a data stream.  The stream status
+             * is set to QDataStream::ReadCorruptData on error.
+             *
+             * \param[in] stream The stream to read from.
+             *
+             * \return Returns true on success.  Returns false if the data could not be read or is invalid.  The array
+             *         is left unchanged on error.
+             */
+            bool read(QDataStream& stream);
+
             /**
              * Method you can use to determine the size of the array, in bits.
              *
@@ -140,17 +644,63 @@ namespace Util {
             Index length() const;
 
             /**
-             * Method you can use to clear the array contents.
+             * Method you can use to determine the number of bits the array can hold before the underlying storage
+             * must be reallocated.
+             *
+             * \return Returns the current capacity, in bits.
+             */
+            Index capacity() const;
+
+            /**
+             * Method you can use to determine the allocator used to obtain word storage for this array.
+             *
+             * \return Returns the allocator used by this array.
+             */
+            BitArrayAllocator* allocator() const;
+
+            /**
+             * Method you can use to access the underlying storage.  Bits are stored LSB first in 64-bit words.  Bits
+             * past the end of the array are always cleared.  The pointer is invalidated by any modification to the
+             * array.
+             *
+             * \return Returns a pointer to the underlying words.  A null pointer may be returned for empty arrays.
+             */
+            const std::uint64_t* constData() const;
+
+            /**
+             * Method you can use to determine the number of 64-bit words returned by
+             * \ref Util::BitArray::constData.
+             *
+             * \return Returns the number of words holding the array contents.
+             */
+            Index wordCount() const;
+
+            /**
+             * Method you can use to clear the array contents.  Any underlying storage is released.
              */
             void clear();
 
             /**
-             * Method you can use to resize the bit array.  Newly added bits will be cleared.
+             * Method you can use to resize the bit array.  Newly added bits will be cleared.  Storage grows
+             * geometrically so extending the array a few bits at a time is amortized constant time.
              *
              * \param[in] newLength The new bit array length, in bits.
              */
             void resize(Index newLength);
 
+            /**
+             * Method you can use to preallocate storage for the array.  Use this method before bulk loads to avoid
+             * repeated reallocation.  The length of the array is not changed.
+             *
+             * \param[in] numberBits The number of bits to reserve space for.
+             */
+            void reserve(Index numberBits);
+
+            /**
+             * Method you can use to release any storage not required to hold the current array contents.
+             */
+            void shrinkToFit();
+
             /**
              * Method you can use to set a single bit.
              *
@@ -179,8 +729,15 @@ namespace Util {
              * \param[in] endingIndex   The ending index of the range of bits to set.  Value is inclusive.
              *
              * \param[in] nowSet        If true, bits will be set.  if false, bits will be cleared.
+             *
+             * \param[in] execution     The execution mode to use.
              */
-            void setBits(Index startingIndex, Index endingIndex, bool nowSet = true);
+            void setBits(
+                Index     startingIndex,
+                Index     endingIndex,
+                bool      nowSet = true,
+                Execution execution = Execution::SEQUENTIAL
+            );
 
             /**
              * Method you can use to clear a range of bits.  The array will be extended, if needed.
@@ -190,8 +747,15 @@ namespace Util {
              * \param[in] endingIndex   The ending index of the range of bits to clear.  Value is inclusive.
              *
              * \param[in] nowCleared    If true, bits will be cleared.  if false, bits will be set.
+             *
+             * \param[in] execution     The execution mode to use.
              */
-            void clearBits(Index startingIndex, Index endingIndex, bool nowCleared = true);
+            void clearBits(
+                Index     startingIndex,
+                Index     endingIndex,
+                bool      nowCleared = true,
+                Execution execution = Execution::SEQUENTIAL
+            );
 
             /**
              * Method you can use to determine if a bit is set.
@@ -214,18 +778,22 @@ namespace Util {
             /**
              * Method you can use to locate the first set bit in the array.
              *
+             * \param[in] execution The execution mode to use.
+             *
              * \return Returns the index of the first set bit in the array.  A value of
              *         \ref Util::BitArray::invalidIndex is returned if no set bits exist in the array.
              */
-            Index firstSetBit() const;
+            Index firstSetBit(Execution execution = Execution::SEQUENTIAL) const;
 
             /**
              * Method you can use to locate the first cleared bit in the array.
              *
+             * \param[in] execution The execution mode to use.
+             *
              * \return Returns the index of the first cleared bit in the array.  A value of
              *         \ref Util::BitArray::invalidIndex is returned if no cleared bits exist in the array.
              */
-            Index firstClearedBit() const;
+            Index firstClearedBit(Execution execution = Execution::SEQUENTIAL) const;
 
             /**
              * Method you can use to locate the first set bit in the array at or after a specific index.
@@ -247,6 +815,346 @@ namespace Util {
              */
             Index firstClearedBit(Index startingIndex) const;
 
+            /**
+             * Method you can use to locate the last set bit in the array.
+             *
+             * \param[in] execution The execution mode to use.
+             *
+             * \return Returns the index of the last set bit in the array.  A value of
+             *         \ref Util::BitArray::invalidIndex is returned if no set bits exist in the array.
+             */
+            Index lastSetBit(Execution execution = Execution::SEQUENTIAL) const;
+
+            /**
+             * Method you can use to locate the last cleared bit in the array.
+             *
+             * \param[in] execution The execution mode to use.
+             *
+             * \return Returns the index of the last cleared bit in the array.  A value of
+             *         \ref Util::BitArray::invalidIndex is returned if no cleared bits exist in the array.
+             */
+            Index lastClearedBit(Execution execution = Execution::SEQUENTIAL) const;
+
+            /**
+             * Method you can use to locate the last set bit in the array at or before a specific index.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.  Indexes past the end of the
+             *                          array search from the last bit.
+             *
+             * \return Returns the index of the set bit.  A value of \ref Util::BitArray::invalidIndex is returned if
+             *         no set bits exist at or before the starting index.
+             */
+            Index previousSetBit(Index startingIndex) const;
+
+            /**
+             * Method you can use to locate the last cleared bit in the array at or before a specific index.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.  Indexes past the end of the
+             *                          array search from the last bit.
+             *
+             * \return Returns the index of the cleared bit.  A value of \ref Util::BitArray::invalidIndex is returned
+             *         if no cleared bits exist at or before the starting index.
+             */
+            Index previousClearedBit(Index startingIndex) const;
+
+            /**
+             * Method you can use to locate the first run of consecutive cleared bits at or after a specific index.
+             * Allocation bitmaps can use this method to locate a contiguous range of free entries.
+             *
+             * \param[in] length        The required run length, in bits.  The value must be greater than zero.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.
+             *
+             * \return Returns the index of the first bit in the run.  A value of \ref Util::BitArray::invalidIndex
+             *         is returned if no run of the required length exists within the array.
+             */
+            Index findClearRun(Index length, Index startingIndex = 0) const;
+
+            /**
+             * Method you can use to locate the first run of consecutive set bits at or after a specific index.
+             *
+             * \param[in] length        The required run length, in bits.  The value must be greater than zero.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.
+             *
+             * \return Returns the index of the first bit in the run.  A value of \ref Util::BitArray::invalidIndex
+             *         is returned if no run of the required length exists within the array.
+             */
+            Index findSetRun(Index length, Index startingIndex = 0) const;
+
+            /**
+             * Method that returns a range over the indexes of every set bit, in ascending order.  You can use the
+             * returned value in a range based for loop.  The range is invalidated by any modification to the array.
+             *
+             * \return Returns a range over the set bit indexes.
+             */
+            SetBitRange setBitIndices() const;
+
+            /**
+             * Template method that calls a function with the index of every set bit, in ascending order.  Runs of
+             * cleared words are skipped four words at a time.
+             *
+             * \param[in] function The function to be called.  The function must accept a single
+             *                     \ref Util::BitArray::Index parameter.
+             */
+            template<typename F> UTIL_PUBLIC_TEMPLATE_METHOD void forEachSetBit(F function) const {
+                const std::uint64_t* words       = constData();
+                Index                numberWords = wordCount();
+                Index                wordIndex   = 0;
+
+                while (wordIndex < numberWords) {
+                    if (   wordIndex + 4 <= numberWords
+                        && (  words[wordIndex]
+                            | words[wordIndex + 1]
+                            | words[wordIndex + 2]
+                            | words[wordIndex + 3]) == 0) {
+                        wordIndex += 4;
+                    } else {
+                        std::uint64_t word = words[wordIndex];
+                        Index         base = 64 * wordIndex;
+
+                        while (word != 0) {
+                            function(base + static_cast<Index>(lsbLocation64(word)));
+                            word &= word - 1;
+                        }
+
+                        ++wordIndex;
+                    }
+                }
+            }
+
+            /**
+             * Template method that calls a function with the index of every cleared bit, in ascending order.  Runs of
+             * fully set words are skipped four words at a time.
+             *
+             * \param[in] function The function to be called.  The function must accept a single
+             *                     \ref Util::BitArray::Index parameter.
+             */
+            template<typename F> UTIL_PUBLIC_TEMPLATE_METHOD void forEachClearBit(F function) const {
+                const std::uint64_t* words       = constData();
+                Index                numberWords = wordCount();
+                Index                bitLength   = size();
+                Index                wordIndex   = 0;
+
+                while (wordIndex < numberWords) {
+                    if (   wordIndex + 4 < numberWords
+                        && (words[wordIndex] & words[wordIndex + 1] & words[wordIndex + 2] & words[wordIndex + 3])
+                           == static_cast<std::uint64_t>(-1)) {
+                        wordIndex += 4;
+                    } else {
+                        std::uint64_t word = ~words[wordIndex];
+                        Index         base = 64 * wordIndex;
+
+                        if (wordIndex + 1 == numberWords && bitLength % 64 != 0) {
+                            word &= (static_cast<std::uint64_t>(1) << (bitLength % 64)) - 1;
+                        }
+
+                        while (word != 0) {
+                            function(base + static_cast<Index>(lsbLocation64(word)));
+                            word &= word - 1;
+                        }
+
+                        ++wordIndex;
+                    }
+                }
+            }
+
+            /**
+             * Method you can use to determine the number of set bits in the array.
+             *
+             * \param[in] execution The execution mode to use.
+             *
+             * \return Returns the number of set bits.
+             */
+            Index popcount(Execution execution = Execution::SEQUENTIAL) const;
+
+            /**
+             * Method you can use to determine the number of set bits preceding a given position.  The first call
+             * after the array is modified builds a small rank/select index, after which the method is constant time.
+             *
+             * \param[in] index The position of interest.  Values past the end of the array are treated as the array
+             *                  length.
+             *
+             * \return Returns the number of set bits at positions less than index.
+             */
+            Index rank(Index index) const;
+
+            /**
+             * Method you can use to locate a set bit by its rank.  This method is the inverse of
+             * \ref Util::BitArray::rank, using the same lazily built index.
+             *
+             * \param[in] setBitNumber The zero based rank of the desired set bit.
+             *
+             * \return Returns the index of the requested set bit.  A value of \ref Util::BitArray::invalidIndex is
+             *         returned if the array contains setBitNumber or fewer set bits.
+             */
+            Index select(Index setBitNumber) const;
+
+            /**
+             * Method that returns the intersection of this array with another array.  The result will be as long
+             * as the longer of the two arrays with the shorter array treated as if it were extended with cleared bits.
+             *
+             * \param[in] other     The array to calculate the intersection with.
+             *
+             * \param[in] execution The execution mode to use.
+             *
+             * \return Returns an array holding the bitwise AND of the two arrays.
+             */
+            BitArray intersectionBits(const BitArray& other, Execution execution = Execution::SEQUENTIAL) const;
+
+            /**
+             * Method that returns the union of this array with another array.  The result will be as long as the
+             * longer of the two arrays.
+             *
+             * \param[in] other     The array to calculate the union with.
+             *
+             * \param[in] execution The execution mode to use.
+             *
+             * \return Returns an array holding the bitwise OR of the two arrays.
+             */
+            BitArray unionBits(const BitArray& other, Execution execution = Execution::SEQUENTIAL) const;
+
+            /**
+             * Method that returns the symmetric difference of this array with another array.  The result will be as
+             * long as the longer of the two arrays.
+             *
+             * \param[in] other     The array to calculate the symmetric difference with.
+             *
+             * \param[in] execution The execution mode to use.
+             *
+             * \return Returns an array holding the bitwise exclusive OR of the two arrays.
+             */
+            BitArray symmetricDifferenceBits(const BitArray& other, Execution execution = Execution::SEQUENTIAL) const;
+
+            /**
+             * Method that returns the bits of this array that are not set in another array.  The result will be as
+             * long as the longer of the two arrays.
+             *
+             * \param[in] other     The array holding the bits to be removed.
+             *
+             * \param[in] execution The execution mode to use.
+             *
+             * \return Returns an array holding this array AND NOT the other array.
+             */
+            BitArray differenceBits(const BitArray& other, Execution execution = Execution::SEQUENTIAL) const;
+
+            /**
+             * Method that returns the complement of this array.  The result will have the same length as this array.
+             *
+             * \return Returns an array with every bit inverted.
+             */
+            BitArray complement() const;
+
+            /**
+             * Method that clears every bit in this array that is set in another array.  The array will be extended to
+             * the length of the other array, if needed.
+             *
+             * \param[in] other The array holding the bits to be cleared.
+             *
+             * \return Returns a reference to this instance.
+             */
+            BitArray& andNot(const BitArray& other);
+
+            /**
+             * Method that inverts every bit in this array.
+             */
+            void invert();
+
+            /**
+             * Method that returns a copy of a range of bits.  Bits are copied a word at a time regardless of the
+             * alignment of the range.
+             *
+             * \param[in] startingIndex The zero based index of the first bit to be copied.  Value is inclusive.
+             *
+             * \param[in] endingIndex   The zero based index of the last bit to be copied.  Value is inclusive.  The
+             *                          value must be less than the array length.
+             *
+             * \return Returns a new array holding the requested bits.
+             */
+            BitArray slice(Index startingIndex, Index endingIndex) const;
+
+            /**
+             * Method that gathers the bits selected by a mask into a new, densely packed array.  The first set bit in
+             * the mask selects bit 0 of the result, the second selects bit 1 and so on.  The BMI2 PEXT instruction is
+             * used when the processor supports it.
+             *
+             * \param[in] mask The mask selecting the bits to keep.  Mask bits past the end of this array select
+             *                 cleared bits.
+             *
+             * \return Returns an array whose length equals the number of set bits in the mask.
+             */
+            BitArray extract(const BitArray& mask) const;
+
+            /**
+             * Method that scatters consecutive bits into the positions selected by a mask.  This method is the
+             * inverse of \ref Util::BitArray::extract.  The BMI2 PDEP instruction is used when the processor
+             * supports it.
+             *
+             * \param[in] mask   The mask selecting the destination positions.
+             *
+             * \param[in] values The values to scatter.  Bit 0 is placed at the first set bit in the mask, bit 1 at
+             *                   the second and so on.  Missing values are treated as cleared bits.
+             *
+             * \return Returns an array whose length equals the mask length.  Bits not selected by the mask are
+             *         cleared.
+             */
+            static BitArray deposit(const BitArray& mask, const BitArray& values);
+
+            /**
+             * Method you can use to copy a range of bits from another array into this array.  Bits are copied a word
+             * at a time using funnel shifts so the source and destination ranges need not share the same alignment.
+             * The array is extended, if needed.  The source may be this array, in which case the ranges may overlap.
+             *
+             * \param[in] source           The array to copy bits from.
+             *
+             * \param[in] sourceIndex      The zero based index of the first bit to be copied.
+             *
+             * \param[in] numberBits       The number of bits to be copied.  The range must be within the source
+             *                             array.
+             *
+             * \param[in] destinationIndex The zero based index in this array to receive the first bit.
+             */
+            void copyBits(const BitArray& source, Index sourceIndex, Index numberBits, Index destinationIndex);
+
+            /**
+             * Method you can use to move every bit towards higher indexes.  Bits shifted past the end of the array are
+             * discarded and vacated bits are cleared.  The array length is unchanged.
+             *
+             * \param[in] numberBits The number of positions to shift by.
+             */
+            void shiftLeft(Index numberBits);
+
+            /**
+             * Method you can use to move every bit towards lower indexes.  Bits shifted past the start of the array
+             * are discarded and vacated bits are cleared.  The array length is unchanged.
+             *
+             * \param[in] numberBits The number of positions to shift by.
+             */
+            void shiftRight(Index numberBits);
+
+            /**
+             * Method you can use to insert a range of bits.  Bits at and after the insertion point move up and the
+             * array grows by the number of bits inserted.
+             *
+             * \param[in] index      The zero based index where the new bits should be inserted.  The value may be
+             *                       equal to the array length to append bits.
+             *
+             * \param[in] numberBits The number of bits to insert.
+             *
+             * \param[in] value      The value to assign to the inserted bits.
+             */
+            void insertBits(Index index, Index numberBits, bool value = false);
+
+            /**
+             * Method you can use to remove a range of bits.  Bits after the range move down and the array shrinks by
+             * the number of bits removed.
+             *
+             * \param[in] index      The zero based index of the first bit to be removed.
+             *
+             * \param[in] numberBits The number of bits to remove.  The range must be within the array.
+             */
+            void removeBits(Index index, Index numberBits);
+
             /**
              * Assignment operator.
              *
@@ -256,6 +1164,15 @@ namespace Util {
              */
             BitArray& operator=(const BitArray& other);
 
+            /**
+             * Move assignment operator.  The other instance receives the previous contents of this instance.
+             *
+             * \param[in] other The instance to be moved into this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            BitArray& operator=(BitArray&& other);
+
             /**
              * Comparison operator.
              *
@@ -265,6 +1182,17 @@ namespace Util {
              */
             bool operator==(const BitArray& other) const;
 
+            /**
+             * Method you can use to compare this array against another array.
+             *
+             * \param[in] other     The instance to be compared against.
+             *
+             * \param[in] execution The execution mode to use.
+             *
+             * \return Returns true if the instances are equal.  Returns false if the instances are different.
+             */
+            bool isEqualTo(const BitArray& other, Execution execution) const;
+
             /**
              * Comparison operator.
              *
@@ -274,17 +1202,202 @@ namespace Util {
              */
             bool operator!=(const BitArray& other) const;
 
+            /**
+             * Less than operator.  Arrays are ordered lexicographically by bit, starting at bit zero.  An array that
+             * is a proper prefix of another array orders first.  You can use this operator to key ordered containers
+             * such as QMap.
+             *
+             * \param[in] other The instance to be compared against.
+             *
+             * \return Returns true if this array orders before the other array.  Returns false otherwise.
+             */
+            bool operator<(const BitArray& other) const;
+
+            /**
+             * Method that calculates a hash for this array suitable for use in hash tables and other similar
+             * structures.  Arrays that compare equal produce the same hash.  The hash of large arrays is cached until
+             * the array is modified.
+             *
+             * \param[in] seed An optional seed to apply to the hash.
+             *
+             * \return Returns a hash for this array.
+             */
+            HashResult hash(HashSeed seed = 0) const;
+
+            /**
+             * Modifying intersection operator.  The array will be extended to the length of the other array, if
+             * needed.
+             *
+             * \param[in] other The instance to intersect with this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            BitArray& operator&=(const BitArray& other);
+
+            /**
+             * Modifying union operator.  The array will be extended to the length of the other array, if needed.
+             *
+             * \param[in] other The instance to join with this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            BitArray& operator|=(const BitArray& other);
+
+            /**
+             * Modifying exclusive OR operator.  The array will be extended to the length of the other array, if
+             * needed.
+             *
+             * \param[in] other The instance to combine with this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            BitArray& operator^=(const BitArray& other);
+
+            /**
+             * Complement operator.
+             *
+             * \return Returns the complement of this array.
+             */
+            inline BitArray operator~() const {
+                return complement();
+            }
+
         private:
+            /**
+             * The number of words held inline.
+             */
+            static constexpr unsigned inlineWords = 2;
+
+            /**
+             * The largest array, in bits, that is held inline.
+             */
+            static constexpr Index inlineBits = 64 * inlineWords;
+
             /**
              * Private base class for the underlying shared data instance.
              */
             class Private;
 
             /**
-             * The underlying shared data instance.
+             * Class that provides read access to the array contents.
+             */
+            class Reader;
+
+            /**
+             * Class that provides write access to the array contents.
+             */
+            class Writer;
+
+            /**
+             * Method that takes ownership of a newly created shared data instance.  Small arrays that own their
+             * storage are moved into the inline buffer.
+             *
+             * \param[in] newImpl The new shared data instance.
+             */
+            void adopt(Private* newImpl);
+
+            /**
+             * The underlying shared data instance.  A null pointer indicates that the array is held inline.
              */
             QSharedDataPointer<Private> impl;
+
+            /**
+             * The inline buffer.  Bits past the inline length are always cleared.  The buffer is cleared whenever
+             * the shared data instance is in use.
+             */
+            std::uint64_t inlineData[inlineWords];
+
+            /**
+             * The array length, in bits, when the array is held inline.
+             */
+            Index inlineLength;
+
+            /**
+             * The allocator used to obtain word storage when the array outgrows the inline buffer.
+             */
+            BitArrayAllocator* currentAllocator;
     };
+
+    /**
+     * Hash function for the \ref Util::BitArray class.
+     *
+     * \param[in] bitArray The \ref Util::BitArray to be hashed.
+     *
+     * \param[in] seed     An optional seed to apply to the hash.
+     *
+     * \return Returns a hash for this value.
+     */
+    inline UTIL_PUBLIC_API HashResult qHash(const BitArray& bitArray, HashSeed seed = 0) {
+        return bitArray.hash(seed);
+    }
+}
+
+/**
+ * Intersection operator.
+ *
+ * \param[in] a The first bit array to calculate the intersection from.
+ *
+ * \param[in] b The second bit array to calculate the intersection from.
+ *
+ * \return Returns the bitwise AND of the two bit arrays.
+ */
+inline UTIL_PUBLIC_API Util::BitArray operator&(const Util::BitArray& a, const Util::BitArray& b) {
+    return a.intersectionBits(b);
+}
+
+/**
+ * Union operator.
+ *
+ * \param[in] a The first bit array to calculate the union from.
+ *
+ * \param[in] b The second bit array to calculate the union from.
+ *
+ * \return Returns the bitwise OR of the two bit arrays.
+ */
+inline UTIL_PUBLIC_API Util::BitArray operator|(const Util::BitArray& a, const Util::BitArray& b) {
+    return a.unionBits(b);
+}
+
+/**
+ * Exclusive OR operator.
+ *
+ * \param[in] a The first bit array to combine.
+ *
+ * \param[in] b The second bit array to combine.
+ *
+ * \return Returns the bitwise exclusive OR of the two bit arrays.
+ */
+inline UTIL_PUBLIC_API Util::BitArray operator^(const Util::BitArray& a, const Util::BitArray& b) {
+    return a.symmetricDifferenceBits(b);
+}
+
+/**
+ * Data stream insertion operator.  The array is written using run length compression in the same format as
+ * \ref Util::BitArray::write.
+ *
+ * \param[in] stream   The stream to write to.
+ *
+ * \param[in] bitArray The array to be written.
+ *
+ * \return Returns a reference to the stream.
+ */
+inline UTIL_PUBLIC_API QDataStream& operator<<(QDataStream& stream, const Util::BitArray& bitArray) {
+    bitArray.write(stream);
+    return stream;
+}
+
+/**
+ * Data stream extraction operator.  On error, the stream status is updated and the array is left unchanged.
+ *
+ * \param[in]  stream   The stream to read from.
+ *
+ * \param[out] bitArray The array to receive the stream contents.
+ *
+ * \return Returns a reference to the stream.
+ */
+inline UTIL_PUBLIC_API QDataStream& operator>>(QDataStream& stream, Util::BitArray& bitArray) {
+    bitArray.read(stream);
+    return stream;
 }
 
 #endif
@@ -0,0 +1,197 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref Util::BitArrayAllocator and \ref Util::BitArrayArena classes.
+***********************************************************************************************************************/
+
+/* .. sphinx-project ineutil */
+
+#ifndef UTIL_BIT_ARRAY_ALLOCATOR_H
+#define UTIL_BIT_ARRAY_ALLOCATOR_H
+
+#include <QMutex>
+#include <QList>
+
+#include <cstdint>
+
+#include "util_common.h"
+
+namespace Util {
+    /**
+     * Pure virtual base class for allocators that provide word storage to \ref Util::BitArray instances.  All
+     * storage is aligned to \ref Util::BitArrayAllocator::alignment bytes.
+     *
+     * Allocators must outlive every array that uses them.  The allocators returned by the static methods of this
+     * class live for the lifetime of the application.
+     */
+    class UTIL_PUBLIC_API BitArrayAllocator {
+        public:
+            /**
+             * The alignment of all storage provided by an allocator, in bytes.  The value matches the cache line
+             * size of common processors.
+             */
+            static constexpr unsigned alignment = 64;
+
+            virtual ~BitArrayAllocator();
+
+            /**
+             * Method that allocates storage for a number of words.  Storage is not initialized.
+             *
+             * \param[in] numberWords The number of words to allocate.  The value must be greater than zero.
+             *
+             * \return Returns a pointer to the newly allocated storage.
+             */
+            virtual std::uint64_t* allocate(unsigned long numberWords) = 0;
+
+            /**
+             * Method that releases storage previously obtained from \ref Util::BitArrayAllocator::allocate.
+             *
+             * \param[in] words       The storage to be released.
+             *
+             * \param[in] numberWords The number of words requested when the storage was allocated.
+             */
+            virtual void release(std::uint64_t* words, unsigned long numberWords) = 0;
+
+            /**
+             * Method you can use to obtain the default allocator.  The allocator obtains aligned storage directly
+             * from the heap.
+             *
+             * \return Returns a pointer to the default allocator.
+             */
+            static BitArrayAllocator* standard();
+
+            /**
+             * Method you can use to obtain an allocator that caches released storage in per-thread pools, sorted
+             * by size.  Storage can be released from any thread.  This allocator avoids contention on the heap
+             * when many short lived arrays are created and destroyed concurrently.
+             *
+             * \return Returns a pointer to the pooled allocator.
+             */
+            static BitArrayAllocator* threadPool();
+
+            /**
+             * Method you can use to obtain an allocator that backs large arrays with huge pages, where supported by
+             * the platform.  Smaller arrays use the default allocator.
+             *
+             * \return Returns a pointer to the huge page allocator.
+             */
+            static BitArrayAllocator* hugePages();
+    };
+}
+
+namespace Util {
+    /**
+     * Monotonic allocator that carves storage out of large blocks.  Released storage is not reused.  All storage is
+     * freed at once when the arena is reset or destroyed, which makes the arena a good fit for arrays that live only
+     * for the duration of a single query.  Every array using the arena must be destroyed before the arena is reset.
+     */
+    class UTIL_PUBLIC_API BitArrayArena:public BitArrayAllocator {
+        public:
+            /**
+             * The default block size, in words.
+             */
+            static constexpr unsigned long defaultBlockWords = 1UL << 16;
+
+            /**
+             * Constructor.
+             *
+             * \param[in] blockWords The size of each block, in words.  Larger allocations receive a dedicated block.
+             */
+            explicit BitArrayArena(unsigned long blockWords = defaultBlockWords);
+
+            BitArrayArena(const BitArrayArena& other) = delete;
+
+            ~BitArrayArena() override;
+
+            BitArrayArena& operator=(const BitArrayArena& other) = delete;
+
+            /**
+             * Method that allocates storage for a number of words.  Storage is not initialized.
+             *
+             * \param[in] numberWords The number of words to allocate.  The value must be greater than zero.
+             *
+             * \return Returns a pointer to the newly allocated storage.
+             */
+            std::uint64_t* allocate(unsigned long numberWords) override;
+
+            /**
+             * Method that releases storage.  Storage is only reclaimed when the arena is reset.
+             *
+             * \param[in] words       The storage to be released.
+             *
+             * \param[in] numberWords The number of words requested when the storage was allocated.
+             */
+            void release(std::uint64_t* words, unsigned long numberWords) override;
+
+            /**
+             * Method you can use to free all storage held by the arena.
+             */
+            void reset();
+
+            /**
+             * Method you can use to determine the total storage obtained from the heap by this arena.
+             *
+             * \return Returns the storage held by the arena, in words.
+             */
+            unsigned long heldWords() const;
+
+        private:
+            /**
+             * The number of words in a cache line.
+             */
+            static constexpr unsigned long wordsPerLine = alignment / sizeof(std::uint64_t);
+
+            /**
+             * The size of each shared block, in words.
+             */
+            unsigned long blockWords;
+
+            /**
+             * The blocks obtained from the heap.
+             */
+            QList<std::uint64_t*> blocks;
+
+            /**
+             * The size of each block, in words.
+             */
+            QList<unsigned long> blockSizes;
+
+            /**
+             * The next free word in the current block.
+             */
+            std::uint64_t* nextWord;
+
+            /**
+             * The number of free words remaining in the current block.
+             */
+            unsigned long remainingWords;
+
+            /**
+             * Mutex used to allow arrays on multiple threads to share the arena.
+             */
+            mutable QMutex mutex;
+    };
+}
+
+#endif
@@ -33,6 +33,12 @@
 #include <cstdint>
 #include <type_traits>
 
+#if (defined(_MSC_VER))
+
+    #include <intrin.h>
+
+#endif
+
 #include "util_common.h"
 
 namespace Util {
@@ -56,7 +62,8 @@ namespace Util {
     UTIL_PUBLIC_API unsigned numberOnes64(std::uint64_t value);
 
     /**
-     * Function that calculates the location of the MSB of a 32-bit value.
+     * Function that calculates the location of the MSB of a 32-bit value.  The function maps to a single LZCNT or BSR
+     * instruction on compilers that support it.
      *
      *  param[in] value The value to determine the MSB location of.
      *
@@ -74,6 +81,56 @@ namespace Util {
      */
     UTIL_PUBLIC_API int msbLocation64(std::uint64_t value);
 
+    /**
+     * Function that calculates the location of the LSB of a 32-bit value.  The function is inlined and maps to a
+     * single TZCNT or BSF instruction on compilers that support it.
+     *
+     *  param[in] value The value to determine the LSB location of.
+     *
+     * \return Returns the power of 2 indicating the location.  A value of -1 is returned for the value 0.
+     */
+    inline int lsbLocation32(std::uint32_t value) {
+        #if (defined(_MSC_VER))
+
+            unsigned long location;
+            return _BitScanForward(&location, value) ? static_cast<int>(location) : -1;
+
+        #elif (defined(__GNUC__) || defined(__clang__))
+
+            return value != 0 ? __builtin_ctz(value) : -1;
+
+        #else
+
+            return msbLocation32(value & (0 - value));
+
+        #endif
+    }
+
+    /**
+     * Function that calculates the location of the LSB of a 64-bit value.  The function is similar to lsbLocation32
+     * except that it operates on 64-bit values rather than 32-bit values.
+     *
+     *  param[in] value The value to determine the LSB location of.
+     *
+     * \return Returns the power of 2 indicating the location.  A value of -1 is returned for the value 0.
+     */
+    inline int lsbLocation64(std::uint64_t value) {
+        #if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64)))
+
+            unsigned long location;
+            return _BitScanForward64(&location, value) ? static_cast<int>(location) : -1;
+
+        #elif (defined(__GNUC__) || defined(__clang__))
+
+            return value != 0 ? __builtin_ctzll(value) : -1;
+
+        #else
+
+            return msbLocation64(value & (0 - value));
+
+        #endif
+    }
+
     /**
      * Template function that creates a mask with a single "1" at the least significant "1" in a number.
      *
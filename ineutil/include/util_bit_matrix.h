@@ -0,0 +1,362 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref Util::BitMatrix class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project ineutil */
+
+#ifndef UTIL_BIT_MATRIX_H
+#define UTIL_BIT_MATRIX_H
+
+#include <QList>
+
+#include <cstdint>
+
+#include "util_common.h"
+#include "util_bit_array.h"
+#include "util_bit_array_allocator.h"
+
+namespace Util {
+    /**
+     * Class that provides a two dimensional matrix of bits.  Rows are held contiguously in a single buffer, each row
+     * occupying a whole number of 64-bit words, so row operations process a word at a time and the matrix needs a
+     * single allocation regardless of the number of rows.
+     *
+     * The class is intended for adjacency matrices of directed graphs.  Row r, column c is set when there is an edge
+     * from node r to node c.
+     */
+    class UTIL_PUBLIC_API BitMatrix {
+        public:
+            /**
+             * Type used to represent a row or column index.
+             */
+            typedef BitArray::Index Index;
+
+            /**
+             * Constructor, creates an empty matrix.
+             */
+            BitMatrix();
+
+            /**
+             * Constructor.
+             *
+             * \param[in] numberRows    The number of rows in the matrix.
+             *
+             * \param[in] numberColumns The number of columns in the matrix.
+             *
+             * \param[in] value         The initial value for every bit.
+             *
+             * \param[in] allocator     The allocator used to obtain storage for the matrix.
+             */
+            BitMatrix(
+                Index              numberRows,
+                Index              numberColumns,
+                bool               value = false,
+                BitArrayAllocator* allocator = BitArrayAllocator::standard()
+            );
+
+            /**
+             * Constructor, creates a matrix from a list of rows.  The matrix has as many columns as the longest row.
+             * Shorter rows are padded with cleared bits.
+             *
+             * \param[in] rows The rows of the matrix.
+             */
+            BitMatrix(const QList<BitArray>& rows);
+
+            /**
+             * Copy constructor.
+             *
+             * \param[in] other The instance to be copied.
+             */
+            BitMatrix(const BitMatrix& other);
+
+            /**
+             * Move constructor.  The other instance is left empty.
+             *
+             * \param[in] other The instance to be moved.
+             */
+            BitMatrix(BitMatrix&& other);
+
+            ~BitMatrix();
+
+            /**
+             * Method you can use to create a square identity matrix.
+             *
+             * \param[in] size      The number of rows and columns in the matrix.
+             *
+             * \param[in] allocator The allocator used to obtain storage for the matrix.
+             *
+             * \return Returns the identity matrix.
+             */
+            static BitMatrix identity(Index size, BitArrayAllocator* allocator = BitArrayAllocator::standard());
+
+            /**
+             * Method you can use to determine the number of rows in the matrix.
+             *
+             * \return Returns the number of rows.
+             */
+            Index numberRows() const;
+
+            /**
+             * Method you can use to determine the number of columns in the matrix.
+             *
+             * \return Returns the number of columns.
+             */
+            Index numberColumns() const;
+
+            /**
+             * Method you can use to determine if the matrix is empty.
+             *
+             * \return Returns true if the matrix has no rows or no columns.
+             */
+            bool isEmpty() const;
+
+            /**
+             * Method you can use to determine the number of words used to store each row.
+             *
+             * \return Returns the number of words per row.
+             */
+            Index wordsPerRow() const;
+
+            /**
+             * Method you can use to read the words of a row directly.  Bits are ordered LSB first and bits past the
+             * last column are cleared.  The pointer is invalidated by any change to the matrix.
+             *
+             * \param[in] row The zero based row index.
+             *
+             * \return Returns a pointer to the \ref Util::BitMatrix::wordsPerRow words holding the row.
+             */
+            const std::uint64_t* rowData(Index row) const;
+
+            /**
+             * Method you can use to count the set bits in the matrix.
+             *
+             * \return Returns the number of set bits.
+             */
+            Index popcount() const;
+
+            /**
+             * Method you can use to count the set bits in a row.
+             *
+             * \param[in] row The zero based row index.
+             *
+             * \return Returns the number of set bits in the row.
+             */
+            Index rowPopcount(Index row) const;
+
+            /**
+             * Method you can use to determine if a bit is set.
+             *
+             * \param[in] row    The zero based row index.
+             *
+             * \param[in] column The zero based column index.
+             *
+             * \return Returns true if the bit is set.  Returns false if the bit is cleared.
+             */
+            bool isSet(Index row, Index column) const;
+
+            /**
+             * Method you can use to set or clear a bit.
+             *
+             * \param[in] row     The zero based row index.
+             *
+             * \param[in] column  The zero based column index.
+             *
+             * \param[in] nowSet  If true, the bit will be set.  If false, the bit will be cleared.
+             */
+            void setBit(Index row, Index column, bool nowSet = true);
+
+            /**
+             * Method you can use to clear a bit.
+             *
+             * \param[in] row    The zero based row index.
+             *
+             * \param[in] column The zero based column index.
+             */
+            void clearBit(Index row, Index column);
+
+            /**
+             * Method you can use to obtain a copy of a row.
+             *
+             * \param[in] row The zero based row index.
+             *
+             * \return Returns the row as an array holding one bit per column.
+             */
+            BitArray row(Index row) const;
+
+            /**
+             * Method you can use to replace a row.
+             *
+             * \param[in] row     The zero based row index.
+             *
+             * \param[in] rowBits The new row contents.  The array must not be longer than the number of columns.
+             *                    Columns past the end of the array are cleared.
+             */
+            void setRow(Index row, const BitArray& rowBits);
+
+            /**
+             * Method you can use to obtain a copy of every row.
+             *
+             * \return Returns a list holding one array per row.
+             */
+            QList<BitArray> toRows() const;
+
+            /**
+             * Method you can use to OR one row of the matrix into another.
+             *
+             * \param[in] destinationRow The zero based index of the row to be updated.
+             *
+             * \param[in] sourceRow      The zero based index of the row to OR into the destination row.
+             */
+            void orRow(Index destinationRow, Index sourceRow);
+
+            /**
+             * Method you can use to OR an array into a row.
+             *
+             * \param[in] destinationRow The zero based index of the row to be updated.
+             *
+             * \param[in] rowBits        The bits to OR into the row.  The array must not be longer than the number
+             *                           of columns.
+             */
+            void orRow(Index destinationRow, const BitArray& rowBits);
+
+            /**
+             * Method you can use to AND one row of the matrix into another.
+             *
+             * \param[in] destinationRow The zero based index of the row to be updated.
+             *
+             * \param[in] sourceRow      The zero based index of the row to AND into the destination row.
+             */
+            void andRow(Index destinationRow, Index sourceRow);
+
+            /**
+             * Method you can use to AND an array into a row.
+             *
+             * \param[in] destinationRow The zero based index of the row to be updated.
+             *
+             * \param[in] rowBits        The bits to AND into the row.  The array must not be longer than the number
+             *                           of columns.  Columns past the end of the array are cleared.
+             */
+            void andRow(Index destinationRow, const BitArray& rowBits);
+
+            /**
+             * Method you can use to calculate the transpose of this matrix.  The matrix is processed as 64 by 64 bit
+             * blocks, each transposed within registers.
+             *
+             * \return Returns the transposed matrix.
+             */
+            BitMatrix transposed() const;
+
+            /**
+             * Method you can use to calculate the boolean product of this matrix and another matrix.  Bit r, c of the
+             * result is set if there is some k where bit r, k of this matrix and bit k, c of the other matrix are both
+             * set.  For adjacency matrices, the result holds the paths that take one step in this graph followed by
+             * one step in the other graph.
+             *
+             * \param[in] other The right hand matrix.  The matrix must have as many rows as this matrix has columns.
+             *
+             * \return Returns the boolean product.
+             */
+            BitMatrix multiplied(const BitMatrix& other) const;
+
+            /**
+             * Method you can use to calculate the transitive closure of this matrix.  Bit r, c of the result is set if
+             * node c can be reached from node r by following one or more edges.  The closure is calculated using a
+             * blocked form of Warshall's algorithm, with rows updated a word at a time and concurrently across the
+             * global thread pool.
+             *
+             * \return Returns the transitive closure.  The matrix must be square.
+             */
+            BitMatrix transitiveClosure() const;
+
+            /**
+             * Assignment operator.
+             *
+             * \param[in] other The instance to be assigned to this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            BitMatrix& operator=(const BitMatrix& other);
+
+            /**
+             * Move assignment operator.  The other instance is left in a valid but unspecified state.
+             *
+             * \param[in] other The instance to be moved to this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            BitMatrix& operator=(BitMatrix&& other);
+
+            /**
+             * Comparison operator.
+             *
+             * \param[in] other The instance to compare against.
+             *
+             * \return Returns true if the matrices have the same dimensions and contents.
+             */
+            bool operator==(const BitMatrix& other) const;
+
+            /**
+             * Comparison operator.
+             *
+             * \param[in] other The instance to compare against.
+             *
+             * \return Returns true if the matrices differ in dimensions or contents.
+             */
+            bool operator!=(const BitMatrix& other) const;
+
+            /**
+             * Multiplication operator.  Calculates the boolean product of two matrices.
+             *
+             * \param[in] other The right hand matrix.
+             *
+             * \return Returns the boolean product.
+             */
+            BitMatrix operator*(const BitMatrix& other) const;
+
+        private:
+            /**
+             * The matrix contents, in row major order.
+             */
+            BitArray bits;
+
+            /**
+             * The number of rows.
+             */
+            Index currentNumberRows;
+
+            /**
+             * The number of columns.
+             */
+            Index currentNumberColumns;
+
+            /**
+             * The number of words per row.
+             */
+            Index currentWordsPerRow;
+    };
+}
+
+#endif
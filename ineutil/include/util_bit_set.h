@@ -33,15 +33,20 @@
 #include <QString>
 #include <QHash>
 #include <QList>
+#include <QVector>
 
 #include <cstdint>
+#include <cstddef>
+#include <iterator>
 
 #include "util_common.h"
 #include "util_hash_functions.h"
+#include "util_bit_functions.h"
 
 namespace Util {
     class BitSetForwardIterator;
     class BitSetReverseIterator;
+    class BitSetIndexIterator;
 
     /**
      * Class that can be used to maintain an extensible set of flags.  You can use this class in much the same way as
@@ -51,12 +56,164 @@ namespace Util {
     class UTIL_PUBLIC_API BitSet {
         friend class BitSetForwardIterator;
         friend class BitSetReverseIterator;
+        friend class BitSetIndexIterator;
 
         public:
             /**
-             * Type used for bit name hashes.
-             */
-            typedef QHash<QString, unsigned> BitNameHash;
+             * Type used for bit name hashes.  Along with the name to index mapping, the hash maintains a table mapping
+             * each bit index back to its bit name.  The table is updated by the \ref insert, \ref remove, \ref take,
+             * and \ref clear methods so you should modify the hash only through these methods.
+             */
+            class UTIL_PUBLIC_API BitNameHash:public QHash<QString, unsigned> {
+                public:
+                    BitNameHash();
+
+                    ~BitNameHash();
+
+                    /**
+                     * Method you can use to add a bit name to the hash.  Bit indexes need not be assigned
+                     * consecutively.
+                     *
+                     * \param[in] bitName  The name of the bit.  An existing entry with the same name is replaced.
+                     *
+                     * \param[in] bitIndex The zero based index of the bit.
+                     *
+                     * \return Returns an iterator to the inserted entry.
+                     */
+                    iterator insert(const QString& bitName, unsigned bitIndex);
+
+                    /**
+                     * Method you can use to remove a bit name from the hash.
+                     *
+                     * \param[in] bitName The name of the bit to be removed.
+                     *
+                     * \return Returns the number of entries removed.
+                     */
+                    int remove(const QString& bitName);
+
+                    /**
+                     * Method you can use to remove a bit name from the hash and obtain its index.
+                     *
+                     * \param[in] bitName The name of the bit to be removed.
+                     *
+                     * \return Returns the index of the removed bit.  A default constructed value is returned if the
+                     *         bit name is not in the hash.
+                     */
+                    unsigned take(const QString& bitName);
+
+                    /**
+                     * Method you can use to remove every bit name from the hash.
+                     */
+                    void clear();
+
+                    /**
+                     * Method you can use to obtain the name of a bit from its index.
+                     *
+                     * \param[in] bitIndex The zero based index of the bit.
+                     *
+                     * \return Returns the name of the bit.  An empty string is returned if no bit has the index.
+                     */
+                    QString bitName(unsigned bitIndex) const;
+
+                    /**
+                     * Array subscript operator.  Only lookups are supported so that the index to name table can not
+                     * be bypassed.
+                     *
+                     * \param[in] bitName The name of the bit.
+                     *
+                     * \return Returns the index of the bit.  A default constructed value is returned if the bit name
+                     *         is not in the hash.
+                     */
+                    inline unsigned operator[](const QString& bitName) const {
+                        return value(bitName);
+                    }
+
+                private:
+                    /**
+                     * Table of bit names, indexed by bit index.  Entries for unused bit indexes are empty.
+                     */
+                    QVector<QString> bitNamesByIndex;
+            };
+
+            /**
+             * Class that identifies a bit that has been resolved from its name.  Handles let frequently executed code
+             * set and test bits without hashing the bit name each time.  A handle is only meaningful for bit sets
+             * that use the bit name hash the handle was resolved against.
+             */
+            class Handle {
+                friend class BitSet;
+
+                public:
+                    /**
+                     * Constructor, creates an invalid handle.
+                     */
+                    inline Handle():names(Q_NULLPTR),index(invalidBitIndex) {}
+
+                    /**
+                     * Method you can use to determine if the handle refers to a defined bit.
+                     *
+                     * \return Returns true if the handle is valid.  Returns false if the handle is invalid.
+                     */
+                    inline bool isValid() const {
+                        return index != invalidBitIndex;
+                    }
+
+                    /**
+                     * Method you can use to determine the bit index the handle refers to.
+                     *
+                     * \return Returns the zero based bit index.  An invalid handle returns the largest unsigned value.
+                     */
+                    inline unsigned bitIndex() const {
+                        return index;
+                    }
+
+                    /**
+                     * Comparison operator.
+                     *
+                     * \param[in] other The instance to compare against.
+                     *
+                     * \return Returns true if the handles refer to the same bit of the same bit name hash.
+                     */
+                    inline bool operator==(const Handle& other) const {
+                        return names == other.names && index == other.index;
+                    }
+
+                    /**
+                     * Comparison operator.
+                     *
+                     * \param[in] other The instance to compare against.
+                     *
+                     * \return Returns true if the handles refer to different bits.
+                     */
+                    inline bool operator!=(const Handle& other) const {
+                        return !operator==(other);
+                    }
+
+                private:
+                    /**
+                     * Value used to mark an invalid handle.
+                     */
+                    static constexpr unsigned invalidBitIndex = static_cast<unsigned>(-1);
+
+                    /**
+                     * Constructor.
+                     *
+                     * \param[in] names The bit name hash the handle was resolved against.
+                     *
+                     * \param[in] index The zero based bit index.
+                     */
+                    inline Handle(const BitNameHash* names, unsigned index):names(names),index(index) {}
+
+                    /**
+                     * The bit name hash the handle was resolved against.
+                     */
+                    const BitNameHash* names;
+
+                    /**
+                     * The zero based bit index.
+                     */
+                    unsigned index;
+            };
 
         protected:
             /**
@@ -71,6 +228,20 @@ namespace Util {
         public:
             BitSet();
 
+            /**
+             * Method you can use to add a bit to a bit name hash and obtain a handle to it.  The method is intended to
+             * be used to initialize static handles in derived classes, so that bit names are hashed once at start-up
+             * rather than on every access.  The bit name hash must be constructed before the method is called and
+             * registration must complete before bit sets using the hash are accessed from multiple threads.
+             *
+             * \param[in] bitHash The bit name hash to add the bit to.
+             *
+             * \param[in] bitName The name of the bit.  If the name is already defined, the existing bit is used.
+             *
+             * \return Returns a handle to the bit.
+             */
+            static Handle registerBit(BitNameHash* bitHash, const QString& bitName);
+
             /**
              * Copy constructor
              *
@@ -94,6 +265,15 @@ namespace Util {
              */
             bool bitDefined(const QString& bitName);
 
+            /**
+             * Method you can use to resolve a bit name to a handle.
+             *
+             * \param[in] bitName The name of the bit.
+             *
+             * \return Returns a handle to the bit.  An invalid handle is returned if the bit is not defined.
+             */
+            Handle handle(const QString& bitName) const;
+
             /**
              * Method you can use to selectively set or clear an individual bit.
              *
@@ -116,6 +296,51 @@ namespace Util {
              */
             bool clearBit(const QString& bitName, bool isClear = true);
 
+            /**
+             * Method you can use to selectively set or clear an individual bit using a previously resolved handle.
+             *
+             * \param[in] bitHandle The handle of the bit.  The handle must have been resolved against the bit name
+             *                      hash used by this set.
+             *
+             * \param[in] isSet     If true, the bit will be set.  If false, the bit will be cleared.
+             *
+             * \return Returns true if the handle is valid.  Returns false if the handle is invalid.
+             */
+            inline bool setBit(const Handle& bitHandle, bool isSet = true) {
+                Q_ASSERT(!bitHandle.isValid() || bitHandle.names == bitNames);
+
+                bool success = bitHandle.isValid();
+                if (success) {
+                    unsigned wordIndex = bitHandle.index / bitsPerEntry;
+                    if (wordIndex >= static_cast<unsigned>(bitArray.size())) {
+                        growToHold(wordIndex);
+                    }
+
+                    ArrayType mask = static_cast<ArrayType>(1) << (bitHandle.index % bitsPerEntry);
+                    if (isSet) {
+                        bitArray[wordIndex] |= mask;
+                    } else {
+                        bitArray[wordIndex] &= ~mask;
+                    }
+                }
+
+                return success;
+            }
+
+            /**
+             * Method you can use to selectively clear or set an individual bit using a previously resolved handle.
+             *
+             * \param[in] bitHandle The handle of the bit.  The handle must have been resolved against the bit name
+             *                      hash used by this set.
+             *
+             * \param[in] isClear   If true, the bit will be cleared.  If false, the bit will be set.
+             *
+             * \return Returns true if the handle is valid.  Returns false if the handle is invalid.
+             */
+            inline bool clearBit(const Handle& bitHandle, bool isClear = true) {
+                return setBit(bitHandle, !isClear);
+            }
+
             /**
              * Template method that sets one or more bits, by name.
              *
@@ -204,6 +429,38 @@ namespace Util {
              */
             bool isCleared(const QString& bitName) const;
 
+            /**
+             * Method you can use to determine if a specific bit is set using a previously resolved handle.
+             *
+             * \param[in] bitHandle The handle of the bit.  The handle must have been resolved against the bit name
+             *                      hash used by this set.
+             *
+             * \return Returns true if the bit is set.  Returns false if the bit is cleared or the handle is invalid.
+             */
+            inline bool isSet(const Handle& bitHandle) const {
+                Q_ASSERT(!bitHandle.isValid() || bitHandle.names == bitNames);
+
+                // An invalid handle maps past the end of the array and so reads as cleared.
+
+                unsigned wordIndex = bitHandle.index / bitsPerEntry;
+                return (
+                       wordIndex < static_cast<unsigned>(bitArray.size())
+                    && ((bitArray.at(wordIndex) >> (bitHandle.index % bitsPerEntry)) & 1) != 0
+                );
+            }
+
+            /**
+             * Method you can use to determine if a specific bit is cleared using a previously resolved handle.
+             *
+             * \param[in] bitHandle The handle of the bit.  The handle must have been resolved against the bit name
+             *                      hash used by this set.
+             *
+             * \return Returns true if the bit is cleared or the handle is invalid.  Returns false if the bit is set.
+             */
+            inline bool isCleared(const Handle& bitHandle) const {
+                return !isSet(bitHandle);
+            }
+
             /**
              * Method that determines if this bit set instance tracks the same bits as another instance.
              *
@@ -276,12 +533,21 @@ namespace Util {
             QList<QString> bits() const;
 
             /**
-             * Method that returns a list of the names of all the set bits.  Note that this method is slow.
+             * Method that returns a list of the names of all the set bits.  The time required is proportional to the
+             * number of set bits rather than the number of defined bits.
              *
-             * \return Returns a list of the name of every set bit.
+             * \return Returns a list of the name of every set bit, in bit index order.
              */
             QList<QString> setBits() const;
 
+            /**
+             * Method that returns a list of the indexes of all the set bits.  Unlike \ref BitSet::setBits, this method
+             * does not need to look up any bit names.
+             *
+             * \return Returns a list of the zero based index of every set bit, in ascending order.
+             */
+            QList<unsigned> setBitIndexes() const;
+
             /**
              * Method that returns a universal set for the given type.
              *
@@ -298,7 +564,8 @@ namespace Util {
 
             /**
              * Method that calculates a hash for this \ref Util::BitSet suitable for use in hash tables and other
-             * similar structures.
+             * similar structures.  Every word of the set is mixed into the hash and sets that compare equal produce
+             * the same hash.
              *
              * \param[in] seed An optional seed to apply to the hash.
              *
@@ -400,6 +667,17 @@ namespace Util {
                 return isSet(QString::fromLocal8Bit(bitName));
             }
 
+            /**
+             * Index operator.
+             *
+             * \param[in] bitHandle The handle of the bit to check.
+             *
+             * \return Returns true if the bit is set.  Returns false if the bit is cleared.
+             */
+            inline bool operator[](const Handle& bitHandle) const {
+                return isSet(bitHandle);
+            }
+
             /**
              * Modifying intersection operator.  This operator will assert if the two instances do not use the same bit
              * name hash.
@@ -432,6 +710,18 @@ namespace Util {
                 return *this;
             }
 
+            /**
+             * Modifying bit set operator.
+             *
+             * \param[in] bitHandle The handle of the bit to be set.
+             *
+             * \return Returns a reference to this object.
+             */
+            inline BitSet& operator<<(const Handle& bitHandle) {
+                setBit(bitHandle, true);
+                return *this;
+            }
+
             /**
              * Complement operator.
              *
@@ -441,16 +731,45 @@ namespace Util {
                 return complement();
             }
 
+            /**
+             * Method you can use to obtain an iterator to the first set bit.  Together with \ref BitSet::end, this
+             * method allows a bit set to be used in a range based for loop, visiting the index of each set bit.
+             *
+             * \return Returns an iterator to the lowest set bit.
+             */
+            inline BitSetIndexIterator begin() const;
+
+            /**
+             * Method you can use to obtain an iterator just past the last set bit.
+             *
+             * \return Returns an end iterator for this set.
+             */
+            inline BitSetIndexIterator end() const;
+
         private:
             /**
              * Type used for the internal array storage.
              */
-            typedef std::uint32_t ArrayType;
+            typedef std::uint64_t ArrayType;
 
             /**
              * Value indicating the number of bits stored per array entry type.
              */
-            static constexpr unsigned bitsPerEntry = 32;
+            static constexpr unsigned bitsPerEntry = 64;
+
+            /**
+             * Method that determines the number of words needed to hold every bit in the bit name hash.
+             *
+             * \return Returns the number of words needed.
+             */
+            unsigned requiredWords() const;
+
+            /**
+             * Method that grows the array to hold a word and every bit in the bit name hash.
+             *
+             * \param[in] wordIndex The index of the word that must be held.
+             */
+            void growToHold(unsigned wordIndex);
 
             /**
              * Pointer to the underlying hash.
@@ -458,9 +777,11 @@ namespace Util {
             BitNameHash* bitNames;
 
             /**
-             * The underlying bit array.
+             * The underlying bit array.  The array is sized to hold every bit in the bit name hash when the set is
+             * created and grows if bits are added to the hash later.  Words past the end of the array are treated as
+             * cleared.
              */
-            QList<ArrayType> bitArray;
+            QVector<ArrayType> bitArray;
     };
 
     /**
@@ -561,6 +882,11 @@ namespace Util {
             bool operator!=(const BitSetForwardIterator& other);
 
         private:
+            /**
+             * Method that updates the reported value to reflect the current position.
+             */
+            void updateReportedValue() const;
+
             /**
              * Pointer to the bit set we are operating on.
              */
@@ -577,9 +903,15 @@ namespace Util {
             unsigned currentWord;
 
             /**
-             * A bit set used to report the current value.
+             * A bit set used to report the current value.  The value is only built when the iterator is dereferenced.
              */
-            BitSet reportedValue;
+            mutable BitSet reportedValue;
+
+            /**
+             * The word holding the bit in the reported value.  A value past the end of the array indicates that no
+             * word is set.
+             */
+            mutable unsigned reportedWord;
     };
 
     /**
@@ -680,6 +1012,11 @@ namespace Util {
             bool operator!=(const BitSetReverseIterator& other);
 
         private:
+            /**
+             * Method that updates the reported value to reflect the current position.
+             */
+            void updateReportedValue() const;
+
             /**
              * Pointer to the bit set we are operating on.
              */
@@ -696,23 +1033,190 @@ namespace Util {
             unsigned currentWord;
 
             /**
-             * A bit set used to report the current value.
+             * A bit set used to report the current value.  The value is only built when the iterator is dereferenced.
              */
-            BitSet reportedValue;
+            mutable BitSet reportedValue;
+
+            /**
+             * The word holding the bit in the reported value.  A value past the end of the array indicates that no
+             * word is set.
+             */
+            mutable unsigned reportedWord;
     };
-}
 
-/**
- * Hash function for the \ref Util::BitSet class.
- *
- * \param[in] value The \ref Util::BitSet to be hashed.
- *
- * \param[in] seed  A seed to apply when calculating the hash.
- *
- * \return Returns a hash for this value.
- */
-inline UTIL_PUBLIC_API Util::HashResult qHash(const Util::BitSet& value, Util::HashSeed seed = 0) {
-    return value.hash(seed);
+    /**
+     * Class that can be used to iterate through the indexes of the set bits in a \ref Util::BitSet.  The iterator holds
+     * only the remaining bits of the current word and the word's position so it can be used with range based for loops
+     * and standard algorithms without allocating memory.  Indexes are returned by value so the iterator is an input
+     * iterator.  The bit set must not be modified while it is being iterated.
+     */
+    class UTIL_PUBLIC_API BitSetIndexIterator {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef unsigned                value_type;
+            typedef std::ptrdiff_t          difference_type;
+            typedef const unsigned*         pointer;
+            typedef unsigned                reference;
+
+            /**
+             * Constructor, creates an iterator that is not associated with a bit set.
+             */
+            inline BitSetIndexIterator():workingBitSet(Q_NULLPTR),workingValue(0),currentWord(0) {}
+
+            /**
+             * Constructor.
+             *
+             * \param[in] bitSet The \ref Util::BitSet to iterate over.
+             *
+             * \param[in] atEnd  If true, the iterator will be positioned past the last set bit.  If false, the iterator
+             *                   will be positioned on the lowest set bit.
+             */
+            inline BitSetIndexIterator(
+                    const BitSet& bitSet,
+                    bool          atEnd = false
+                ):workingBitSet(
+                    &bitSet
+                ),workingValue(
+                    0
+                ),currentWord(
+                    static_cast<unsigned>(bitSet.bitArray.size())
+                ) {
+                if (!atEnd) {
+                    currentWord = 0;
+                    advanceToNonZeroWord();
+                }
+            }
+
+            /**
+             * Method you can use to determine the name of the current bit.  The name is looked up on demand so
+             * iterating by index costs nothing unless names are requested.
+             *
+             * \return Returns the name of the bit the iterator points to.  An empty string is returned if the bit has
+             *         no name.
+             */
+            QString bitName() const;
+
+            /**
+             * Prefix increment operator.
+             *
+             * \return Returns a reference to this instance.
+             */
+            inline BitSetIndexIterator& operator++() {
+                workingValue &= workingValue - 1;
+                if (workingValue == 0) {
+                    ++currentWord;
+                    advanceToNonZeroWord();
+                }
+
+                return *this;
+            }
+
+            /**
+             * Postfix increment operator.
+             *
+             * \param[in] dummy Dummy parameter, unused.
+             *
+             * \return Returns a copy of this instance prior to the increment operation.
+             */
+            inline BitSetIndexIterator operator++(int dummy) {
+                (void) dummy;
+
+                BitSetIndexIterator oldValue(*this);
+                operator++();
+
+                return oldValue;
+            }
+
+            /**
+             * Dereference operator.
+             *
+             * \return Returns the zero based index of the bit the iterator points to.
+             */
+            inline unsigned operator*() const {
+                return currentWord * BitSet::bitsPerEntry + static_cast<unsigned>(lsbLocation64(workingValue));
+            }
+
+            /**
+             * Comparison operator.
+             *
+             * \param[in] other The instance to be compared against.
+             *
+             * \return Returns true if the iterators are identical.  Returns false if the iterators are different.
+             */
+            inline bool operator==(const BitSetIndexIterator& other) const {
+                return (
+                       workingBitSet == other.workingBitSet
+                    && workingValue  == other.workingValue
+                    && currentWord   == other.currentWord
+                );
+            }
+
+            /**
+             * Comparison operator.
+             *
+             * \param[in] other The instance to be compared against.
+             *
+             * \return Returns true if the iterators are different.  Returns false if the iterators are identical.
+             */
+            inline bool operator!=(const BitSetIndexIterator& other) const {
+                return !operator==(other);
+            }
+
+        private:
+            /**
+             * Method that moves forward from the current word to the next word with a set bit.  If there are no more
+             * set bits, the iterator is left at the end position.
+             */
+            inline void advanceToNonZeroWord() {
+                const QVector<BitSet::ArrayType>& workingArray     = workingBitSet->bitArray;
+                unsigned                          workingArraySize = static_cast<unsigned>(workingArray.size());
+
+                while (currentWord < workingArraySize && workingArray.at(static_cast<int>(currentWord)) == 0) {
+                    ++currentWord;
+                }
+
+                workingValue = currentWord < workingArraySize ? workingArray.at(static_cast<int>(currentWord)) : 0;
+            }
+
+            /**
+             * Pointer to the bit set we are operating on.
+             */
+            const BitSet* workingBitSet;
+
+            /**
+             * The bits of the current word that have not yet been visited.
+             */
+            BitSet::ArrayType workingValue;
+
+            /**
+             * The current word in the bit set.
+             */
+            unsigned currentWord;
+    };
+
+
+    inline BitSetIndexIterator BitSet::begin() const {
+        return BitSetIndexIterator(*this);
+    }
+
+
+    inline BitSetIndexIterator BitSet::end() const {
+        return BitSetIndexIterator(*this, true);
+    }
+
+    /**
+     * Hash function for the \ref Util::BitSet class.  The function is placed in the Util namespace so that it is
+     * found by argument dependent lookup when \ref Util::BitSet instances are used as QHash or QSet keys.
+     *
+     * \param[in] value The \ref Util::BitSet to be hashed.
+     *
+     * \param[in] seed  A seed to apply when calculating the hash.
+     *
+     * \return Returns a hash for this value.
+     */
+    inline UTIL_PUBLIC_API HashResult qHash(const BitSet& value, HashSeed seed = 0) {
+        return value.hash(seed);
+    }
 }
 
 /**
@@ -0,0 +1,289 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref Util::BloomFilter class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project ineutil */
+
+#ifndef UTIL_BLOOM_FILTER_H
+#define UTIL_BLOOM_FILTER_H
+
+#include <cstdint>
+
+#include "util_common.h"
+#include "util_bit_array.h"
+
+namespace Util {
+    /**
+     * Class that provides a blocked Bloom filter.  The filter is divided into cache line sized blocks and every
+     * probe for a key falls within a single block, so each insertion or lookup costs at most one cache miss.
+     *
+     * Keys are supplied as 64-bit hashes, for example as calculated by \ref Util::hashWords.  The hashes should be
+     * well mixed as the filter uses them directly.
+     */
+    class UTIL_PUBLIC_API BloomFilter {
+        public:
+            /**
+             * The number of bits in each block.  Blocks match the cache line size of common processors.
+             */
+            static constexpr unsigned bitsPerBlock = 512;
+
+            /**
+             * The maximum supported number of hash functions.
+             */
+            static constexpr unsigned maximumNumberHashes = 16;
+
+            /**
+             * Constructor, creates an empty filter.  The filter reports that no key is present and must be assigned
+             * before use.
+             */
+            BloomFilter();
+
+            /**
+             * Constructor.
+             *
+             * \param[in] numberBits   The desired filter size, in bits.  The value is rounded up to a whole number
+             *                         of blocks.
+             *
+             * \param[in] numberHashes The number of bits set for each key.  The value is clamped to the range 1 to
+             *                         \ref Util::BloomFilter::maximumNumberHashes.
+             *
+             * \param[in] allocator    The allocator used to obtain storage for the filter.
+             */
+            BloomFilter(
+                unsigned long      numberBits,
+                unsigned           numberHashes,
+                BitArrayAllocator* allocator = BitArrayAllocator::standard()
+            );
+
+            /**
+             * Copy constructor.
+             *
+             * \param[in] other The instance to be copied.
+             */
+            BloomFilter(const BloomFilter& other);
+
+            ~BloomFilter();
+
+            /**
+             * Method you can use to create a filter sized to hold a number of keys at a target false positive rate.
+             *
+             * \param[in] expectedKeys      The expected number of keys to be inserted.
+             *
+             * \param[in] falsePositiveRate The desired false positive rate.  The value must be between 0 and 1,
+             *                              exclusive.
+             *
+             * \return Returns the newly created filter.
+             */
+            static BloomFilter forCapacity(unsigned long expectedKeys, double falsePositiveRate);
+
+            /**
+             * Method you can use to determine the filter size needed to hold a number of keys at a target false
+             * positive rate.  The size accounts for the uneven distribution of keys across blocks.
+             *
+             * \param[in] expectedKeys      The expected number of keys to be inserted.
+             *
+             * \param[in] falsePositiveRate The desired false positive rate.  The value must be between 0 and 1,
+             *                              exclusive.
+             *
+             * \return Returns the required filter size, in bits.  The value is a whole number of blocks.
+             */
+            static unsigned long optimalNumberBits(unsigned long expectedKeys, double falsePositiveRate);
+
+            /**
+             * Method you can use to determine the number of hash functions that minimizes the false positive rate.
+             *
+             * \param[in] numberBits   The filter size, in bits.
+             *
+             * \param[in] expectedKeys The expected number of keys to be inserted.
+             *
+             * \return Returns the optimal number of hash functions.
+             */
+            static unsigned optimalNumberHashes(unsigned long numberBits, unsigned long expectedKeys);
+
+            /**
+             * Method you can use to estimate the false positive rate of a filter.  The estimate models the number of
+             * keys landing in each block as a Poisson distribution.
+             *
+             * \param[in] numberBits   The filter size, in bits.
+             *
+             * \param[in] numberHashes The number of hash functions.
+             *
+             * \param[in] numberKeys   The number of keys inserted.
+             *
+             * \return Returns the estimated false positive rate.
+             */
+            static double estimatedFalsePositiveRate(
+                unsigned long numberBits,
+                unsigned      numberHashes,
+                unsigned long numberKeys
+            );
+
+            /**
+             * Method you can use to determine the size of the filter.
+             *
+             * \return Returns the filter size, in bits.
+             */
+            unsigned long numberBits() const;
+
+            /**
+             * Method you can use to determine the number of hash functions.
+             *
+             * \return Returns the number of bits set for each key.
+             */
+            unsigned numberHashes() const;
+
+            /**
+             * Method you can use to determine the fraction of filter bits that are set.
+             *
+             * \return Returns the fraction of set bits.
+             */
+            double fillRatio() const;
+
+            /**
+             * Method you can use to insert a key.
+             *
+             * \param[in] keyHash The hash of the key to be inserted.
+             */
+            void insert(std::uint64_t keyHash);
+
+            /**
+             * Method you can use to insert a batch of keys.  Blocks are prefetched ahead of use so that cache misses
+             * overlap.
+             *
+             * \param[in] keyHashes    The hashes of the keys to be inserted.
+             *
+             * \param[in] numberHashes The number of hashes.
+             */
+            void insert(const std::uint64_t* keyHashes, unsigned long numberHashes);
+
+            /**
+             * Method you can use to determine if a key may have been inserted.
+             *
+             * \param[in] keyHash The hash of the key to be tested.
+             *
+             * \return Returns true if the key may have been inserted.  Returns false if the key was definitely not
+             *         inserted.
+             */
+            bool mightContain(std::uint64_t keyHash) const;
+
+            /**
+             * Method you can use to test a batch of keys.  Blocks are prefetched ahead of use so that cache misses
+             * overlap.
+             *
+             * \param[in]  keyHashes    The hashes of the keys to be tested.
+             *
+             * \param[in]  numberHashes The number of hashes.
+             *
+             * \param[out] results      Array to receive one result per key.  A value of true indicates that the key
+             *                          may have been inserted.
+             *
+             * \return Returns the number of keys that may have been inserted.
+             */
+            unsigned long mightContain(const std::uint64_t* keyHashes, unsigned long numberHashes, bool* results) const;
+
+            /**
+             * Method you can use to merge another filter into this filter.  The result reports every key inserted
+             * into either filter.
+             *
+             * \param[in] other The filter to merge.  The filter must have the same size and number of hash functions
+             *                  as this filter.
+             *
+             * \return Returns true on success.  Returns false if the filters are not compatible.
+             */
+            bool unite(const BloomFilter& other);
+
+            /**
+             * Method you can use to remove all keys from the filter.
+             */
+            void clear();
+
+            /**
+             * Assignment operator.
+             *
+             * \param[in] other The instance to be assigned to this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            BloomFilter& operator=(const BloomFilter& other);
+
+        private:
+            /**
+             * The number of words in each block.
+             */
+            static constexpr unsigned wordsPerBlock = bitsPerBlock / 64;
+
+            /**
+             * The number of keys looked ahead of the current key when prefetching blocks.
+             */
+            static constexpr unsigned prefetchDistance = 8;
+
+            /**
+             * Method that determines the index of the first word of the block used by a key.
+             *
+             * \param[in] keyHash The key hash.
+             *
+             * \return Returns the index of the first word in the block.
+             */
+            inline unsigned long blockWordIndex(std::uint64_t keyHash) const;
+
+            /**
+             * Method that sets the bits for a key within its block.
+             *
+             * \param[in] block   The words of the block.
+             *
+             * \param[in] keyHash The key hash.
+             */
+            inline void setProbes(std::uint64_t* block, std::uint64_t keyHash) const;
+
+            /**
+             * Method that tests the bits for a key within its block.
+             *
+             * \param[in] block   The words of the block.
+             *
+             * \param[in] keyHash The key hash.
+             *
+             * \return Returns true if every probed bit is set.
+             */
+            inline bool testProbes(const std::uint64_t* block, std::uint64_t keyHash) const;
+
+            /**
+             * The filter bits.
+             */
+            BitArray bits;
+
+            /**
+             * The number of blocks in the filter.
+             */
+            unsigned long numberBlocks;
+
+            /**
+             * The number of bits set for each key.
+             */
+            unsigned currentNumberHashes;
+    };
+}
+
+#endif
@@ -0,0 +1,359 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref Util::CompressedBitArray class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project ineutil */
+
+#ifndef UTIL_COMPRESSED_BIT_ARRAY_H
+#define UTIL_COMPRESSED_BIT_ARRAY_H
+
+#include <QSharedDataPointer>
+#include <QSharedData>
+
+#include "util_common.h"
+#include "util_bit_array.h"
+
+namespace Util {
+    /**
+     * Class that can be used to maintain a compressed, searchable array of bits.  The index space is split into chunks
+     * of 65536 bits.  Empty chunks consume no storage.  Each remaining chunk holds its bits in whichever container is
+     * smallest: a sorted array of offsets for sparse chunks, a 1024 word bitmap for dense chunks, or a sorted list of
+     * runs for chunks made up of long runs of set bits.
+     *
+     * The class is well suited to very sparse arrays or arrays made up of long runs over large index spaces.  Use
+     * \ref Util::BitArray for small or uniformly dense arrays.
+     */
+    class UTIL_PUBLIC_API CompressedBitArray {
+        public:
+            /**
+             * Type used to represent a bit index.
+             */
+            typedef BitArray::Index Index;
+
+            /**
+             * Value that represents an invalid bit index.
+             */
+            static constexpr Index invalidIndex = BitArray::invalidIndex;
+
+            /**
+             * The number of bits covered by each chunk.
+             */
+            static constexpr Index chunkSize = 65536;
+
+            CompressedBitArray();
+
+            /**
+             * Constructor, constructs an empty array of bits of a fixed sized.
+             *
+             * \param[in] numberBits The desired initial length of the array, in bits.
+             */
+            CompressedBitArray(Index numberBits);
+
+            /**
+             * Constructor, constructs a compressed array from a dense array.
+             *
+             * \param[in] bitArray The dense array to be compressed.
+             */
+            CompressedBitArray(const BitArray& bitArray);
+
+            /**
+             * Copy constructor.
+             *
+             * \param[in] other The instance to be copied.
+             */
+            CompressedBitArray(const CompressedBitArray& other);
+
+            ~CompressedBitArray();
+
+            /**
+             * Method you can use to convert this array to a dense array.
+             *
+             * \return Returns a dense array holding the same bits.
+             */
+            BitArray toBitArray() const;
+
+            /**
+             * Method you can use to determine the size of the array, in bits.
+             *
+             * \return Returns the array size, in bits.
+             */
+            Index size() const;
+
+            /**
+             * Method you can use to determine the size of the array, in bits.
+             *
+             * \return Returns the array size, in bits.
+             */
+            Index length() const;
+
+            /**
+             * Method you can use to determine the number of set bits in the array.
+             *
+             * \return Returns the number of set bits.
+             */
+            Index popcount() const;
+
+            /**
+             * Method you can use to determine the approximate number of bytes used to hold the array contents.
+             *
+             * \return Returns the approximate storage used, in bytes.
+             */
+            Index memoryUsage() const;
+
+            /**
+             * Method you can use to clear the array contents.  Any underlying storage is released.
+             */
+            void clear();
+
+            /**
+             * Method you can use to resize the array.  Set bits past the new end of the array are discarded.
+             *
+             * \param[in] newLength The new array length, in bits.
+             */
+            void resize(Index newLength);
+
+            /**
+             * Method you can use to convert every chunk to its smallest container, including run containers.  Bit
+             * updates only convert between array and bitmap containers so you may wish to call this method after
+             * building up a run heavy array.
+             */
+            void optimize();
+
+            /**
+             * Method you can use to set a bit.  The array will be extended, if needed.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be set.
+             *
+             * \param[in] nowSet   If true, the bit will be set.  If false, the bit will be cleared.
+             */
+            void setBit(Index bitIndex, bool nowSet = true);
+
+            /**
+             * Method you can use to clear a bit.  The array will be extended, if needed.
+             *
+             * \param[in] bitIndex   The zero based index of the bit to be cleared.
+             *
+             * \param[in] nowCleared If true, the bit will be cleared.  If false, the bit will be set.
+             */
+            void clearBit(Index bitIndex, bool nowCleared = true);
+
+            /**
+             * Method you can use to determine if a bit is set.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be checked.
+             *
+             * \return Returns true if the bit is set.  Returns false if the bit is cleared or past the end of the
+             *         array.
+             */
+            bool isSet(Index bitIndex) const;
+
+            /**
+             * Method you can use to determine if a bit is cleared.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be checked.
+             *
+             * \return Returns true if the bit is cleared or past the end of the array.  Returns false if the bit is
+             *         set.
+             */
+            bool isClear(Index bitIndex) const;
+
+            /**
+             * Method you can use to locate the first set bit.  Empty chunks are skipped without being visited.
+             *
+             * \param[in] startingIndex The zero based index to start the search at.
+             *
+             * \return Returns the zero based index of the first set bit at or after the starting index.  The value
+             *         \ref Util::CompressedBitArray::invalidIndex is returned if there are no set bits.
+             */
+            Index firstSetBit(Index startingIndex = 0) const;
+
+            /**
+             * Method that returns the bitwise AND of this array and another array.  The result will have the length of
+             * the longer array.
+             *
+             * \param[in] other The array to combine with this array.
+             *
+             * \return Returns the intersection of the two arrays.
+             */
+            CompressedBitArray intersectionBits(const CompressedBitArray& other) const;
+
+            /**
+             * Method that returns the bitwise OR of this array and another array.  The result will have the length of
+             * the longer array.
+             *
+             * \param[in] other The array to combine with this array.
+             *
+             * \return Returns the union of the two arrays.
+             */
+            CompressedBitArray unionBits(const CompressedBitArray& other) const;
+
+            /**
+             * Method that returns the bitwise exclusive OR of this array and another array.  The result will have the
+             * length of the longer array.
+             *
+             * \param[in] other The array to combine with this array.
+             *
+             * \return Returns the symmetric difference of the two arrays.
+             */
+            CompressedBitArray symmetricDifferenceBits(const CompressedBitArray& other) const;
+
+            /**
+             * Method that returns the bits in this array that are not set in another array.  The result will have the
+             * length of the longer array.
+             *
+             * \param[in] other The array holding the bits to be removed.
+             *
+             * \return Returns this array AND NOT the other array.
+             */
+            CompressedBitArray differenceBits(const CompressedBitArray& other) const;
+
+            /**
+             * Method that clears every bit in this array that is set in another array.  The array will be extended to
+             * the length of the other array, if needed.
+             *
+             * \param[in] other The array holding the bits to be cleared.
+             *
+             * \return Returns a reference to this instance.
+             */
+            CompressedBitArray& andNot(const CompressedBitArray& other);
+
+            /**
+             * Assignment operator.
+             *
+             * \param[in] other The instance to be copied.
+             *
+             * \return Returns a reference to this instance.
+             */
+            CompressedBitArray& operator=(const CompressedBitArray& other);
+
+            /**
+             * Comparison operator.
+             *
+             * \param[in] other The instance to be compared against.
+             *
+             * \return Returns true if the arrays have the same length and the same set bits.
+             */
+            bool operator==(const CompressedBitArray& other) const;
+
+            /**
+             * Comparison operator.
+             *
+             * \param[in] other The instance to be compared against.
+             *
+             * \return Returns true if the arrays differ.
+             */
+            bool operator!=(const CompressedBitArray& other) const;
+
+            /**
+             * Modifying AND operator.  The array will be extended to the length of the other array, if needed.
+             *
+             * \param[in] other The instance to combine with this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            CompressedBitArray& operator&=(const CompressedBitArray& other);
+
+            /**
+             * Modifying OR operator.  The array will be extended to the length of the other array, if needed.
+             *
+             * \param[in] other The instance to combine with this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            CompressedBitArray& operator|=(const CompressedBitArray& other);
+
+            /**
+             * Modifying exclusive OR operator.  The array will be extended to the length of the other array, if
+             * needed.
+             *
+             * \param[in] other The instance to combine with this instance.
+             *
+             * \return Returns a reference to this instance.
+             */
+            CompressedBitArray& operator^=(const CompressedBitArray& other);
+
+        private:
+            /**
+             * Private base class for the underlying shared data instance.
+             */
+            class Private;
+
+            /**
+             * The underlying shared data instance.
+             */
+            QSharedDataPointer<Private> impl;
+    };
+}
+
+/**
+ * Intersection operator.
+ *
+ * \param[in] a The first bit array to calculate the intersection from.
+ *
+ * \param[in] b The second bit array to calculate the intersection from.
+ *
+ * \return Returns the bitwise AND of the two bit arrays.
+ */
+inline UTIL_PUBLIC_API Util::CompressedBitArray operator&(
+        const Util::CompressedBitArray& a,
+        const Util::CompressedBitArray& b
+    ) {
+    return a.intersectionBits(b);
+}
+
+/**
+ * Union operator.
+ *
+ * \param[in] a The first bit array to calculate the union from.
+ *
+ * \param[in] b The second bit array to calculate the union from.
+ *
+ * \return Returns the bitwise OR of the two bit arrays.
+ */
+inline UTIL_PUBLIC_API Util::CompressedBitArray operator|(
+        const Util::CompressedBitArray& a,
+        const Util::CompressedBitArray& b
+    ) {
+    return a.unionBits(b);
+}
+
+/**
+ * Exclusive OR operator.
+ *
+ * \param[in] a The first bit array to combine.
+ *
+ * \param[in] b The second bit array to combine.
+ *
+ * \return Returns the bitwise exclusive OR of the two bit arrays.
+ */
+inline UTIL_PUBLIC_API Util::CompressedBitArray operator^(
+        const Util::CompressedBitArray& a,
+        const Util::CompressedBitArray& b
+    ) {
+    return a.symmetricDifferenceBits(b);
+}
+
+#endif
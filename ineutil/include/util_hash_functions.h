@@ -76,6 +76,24 @@ namespace Util {
      * \return Returns a hash calculated from the value and seed.
      */
     UTIL_PUBLIC_API HashResult qHash(const QColor& color, HashSeed seed = 0);
+
+    /**
+     * Function that calculates a 64-bit hash over an array of 64-bit words.  Words are consumed two at a time using
+     * a multiply and fold mixing step so the function runs at close to memory bandwidth.
+     *
+     * \param[in] words       The words to be hashed.  The pointer may be null if the word count is zero.
+     *
+     * \param[in] numberWords The number of words to be hashed.
+     *
+     * \param[in] seed        An optional hash seed.
+     *
+     * \return Returns a hash calculated from the words and seed.
+     */
+    UTIL_PUBLIC_API std::uint64_t hashWords(
+        const std::uint64_t* words,
+        unsigned long        numberWords,
+        std::uint64_t        seed = 0
+    );
 }
 
 /**
@@ -42,6 +42,11 @@ API_HEADERS = include/util_common.h \
               include/util_algorithm.h \
               include/util_bit_functions.h \
               include/util_bit_array.h \
+              include/util_bit_array_allocator.h \
+              include/util_bloom_filter.h \
+              include/util_bit_matrix.h \
+              include/util_compressed_bit_array.h \
+              include/util_atomic_bit_array.h \
               include/util_bit_set.h \
               include/util_color_functions.h \
               include/util_shape_functions.h \
@@ -58,6 +63,14 @@ API_HEADERS = include/util_common.h \
 SOURCES = source/util_bit_functions.cpp \
           source/util_bit_array.cpp \
           source/util_bit_array_private.cpp \
+          source/util_bit_array_allocator.cpp \
+          source/util_bloom_filter.cpp \
+          source/util_bit_matrix.cpp \
+          source/util_bit_kernels.cpp \
+          source/util_parallel_word_range.cpp \
+          source/util_compressed_bit_array.cpp \
+          source/util_compressed_bit_array_private.cpp \
+          source/util_atomic_bit_array.cpp \
           source/util_bit_set.cpp \
           source/util_color_functions.cpp \
           source/util_shape_functions.cpp \
@@ -71,7 +84,10 @@ SOURCES = source/util_bit_functions.cpp \
 # Inesonic private includes
 #
 
-PRIVATE_HEADERS = source/util_bit_array_private.h
+PRIVATE_HEADERS = source/util_bit_array_private.h \
+                  source/util_bit_kernels.h \
+                  source/util_parallel_word_range.h \
+                  source/util_compressed_bit_array_private.h
 
 ########################################################################################################################
 # Setup headers and installation
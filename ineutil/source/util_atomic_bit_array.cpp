@@ -0,0 +1,238 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref Util::AtomicBitArray class.
+***********************************************************************************************************************/
+
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+
+#include "util_bit_functions.h"
+#include "util_atomic_bit_array.h"
+
+namespace Util {
+    constexpr AtomicBitArray::Index AtomicBitArray::invalidIndex;
+
+    AtomicBitArray::AtomicBitArray(AtomicBitArray::Index numberBits) {
+        bitLength   = numberBits;
+        numberWords = (numberBits + bitsPerWord - 1) / bitsPerWord;
+        words       = numberWords > 0 ? new std::atomic<Word>[numberWords] : nullptr;
+
+        for (Index wordIndex=0 ; wordIndex<numberWords ; ++wordIndex) {
+            words[wordIndex].store(0, std::memory_order_relaxed);
+        }
+
+        unsigned residue = numberBits % bitsPerWord;
+        lastWordMask = residue == 0 ? static_cast<Word>(-1) : (static_cast<Word>(1) << residue) - 1;
+    }
+
+
+    AtomicBitArray::~AtomicBitArray() {
+        delete[] words;
+    }
+
+
+    AtomicBitArray::Index AtomicBitArray::size() const {
+        return bitLength;
+    }
+
+
+    AtomicBitArray::Index AtomicBitArray::length() const {
+        return bitLength;
+    }
+
+
+    AtomicBitArray::Index AtomicBitArray::wordCount() const {
+        return numberWords;
+    }
+
+
+    AtomicBitArray::Index AtomicBitArray::popcount() const {
+        Index result = 0;
+        for (Index wordIndex=0 ; wordIndex<numberWords ; ++wordIndex) {
+            result += numberOnes64(words[wordIndex].load(std::memory_order_relaxed));
+        }
+
+        return result;
+    }
+
+
+    bool AtomicBitArray::isSet(AtomicBitArray::Index bitIndex) const {
+        assert(bitIndex < bitLength);
+
+        Word mask = static_cast<Word>(1) << (bitIndex % bitsPerWord);
+        return (words[bitIndex / bitsPerWord].load(std::memory_order_acquire) & mask) != 0;
+    }
+
+
+    bool AtomicBitArray::isClear(AtomicBitArray::Index bitIndex) const {
+        return !isSet(bitIndex);
+    }
+
+
+    void AtomicBitArray::setBit(AtomicBitArray::Index bitIndex) {
+        testAndSet(bitIndex);
+    }
+
+
+    void AtomicBitArray::clearBit(AtomicBitArray::Index bitIndex) {
+        testAndClear(bitIndex);
+    }
+
+
+    bool AtomicBitArray::testAndSet(AtomicBitArray::Index bitIndex) {
+        assert(bitIndex < bitLength);
+
+        Word mask = static_cast<Word>(1) << (bitIndex % bitsPerWord);
+        return (words[bitIndex / bitsPerWord].fetch_or(mask, std::memory_order_acq_rel) & mask) != 0;
+    }
+
+
+    bool AtomicBitArray::testAndClear(AtomicBitArray::Index bitIndex) {
+        assert(bitIndex < bitLength);
+
+        Word mask = static_cast<Word>(1) << (bitIndex % bitsPerWord);
+        return (words[bitIndex / bitsPerWord].fetch_and(~mask, std::memory_order_acq_rel) & mask) != 0;
+    }
+
+
+    AtomicBitArray::Word AtomicBitArray::fetchOr(AtomicBitArray::Index wordIndex, AtomicBitArray::Word mask) {
+        assert(wordIndex < numberWords);
+        return words[wordIndex].fetch_or(mask & validMask(wordIndex), std::memory_order_acq_rel);
+    }
+
+
+    AtomicBitArray::Word AtomicBitArray::fetchAnd(AtomicBitArray::Index wordIndex, AtomicBitArray::Word mask) {
+        assert(wordIndex < numberWords);
+        return words[wordIndex].fetch_and(mask, std::memory_order_acq_rel);
+    }
+
+
+    AtomicBitArray::Word AtomicBitArray::fetchXor(AtomicBitArray::Index wordIndex, AtomicBitArray::Word mask) {
+        assert(wordIndex < numberWords);
+        return words[wordIndex].fetch_xor(mask & validMask(wordIndex), std::memory_order_acq_rel);
+    }
+
+
+    AtomicBitArray::Word AtomicBitArray::word(AtomicBitArray::Index wordIndex) const {
+        assert(wordIndex < numberWords);
+        return words[wordIndex].load(std::memory_order_acquire);
+    }
+
+
+    void AtomicBitArray::setBits(AtomicBitArray::Index startingIndex, AtomicBitArray::Index endingIndex) {
+        updateBits(startingIndex, endingIndex, true);
+    }
+
+
+    void AtomicBitArray::clearBits(AtomicBitArray::Index startingIndex, AtomicBitArray::Index endingIndex) {
+        updateBits(startingIndex, endingIndex, false);
+    }
+
+
+    AtomicBitArray::Index AtomicBitArray::firstClearedBit(AtomicBitArray::Index startingIndex) const {
+        Index result    = invalidIndex;
+        Index wordIndex = startingIndex / bitsPerWord;
+        Word  mask      = static_cast<Word>(-1) << (startingIndex % bitsPerWord);
+
+        while (result == invalidIndex && wordIndex < numberWords) {
+            Word available = ~words[wordIndex].load(std::memory_order_acquire) & mask & validMask(wordIndex);
+            if (available != 0) {
+                result = wordIndex * bitsPerWord + lsbLocation64(available);
+            }
+
+            mask = static_cast<Word>(-1);
+            ++wordIndex;
+        }
+
+        return result;
+    }
+
+
+    AtomicBitArray::Index AtomicBitArray::claimFirstClearedBit(AtomicBitArray::Index startingIndex) {
+        Index result    = invalidIndex;
+        Index wordIndex = startingIndex / bitsPerWord;
+        Word  mask      = static_cast<Word>(-1) << (startingIndex % bitsPerWord);
+
+        while (result == invalidIndex && wordIndex < numberWords) {
+            Word wordMask  = mask & validMask(wordIndex);
+            Word current   = words[wordIndex].load(std::memory_order_relaxed);
+            Word available = ~current & wordMask;
+
+            while (available != 0) {
+                Word bit = available & (0 - available);
+
+                // On failure, current is reloaded with the latest word value so we simply try again.
+
+                if (words[wordIndex].compare_exchange_weak(
+                        current,
+                        current | bit,
+                        std::memory_order_acq_rel,
+                        std::memory_order_relaxed
+                    )) {
+                    result    = wordIndex * bitsPerWord + lsbLocation64(bit);
+                    available = 0;
+                } else {
+                    available = ~current & wordMask;
+                }
+            }
+
+            mask = static_cast<Word>(-1);
+            ++wordIndex;
+        }
+
+        return result;
+    }
+
+
+    void AtomicBitArray::updateBits(
+            AtomicBitArray::Index startingIndex,
+            AtomicBitArray::Index endingIndex,
+            bool                  nowSet
+        ) {
+        assert(startingIndex <= endingIndex && endingIndex < bitLength);
+
+        Index firstWord = startingIndex / bitsPerWord;
+        Index lastWord  = endingIndex / bitsPerWord;
+
+        for (Index wordIndex=firstWord ; wordIndex<=lastWord ; ++wordIndex) {
+            Word mask = static_cast<Word>(-1);
+
+            if (wordIndex == firstWord) {
+                mask &= static_cast<Word>(-1) << (startingIndex % bitsPerWord);
+            }
+
+            if (wordIndex == lastWord) {
+                mask &= static_cast<Word>(-1) >> (bitsPerWord - 1 - endingIndex % bitsPerWord);
+            }
+
+            if (nowSet) {
+                words[wordIndex].fetch_or(mask, std::memory_order_acq_rel);
+            } else {
+                words[wordIndex].fetch_and(~mask, std::memory_order_acq_rel);
+            }
+        }
+    }
+}
@@ -28,78 +28,127 @@
 #include <QString>
 #include <QSharedDataPointer>
 #include <QSharedData>
+#include <QIODevice>
+#include <QDataStream>
 
 #include <cstdint>
 #include <cassert>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "util_bit_functions.h"
+#include "util_hash_functions.h"
+#include "util_bit_kernels.h"
 #include "util_bit_array_private.h"
 #include "util_bit_array.h"
 
 namespace Util {
-    BitArray::BitArray() : impl(new BitArray::Private) {}
+    constexpr BitArray::Index BitArray::invalidIndex;
 
+    BitArray::BitArray() : inlineData(), inlineLength(0), currentAllocator(BitArrayAllocator::standard()) {}
 
-    BitArray::BitArray(BitArray::Index numberBits, bool value) : impl(new BitArray::Private(numberBits, value)) {}
+
+    BitArray::BitArray(BitArray::Index numberBits, bool value) : BitArray(
+            numberBits,
+            value,
+            BitArrayAllocator::standard()
+        ) {}
+
+
+    BitArray::BitArray(
+            BitArray::Index    numberBits,
+            bool               value,
+            BitArrayAllocator* allocator
+        ) : inlineData(),
+            inlineLength(0),
+            currentAllocator(allocator) {
+        if (numberBits <= inlineBits) {
+            inlineLength = numberBits;
+            if (value && numberBits > 0) {
+                Writer(*this)->setBits(0, numberBits - 1, true);
+            }
+        } else {
+            impl = new BitArray::Private(numberBits, value, allocator);
+        }
+    }
 
 
     BitArray::BitArray(
             const bool*     rawData,
             BitArray::Index numberBits
-        ) : impl(
-             new BitArray::Private(
-                 rawData,
-                 numberBits
-             )
-        ) {}
+        ) : inlineData(),
+            inlineLength(0),
+            currentAllocator(BitArrayAllocator::standard()) {
+        if (numberBits <= inlineBits) {
+            Private::packBits(inlineData, rawData, numberBits);
+            inlineLength = numberBits;
+        } else {
+            impl = new BitArray::Private(rawData, numberBits);
+        }
+    }
 
 
     BitArray::BitArray(
             const std::uint8_t* rawData,
             BitArray::Index     numberBits
-        ) : impl(
-            new BitArray::Private(
-                rawData,
-                numberBits
-            )
-        ) {}
+        ) : inlineData(),
+            inlineLength(0),
+            currentAllocator(BitArrayAllocator::standard()) {
+        if (numberBits <= inlineBits) {
+            Private::packBits(inlineData, static_cast<const void*>(rawData), numberBits);
+            inlineLength = numberBits;
+        } else {
+            impl = new BitArray::Private(rawData, numberBits);
+        }
+    }
 
 
     BitArray::BitArray(
             const std::uint16_t* rawData,
             BitArray::Index      numberBits
-        ) : impl(
-            new BitArray::Private(
-                rawData,
-                numberBits
-            )
+        ) : BitArray(
+            reinterpret_cast<const std::uint8_t*>(rawData),
+            numberBits
         ) {}
 
 
     BitArray::BitArray(
             const std::uint32_t* rawData,
             BitArray::Index      numberBits
-        ) : impl(
-            new BitArray::Private(
-                rawData,
-                numberBits
-            )
+        ) : BitArray(
+            reinterpret_cast<const std::uint8_t*>(rawData),
+            numberBits
         ) {}
 
 
     BitArray::BitArray(
             const std::uint64_t* rawData,
             BitArray::Index      numberBits
-        ) : impl(
-            new BitArray::Private(
-                rawData,
-                numberBits
-            )
+        ) : BitArray(
+            reinterpret_cast<const std::uint8_t*>(rawData),
+            numberBits
         ) {}
 
 
-    BitArray::BitArray(const BitArray& other) {
-        impl = other.impl;
+    BitArray::BitArray(
+            const BitArray& other
+        ) : impl(other.impl),
+            inlineLength(other.inlineLength),
+            currentAllocator(other.currentAllocator) {
+        std::copy(other.inlineData, other.inlineData + inlineWords, inlineData);
+    }
+
+
+    BitArray::BitArray(
+            BitArray&& other
+        ) : impl(std::move(other.impl)),
+            inlineLength(other.inlineLength),
+            currentAllocator(other.currentAllocator) {
+        std::copy(other.inlineData, other.inlineData + inlineWords, inlineData);
+        std::fill(other.inlineData, other.inlineData + inlineWords, 0);
+
+        other.inlineLength = 0;
     }
 
 
@@ -107,92 +156,680 @@ namespace Util {
 
 
     BitArray::Index BitArray::size() const {
-        return impl->size();
+        return impl.constData() != nullptr ? impl->size() : inlineLength;
     }
 
 
     BitArray::Index BitArray::count() const {
-        return impl->size();
+        return size();
     }
 
 
     BitArray::Index BitArray::length() const {
-        return impl->size();
+        return size();
+    }
+
+
+    BitArray BitArray::fromRawData(const std::uint64_t* rawData, BitArray::Index numberBits) {
+        BitArray result;
+        result.adopt(Private::createView(rawData, numberBits, nullptr));
+
+        return result;
+    }
+
+
+    BitArray BitArray::fromBytes(const std::uint8_t* values, BitArray::Index numberBits) {
+        BitArray result(numberBits);
+
+        if (numberBits > 0) {
+            Mutator mutator(result);
+            packBytes(mutator.words(), values, numberBits);
+        }
+
+        return result;
+    }
+
+
+    BitArray BitArray::fromIndexList(const std::vector<BitArray::Index>& indexes, BitArray::Index numberBits) {
+        if (numberBits == invalidIndex) {
+            numberBits = indexes.empty() ? 0 : indexes.back() + 1;
+        }
+
+        BitArray result(numberBits);
+
+        if (!indexes.empty()) {
+            Mutator        mutator(result);
+            std::uint64_t* words = mutator.words();
+
+            // Sorted indexes share words, so each word is assembled in a register and stored once.  Out of order
+            // indexes still produce the correct result, only more slowly.
+
+            Index         wordIndex = indexes.front() / 64;
+            std::uint64_t word      = 0;
+            for (Index index : indexes) {
+                assert(index < numberBits);
+
+                if (index / 64 != wordIndex) {
+                    words[wordIndex] |= word;
+                    wordIndex         = index / 64;
+                    word              = 0;
+                }
+
+                word |= static_cast<std::uint64_t>(1) << (index % 64);
+            }
+
+            words[wordIndex] |= word;
+        }
+
+        return result;
+    }
+
+
+    void BitArray::toBools(bool* destination) const {
+        static_assert(sizeof(bool) == 1, "Boolean values are expected to occupy a single byte.");
+        unpackBytes(reinterpret_cast<std::uint8_t*>(destination), constData(), size());
+    }
+
+
+    void BitArray::toBytes(std::uint8_t* destination) const {
+        unpackBytes(destination, constData(), size());
+    }
+
+
+    std::vector<BitArray::Index> BitArray::toIndexList() const {
+        std::vector<Index> result;
+        result.reserve(popcount());
+
+        const std::uint64_t* words       = constData();
+        Index                numberWords = wordCount();
+        for (Index wordIndex=0 ; wordIndex<numberWords ; ++wordIndex) {
+            std::uint64_t word = words[wordIndex];
+            while (word != 0) {
+                result.push_back(wordIndex * 64 + lsbLocation64(word));
+                word &= word - 1;
+            }
+        }
+
+        return result;
+    }
+
+
+    bool BitArray::isView() const {
+        return impl.constData() != nullptr && impl->isView();
+    }
+
+
+    bool BitArray::mapFile(const QString& filename) {
+        Private* mapped = Private::mapFile(filename);
+        if (mapped != nullptr) {
+            adopt(mapped);
+        }
+
+        return mapped != nullptr;
+    }
+
+
+    bool BitArray::saveFile(const QString& filename) const {
+        return Reader(*this)->saveFile(filename);
+    }
+
+
+    bool BitArray::write(QIODevice* device, BitArray::Compression compression) const {
+        return Reader(*this)->encode(
+            [device](const char* buffer, unsigned long length) {
+                return device->write(buffer, static_cast<qint64>(length)) == static_cast<qint64>(length);
+            },
+            compression
+        );
+    }
+
+
+    bool BitArray::read(QIODevice* device) {
+        Private* decoded = Private::decode(
+            [device](char* buffer, unsigned long length) {
+                qint64 remaining = static_cast<qint64>(length);
+                bool   success   = true;
+
+                while (success && remaining > 0) {
+                    qint64 bytesRead = device->read(buffer, remaining);
+                    if (bytesRead > 0) {
+                        buffer    += bytesRead;
+                        remaining -= bytesRead;
+                    } else {
+                        success = (bytesRead == 0 && device->waitForReadyRead(-1));
+                    }
+                }
+
+                return success;
+            }
+        );
+
+        if (decoded != nullptr) {
+            adopt(decoded);
+        }
+
+        return decoded != nullptr;
+    }
+
+
+    bool BitArray::write(QDataStream& stream, BitArray::Compression compression) const {
+        bool success = Reader(*this)->encode(
+            [&stream](const char* buffer, unsigned long length) {
+                return stream.writeRawData(buffer, static_cast<int>(length)) == static_cast<int>(length);
+            },
+            compression
+        );
+
+        if (!success) {
+            stream.setStatus(QDataStream::WriteFailed);
+        }
+
+        return success;
+    }
+
+
+    bool BitArray::read(QDataStream& stream) {
+        Private* decoded = Private::decode(
+            [&stream](char* buffer, unsigned long length) {
+                return stream.readRawData(buffer, static_cast<int>(length)) == static_cast<int>(length);
+            }
+        );
+
+        if (decoded != nullptr) {
+            adopt(decoded);
+        } else {
+            stream.setStatus(QDataStream::ReadCorruptData);
+        }
+
+        return decoded != nullptr;
+    }
+
+
+    const std::uint64_t* BitArray::constData() const {
+        return impl.constData() != nullptr ? impl->constData() : inlineData;
+    }
+
+
+    BitArray::Index BitArray::wordCount() const {
+        return impl.constData() != nullptr ? impl->wordCount() : (inlineLength + 63) / 64;
+    }
+
+
+    BitArray::Index BitArray::capacity() const {
+        return impl.constData() != nullptr ? impl->capacity() : inlineBits;
+    }
+
+
+    BitArrayAllocator* BitArray::allocator() const {
+        return impl.constData() != nullptr ? impl->storageAllocator() : currentAllocator;
     }
 
 
     void BitArray::clear() {
-        impl->clear();
+        impl         = nullptr;
+        inlineLength = 0;
+
+        std::fill(inlineData, inlineData + inlineWords, 0);
     }
 
 
     void BitArray::resize(Index newLength) {
-        impl->resize(newLength);
+        Writer(*this)->resize(newLength);
+    }
+
+
+    void BitArray::reserve(BitArray::Index numberBits) {
+        Writer(*this)->reserve(numberBits);
+    }
+
+
+    void BitArray::shrinkToFit() {
+        const Private* shared = impl.constData();
+        if (shared != nullptr && shared->size() <= inlineBits && !shared->isView()) {
+            Private::packBits(inlineData, static_cast<const void*>(shared->constData()), shared->size());
+            inlineLength = shared->size();
+            impl         = nullptr;
+        } else {
+            Writer(*this)->shrinkToFit();
+        }
     }
 
 
     void BitArray::setBit(BitArray::Index bitIndex, bool nowSet) {
-        impl->setBit(bitIndex, nowSet);
+        if (impl.constData() == nullptr && bitIndex < inlineLength) {
+            std::uint64_t mask = static_cast<std::uint64_t>(1) << (bitIndex % 64);
+            if (nowSet) {
+                inlineData[bitIndex / 64] |= mask;
+            } else {
+                inlineData[bitIndex / 64] &= ~mask;
+            }
+        } else {
+            Writer(*this)->setBit(bitIndex, nowSet);
+        }
     }
 
 
     void BitArray::clearBit(BitArray::Index bitIndex, bool nowCleared) {
-        impl->clearBit(bitIndex, nowCleared);
+        setBit(bitIndex, !nowCleared);
     }
 
 
-    void BitArray::setBits(BitArray::Index startingIndex, BitArray::Index endingIndex, bool nowSet) {
-        impl->setBits(startingIndex, endingIndex, nowSet);
+    void BitArray::setBits(
+            BitArray::Index     startingIndex,
+            BitArray::Index     endingIndex,
+            bool                nowSet,
+            BitArray::Execution execution
+        ) {
+        if (execution == Execution::PARALLEL) {
+            Writer(*this)->parallelSetBits(startingIndex, endingIndex, nowSet);
+        } else {
+            Writer(*this)->setBits(startingIndex, endingIndex, nowSet);
+        }
     }
 
 
-    void BitArray::clearBits(BitArray::Index startingIndex, BitArray::Index endingIndex, bool nowCleared) {
-        impl->clearBits(startingIndex, endingIndex, nowCleared);
+    void BitArray::clearBits(
+            BitArray::Index     startingIndex,
+            BitArray::Index     endingIndex,
+            bool                nowCleared,
+            BitArray::Execution execution
+        ) {
+        setBits(startingIndex, endingIndex, !nowCleared, execution);
     }
 
 
     bool BitArray::isSet(BitArray::Index index) const {
-        return impl->isSet(index);
+        bool result;
+
+        if (impl.constData() != nullptr) {
+            result = impl->isSet(index);
+        } else {
+            result = index < inlineLength && ((inlineData[index / 64] >> (index % 64)) & 1) != 0;
+        }
+
+        return result;
     }
 
 
     bool BitArray::isClear(BitArray::Index index) const {
-        return impl->isClear(index);
+        return !isSet(index);
     }
 
 
-    BitArray::Index BitArray::firstSetBit() const {
-        return impl->firstSetBit();
+    BitArray::Index BitArray::firstSetBit(BitArray::Execution execution) const {
+        Reader reader(*this);
+        return execution == Execution::PARALLEL ? reader->parallelFirstSetBit() : reader->firstSetBit();
     }
 
 
-    BitArray::Index BitArray::firstClearedBit() const {
-        return impl->firstClearedBit();
+    BitArray::Index BitArray::firstClearedBit(BitArray::Execution execution) const {
+        Reader reader(*this);
+        return execution == Execution::PARALLEL ? reader->parallelFirstClearedBit() : reader->firstClearedBit();
     }
 
 
     BitArray::Index BitArray::firstSetBit(BitArray::Index startingIndex) const {
-        return impl->firstSetBit(startingIndex);
+        return Reader(*this)->firstSetBit(startingIndex);
     }
 
 
     BitArray::Index BitArray::firstClearedBit(BitArray::Index startingIndex) const {
-        return impl->firstClearedBit(startingIndex);
+        return Reader(*this)->firstClearedBit(startingIndex);
+    }
+
+
+    BitArray::Index BitArray::lastSetBit(BitArray::Execution execution) const {
+        Reader reader(*this);
+        return execution == Execution::PARALLEL ? reader->parallelLastSetBit() : reader->lastSetBit();
+    }
+
+
+    BitArray::Index BitArray::lastClearedBit(BitArray::Execution execution) const {
+        Reader reader(*this);
+        return execution == Execution::PARALLEL ? reader->parallelLastClearedBit() : reader->lastClearedBit();
+    }
+
+
+    BitArray::Index BitArray::previousSetBit(BitArray::Index startingIndex) const {
+        return Reader(*this)->previousSetBit(startingIndex);
+    }
+
+
+    BitArray::Index BitArray::previousClearedBit(BitArray::Index startingIndex) const {
+        return Reader(*this)->previousClearedBit(startingIndex);
+    }
+
+
+    BitArray::Index BitArray::findClearRun(BitArray::Index length, BitArray::Index startingIndex) const {
+        return Reader(*this)->findClearRun(length, startingIndex);
+    }
+
+
+    BitArray::Index BitArray::findSetRun(BitArray::Index length, BitArray::Index startingIndex) const {
+        return Reader(*this)->findSetRun(length, startingIndex);
+    }
+
+
+    BitArray::SetBitRange BitArray::setBitIndices() const {
+        return SetBitRange(constData(), wordCount());
+    }
+
+
+    BitArray::Index BitArray::popcount(BitArray::Execution execution) const {
+        Reader reader(*this);
+        return execution == Execution::PARALLEL ? reader->parallelPopcount() : reader->popcount();
+    }
+
+
+    BitArray::Index BitArray::rank(BitArray::Index index) const {
+        return Reader(*this)->rank(index);
+    }
+
+
+    BitArray::Index BitArray::select(BitArray::Index setBitNumber) const {
+        return Reader(*this)->select(setBitNumber);
+    }
+
+
+    BitArray BitArray::intersectionBits(const BitArray& other, BitArray::Execution execution) const {
+        BitArray result;
+
+        if (impl.constData() == nullptr && other.impl.constData() == nullptr) {
+            result = *this;
+            result &= other;
+        } else {
+            result.adopt(
+                new Private(
+                    *Reader(*this),
+                    *Reader(other),
+                    Private::Operation::AND,
+                    execution == Execution::PARALLEL
+                )
+            );
+        }
+
+        return result;
+    }
+
+
+    BitArray BitArray::unionBits(const BitArray& other, BitArray::Execution execution) const {
+        BitArray result;
+
+        if (impl.constData() == nullptr && other.impl.constData() == nullptr) {
+            result = *this;
+            result |= other;
+        } else {
+            result.adopt(
+                new Private(
+                    *Reader(*this),
+                    *Reader(other),
+                    Private::Operation::OR,
+                    execution == Execution::PARALLEL
+                )
+            );
+        }
+
+        return result;
+    }
+
+
+    BitArray BitArray::symmetricDifferenceBits(const BitArray& other, BitArray::Execution execution) const {
+        BitArray result;
+
+        if (impl.constData() == nullptr && other.impl.constData() == nullptr) {
+            result = *this;
+            result ^= other;
+        } else {
+            result.adopt(
+                new Private(
+                    *Reader(*this),
+                    *Reader(other),
+                    Private::Operation::XOR,
+                    execution == Execution::PARALLEL
+                )
+            );
+        }
+
+        return result;
+    }
+
+
+    BitArray BitArray::differenceBits(const BitArray& other, BitArray::Execution execution) const {
+        BitArray result;
+
+        if (impl.constData() == nullptr && other.impl.constData() == nullptr) {
+            result = *this;
+            result.andNot(other);
+        } else {
+            result.adopt(
+                new Private(
+                    *Reader(*this),
+                    *Reader(other),
+                    Private::Operation::AND_NOT,
+                    execution == Execution::PARALLEL
+                )
+            );
+        }
+
+        return result;
+    }
+
+
+    BitArray BitArray::complement() const {
+        BitArray result(*this);
+        result.invert();
+
+        return result;
+    }
+
+
+    BitArray& BitArray::andNot(const BitArray& other) {
+        Writer(*this)->combine(*Reader(other), Private::Operation::AND_NOT);
+        return *this;
+    }
+
+
+    void BitArray::invert() {
+        Writer(*this)->invert();
+    }
+
+
+    BitArray BitArray::slice(BitArray::Index startingIndex, BitArray::Index endingIndex) const {
+        assert(startingIndex <= endingIndex);
+
+        BitArray        result;
+        BitArray::Index numberBits = endingIndex - startingIndex + 1;
+
+        if (numberBits <= inlineBits) {
+            Writer(result)->copyBits(*Reader(*this), startingIndex, numberBits, 0);
+        } else {
+            result.adopt(Reader(*this)->slice(startingIndex, numberBits));
+        }
+
+        return result;
+    }
+
+
+    BitArray BitArray::extract(const BitArray& mask) const {
+        BitArray result;
+        result.adopt(Reader(*this)->extract(*Reader(mask)));
+
+        return result;
+    }
+
+
+    BitArray BitArray::deposit(const BitArray& mask, const BitArray& values) {
+        BitArray result;
+        result.adopt(Private::deposit(*Reader(mask), *Reader(values)));
+
+        return result;
+    }
+
+
+    void BitArray::copyBits(
+            const BitArray& source,
+            BitArray::Index sourceIndex,
+            BitArray::Index numberBits,
+            BitArray::Index destinationIndex
+        ) {
+        Writer(*this)->copyBits(*Reader(source), sourceIndex, numberBits, destinationIndex);
+    }
+
+
+    void BitArray::shiftLeft(BitArray::Index numberBits) {
+        Writer(*this)->shiftLeft(numberBits);
+    }
+
+
+    void BitArray::shiftRight(BitArray::Index numberBits) {
+        Writer(*this)->shiftRight(numberBits);
+    }
+
+
+    void BitArray::insertBits(BitArray::Index index, BitArray::Index numberBits, bool value) {
+        Writer(*this)->insertBits(index, numberBits, value);
+    }
+
+
+    void BitArray::removeBits(BitArray::Index index, BitArray::Index numberBits) {
+        Writer(*this)->removeBits(index, numberBits);
     }
 
 
     BitArray& BitArray::operator=(const BitArray& other) {
-        impl = other.impl;
+        impl             = other.impl;
+        inlineLength     = other.inlineLength;
+        currentAllocator = other.currentAllocator;
+
+        std::copy(other.inlineData, other.inlineData + inlineWords, inlineData);
+
+        return *this;
+    }
+
+
+    BitArray& BitArray::operator=(BitArray&& other) {
+        impl.swap(other.impl);
+        std::swap(inlineLength, other.inlineLength);
+        std::swap(currentAllocator, other.currentAllocator);
+        std::swap_ranges(inlineData, inlineData + inlineWords, other.inlineData);
+
         return *this;
     }
 
 
     bool BitArray::operator==(const BitArray& other) const {
-        return impl == other.impl || *impl == *other.impl;
+        bool isEqual;
+
+        if (impl.constData() == nullptr && other.impl.constData() == nullptr) {
+            isEqual = (
+                   inlineLength == other.inlineLength
+                && std::equal(inlineData, inlineData + inlineWords, other.inlineData)
+            );
+        } else {
+            isEqual = impl.constData() == other.impl.constData() || *Reader(*this) == *Reader(other);
+        }
+
+        return isEqual;
+    }
+
+
+    bool BitArray::isEqualTo(const BitArray& other, BitArray::Execution execution) const {
+        bool isEqual;
+
+        if (execution == Execution::PARALLEL) {
+            isEqual = Reader(*this)->parallelEquals(*Reader(other));
+        } else {
+            isEqual = operator==(other);
+        }
+
+        return isEqual;
     }
 
 
     bool BitArray::operator!=(const BitArray& other) const {
-        return impl != other.impl && *impl != *other.impl;
+        return !operator==(other);
+    }
+
+
+    bool BitArray::operator<(const BitArray& other) const {
+        return Reader(*this)->isLessThan(*Reader(other));
+    }
+
+
+    HashResult BitArray::hash(HashSeed seed) const {
+        std::uint64_t contentHash = Reader(*this)->contentHash();
+        std::uint64_t result      = seed == 0 ? contentHash : hashWords(&contentHash, 1, seed);
+
+        return static_cast<HashResult>(result ^ (result >> 32));
+    }
+
+
+    BitArray& BitArray::operator&=(const BitArray& other) {
+        Writer(*this)->combine(*Reader(other), Private::Operation::AND);
+        return *this;
+    }
+
+
+    BitArray& BitArray::operator|=(const BitArray& other) {
+        Writer(*this)->combine(*Reader(other), Private::Operation::OR);
+        return *this;
+    }
+
+
+    BitArray& BitArray::operator^=(const BitArray& other) {
+        Writer(*this)->combine(*Reader(other), Private::Operation::XOR);
+        return *this;
+    }
+
+
+    void BitArray::adopt(BitArray::Private* newImpl) {
+        if (newImpl->size() <= inlineBits && !newImpl->isView()) {
+            std::fill(inlineData, inlineData + inlineWords, 0);
+            Private::packBits(inlineData, static_cast<const void*>(newImpl->constData()), newImpl->size());
+            inlineLength = newImpl->size();
+            impl         = nullptr;
+
+            delete newImpl;
+        } else {
+            impl         = newImpl;
+            inlineLength = 0;
+
+            std::fill(inlineData, inlineData + inlineWords, 0);
+        }
+    }
+}
+
+
+namespace Util {
+    BitArray::Mutator::Mutator(
+            BitArray& array
+        ):array(
+            array
+        ) {
+        if (array.impl.constData() != nullptr) {
+            Private* current = array.impl.data();
+
+            currentWords  = current->mutableData();
+            currentLength = current->size();
+        } else {
+            currentWords  = array.inlineData;
+            currentLength = array.inlineLength;
+        }
+    }
+
+
+    BitArray::Mutator::~Mutator() {
+        // Bits past the end of the array may have been set through words() so the tail of the last word is cleared.
+
+        unsigned residue = static_cast<unsigned>(currentLength % 64);
+        if (residue != 0) {
+            currentWords[currentLength / 64] &= (static_cast<std::uint64_t>(1) << residue) - 1;
+        }
+
+        if (array.impl.constData() != nullptr) {
+            // Discards any rank/select index built while the array was being updated.
+
+            array.impl.data()->mutableData();
+        }
     }
 }
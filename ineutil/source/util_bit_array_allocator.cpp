@@ -0,0 +1,423 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref Util::BitArrayAllocator and \ref Util::BitArrayArena classes.
+***********************************************************************************************************************/
+
+#include <QMutex>
+#include <QList>
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#if (defined(_WIN32))
+
+    #include <malloc.h>
+
+#elif (defined(__linux__))
+
+    #include <sys/mman.h>
+
+#endif
+
+#include "util_common.h"
+#include "util_bit_functions.h"
+#include "util_bit_array_allocator.h"
+
+namespace Util {
+    /**
+     * Function that obtains aligned storage from the heap.
+     *
+     * \param[in] numberWords The number of words to allocate.
+     *
+     * \return Returns a pointer to the newly allocated storage.
+     */
+    static std::uint64_t* allocateAligned(unsigned long numberWords) {
+        std::size_t numberBytes = numberWords * sizeof(std::uint64_t);
+        void*       result      = nullptr;
+
+        #if (defined(_WIN32))
+
+            result = _aligned_malloc(numberBytes, BitArrayAllocator::alignment);
+
+        #else
+
+            if (posix_memalign(&result, BitArrayAllocator::alignment, numberBytes) != 0) {
+                result = nullptr;
+            }
+
+        #endif
+
+        if (result == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        return static_cast<std::uint64_t*>(result);
+    }
+
+
+    /**
+     * Function that releases storage obtained from \ref Util::allocateAligned.
+     *
+     * \param[in] words The storage to be released.
+     */
+    static void releaseAligned(std::uint64_t* words) {
+        #if (defined(_WIN32))
+
+            _aligned_free(words);
+
+        #else
+
+            free(words);
+
+        #endif
+    }
+
+
+    /**
+     * Allocator that obtains storage directly from the heap.
+     */
+    class StandardBitArrayAllocator:public BitArrayAllocator {
+        public:
+            std::uint64_t* allocate(unsigned long numberWords) override {
+                return allocateAligned(numberWords);
+            }
+
+            void release(std::uint64_t* words, unsigned long) override {
+                releaseAligned(words);
+            }
+    };
+
+
+    /**
+     * Allocator that caches released storage in per-thread free lists, one per power of two size class.
+     */
+    class PooledBitArrayAllocator:public BitArrayAllocator {
+        public:
+            std::uint64_t* allocate(unsigned long numberWords) override {
+                std::uint64_t* result = nullptr;
+
+                unsigned sizeClass = sizeClassOf(numberWords);
+                if (sizeClass < numberSizeClasses) {
+                    ThreadPool* pool = currentPool();
+                    if (pool != nullptr && !pool->freeBlocks[sizeClass].empty()) {
+                        result = pool->freeBlocks[sizeClass].back();
+                        pool->freeBlocks[sizeClass].pop_back();
+                    } else {
+                        result = allocateAligned(minimumClassWords << sizeClass);
+                    }
+                } else {
+                    result = allocateAligned(numberWords);
+                }
+
+                return result;
+            }
+
+            void release(std::uint64_t* words, unsigned long numberWords) override {
+                unsigned sizeClass = sizeClassOf(numberWords);
+                if (sizeClass < numberSizeClasses) {
+                    ThreadPool* pool = currentPool();
+                    if (pool != nullptr && pool->freeBlocks[sizeClass].size() < maximumCachedBlocks) {
+                        pool->freeBlocks[sizeClass].push_back(words);
+                    } else {
+                        releaseAligned(words);
+                    }
+                } else {
+                    releaseAligned(words);
+                }
+            }
+
+        private:
+            /**
+             * The size of the smallest size class, in words.  The value equals one cache line.
+             */
+            static constexpr unsigned long minimumClassWords = alignment / sizeof(std::uint64_t);
+
+            /**
+             * The number of size classes.  Larger requests bypass the pools.
+             */
+            static constexpr unsigned numberSizeClasses = 13;
+
+            /**
+             * The maximum number of blocks cached per size class, per thread.
+             */
+            static constexpr std::size_t maximumCachedBlocks = 64;
+
+            /**
+             * The free lists for a single thread.
+             */
+            struct ThreadPool {
+                ~ThreadPool() {
+                    poolDestroyed = true;
+
+                    for (unsigned sizeClass=0 ; sizeClass<numberSizeClasses ; ++sizeClass) {
+                        for (std::uint64_t* block : freeBlocks[sizeClass]) {
+                            releaseAligned(block);
+                        }
+                    }
+                }
+
+                std::vector<std::uint64_t*> freeBlocks[numberSizeClasses];
+            };
+
+            /**
+             * Flag indicating that the calling thread's pool has been destroyed.  Arrays destroyed after the pool,
+             * such as static instances, release their storage directly to the heap.
+             */
+            static thread_local bool poolDestroyed;
+
+            /**
+             * Method that determines the size class for a request.
+             *
+             * \param[in] numberWords The requested number of words.
+             *
+             * \return Returns the size class.  A value of numberSizeClasses or larger indicates the request is too
+             *         large to be pooled.
+             */
+            static unsigned sizeClassOf(unsigned long numberWords) {
+                unsigned result = 0;
+                if (numberWords > minimumClassWords) {
+                    result = msbLocation64(numberWords - 1) + 1 - msbLocation64(minimumClassWords);
+                }
+
+                return result;
+            }
+
+            /**
+             * Method that obtains the pool for the calling thread.
+             *
+             * \return Returns the pool for the calling thread.  A null pointer is returned if the pool has already
+             *         been destroyed.
+             */
+            static ThreadPool* currentPool() {
+                ThreadPool* result = nullptr;
+
+                if (!poolDestroyed) {
+                    static thread_local ThreadPool pool;
+                    result = &pool;
+                }
+
+                return result;
+            }
+    };
+
+    thread_local bool PooledBitArrayAllocator::poolDestroyed = false;
+
+
+    /**
+     * Allocator that maps large requests onto transparent huge pages.
+     */
+    class HugePageBitArrayAllocator:public BitArrayAllocator {
+        public:
+            std::uint64_t* allocate(unsigned long numberWords) override {
+                std::uint64_t* result = nullptr;
+
+                #if (defined(__linux__))
+
+                    std::size_t numberBytes = mappedBytes(numberWords);
+                    if (numberBytes >= hugePageBytes) {
+                        // Over map by one huge page so the region can be trimmed to a huge page boundary.
+
+                        std::size_t mapBytes = numberBytes + hugePageBytes;
+                        void*       region   = mmap(
+                            nullptr,
+                            mapBytes,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1,
+                            0
+                        );
+
+                        if (region == MAP_FAILED) {
+                            throw std::bad_alloc();
+                        }
+
+                        std::uintptr_t start   = reinterpret_cast<std::uintptr_t>(region);
+                        std::uintptr_t aligned = (start + hugePageBytes - 1) & ~(hugePageBytes - 1);
+                        std::size_t    head    = aligned - start;
+                        std::size_t    tail    = mapBytes - head - numberBytes;
+
+                        if (head > 0) {
+                            munmap(region, head);
+                        }
+
+                        if (tail > 0) {
+                            munmap(reinterpret_cast<void*>(aligned + numberBytes), tail);
+                        }
+
+                        madvise(reinterpret_cast<void*>(aligned), numberBytes, MADV_HUGEPAGE);
+                        result = reinterpret_cast<std::uint64_t*>(aligned);
+                    } else {
+                        result = allocateAligned(numberWords);
+                    }
+
+                #else
+
+                    result = allocateAligned(numberWords);
+
+                #endif
+
+                return result;
+            }
+
+            void release(std::uint64_t* words, unsigned long numberWords) override {
+                #if (defined(__linux__))
+
+                    std::size_t numberBytes = mappedBytes(numberWords);
+                    if (numberBytes >= hugePageBytes) {
+                        munmap(words, numberBytes);
+                    } else {
+                        releaseAligned(words);
+                    }
+
+                #else
+
+                    releaseAligned(words);
+
+                #endif
+            }
+
+        private:
+            /**
+             * The huge page size, in bytes.
+             */
+            static constexpr std::size_t hugePageBytes = 2UL * 1024UL * 1024UL;
+
+            /**
+             * Method that determines the mapped size of a request.
+             *
+             * \param[in] numberWords The requested number of words.
+             *
+             * \return Returns the request size rounded up to a whole number of huge pages.  Requests smaller than
+             *         half a huge page return their unrounded size.
+             */
+            static std::size_t mappedBytes(unsigned long numberWords) {
+                std::size_t numberBytes = numberWords * sizeof(std::uint64_t);
+                return   numberBytes >= hugePageBytes / 2
+                       ? (numberBytes + hugePageBytes - 1) & ~(hugePageBytes - 1)
+                       : numberBytes;
+            }
+    };
+
+
+    BitArrayAllocator::~BitArrayAllocator() {}
+
+
+    BitArrayAllocator* BitArrayAllocator::standard() {
+        // Allocators are never destroyed so that static arrays can safely release storage at exit.
+
+        static BitArrayAllocator* instance = new StandardBitArrayAllocator;
+        return instance;
+    }
+
+
+    BitArrayAllocator* BitArrayAllocator::threadPool() {
+        static BitArrayAllocator* instance = new PooledBitArrayAllocator;
+        return instance;
+    }
+
+
+    BitArrayAllocator* BitArrayAllocator::hugePages() {
+        static BitArrayAllocator* instance = new HugePageBitArrayAllocator;
+        return instance;
+    }
+}
+
+
+namespace Util {
+    BitArrayArena::BitArrayArena(
+            unsigned long blockWords
+        ):blockWords(
+            (blockWords + wordsPerLine - 1) & ~(wordsPerLine - 1)
+        ),nextWord(
+            nullptr
+        ),remainingWords(
+            0
+        ) {}
+
+
+    BitArrayArena::~BitArrayArena() {
+        reset();
+    }
+
+
+    std::uint64_t* BitArrayArena::allocate(unsigned long numberWords) {
+        std::uint64_t* result       = nullptr;
+        unsigned long  roundedWords = (numberWords + wordsPerLine - 1) & ~(wordsPerLine - 1);
+
+        QMutexLocker locker(&mutex);
+
+        if (roundedWords > blockWords) {
+            result = allocateAligned(roundedWords);
+            blocks.append(result);
+            blockSizes.append(roundedWords);
+        } else {
+            if (roundedWords > remainingWords) {
+                nextWord       = allocateAligned(blockWords);
+                remainingWords = blockWords;
+
+                blocks.append(nextWord);
+                blockSizes.append(blockWords);
+            }
+
+            result          = nextWord;
+            nextWord       += roundedWords;
+            remainingWords -= roundedWords;
+        }
+
+        return result;
+    }
+
+
+    void BitArrayArena::release(std::uint64_t*, unsigned long) {}
+
+
+    void BitArrayArena::reset() {
+        QMutexLocker locker(&mutex);
+
+        for (std::uint64_t* block : blocks) {
+            releaseAligned(block);
+        }
+
+        blocks.clear();
+        blockSizes.clear();
+
+        nextWord       = nullptr;
+        remainingWords = 0;
+    }
+
+
+    unsigned long BitArrayArena::heldWords() const {
+        QMutexLocker locker(&mutex);
+
+        unsigned long result = 0;
+        for (unsigned long blockSize : blockSizes) {
+            result += blockSize;
+        }
+
+        return result;
+    }
+}
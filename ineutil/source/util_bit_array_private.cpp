@@ -28,28 +28,126 @@
 #include <QString>
 #include <QHash>
 #include <QList>
+#include <QFile>
+#include <QtEndian>
 
 #include <cstdint>
 #include <cstring>
 #include <cassert>
 #include <algorithm>
+#include <limits>
+#include <new>
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <numeric>
 
 #include "util_bit_functions.h"
+#include "util_hash_functions.h"
+#include "util_bit_kernels.h"
+#include "util_parallel_word_range.h"
 #include "util_bit_array.h"
 #include "util_bit_array_private.h"
 
 namespace Util {
-    BitArray::Private::Private() {
-        data       = nullptr;
-        dataLength = 0;
-        bitLength  = 0;
+    struct BitArray::Private::RankIndex {
+        /**
+         * The number of allocation units covered by each block.
+         */
+        static constexpr unsigned long unitsPerBlock = 8;
+
+        /**
+         * The number of blocks covered by each superblock.
+         */
+        static constexpr unsigned long blocksPerSuperblock = 128;
+
+        /**
+         * The number of set bits between select samples.
+         */
+        static constexpr BitArray::Index setBitsPerSample = 4096;
+
+        /**
+         * The number of set bits preceding each superblock.
+         */
+        std::vector<BitArray::Index> superblockRanks;
+
+        /**
+         * The number of set bits preceding each block, relative to the start of the block's superblock.
+         */
+        std::vector<std::uint16_t> blockRanks;
+
+        /**
+         * The block holding every setBitsPerSample'th set bit.
+         */
+        std::vector<unsigned long> selectSamples;
+
+        /**
+         * The total number of set bits.
+         */
+        BitArray::Index numberSetBits;
+
+        /**
+         * Method that calculates the number of set bits preceding a block.
+         *
+         * \param[in] blockIndex The zero based block index.
+         *
+         * \return Returns the number of set bits preceding the block.
+         */
+        inline BitArray::Index blockRank(unsigned long blockIndex) const {
+            return superblockRanks[blockIndex / blocksPerSuperblock] + blockRanks[blockIndex];
+        }
+    };
+
+    constexpr unsigned long   BitArray::Private::RankIndex::unitsPerBlock;
+    constexpr unsigned long   BitArray::Private::RankIndex::blocksPerSuperblock;
+    constexpr BitArray::Index BitArray::Private::RankIndex::setBitsPerSample;
+
+    constexpr char BitArray::Private::fileMagic[8];
+    constexpr char BitArray::Private::streamMagic[4];
+
+
+    BitArray::Private::Private(
+        ):ownsData(
+            true
+        ),borrowsData(
+            false
+        ),allocator(
+            BitArrayAllocator::standard()
+        ),mappedFile(
+            nullptr
+        ),currentRankIndex(
+            nullptr
+        ),currentHash(
+            0
+        ) {
+        data           = nullptr;
+        dataLength     = 0;
+        capacityLength = 0;
+        bitLength      = 0;
     }
 
 
-    BitArray::Private::Private(BitArray::Index numberBits, bool value) {
-        bitLength  = numberBits;
-        dataLength = allocationDataSize(numberBits);
-        data       = new AllocationUnit[dataLength];
+    BitArray::Private::Private(
+            BitArray::Index    numberBits,
+            bool               value,
+            BitArrayAllocator* allocator
+        ):ownsData(
+            true
+        ),borrowsData(
+            false
+        ),allocator(
+            allocator
+        ),mappedFile(
+            nullptr
+        ),currentRankIndex(
+            nullptr
+        ),currentHash(
+            0
+        ) {
+        bitLength      = numberBits;
+        dataLength     = allocationDataSize(numberBits);
+        capacityLength = dataLength;
+        data           = dataLength > 0 ? allocator->allocate(dataLength) : nullptr;
 
         if (value == false) {
             memset(reinterpret_cast<std::uint8_t*>(data), 0, dataLength * allocationUnitSize / 8);
@@ -66,84 +164,578 @@ namespace Util {
     }
 
 
-    BitArray::Private::Private(const bool* rawData, BitArray::Index numberBits) {
+    BitArray::Private::Private(
+            const bool*     rawData,
+            BitArray::Index numberBits
+        ):ownsData(
+            true
+        ),borrowsData(
+            false
+        ),allocator(
+            BitArrayAllocator::standard()
+        ),mappedFile(
+            nullptr
+        ),currentRankIndex(
+            nullptr
+        ),currentHash(
+            0
+        ) {
         if (numberBits == 0) {
-            data       = nullptr;
-            dataLength = 0;
-            bitLength  = 0;
+            data           = nullptr;
+            dataLength     = 0;
+            capacityLength = 0;
+            bitLength      = 0;
         } else {
-            bitLength  = numberBits;
-            dataLength = allocationDataSize(numberBits);
-            data       = new AllocationUnit[dataLength];
-
-            AllocationUnit* dataPointer = data;
-            AllocationUnit  unit        = 0;
-            AllocationUnit  mask        = 1;
-            for (BitArray::Index index=0 ; index<numberBits ; ++index) {
-                bool value = rawData[index];
-
-                if (value) {
-                    unit |= mask;
-                } else {
-                    unit &= ~mask;
-                }
+            bitLength      = numberBits;
+            dataLength     = allocationDataSize(numberBits);
+            capacityLength = dataLength;
+            data           = allocator->allocate(dataLength);
+
+            packBits(data, rawData, numberBits);
+        }
+    }
+
+
+    BitArray::Private::Private(
+            const void*     rawData,
+            BitArray::Index numberBits
+        ):ownsData(
+            true
+        ),borrowsData(
+            false
+        ),allocator(
+            BitArrayAllocator::standard()
+        ),mappedFile(
+            nullptr
+        ),currentRankIndex(
+            nullptr
+        ),currentHash(
+            0
+        ) {
+        if (numberBits == 0) {
+            data           = nullptr;
+            dataLength     = 0;
+            capacityLength = 0;
+            bitLength      = 0;
+        } else {
+            bitLength      = numberBits;
+            dataLength     = allocationDataSize(numberBits);
+            capacityLength = dataLength;
+            data           = allocator->allocate(dataLength);
+
+            packBits(data, rawData, numberBits);
+        }
+    }
+
+
+    BitArray::Private::Private(
+            const BitArray::Private& other
+        ):QSharedData(
+            other
+        ),ownsData(
+            true
+        ),borrowsData(
+            false
+        ),allocator(
+            other.allocator
+        ),mappedFile(
+            nullptr
+        ),currentRankIndex(
+            nullptr
+        ),currentHash(
+            0
+        ) {
+        if (other.dataLength > 0) {
+            data = allocator->allocate(other.dataLength);
+            memcpy(data, other.data, other.dataLength * (allocationUnitSize / 8));
+        } else {
+            data = nullptr;
+        }
+
+        dataLength     = other.dataLength;
+        capacityLength = other.dataLength;
+        bitLength      = other.bitLength;
+    }
 
-                mask <<= 1;
-                if (mask == 0) {
-                    *dataPointer = unit;
-                    ++dataPointer;
 
-                    unit = 0;
-                    mask = 1;
+    BitArray::Private::Private(
+            const BitArray::Private& first,
+            const BitArray::Private&     second,
+            BitArray::Private::Operation operation,
+            bool                         parallel
+        ):ownsData(
+            true
+        ),borrowsData(
+            false
+        ),allocator(
+            BitArrayAllocator::standard()
+        ),mappedFile(
+            nullptr
+        ),currentRankIndex(
+            nullptr
+        ),currentHash(
+            0
+        ) {
+        const BitArray::Private& longer = first.dataLength >= second.dataLength ? first : second;
+
+        unsigned long commonDataLength = std::min(first.dataLength, second.dataLength);
+
+        bitLength      = std::max(first.bitLength, second.bitLength);
+        dataLength     = longer.dataLength;
+        capacityLength = dataLength;
+        data           = dataLength > 0 ? allocator->allocate(dataLength) : nullptr;
+
+        if (parallel) {
+            ParallelWordRange(0, commonDataLength).run(
+                [this, &first, &second, operation](unsigned, unsigned long startingUnit, unsigned long endingUnit) {
+                    combineUnits(
+                        data + startingUnit,
+                        first.data + startingUnit,
+                        second.data + startingUnit,
+                        endingUnit - startingUnit,
+                        operation
+                    );
                 }
-            }
+            );
+        } else {
+            combineUnits(data, first.data, second.data, commonDataLength, operation);
+        }
 
-            if (mask != 1) {
-                *dataPointer = unit;
+        unsigned long remainingLength = dataLength - commonDataLength;
+        if (remainingLength > 0) {
+            bool keepRemaining = (
+                   operation == Operation::OR
+                || operation == Operation::XOR
+                || (operation == Operation::AND_NOT && &longer == &first)
+            );
+
+            if (keepRemaining) {
+                memcpy(
+                    data + commonDataLength,
+                    longer.data + commonDataLength,
+                    remainingLength * (allocationUnitSize / 8)
+                );
+            } else {
+                memset(data + commonDataLength, 0, remainingLength * (allocationUnitSize / 8));
             }
         }
     }
 
 
-    BitArray::Private::Private(const void* rawData, BitArray::Index numberBits) {
-        if (numberBits == 0) {
-            data       = nullptr;
-            dataLength = 0;
-            bitLength  = 0;
+    BitArray::Private::Private(
+            std::uint64_t*     buffer,
+            unsigned long      bufferLength,
+            BitArray::Index    numberBits,
+            BitArrayAllocator* allocator
+        ):ownsData(
+            true
+        ),borrowsData(
+            true
+        ),allocator(
+            allocator
+        ),mappedFile(
+            nullptr
+        ),currentRankIndex(
+            nullptr
+        ),currentHash(
+            0
+        ) {
+        assert(allocationDataSize(numberBits) <= bufferLength);
+
+        data           = buffer;
+        dataLength     = allocationDataSize(numberBits);
+        capacityLength = bufferLength;
+        bitLength      = numberBits;
+    }
+
+
+    BitArray::Private::Private(
+            BitArray::Private&& other
+        ):ownsData(
+            other.ownsData
+        ),borrowsData(
+            false
+        ),allocator(
+            other.allocator
+        ),mappedFile(
+            other.mappedFile
+        ),currentRankIndex(
+            other.currentRankIndex.exchange(nullptr)
+        ),currentHash(
+            other.currentHash.exchange(0)
+        ) {
+        assert(!other.borrowsData);
+
+        data           = other.data;
+        dataLength     = other.dataLength;
+        capacityLength = other.capacityLength;
+        bitLength      = other.bitLength;
+
+        other.data           = nullptr;
+        other.dataLength     = 0;
+        other.capacityLength = 0;
+        other.bitLength      = 0;
+        other.ownsData       = true;
+        other.mappedFile     = nullptr;
+    }
+
+
+    BitArray::Private::~Private() {
+        releaseData();
+        delete currentRankIndex.load();
+    }
+
+
+    void BitArray::Private::packBits(std::uint64_t* destination, const bool* rawData, BitArray::Index numberBits) {
+        static_assert(sizeof(bool) == 1, "Boolean values are expected to occupy a single byte.");
+        packBytes(destination, reinterpret_cast<const std::uint8_t*>(rawData), numberBits);
+    }
+
+
+    void BitArray::Private::packBits(std::uint64_t* destination, const void* rawData, BitArray::Index numberBits) {
+        unsigned long dataLength            = allocationDataSize(numberBits);
+        unsigned long numberBytes           = (numberBits + 7) / 8;
+        unsigned long allocationSizeInBytes = dataLength * (allocationUnitSize / 8);
+        unsigned      residue               = allocationSizeInBytes - numberBytes;
+
+        if (numberBytes > 0) {
+            memcpy(destination, rawData, numberBytes);
+        }
+
+        if (residue > 0) {
+            memset(reinterpret_cast<std::uint8_t*>(destination) + numberBytes, 0, residue);
+        }
+
+        unsigned lastUnitBits = numberBits % allocationUnitSize;
+        if (lastUnitBits != 0) {
+            destination[dataLength - 1] &= (static_cast<AllocationUnit>(1) << lastUnitBits) - 1;
+        }
+    }
+
+
+    BitArray::Private* BitArray::Private::createView(
+            const std::uint64_t* rawData,
+            BitArray::Index      numberBits,
+            QFile*               mappedFile
+        ) {
+        assert((reinterpret_cast<std::uintptr_t>(rawData) & (sizeof(AllocationUnit) - 1)) == 0);
+
+        Private* result = new Private;
+
+        if (numberBits > 0) {
+            result->bitLength      = numberBits;
+            result->dataLength     = allocationDataSize(numberBits);
+            result->capacityLength = result->dataLength;
+            result->data           = const_cast<AllocationUnit*>(rawData);
+            result->ownsData       = false;
+            result->mappedFile     = mappedFile;
+
+            unsigned residue = numberBits % allocationUnitSize;
+            if (residue != 0 && (rawData[result->dataLength - 1] >> residue) != 0) {
+                // Bits past the end of the array must be cleared so we fall back to an owned copy.
+
+                result->reallocate(result->dataLength);
+                result->data[result->dataLength - 1] &= (static_cast<AllocationUnit>(1) << residue) - 1;
+            }
         } else {
-            bitLength  = numberBits;
-            dataLength = allocationDataSize(numberBits);
-            data       = new AllocationUnit[dataLength];
+            delete mappedFile;
+        }
+
+        return result;
+    }
 
-            unsigned long numberBytes           = (numberBits + 7) / 8;
-            unsigned long allocationSizeInBytes = dataLength * (allocationUnitSize / 8);
-            unsigned      residue               = allocationSizeInBytes - numberBytes;
 
-            memcpy(data, rawData, numberBytes);
-            if (residue > 0) {
-                memset(reinterpret_cast<std::uint8_t*>(data) + numberBytes, 0, residue);
+    BitArray::Private* BitArray::Private::mapFile(const QString& filename) {
+        Private* result = nullptr;
+        QFile*   file   = new QFile(filename);
+
+        if (file->open(QFile::ReadOnly)) {
+            std::uint8_t header[fileHeaderSize];
+            if (file->read(reinterpret_cast<char*>(header), fileHeaderSize) == fileHeaderSize &&
+                memcmp(header, fileMagic, sizeof(fileMagic)) == 0                            &&
+                qFromLittleEndian<quint32>(header + 8) == fileVersion                          ) {
+                BitArray::Index numberBits    = qFromLittleEndian<quint64>(header + 16);
+                quint64         numberWords   = (
+                      numberBits / allocationUnitSize
+                    + (numberBits % allocationUnitSize != 0 ? 1 : 0)
+                );
+                qint64          availableSize = file->size() - fileHeaderSize;
+
+                // The word count is computed without overflow and checked against the file size before anything is
+                // mapped so corrupt or truncated headers are rejected rather than read past the end of the file.
+
+                if (availableSize >= 0 && numberWords <= static_cast<quint64>(availableSize) / sizeof(AllocationUnit)) {
+                    qint64 numberBytes = static_cast<qint64>(numberWords * sizeof(AllocationUnit));
+
+                    #if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN)
+
+                        if (numberWords > 0) {
+                            uchar* mapped = file->map(fileHeaderSize, numberBytes);
+                            if (mapped != nullptr) {
+                                result = createView(reinterpret_cast<const AllocationUnit*>(mapped), numberBits, file);
+                                file   = nullptr;
+                            }
+                        }
+
+                    #endif
+
+                    if (result == nullptr) {
+                        // Mapping is not available so we fall back to reading the file contents.
+
+                        result = new Private(numberBits, false);
+                        if (numberWords > 0) {
+                            if (file->read(reinterpret_cast<char*>(result->data), numberBytes) == numberBytes) {
+                                for (unsigned long index=0 ; index<numberWords ; ++index) {
+                                    result->data[index] = qFromLittleEndian<quint64>(result->data + index);
+                                }
+
+                                unsigned residue = numberBits % allocationUnitSize;
+                                if (residue != 0) {
+                                    result->data[numberWords - 1] &= (static_cast<AllocationUnit>(1) << residue) - 1;
+                                }
+                            } else {
+                                delete result;
+                                result = nullptr;
+                            }
+                        }
+                    }
+                }
             }
         }
+
+        delete file;
+        return result;
     }
 
 
-    BitArray::Private::Private(const BitArray::Private& other):QSharedData(other) {
-        if (other.data != nullptr) {
-            data = new AllocationUnit[other.dataLength];
-            memcpy(data, other.data, other.dataLength * (allocationUnitSize / 8));
-        } else {
-            data = nullptr;
+    bool BitArray::Private::saveFile(const QString& filename) const {
+        QFile file(filename);
+        bool  success = file.open(QFile::WriteOnly | QFile::Truncate);
+
+        if (success) {
+            std::uint8_t header[fileHeaderSize];
+            memcpy(header, fileMagic, sizeof(fileMagic));
+            qToLittleEndian<quint32>(fileVersion, header + 8);
+            qToLittleEndian<quint32>(0, header + 12);
+            qToLittleEndian<quint64>(bitLength, header + 16);
+
+            success = (file.write(reinterpret_cast<const char*>(header), fileHeaderSize) == fileHeaderSize);
+
+            #if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN)
+
+                qint64 numberBytes = static_cast<qint64>(dataLength * sizeof(AllocationUnit));
+                if (success && numberBytes > 0) {
+                    success = (file.write(reinterpret_cast<const char*>(data), numberBytes) == numberBytes);
+                }
+
+            #else
+
+                unsigned long index = 0;
+                while (success && index < dataLength) {
+                    std::uint8_t word[sizeof(AllocationUnit)];
+                    qToLittleEndian<quint64>(data[index], word);
+
+                    success = (file.write(reinterpret_cast<const char*>(word), sizeof(word)) == sizeof(word));
+                    ++index;
+                }
+
+            #endif
+
+            file.close();
+            success = success && file.error() == QFile::NoError;
         }
 
-        dataLength = other.dataLength;
-        bitLength  = other.bitLength;
+        return success;
     }
 
 
-    BitArray::Private::~Private() {
-        if (data != nullptr) {
-            delete[] data;
+    bool BitArray::Private::isView() const {
+        return !ownsData;
+    }
+
+
+    bool BitArray::Private::isBorrowed() const {
+        return borrowsData;
+    }
+
+
+    bool BitArray::Private::encode(
+            const BitArray::Private::WriteFunction& writeFunction,
+            BitArray::Compression                   compression
+        ) const {
+        std::uint8_t header[streamHeaderSize];
+        memcpy(header, streamMagic, sizeof(streamMagic));
+        qToLittleEndian<quint16>(streamVersion, header + 4);
+        qToLittleEndian<quint16>(static_cast<quint16>(compression), header + 6);
+        qToLittleEndian<quint64>(bitLength, header + 8);
+
+        bool success = writeFunction(reinterpret_cast<const char*>(header), streamHeaderSize);
+
+        #if (Q_BYTE_ORDER != Q_LITTLE_ENDIAN)
+
+            std::vector<AllocationUnit> buffer;
+
+        #endif
+
+        bool          compress  = (compression == BitArray::Compression::RUN_LENGTH);
+        unsigned long unitIndex = 0;
+        while (success && unitIndex < dataLength) {
+            RecordType    recordType;
+            unsigned long count;
+
+            if (compress && startsFill(unitIndex)) {
+                AllocationUnit fill = data[unitIndex];
+
+                count = 1;
+                while (unitIndex + count < dataLength && count < maximumFillWords && data[unitIndex + count] == fill) {
+                    ++count;
+                }
+
+                recordType = fill == 0 ? RecordType::ZERO_FILL : RecordType::ONES_FILL;
+            } else {
+                count = 1;
+                while (unitIndex + count < dataLength                 &&
+                       count < maximumLiteralWords                    &&
+                       (!compress || !startsFill(unitIndex + count))    ) {
+                    ++count;
+                }
+
+                recordType = RecordType::LITERAL;
+            }
+
+            std::uint8_t recordHeader[4];
+            quint32      record = (static_cast<quint32>(recordType) << 30) | static_cast<quint32>(count);
+            qToLittleEndian<quint32>(record, recordHeader);
+
+            success = writeFunction(reinterpret_cast<const char*>(recordHeader), sizeof(recordHeader));
+
+            if (success && recordType == RecordType::LITERAL) {
+                #if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN)
+
+                    success = writeFunction(
+                        reinterpret_cast<const char*>(data + unitIndex),
+                        count * sizeof(AllocationUnit)
+                    );
+
+                #else
+
+                    buffer.resize(count);
+                    for (unsigned long i=0 ; i<count ; ++i) {
+                        qToLittleEndian<quint64>(data[unitIndex + i], buffer.data() + i);
+                    }
+
+                    success = writeFunction(
+                        reinterpret_cast<const char*>(buffer.data()),
+                        count * sizeof(AllocationUnit)
+                    );
+
+                #endif
+            }
+
+            unitIndex += count;
+        }
+
+        return success;
+    }
+
+
+    BitArray::Private* BitArray::Private::decode(const BitArray::Private::ReadFunction& readFunction) {
+        Private* result = nullptr;
+
+        std::uint8_t header[streamHeaderSize];
+        if (readFunction(reinterpret_cast<char*>(header), streamHeaderSize)                                  &&
+            memcmp(header, streamMagic, sizeof(streamMagic)) == 0                                            &&
+            qFromLittleEndian<quint16>(header + 4) == streamVersion                                          &&
+            qFromLittleEndian<quint16>(header + 6) <= static_cast<quint16>(BitArray::Compression::RUN_LENGTH)   ) {
+            BitArray::Index numberBits  = qFromLittleEndian<quint64>(header + 8);
+            quint64         numberWords = (
+                  numberBits / allocationUnitSize
+                + (numberBits % allocationUnitSize != 0 ? 1 : 0)
+            );
+
+            // The claimed length is not trusted.  Storage grows as records are decoded so a corrupt or truncated
+            // stream fails before the full claimed buffer is allocated.
+
+            bool success = (numberWords <= std::numeric_limits<unsigned long>::max() / sizeof(AllocationUnit));
+
+            result = new Private;
+
+            unsigned long unitIndex = 0;
+            while (success && unitIndex < numberWords) {
+                std::uint8_t recordHeader[4];
+                success = readFunction(reinterpret_cast<char*>(recordHeader), sizeof(recordHeader));
+
+                if (success) {
+                    quint32       record = qFromLittleEndian<quint32>(recordHeader);
+                    unsigned long count  = record & maximumFillWords;
+
+                    success = (count > 0 && count <= numberWords - unitIndex);
+                    if (success) {
+                        if (unitIndex + count > result->capacityLength) {
+                            // Newly allocated words are cleared so zero fill records need no further work.
+
+                            unsigned long newCapacity = grownCapacity(result->capacityLength, unitIndex + count);
+                            result->reallocate(static_cast<unsigned long>(std::min<quint64>(newCapacity, numberWords)));
+                        }
+
+                        switch (static_cast<RecordType>(record >> 30)) {
+                            case RecordType::ZERO_FILL: {
+                                break;
+                            }
+
+                            case RecordType::ONES_FILL: {
+                                memset(result->data + unitIndex, 0xFF, count * sizeof(AllocationUnit));
+                                break;
+                            }
+
+                            case RecordType::LITERAL: {
+                                success = (
+                                       count <= maximumLiteralWords
+                                    && readFunction(
+                                           reinterpret_cast<char*>(result->data + unitIndex),
+                                           count * sizeof(AllocationUnit)
+                                       )
+                                );
+
+                                #if (Q_BYTE_ORDER != Q_LITTLE_ENDIAN)
+
+                                    for (unsigned long i=0 ; i<count ; ++i) {
+                                        result->data[unitIndex + i] = qFromLittleEndian<quint64>(
+                                            result->data + unitIndex + i
+                                        );
+                                    }
+
+                                #endif
+
+                                break;
+                            }
+
+                            default: {
+                                success = false;
+                                break;
+                            }
+                        }
+
+                        unitIndex          += count;
+                        result->dataLength  = unitIndex;
+                    }
+                }
+            }
+
+            if (success) {
+                result->bitLength = numberBits;
+
+                unsigned residue = result->bitLength % allocationUnitSize;
+                if (residue != 0) {
+                    result->data[result->dataLength - 1] &= (static_cast<AllocationUnit>(1) << residue) - 1;
+                }
+            } else {
+                delete result;
+                result = nullptr;
+            }
         }
+
+        return result;
     }
 
 
@@ -152,60 +744,91 @@ namespace Util {
     }
 
 
+    BitArray::Index BitArray::Private::capacity() const {
+        return static_cast<BitArray::Index>(capacityLength) * allocationUnitSize;
+    }
+
+
+    const std::uint64_t* BitArray::Private::constData() const {
+        return data;
+    }
+
+
+    std::uint64_t* BitArray::Private::mutableData() {
+        prepareForUpdate();
+        return data;
+    }
+
+
+    BitArrayAllocator* BitArray::Private::storageAllocator() const {
+        return allocator;
+    }
+
+
+    unsigned long BitArray::Private::wordCount() const {
+        return dataLength;
+    }
+
+
     void BitArray::Private::clear() {
-        if (data != nullptr) {
-            delete[] data;
-        }
+        invalidateCaches();
+        releaseData();
 
-        data       = nullptr;
-        dataLength = 0;
-        bitLength  = 0;
+        data           = nullptr;
+        dataLength     = 0;
+        capacityLength = 0;
+        bitLength      = 0;
     }
 
 
     void BitArray::Private::resize(Index newLength) {
-        if (newLength != bitLength) {
-            if (newLength == 0) {
-                if (data != nullptr) {
-                    delete[] data;
-                }
+        prepareForUpdate();
 
-                data       = nullptr;
-                dataLength = 0;
-                bitLength  = 0;
-            } else if (data == nullptr) {
-                unsigned long   newDataLength = allocationDataSize(newLength);
-                AllocationUnit* newData       = new AllocationUnit[newDataLength];
-                memset(newData, 0, newDataLength * (allocationUnitSize / 8));
-
-                data       = newData;
-                dataLength = newDataLength;
-                bitLength  = newLength;
-            } else {
-                unsigned long   newDataLength = allocationDataSize(newLength);
-                AllocationUnit* newData       = new AllocationUnit[newDataLength];
+        if (newLength < bitLength) {
+            unsigned long newDataLength = allocationDataSize(newLength);
 
-                unsigned long   oldDataLength = dataLength;
-                AllocationUnit* oldData       = data;
+            if (newDataLength < dataLength) {
+                memset(data + newDataLength, 0, (dataLength - newDataLength) * (allocationUnitSize / 8));
+            }
 
-                if (newDataLength > oldDataLength) {
-                    memcpy(newData, oldData, oldDataLength * (allocationUnitSize / 8));
-                    memset(newData + oldDataLength, 0, (newDataLength - oldDataLength) * (allocationUnitSize / 8));
-                } else /* if (newDataLength <= oldDataLength) */ {
-                    memcpy(newData, oldData, newDataLength * (allocationUnitSize / 8));
-                }
+            unsigned residue = newLength % allocationUnitSize;
+            if (residue != 0) {
+                data[newDataLength - 1] &= (static_cast<AllocationUnit>(1) << residue) - 1;
+            }
 
-                data       = newData;
-                dataLength = newDataLength;
-                bitLength  = newLength;
+            dataLength = newDataLength;
+            bitLength  = newLength;
+        } else if (newLength > bitLength) {
+            unsigned long newDataLength = allocationDataSize(newLength);
 
-                delete[] oldData;
+            if (newDataLength > capacityLength) {
+                reallocate(grownCapacity(capacityLength, newDataLength));
             }
+
+            dataLength = newDataLength;
+            bitLength  = newLength;
+        }
+    }
+
+
+    void BitArray::Private::reserve(BitArray::Index numberBits) {
+        unsigned long requiredCapacity = allocationDataSize(numberBits);
+        if (requiredCapacity > capacityLength) {
+            reallocate(requiredCapacity);
+        }
+    }
+
+
+    void BitArray::Private::shrinkToFit() {
+        if (!borrowsData && capacityLength > dataLength) {
+            reallocate(dataLength);
         }
     }
 
 
     void BitArray::Private::setBit(BitArray::Index bitIndex, bool nowSet) {
+        prepareForUpdate();
+
         resizeToFit(bitIndex);
 
         unsigned long  unitIndex = bitIndex / allocationUnitSize;
@@ -229,6 +852,8 @@ namespace Util {
 
 
     void BitArray::Private::setBits(BitArray::Index startingIndex, BitArray::Index endingIndex, bool nowSet) {
+        prepareForUpdate();
+
         assert(startingIndex <= endingIndex);
 
         resizeToFit(endingIndex);
@@ -306,6 +931,38 @@ namespace Util {
     }
 
 
+    void BitArray::Private::parallelSetBits(BitArray::Index startingIndex, BitArray::Index endingIndex, bool nowSet) {
+        assert(startingIndex <= endingIndex);
+
+        prepareForUpdate();
+        resizeToFit(endingIndex);
+
+        unsigned long firstWholeUnit = (startingIndex + allocationUnitSize - 1) / allocationUnitSize;
+        unsigned long endWholeUnit   = (endingIndex + 1) / allocationUnitSize;
+
+        if (endWholeUnit > firstWholeUnit) {
+            // Partial allocation units at either end are handled on this thread, whole units are filled in parallel.
+
+            if (startingIndex < firstWholeUnit * allocationUnitSize) {
+                setBits(startingIndex, firstWholeUnit * allocationUnitSize - 1, nowSet);
+            }
+
+            if (endingIndex >= endWholeUnit * allocationUnitSize) {
+                setBits(endWholeUnit * allocationUnitSize, endingIndex, nowSet);
+            }
+
+            int fillByte = nowSet ? 0xFF : 0x00;
+            ParallelWordRange(firstWholeUnit, endWholeUnit).run(
+                [this, fillByte](unsigned, unsigned long startingUnit, unsigned long endingUnit) {
+                    memset(data + startingUnit, fillByte, (endingUnit - startingUnit) * (allocationUnitSize / 8));
+                }
+            );
+        } else {
+            setBits(startingIndex, endingIndex, nowSet);
+        }
+    }
+
+
     bool BitArray::Private::isSet(BitArray::Index index) const {
         bool result;
 
@@ -339,14 +996,7 @@ namespace Util {
             }
 
             if (index < dataLength) {
-                AllocationUnit unit = data[index];
-                AllocationUnit mask = maskLsbOne(unit);
-
-                if (allocationUnitSize == 64) {
-                    result = allocationUnitSize * index + msbLocation64(mask);
-                } else {
-                    result = allocationUnitSize * index + msbLocation32(static_cast<std::uint32_t>(mask));
-                }
+                result = allocationUnitSize * index + lsbLocation64(data[index]);
 
                 if (result >= bitLength) {
                     result = BitArray::invalidIndex;
@@ -373,14 +1023,7 @@ namespace Util {
             }
 
             if (index < dataLength) {
-                AllocationUnit unit = data[index];
-                AllocationUnit mask = maskLsbZero(unit);
-
-                if (allocationUnitSize == 64) {
-                    result = allocationUnitSize * index + msbLocation64(mask);
-                } else {
-                    result = allocationUnitSize * index + msbLocation32(static_cast<std::uint32_t>(mask));
-                }
+                result = allocationUnitSize * index + lsbLocation64(~data[index]);
 
                 if (result >= bitLength) {
                     result = BitArray::invalidIndex;
@@ -397,6 +1040,36 @@ namespace Util {
     }
 
 
+    BitArray::Index BitArray::Private::parallelFirstSetBit() const {
+        BitArray::Index result     = BitArray::invalidIndex;
+        unsigned long   unitIndex  = parallelFirstUnitNotEqualTo(0);
+
+        if (unitIndex < dataLength) {
+            result = allocationUnitSize * unitIndex + lsbLocation64(data[unitIndex]);
+            if (result >= bitLength) {
+                result = BitArray::invalidIndex;
+            }
+        }
+
+        return result;
+    }
+
+
+    BitArray::Index BitArray::Private::parallelFirstClearedBit() const {
+        BitArray::Index result     = BitArray::invalidIndex;
+        unsigned long   unitIndex  = parallelFirstUnitNotEqualTo(allOnes);
+
+        if (unitIndex < dataLength) {
+            result = allocationUnitSize * unitIndex + lsbLocation64(~data[unitIndex]);
+            if (result >= bitLength) {
+                result = BitArray::invalidIndex;
+            }
+        }
+
+        return result;
+    }
+
+
     BitArray::Index BitArray::Private::firstSetBit(BitArray::Index startingIndex) const {
         BitArray::Index result;
 
@@ -409,14 +1082,7 @@ namespace Util {
             }
 
             if (index < dataLength) {
-                AllocationUnit unit    = data[index] & mask;
-                AllocationUnit oneMask = maskLsbOne(unit);
-
-                if (allocationUnitSize == 64) {
-                    result = allocationUnitSize * index + msbLocation64(oneMask);
-                } else {
-                    result = allocationUnitSize * index + msbLocation32(static_cast<std::uint32_t>(oneMask));
-                }
+                result = allocationUnitSize * index + lsbLocation64(data[index] & mask);
 
                 if (result >= bitLength) {
                     result = BitArray::invalidIndex;
@@ -445,14 +1111,7 @@ namespace Util {
             }
 
             if (index < dataLength) {
-                AllocationUnit unit     = data[index] | mask;
-                AllocationUnit zeroMask = maskLsbZero(unit);
-
-                if (allocationUnitSize == 64) {
-                    result = allocationUnitSize * index + msbLocation64(zeroMask);
-                } else {
-                    result = allocationUnitSize * index + msbLocation32(static_cast<std::uint32_t>(zeroMask));
-                }
+                result = allocationUnitSize * index + lsbLocation64(~(data[index] | mask));
 
                 if (result >= bitLength) {
                     result = BitArray::invalidIndex;
@@ -469,62 +1128,979 @@ namespace Util {
     }
 
 
-    bool BitArray::Private::operator==(const BitArray::Private& other) const {
-        bool isEqual;
+    BitArray::Index BitArray::Private::lastSetBit() const {
+        return bitLength > 0 ? previousSetBit(bitLength - 1) : BitArray::invalidIndex;
+    }
 
-        if (data == nullptr) {
-            if (other.data == nullptr) {
-                isEqual = true;
-            } else {
-                isEqual = false;
-            }
-        } else {
-            if (other.bitLength == bitLength) {
-                isEqual = true;
 
-                unsigned long index = 0;
-                while (index < dataLength && isEqual) {
-                    if (index < (dataLength - 1)) {
-                        isEqual = (data[index] == other.data[index]);
-                    } else {
-                        unsigned long  baseBitIndex = bitLength - index * allocationUnitSize;
-                        if (baseBitIndex == allocationUnitSize) {
-                            isEqual = (data[index] == other.data[index]);
-                        } else {
-                            assert(baseBitIndex < allocationUnitSize);
+    BitArray::Index BitArray::Private::lastClearedBit() const {
+        return bitLength > 0 ? previousClearedBit(bitLength - 1) : BitArray::invalidIndex;
+    }
 
-                            AllocationUnit mask         = (static_cast<AllocationUnit>(1) << baseBitIndex) - 1;
-                            AllocationUnit unit         = data[index] & mask;
-                            AllocationUnit otherUnit    = other.data[index] & mask;
 
-                            isEqual = (unit == otherUnit);
-                        }
-                    }
+    BitArray::Index BitArray::Private::parallelLastSetBit() const {
+        BitArray::Index result   = BitArray::invalidIndex;
+        unsigned long   unitEnd  = parallelLastUnitNotEqualTo(0, dataLength);
 
-                    ++index;
-                }
-            } else {
-                isEqual = false;
-            }
+        if (unitEnd > 0) {
+            result = allocationUnitSize * (unitEnd - 1) + msbLocation64(data[unitEnd - 1]);
         }
 
-        return isEqual;
+        return result;
     }
 
 
-    bool BitArray::Private::operator!=(const BitArray::Private& other) const {
-        return !operator==(other);
-    }
+    BitArray::Index BitArray::Private::parallelLastClearedBit() const {
+        BitArray::Index result    = BitArray::invalidIndex;
+        unsigned long   fullUnits = bitLength / allocationUnitSize;
+        unsigned        residue   = bitLength % allocationUnitSize;
 
+        // The partial allocation unit at the end is checked on this thread so bits past the end are never reported.
 
-    unsigned long BitArray::Private::allocationDataSize(BitArray::Index bitLength) {
-        return (bitLength + allocationUnitSize - 1) / allocationUnitSize;
+        if (residue != 0) {
+            AllocationUnit cleared = ~data[fullUnits] & ((static_cast<AllocationUnit>(1) << residue) - 1);
+            if (cleared != 0) {
+                result = allocationUnitSize * fullUnits + msbLocation64(cleared);
+            }
+        }
+
+        if (result == BitArray::invalidIndex) {
+            unsigned long unitEnd = parallelLastUnitNotEqualTo(allOnes, fullUnits);
+            if (unitEnd > 0) {
+                result = allocationUnitSize * (unitEnd - 1) + msbLocation64(~data[unitEnd - 1]);
+            }
+        }
+
+        return result;
     }
 
 
-    void BitArray::Private::resizeToFit(BitArray::Index index) {
-        if (index >= bitLength) {
+    BitArray::Index BitArray::Private::previousSetBit(BitArray::Index startingIndex) const {
+        BitArray::Index result = BitArray::invalidIndex;
+
+        if (bitLength > 0) {
+            BitArray::Index lastIndex = std::min(startingIndex, static_cast<BitArray::Index>(bitLength - 1));
+            unsigned long   index     = lastIndex / allocationUnitSize;
+            AllocationUnit  mask      = allOnes >> (allocationUnitSize - 1 - lastIndex % allocationUnitSize);
+            AllocationUnit  unit      = data[index] & mask;
+
+            while (unit == 0 && index > 0) {
+                --index;
+                unit = data[index];
+            }
+
+            if (unit != 0) {
+                result = allocationUnitSize * index + msbLocation64(unit);
+            }
+        }
+
+        return result;
+    }
+
+
+    BitArray::Index BitArray::Private::previousClearedBit(BitArray::Index startingIndex) const {
+        BitArray::Index result = BitArray::invalidIndex;
+
+        if (bitLength > 0) {
+            BitArray::Index lastIndex = std::min(startingIndex, static_cast<BitArray::Index>(bitLength - 1));
+            unsigned long   index     = lastIndex / allocationUnitSize;
+            AllocationUnit  mask      = allOnes >> (allocationUnitSize - 1 - lastIndex % allocationUnitSize);
+            AllocationUnit  unit      = ~data[index] & mask;
+
+            while (unit == 0 && index > 0) {
+                --index;
+                unit = ~data[index];
+            }
+
+            if (unit != 0) {
+                result = allocationUnitSize * index + msbLocation64(unit);
+            }
+        }
+
+        return result;
+    }
+
+
+    BitArray::Index BitArray::Private::findClearRun(BitArray::Index length, BitArray::Index startingIndex) const {
+        return findRun(length, startingIndex, allOnes);
+    }
+
+
+    BitArray::Index BitArray::Private::findSetRun(BitArray::Index length, BitArray::Index startingIndex) const {
+        return findRun(length, startingIndex, 0);
+    }
+
+
+    BitArray::Index BitArray::Private::popcount() const {
+        BitArray::Index result;
+
+        const RankIndex* index = currentRankIndex.load(std::memory_order_acquire);
+        if (index != nullptr) {
+            result = index->numberSetBits;
+        } else {
+            result = populationCount(data, dataLength);
+        }
+
+        return result;
+    }
+
+
+    BitArray::Index BitArray::Private::parallelPopcount() const {
+        BitArray::Index result;
+
+        const RankIndex* index = currentRankIndex.load(std::memory_order_acquire);
+        if (index != nullptr) {
+            result = index->numberSetBits;
+        } else {
+            ParallelWordRange            range(0, dataLength);
+            std::vector<BitArray::Index> chunkCounts(range.numberChunks());
+
+            range.run(
+                [this, &chunkCounts](unsigned chunkIndex, unsigned long startingUnit, unsigned long endingUnit) {
+                    chunkCounts[chunkIndex] = populationCount(data + startingUnit, endingUnit - startingUnit);
+                }
+            );
+
+            result = std::accumulate(chunkCounts.begin(), chunkCounts.end(), static_cast<BitArray::Index>(0));
+        }
+
+        return result;
+    }
+
+
+    BitArray::Index BitArray::Private::rank(BitArray::Index index) const {
+        BitArray::Index result;
+
+        if (index >= bitLength) {
+            result = popcount();
+        } else {
+            // Arrays that fit in a single block are counted directly so no index is built.
+
+            const RankIndex* rankIndex = dataLength > RankIndex::unitsPerBlock ? this->rankIndex() : nullptr;
+
+            unsigned long  unitIndex  = index / allocationUnitSize;
+            unsigned long  blockIndex = unitIndex / RankIndex::unitsPerBlock;
+            unsigned long  blockStart = blockIndex * RankIndex::unitsPerBlock;
+            unsigned       residue    = index % allocationUnitSize;
+
+            result = populationCount(data + blockStart, unitIndex - blockStart);
+            if (rankIndex != nullptr) {
+                result += rankIndex->blockRank(blockIndex);
+            }
+
+            if (residue != 0) {
+                result += numberOnes64(data[unitIndex] & ((static_cast<AllocationUnit>(1) << residue) - 1));
+            }
+        }
+
+        return result;
+    }
+
+
+    BitArray::Index BitArray::Private::select(BitArray::Index setBitNumber) const {
+        BitArray::Index result;
+
+        if (dataLength <= RankIndex::unitsPerBlock) {
+            // Arrays that fit in a single block are scanned directly so no index is built.
+
+            BitArray::Index remaining = setBitNumber;
+            unsigned long   unitIndex = 0;
+            while (unitIndex < dataLength && numberOnes64(data[unitIndex]) <= remaining) {
+                remaining -= numberOnes64(data[unitIndex]);
+                ++unitIndex;
+            }
+
+            if (unitIndex < dataLength) {
+                result = (
+                      unitIndex * allocationUnitSize
+                    + selectInUnit(data[unitIndex], static_cast<unsigned>(remaining))
+                );
+            } else {
+                result = BitArray::invalidIndex;
+            }
+        } else {
+            result = selectIndexed(setBitNumber);
+        }
+
+        return result;
+    }
+
+
+    BitArray::Index BitArray::Private::selectIndexed(BitArray::Index setBitNumber) const {
+        BitArray::Index result;
+
+        const RankIndex* rankIndex = this->rankIndex();
+        if (setBitNumber >= rankIndex->numberSetBits) {
+            result = BitArray::invalidIndex;
+        } else {
+            unsigned long sampleIndex     = setBitNumber / RankIndex::setBitsPerSample;
+            unsigned long numberBlocks    = rankIndex->blockRanks.size();
+            unsigned long lowBlockIndex   = rankIndex->selectSamples[sampleIndex];
+            unsigned long highBlockIndex  =   sampleIndex + 1 < rankIndex->selectSamples.size()
+                                            ? rankIndex->selectSamples[sampleIndex + 1]
+                                            : numberBlocks - 1;
+
+            // Locate the last block whose rank does not exceed the requested rank.
+
+            while (lowBlockIndex < highBlockIndex) {
+                unsigned long middleBlockIndex = lowBlockIndex + (highBlockIndex - lowBlockIndex + 1) / 2;
+                if (rankIndex->blockRank(middleBlockIndex) <= setBitNumber) {
+                    lowBlockIndex = middleBlockIndex;
+                } else {
+                    highBlockIndex = middleBlockIndex - 1;
+                }
+            }
+
+            BitArray::Index remaining = setBitNumber - rankIndex->blockRank(lowBlockIndex);
+            unsigned long   unitIndex = lowBlockIndex * RankIndex::unitsPerBlock;
+            unsigned        unitCount = numberOnes64(data[unitIndex]);
+            while (unitCount <= remaining) {
+                remaining -= unitCount;
+                ++unitIndex;
+                unitCount = numberOnes64(data[unitIndex]);
+            }
+
+            result = unitIndex * allocationUnitSize + selectInUnit(data[unitIndex], static_cast<unsigned>(remaining));
+        }
+
+        return result;
+    }
+
+
+    void BitArray::Private::combine(const BitArray::Private& other, BitArray::Private::Operation operation) {
+        prepareForUpdate();
+
+        if (other.bitLength > bitLength) {
+            resize(other.bitLength);
+        }
+
+        unsigned long commonDataLength = other.dataLength;
+
+        switch (operation) {
+            case Operation::AND: {
+                bitwiseAnd(data, data, other.data, commonDataLength);
+                if (dataLength > commonDataLength) {
+                    memset(data + commonDataLength, 0, (dataLength - commonDataLength) * (allocationUnitSize / 8));
+                }
+
+                break;
+            }
+
+            case Operation::OR: {
+                bitwiseOr(data, data, other.data, commonDataLength);
+                break;
+            }
+
+            case Operation::XOR: {
+                bitwiseXor(data, data, other.data, commonDataLength);
+                break;
+            }
+
+            case Operation::AND_NOT: {
+                bitwiseAndNot(data, data, other.data, commonDataLength);
+                break;
+            }
+
+            default: {
+                assert(false);
+                break;
+            }
+        }
+    }
+
+
+    void BitArray::Private::invert() {
+        prepareForUpdate();
+
+        if (dataLength > 0) {
+            bitwiseNot(data, data, dataLength);
+
+            unsigned residue = bitLength % allocationUnitSize;
+            if (residue != 0) {
+                data[dataLength - 1] &= (static_cast<AllocationUnit>(1) << residue) - 1;
+            }
+        }
+    }
+
+
+    BitArray::Private* BitArray::Private::slice(BitArray::Index startingIndex, BitArray::Index numberBits) const {
+        assert(startingIndex + numberBits <= bitLength);
+
+        Private* result = new Private(numberBits, false);
+        copyBitRange(result->data, 0, data, startingIndex, dataLength, numberBits);
+
+        return result;
+    }
+
+
+    BitArray::Private* BitArray::Private::extract(const BitArray::Private& mask) const {
+        Private* result = new Private(mask.popcount(), false);
+
+        unsigned long commonDataLength = std::min(dataLength, mask.dataLength);
+        if (commonDataLength > 0) {
+            extractBits(result->data, data, mask.data, commonDataLength);
+        }
+
+        return result;
+    }
+
+
+    BitArray::Private* BitArray::Private::deposit(const BitArray::Private& mask, const BitArray::Private& values) {
+        Private*        result       = new Private(mask.bitLength, false);
+        BitArray::Index requiredBits = mask.popcount();
+
+        if (requiredBits > 0) {
+            if (values.bitLength >= requiredBits) {
+                depositBits(result->data, values.data, mask.data, mask.dataLength);
+            } else {
+                Private paddedValues(values);
+                paddedValues.resize(requiredBits);
+
+                depositBits(result->data, paddedValues.data, mask.data, mask.dataLength);
+            }
+        }
+
+        return result;
+    }
+
+
+    void BitArray::Private::copyBits(
+            const BitArray::Private& source,
+            BitArray::Index          sourceIndex,
+            BitArray::Index          numberBits,
+            BitArray::Index          destinationIndex
+        ) {
+        assert(sourceIndex + numberBits <= source.bitLength);
+
+        if (numberBits > 0) {
+            prepareForUpdate();
+            resizeToFit(destinationIndex + numberBits - 1);
+
+            // The source is read after resizing in case the source is this instance and the buffer moved.
+
+            copyBitRange(data, destinationIndex, source.data, sourceIndex, source.dataLength, numberBits);
+        }
+    }
+
+
+    void BitArray::Private::shiftLeft(BitArray::Index numberBits) {
+        if (numberBits > 0 && bitLength > 0) {
+            prepareForUpdate();
+
+            if (numberBits >= bitLength) {
+                setBits(0, bitLength - 1, false);
+            } else {
+                copyBitRange(data, numberBits, data, 0, dataLength, bitLength - numberBits);
+                setBits(0, numberBits - 1, false);
+            }
+        }
+    }
+
+
+    void BitArray::Private::shiftRight(BitArray::Index numberBits) {
+        if (numberBits > 0 && bitLength > 0) {
+            prepareForUpdate();
+
+            if (numberBits >= bitLength) {
+                setBits(0, bitLength - 1, false);
+            } else {
+                copyBitRange(data, 0, data, numberBits, dataLength, bitLength - numberBits);
+                setBits(bitLength - numberBits, bitLength - 1, false);
+            }
+        }
+    }
+
+
+    void BitArray::Private::insertBits(BitArray::Index index, BitArray::Index numberBits, bool value) {
+        assert(index <= bitLength);
+
+        if (numberBits > 0) {
+            prepareForUpdate();
+
+            BitArray::Index bitsToMove = bitLength - index;
+            resize(bitLength + numberBits);
+
+            copyBitRange(data, index + numberBits, data, index, dataLength, bitsToMove);
+            setBits(index, index + numberBits - 1, value);
+        }
+    }
+
+
+    void BitArray::Private::removeBits(BitArray::Index index, BitArray::Index numberBits) {
+        assert(index + numberBits <= bitLength);
+
+        if (numberBits > 0) {
+            prepareForUpdate();
+
+            copyBitRange(data, index, data, index + numberBits, dataLength, bitLength - index - numberBits);
+            resize(bitLength - numberBits);
+        }
+    }
+
+
+    bool BitArray::Private::operator==(const BitArray::Private& other) const {
+        bool isEqual;
+
+        if (other.bitLength == bitLength) {
+            isEqual = (dataLength == 0 || memcmp(data, other.data, dataLength * (allocationUnitSize / 8)) == 0);
+        } else {
+            isEqual = false;
+        }
+
+        return isEqual;
+    }
+
+
+    bool BitArray::Private::isLessThan(const BitArray::Private& other) const {
+        bool          isLess           = false;
+        unsigned long commonDataLength = std::min(dataLength, other.dataLength);
+        unsigned long unitIndex        = 0;
+
+        if (data != other.data) {
+            while (unitIndex < commonDataLength && data[unitIndex] == other.data[unitIndex]) {
+                ++unitIndex;
+            }
+        } else {
+            unitIndex = commonDataLength;
+        }
+
+        if (unitIndex < commonDataLength) {
+            // Bits past the end of the shorter array are cleared so the first difference always orders correctly.
+
+            AllocationUnit difference = data[unitIndex] ^ other.data[unitIndex];
+            isLess = (data[unitIndex] & (difference & (0 - difference))) == 0;
+        } else {
+            isLess = bitLength < other.bitLength;
+        }
+
+        return isLess;
+    }
+
+
+    std::uint64_t BitArray::Private::contentHash() const {
+        std::uint64_t result = currentHash.load(std::memory_order_relaxed);
+
+        if (result == 0) {
+            result = hashWords(data, dataLength, bitLength);
+            if (result == 0) {
+                result = 1;
+            }
+
+            currentHash.store(result, std::memory_order_relaxed);
+        }
+
+        return result;
+    }
+
+
+    bool BitArray::Private::parallelEquals(const BitArray::Private& other) const {
+        bool isEqual;
+
+        if (other.bitLength != bitLength) {
+            isEqual = false;
+        } else if (dataLength == 0 || data == other.data) {
+            isEqual = true;
+        } else {
+            std::atomic<bool> mismatch(false);
+
+            ParallelWordRange(0, dataLength).run(
+                [this, &other, &mismatch](unsigned, unsigned long startingUnit, unsigned long endingUnit) {
+                    unsigned long unitIndex = startingUnit;
+                    while (unitIndex < endingUnit && !mismatch.load(std::memory_order_relaxed)) {
+                        unsigned long blockEnd   = std::min(unitIndex + searchBlockUnits, endingUnit);
+                        unsigned long blockBytes = (blockEnd - unitIndex) * (allocationUnitSize / 8);
+                        if (memcmp(data + unitIndex, other.data + unitIndex, blockBytes) != 0) {
+                            mismatch.store(true, std::memory_order_relaxed);
+                        }
+
+                        unitIndex = blockEnd;
+                    }
+                }
+            );
+
+            isEqual = !mismatch.load(std::memory_order_relaxed);
+        }
+
+        return isEqual;
+    }
+
+
+    bool BitArray::Private::operator!=(const BitArray::Private& other) const {
+        return !operator==(other);
+    }
+
+
+    unsigned long BitArray::Private::allocationDataSize(BitArray::Index bitLength) {
+        return bitLength / allocationUnitSize + (bitLength % allocationUnitSize != 0 ? 1 : 0);
+    }
+
+
+    unsigned long BitArray::Private::grownCapacity(unsigned long currentCapacity, unsigned long requiredCapacity) {
+        return std::max(requiredCapacity, 2 * currentCapacity);
+    }
+
+
+    unsigned BitArray::Private::selectInUnit(AllocationUnit unit, unsigned setBitNumber) {
+        unsigned offset    = 0;
+        unsigned byteCount = numberOnes32(static_cast<std::uint32_t>(unit & 0xFF));
+        while (byteCount <= setBitNumber) {
+            setBitNumber -= byteCount;
+            offset       += 8;
+            byteCount     = numberOnes32(static_cast<std::uint32_t>((unit >> offset) & 0xFF));
+        }
+
+        AllocationUnit remaining = unit >> offset;
+        while (setBitNumber > 0) {
+            remaining &= remaining - 1;
+            --setBitNumber;
+        }
+
+        return offset + static_cast<unsigned>(lsbLocation64(remaining));
+    }
+
+
+    void BitArray::Private::combineUnits(
+            BitArray::Private::AllocationUnit*       destination,
+            const BitArray::Private::AllocationUnit* first,
+            const BitArray::Private::AllocationUnit* second,
+            unsigned long                            numberUnits,
+            BitArray::Private::Operation             operation
+        ) {
+        switch (operation) {
+            case Operation::AND: {
+                bitwiseAnd(destination, first, second, numberUnits);
+                break;
+            }
+
+            case Operation::OR: {
+                bitwiseOr(destination, first, second, numberUnits);
+                break;
+            }
+
+            case Operation::XOR: {
+                bitwiseXor(destination, first, second, numberUnits);
+                break;
+            }
+
+            case Operation::AND_NOT: {
+                bitwiseAndNot(destination, first, second, numberUnits);
+                break;
+            }
+
+            default: {
+                assert(false);
+                break;
+            }
+        }
+    }
+
+
+    unsigned long BitArray::Private::parallelFirstUnitNotEqualTo(BitArray::Private::AllocationUnit fill) const {
+        std::atomic<unsigned long> firstUnit(dataLength);
+
+        ParallelWordRange(0, dataLength).run(
+            [this, fill, &firstUnit](unsigned, unsigned long startingUnit, unsigned long endingUnit) {
+                unsigned long unitIndex = startingUnit;
+
+                // Chunks stop searching once an earlier chunk has found a match.
+
+                while (unitIndex < endingUnit && unitIndex < firstUnit.load(std::memory_order_relaxed)) {
+                    unsigned long blockEnd = std::min(unitIndex + searchBlockUnits, endingUnit);
+                    while (unitIndex < blockEnd && data[unitIndex] == fill) {
+                        ++unitIndex;
+                    }
+
+                    if (unitIndex < blockEnd) {
+                        unsigned long currentFirst = firstUnit.load(std::memory_order_relaxed);
+                        while (unitIndex < currentFirst && !firstUnit.compare_exchange_weak(currentFirst, unitIndex)) {}
+
+                        unitIndex = endingUnit;
+                    }
+                }
+            }
+        );
+
+        return firstUnit.load(std::memory_order_relaxed);
+    }
+
+
+    unsigned long BitArray::Private::parallelLastUnitNotEqualTo(
+            BitArray::Private::AllocationUnit fill,
+            unsigned long                     endingUnit
+        ) const {
+        std::atomic<unsigned long> lastUnitEnd(0);
+
+        ParallelWordRange(0, endingUnit).run(
+            [this, fill, &lastUnitEnd](unsigned, unsigned long startingUnit, unsigned long endingUnit) {
+                unsigned long unitEnd = endingUnit;
+
+                // Chunks stop searching once a later chunk has found a match.
+
+                while (unitEnd > startingUnit && unitEnd > lastUnitEnd.load(std::memory_order_relaxed)) {
+                    unsigned long blockStart = (
+                          unitEnd - startingUnit > searchBlockUnits
+                        ? unitEnd - searchBlockUnits
+                        : startingUnit
+                    );
+
+                    while (unitEnd > blockStart && data[unitEnd - 1] == fill) {
+                        --unitEnd;
+                    }
+
+                    if (unitEnd > blockStart) {
+                        unsigned long currentEnd = lastUnitEnd.load(std::memory_order_relaxed);
+                        while (unitEnd > currentEnd && !lastUnitEnd.compare_exchange_weak(currentEnd, unitEnd)) {}
+
+                        unitEnd = startingUnit;
+                    }
+                }
+            }
+        );
+
+        return lastUnitEnd.load(std::memory_order_relaxed);
+    }
+
+
+    BitArray::Index BitArray::Private::findRun(
+            BitArray::Index                   length,
+            BitArray::Index                   startingIndex,
+            BitArray::Private::AllocationUnit pattern
+        ) const {
+        assert(length > 0);
+
+        BitArray::Index result = BitArray::invalidIndex;
+
+        if (startingIndex < bitLength && length <= bitLength - startingIndex) {
+            unsigned long   unitIndex = startingIndex / allocationUnitSize;
+            unsigned long   lastUnit  = (bitLength - 1) / allocationUnitSize;
+            unsigned        residue   = bitLength % allocationUnitSize;
+            AllocationUnit  firstMask = allOnes << (startingIndex % allocationUnitSize);
+            AllocationUnit  lastMask  = residue != 0 ? (static_cast<AllocationUnit>(1) << residue) - 1 : allOnes;
+            BitArray::Index runStart  = 0;
+            BitArray::Index runLength = 0;
+
+            while (result == BitArray::invalidIndex && unitIndex <= lastUnit) {
+                AllocationUnit unit = (data[unitIndex] ^ pattern) & firstMask;
+                if (unitIndex == lastUnit) {
+                    unit &= lastMask;
+                }
+
+                firstMask = allOnes;
+
+                bool extended = false;
+                if (runLength > 0) {
+                    // Try to complete the run carried over from the preceding allocation units.
+
+                    unsigned trailingOnes = unit == allOnes ? allocationUnitSize : lsbLocation64(~unit);
+                    if (runLength + trailingOnes >= length) {
+                        result = runStart;
+                    } else if (unit == allOnes) {
+                        runLength += allocationUnitSize;
+                        extended   = true;
+                    } else {
+                        runLength = 0;
+                    }
+                }
+
+                if (result == BitArray::invalidIndex && !extended && unit != 0) {
+                    if (length <= allocationUnitSize) {
+                        // After this loop, bit i of matches is set if bits i through i + length - 1 are all set.
+
+                        AllocationUnit  matches = unit;
+                        BitArray::Index covered = 1;
+                        while (covered < length) {
+                            BitArray::Index shift = std::min(covered, length - covered);
+                            matches &= matches >> shift;
+                            covered += shift;
+                        }
+
+                        if (matches != 0) {
+                            result = allocationUnitSize * unitIndex + lsbLocation64(matches);
+                        }
+                    }
+
+                    if (result == BitArray::invalidIndex) {
+                        unsigned leadingOnes = unit == allOnes ? allocationUnitSize : 63 - msbLocation64(~unit);
+                        if (leadingOnes > 0) {
+                            runStart  = allocationUnitSize * (unitIndex + 1) - leadingOnes;
+                            runLength = leadingOnes;
+                        }
+                    }
+                }
+
+                ++unitIndex;
+            }
+        }
+
+        return result;
+    }
+
+
+    void BitArray::Private::copyBitRange(
+            BitArray::Private::AllocationUnit*       destination,
+            BitArray::Index                          destinationIndex,
+            const BitArray::Private::AllocationUnit* source,
+            BitArray::Index                          sourceIndex,
+            unsigned long                            sourceLength,
+            BitArray::Index                          numberBits
+        ) {
+        if (numberBits > 0) {
+            BitArray::Index lastIndex = destinationIndex + numberBits - 1;
+            unsigned long   firstUnit = destinationIndex / allocationUnitSize;
+            unsigned long   lastUnit  = lastIndex / allocationUnitSize;
+
+            // Walk backwards when moving bits up within a buffer so that we never read a unit we've already
+            // written.
+
+            bool          backwards = (destination == source && destinationIndex > sourceIndex);
+            unsigned long count     = lastUnit - firstUnit + 1;
+
+            for (unsigned long i=0 ; i<count ; ++i) {
+                unsigned long   unitIndex = backwards ? lastUnit - i : firstUnit + i;
+                BitArray::Index unitBase  = unitIndex * allocationUnitSize;
+
+                // Gather the 64 source bits that line up with this destination unit.  Source bit positions before
+                // the start of the buffer can only occur for the first unit and are masked off below.
+
+                AllocationUnit value;
+                if (unitBase + sourceIndex >= destinationIndex) {
+                    BitArray::Index sourceBit    = unitBase + sourceIndex - destinationIndex;
+                    unsigned long   sourceUnit   = sourceBit / allocationUnitSize;
+                    unsigned        sourceOffset = sourceBit % allocationUnitSize;
+
+                    value = sourceUnit < sourceLength ? source[sourceUnit] >> sourceOffset : 0;
+                    if (sourceOffset != 0 && sourceUnit + 1 < sourceLength) {
+                        value |= source[sourceUnit + 1] << (allocationUnitSize - sourceOffset);
+                    }
+                } else {
+                    unsigned shift = static_cast<unsigned>(destinationIndex - sourceIndex - unitBase);
+                    value = source[0] << shift;
+                }
+
+                AllocationUnit mask = allOnes;
+                if (unitIndex == firstUnit) {
+                    mask &= allOnes << (destinationIndex % allocationUnitSize);
+                }
+
+                if (unitIndex == lastUnit) {
+                    mask &= allOnes >> (allocationUnitSize - 1 - lastIndex % allocationUnitSize);
+                }
+
+                destination[unitIndex] = (destination[unitIndex] & ~mask) | (value & mask);
+            }
+        }
+    }
+
+
+    const BitArray::Private::RankIndex* BitArray::Private::rankIndex() const {
+        RankIndex* result = currentRankIndex.load(std::memory_order_acquire);
+
+        if (result == nullptr) {
+            unsigned long numberBlocks = (dataLength + RankIndex::unitsPerBlock - 1) / RankIndex::unitsPerBlock;
+
+            RankIndex* newIndex = new RankIndex;
+            newIndex->superblockRanks.reserve(numberBlocks / RankIndex::blocksPerSuperblock + 1);
+            newIndex->blockRanks.reserve(numberBlocks);
+
+            BitArray::Index total          = 0;
+            BitArray::Index superblockBase = 0;
+            BitArray::Index nextSample     = 0;
+            for (unsigned long blockIndex=0 ; blockIndex<numberBlocks ; ++blockIndex) {
+                if (blockIndex % RankIndex::blocksPerSuperblock == 0) {
+                    newIndex->superblockRanks.push_back(total);
+                    superblockBase = total;
+                }
+
+                newIndex->blockRanks.push_back(static_cast<std::uint16_t>(total - superblockBase));
+
+                unsigned long blockStart = blockIndex * RankIndex::unitsPerBlock;
+                unsigned long blockUnits = std::min(
+                    dataLength - blockStart,
+                    static_cast<unsigned long>(RankIndex::unitsPerBlock)
+                );
+
+                total += populationCount(data + blockStart, blockUnits);
+                while (nextSample < total) {
+                    newIndex->selectSamples.push_back(blockIndex);
+                    nextSample += RankIndex::setBitsPerSample;
+                }
+            }
+
+            newIndex->numberSetBits = total;
+
+            // Another thread sharing this instance may have built the index concurrently.  If so, we use theirs.
+
+            if (currentRankIndex.compare_exchange_strong(result, newIndex, std::memory_order_acq_rel)) {
+                result = newIndex;
+            } else {
+                delete newIndex;
+            }
+        }
+
+        return result;
+    }
+
+
+    void BitArray::Private::invalidateCaches() {
+        RankIndex* index = currentRankIndex.load(std::memory_order_relaxed);
+        if (index != nullptr) {
+            currentRankIndex.store(nullptr, std::memory_order_relaxed);
+            delete index;
+        }
+
+        currentHash.store(0, std::memory_order_relaxed);
+    }
+
+
+    bool BitArray::Private::startsFill(unsigned long unitIndex) const {
+        AllocationUnit unit = data[unitIndex];
+        return (
+               (unit == 0 || unit == allOnes)
+            && unitIndex + minimumFillWords <= dataLength
+            && std::all_of(
+                   data + unitIndex + 1,
+                   data + unitIndex + minimumFillWords,
+                   [unit](AllocationUnit other) {
+                       return other == unit;
+                   }
+               )
+        );
+    }
+
+
+    void BitArray::Private::prepareForUpdate() {
+        invalidateCaches();
+
+        if (!ownsData) {
+            reallocate(dataLength);
+        }
+    }
+
+
+    void BitArray::Private::releaseData() {
+        if (borrowsData) {
+            borrowsData = false;
+        } else if (ownsData) {
+            if (data != nullptr) {
+                allocator->release(data, capacityLength);
+            }
+        } else if (mappedFile != nullptr) {
+            mappedFile->unmap(reinterpret_cast<uchar*>(data));
+            delete mappedFile;
+
+            mappedFile = nullptr;
+        }
+
+        data     = nullptr;
+        ownsData = true;
+    }
+
+
+    void BitArray::Private::resizeToFit(BitArray::Index index) {
+        if (index >= bitLength) {
             resize(index + 1);
         }
     }
+
+
+    void BitArray::Private::reallocate(unsigned long newCapacity) {
+        assert(newCapacity >= dataLength);
+
+        AllocationUnit* newData = nullptr;
+        if (newCapacity > 0) {
+            newData = allocator->allocate(newCapacity);
+
+            if (dataLength > 0) {
+                memcpy(newData, data, dataLength * (allocationUnitSize / 8));
+            }
+
+            memset(newData + dataLength, 0, (newCapacity - dataLength) * (allocationUnitSize / 8));
+        }
+
+        releaseData();
+
+        data           = newData;
+        capacityLength = newCapacity;
+    }
+}
+
+
+namespace Util {
+    BitArray::Reader::Reader(const BitArray& array) {
+        if (array.impl.constData() != nullptr) {
+            current = array.impl.constData();
+        } else {
+            current = new(localStorage) Private(
+                const_cast<std::uint64_t*>(array.inlineData),
+                BitArray::inlineWords,
+                array.inlineLength,
+                array.currentAllocator
+            );
+        }
+    }
+
+
+    BitArray::Reader::~Reader() {
+        if (current == reinterpret_cast<const Private*>(localStorage)) {
+            current->~Private();
+        }
+    }
+
+
+    const BitArray::Private* BitArray::Reader::operator->() const {
+        return current;
+    }
+
+
+    const BitArray::Private& BitArray::Reader::operator*() const {
+        return *current;
+    }
+}
+
+
+namespace Util {
+    BitArray::Writer::Writer(
+            BitArray& array
+        ):array(
+            array
+        ) {
+        if (array.impl.constData() != nullptr) {
+            current = array.impl.data();
+        } else {
+            current = new(localStorage) Private(
+                array.inlineData,
+                BitArray::inlineWords,
+                array.inlineLength,
+                array.currentAllocator
+            );
+        }
+    }
+
+
+    BitArray::Writer::~Writer() {
+        if (current == reinterpret_cast<Private*>(localStorage)) {
+            if (current->isBorrowed()) {
+                array.inlineLength = current->size();
+            } else {
+                // The array outgrew the inline buffer.
+
+                array.impl         = new Private(std::move(*current));
+                array.inlineLength = 0;
+
+                std::fill(array.inlineData, array.inlineData + BitArray::inlineWords, 0);
+            }
+
+            current->~Private();
+        }
+    }
+
+
+    BitArray::Private* BitArray::Writer::operator->() const {
+        return current;
+    }
+
+
+    BitArray::Private& BitArray::Writer::operator*() const {
+        return *current;
+    }
 }
@@ -34,16 +34,59 @@
 #include <QSharedData>
 
 #include <cstdint>
+#include <atomic>
+#include <functional>
 
 #include "util_common.h"
+#include "util_bit_array_allocator.h"
 #include "util_bit_array.h"
 
+class QFile;
+class QString;
+
 namespace Util {
     /**
      * Private implementation class that can be used to maintain a searchable array of bits.
      */
     class UTIL_PUBLIC_API BitArray::Private:public QSharedData {
         public:
+            /**
+             * Type of function used to write encoded data.  The function should return true if every byte was
+             * written.
+             */
+            typedef std::function<bool(const char* buffer, unsigned long length)> WriteFunction;
+
+            /**
+             * Type of function used to read encoded data.  The function should return true if every requested byte
+             * was read.
+             */
+            typedef std::function<bool(char* buffer, unsigned long length)> ReadFunction;
+
+            /**
+             * Enumeration of supported bitwise operations between arrays.
+             */
+            enum class Operation {
+                /**
+                 * Indicates a bitwise AND operation.
+                 */
+                AND,
+
+                /**
+                 * Indicates a bitwise OR operation.
+                 */
+                OR,
+
+                /**
+                 * Indicates a bitwise exclusive OR operation.
+                 */
+                XOR,
+
+                /**
+                 * Indicates a bitwise AND operation against the complement of the second array.
+                 */
+                AND_NOT
+            };
+
             /**
              * Default constructor.
              */
@@ -55,8 +98,14 @@ namespace Util {
              * \param[in] numberBits The desired initial length of the array, in bits.
              *
              * \param[in] value      The value to assign to all the bits in the array.
+             *
+             * \param[in] allocator  The allocator used to obtain word storage.
              */
-            Private(BitArray::Index numberBits, bool value = false);
+            Private(
+                BitArray::Index    numberBits,
+                bool               value = false,
+                BitArrayAllocator* allocator = BitArrayAllocator::standard()
+            );
 
             /**
              * Constructor, constructs an array of bits from an array of bytes.
@@ -83,8 +132,152 @@ namespace Util {
              */
             Private(const BitArray::Private& other);
 
+            /**
+             * Constructor, creates an array holding the result of a bitwise operation between two arrays.  The
+             * shorter array is treated as if it were extended with cleared bits.
+             *
+             * \param[in] first     The first array to be combined.
+             *
+             * \param[in] second    The second array to be combined.
+             *
+             * \param[in] operation The operation to be performed.
+             *
+             * \param[in] parallel  If true, the operation is split across the global thread pool.
+             */
+            Private(
+                const BitArray::Private& first,
+                const BitArray::Private& second,
+                Operation                operation,
+                bool                     parallel = false
+            );
+
+            /**
+             * Constructor, creates an array that borrows a fixed size buffer owned by the caller.  The buffer is
+             * updated in place until the array outgrows it, at which point the contents are moved to a newly
+             * allocated buffer and the borrowed buffer is left untouched.
+             *
+             * \param[in] buffer       The buffer to borrow.  Bits past the array length must be cleared.
+             *
+             * \param[in] bufferLength The buffer length, in allocation units.
+             *
+             * \param[in] numberBits   The current array length, in bits.
+             *
+             * \param[in] allocator    The allocator used to obtain storage once the array outgrows the buffer.
+             */
+            Private(
+                std::uint64_t*     buffer,
+                unsigned long      bufferLength,
+                BitArray::Index    numberBits,
+                BitArrayAllocator* allocator = BitArrayAllocator::standard()
+            );
+
+            /**
+             * Move constructor.  The other instance is left empty.
+             *
+             * \param[in] other The instance to be moved.  The instance must not be borrowing a buffer.
+             */
+            Private(BitArray::Private&& other);
+
             ~Private();
 
+            /**
+             * Method that packs an array of boolean values into words, LSB first.
+             *
+             * \param[in] destination The destination words.  Every word needed to hold the bits is written.
+             *
+             * \param[in] rawData     The boolean values to be packed.
+             *
+             * \param[in] numberBits  The number of values to be packed.
+             */
+            static void packBits(std::uint64_t* destination, const bool* rawData, BitArray::Index numberBits);
+
+            /**
+             * Method that copies raw bits into words.  Bits past the requested length are cleared.
+             *
+             * \param[in] destination The destination words.  Every word needed to hold the bits is written.
+             *
+             * \param[in] rawData     The raw data to be copied.  Bits are ordered LSB first.
+             *
+             * \param[in] numberBits  The number of bits to be copied.
+             */
+            static void packBits(std::uint64_t* destination, const void* rawData, BitArray::Index numberBits);
+
+            /**
+             * Method that creates an instance that references external memory rather than a copy of it.  The
+             * instance is converted to an owned copy the first time it's modified.  If any bits past the end of the
+             * array are set in the external memory, an owned copy is made immediately.
+             *
+             * \param[in] rawData    The external memory.  The memory must be aligned to a 64-bit boundary.
+             *
+             * \param[in] numberBits The array length, in bits.
+             *
+             * \param[in] mappedFile An optional file that the external memory was mapped from.  The instance takes
+             *                       ownership of the file and will unmap and close it when the memory is released.
+             *
+             * \return Returns a pointer to the newly created instance.
+             */
+            static Private* createView(const std::uint64_t* rawData, BitArray::Index numberBits, QFile* mappedFile);
+
+            /**
+             * Method that creates an instance by memory mapping a file written by
+             * \ref Util::BitArray::Private::saveFile.  The file contents are read if mapping is unavailable.
+             *
+             * \param[in] filename The name of the file to map.
+             *
+             * \return Returns a pointer to the newly created instance.  A null pointer is returned if the file could
+             *         not be opened or is not a valid bit array file.
+             */
+            static Private* mapFile(const QString& filename);
+
+            /**
+             * Method you can use to save the array contents to a file.
+             *
+             * \param[in] filename The name of the file to write.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool saveFile(const QString& filename) const;
+
+            /**
+             * Method you can use to determine if this instance references external memory.
+             *
+             * \return Returns true if this instance references external memory.  Returns false if this instance owns
+             *         its storage.
+             */
+            bool isView() const;
+
+            /**
+             * Method you can use to determine if this instance is still using a borrowed buffer.
+             *
+             * \return Returns true if the array contents are held in the buffer supplied at construction.  Returns
+             *         false if the contents are held in storage managed by this instance.
+             */
+            bool isBorrowed() const;
+
+            /**
+             * Method you can use to encode the array contents.  The array is written as a header followed by a
+             * series of records, each holding a run of all-zero words, a run of all-one words or a bounded block of
+             * literal words.  No intermediate copy of the array is made.
+             *
+             * \param[in] writeFunction The function used to write the encoded data.
+             *
+             * \param[in] compression   The compression mode to use.
+             *
+             * \return Returns true on success.  Returns false if the write function failed.
+             */
+            bool encode(const WriteFunction& writeFunction, BitArray::Compression compression) const;
+
+            /**
+             * Method that creates an instance from data written by \ref Util::BitArray::Private::encode.  Words are
+             * read directly into the new instance's storage.
+             *
+             * \param[in] readFunction The function used to read the encoded data.
+             *
+             * \return Returns a pointer to the newly created instance.  A null pointer is returned if the data could
+             *         not be read or is invalid.
+             */
+            static Private* decode(const ReadFunction& readFunction);
+
             /**
              * Method you can use to determine the size of the array, in bits.
              *
@@ -93,17 +286,68 @@ namespace Util {
             Index size() const;
 
             /**
-             * Method you can use to clear the array contents.
+             * Method you can use to determine the number of bits that can be stored without reallocating the
+             * underlying storage.
+             *
+             * \return Returns the current capacity, in bits.
+             */
+            Index capacity() const;
+
+            /**
+             * Method you can use to access the underlying words.
+             *
+             * \return Returns a pointer to the underlying words.  A null pointer may be returned for empty arrays.
+             */
+            const std::uint64_t* constData() const;
+
+            /**
+             * Method you can use to access the underlying words for update.  Cached acceleration structures are
+             * discarded and any external memory is replaced with an owned copy.
+             *
+             * \return Returns a pointer to the underlying words.  A null pointer may be returned for empty arrays.
+             */
+            std::uint64_t* mutableData();
+
+            /**
+             * Method you can use to determine the allocator used to obtain word storage.
+             *
+             * \return Returns the allocator used by this instance.
+             */
+            BitArrayAllocator* storageAllocator() const;
+
+            /**
+             * Method you can use to determine the number of words holding the array contents.
+             *
+             * \return Returns the number of words in use.
+             */
+            unsigned long wordCount() const;
+
+            /**
+             * Method you can use to clear the array contents.  The underlying storage is released.
              */
             void clear();
 
             /**
-             * Method you can use to resize the bit array.
+             * Method you can use to resize the bit array.  Storage grows geometrically so repeated small increases in
+             * length are amortized constant time.  Storage is not released when the array shrinks.
              *
              * \param[in] newLength The new bit array length, in bits.
              */
             void resize(Index newLength);
 
+            /**
+             * Method you can use to preallocate storage for a specified number of bits.  This method will never
+             * reduce the capacity or change the length of the array.
+             *
+             * \param[in] numberBits The number of bits to reserve space for.
+             */
+            void reserve(Index numberBits);
+
+            /**
+             * Method you can use to release any storage not needed to hold the current contents of the array.
+             */
+            void shrinkToFit();
+
             /**
              * Method you can use to set a single bit.
              *
@@ -146,6 +390,18 @@ namespace Util {
              */
             void clearBits(Index startingIndex, Index endingIndex, bool nowCleared = true);
 
+            /**
+             * Method you can use to set a range of bits, splitting the work across the global thread pool.  The
+             * array will be extended, if needed.
+             *
+             * \param[in] startingIndex The starting index of the range of bits to set.  Value is inclusive.
+             *
+             * \param[in] endingIndex   The ending index of the range of bits to set.  Value is inclusive.
+             *
+             * \param[in] nowSet        If true, bits will be set.  if false, bits will be cleared.
+             */
+            void parallelSetBits(Index startingIndex, Index endingIndex, bool nowSet = true);
+
             /**
              * Method you can use to determine if a bit is set.
              *
@@ -180,6 +436,24 @@ namespace Util {
              */
             Index firstClearedBit() const;
 
+            /**
+             * Method you can use to locate the first set bit in the array, splitting the search across the global
+             * thread pool.
+             *
+             * \return Returns the index of the first set bit in the array.  A value of
+             *         \ref Util::BitArray::invalidIndex is returned if no set bits exist in the array.
+             */
+            Index parallelFirstSetBit() const;
+
+            /**
+             * Method you can use to locate the first cleared bit in the array, splitting the search across the global
+             * thread pool.
+             *
+             * \return Returns the index of the first cleared bit in the array.  A value of
+             *         \ref Util::BitArray::invalidIndex is returned if no cleared bits exist in the array.
+             */
+            Index parallelFirstClearedBit() const;
+
             /**
              * Method you can use to locate the first set bit in the array at or after a specific index.
              *
@@ -200,6 +474,225 @@ namespace Util {
              */
             Index firstClearedBit(Index startingIndex) const;
 
+            /**
+             * Method you can use to locate the last set bit in the array.
+             *
+             * \return Returns the index of the last set bit in the array.  A value of
+             *         \ref Util::BitArray::invalidIndex is returned if no set bits exist in the array.
+             */
+            Index lastSetBit() const;
+
+            /**
+             * Method you can use to locate the last cleared bit in the array.
+             *
+             * \return Returns the index of the last cleared bit in the array.  A value of
+             *         \ref Util::BitArray::invalidIndex is returned if no cleared bits exist in the array.
+             */
+            Index lastClearedBit() const;
+
+            /**
+             * Method you can use to locate the last set bit in the array, splitting the search across the global
+             * thread pool.
+             *
+             * \return Returns the index of the last set bit in the array.  A value of
+             *         \ref Util::BitArray::invalidIndex is returned if no set bits exist in the array.
+             */
+            Index parallelLastSetBit() const;
+
+            /**
+             * Method you can use to locate the last cleared bit in the array, splitting the search across the global
+             * thread pool.
+             *
+             * \return Returns the index of the last cleared bit in the array.  A value of
+             *         \ref Util::BitArray::invalidIndex is returned if no cleared bits exist in the array.
+             */
+            Index parallelLastClearedBit() const;
+
+            /**
+             * Method you can use to locate the last set bit in the array at or before a specific index.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.  Indexes past the end of the
+             *                          array search from the last bit.
+             *
+             * \return Returns the index of the set bit.  A value of \ref Util::BitArray::invalidIndex is returned if
+             *         no set bits exist at or before the starting index.
+             */
+            Index previousSetBit(Index startingIndex) const;
+
+            /**
+             * Method you can use to locate the last cleared bit in the array at or before a specific index.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.  Indexes past the end of the
+             *                          array search from the last bit.
+             *
+             * \return Returns the index of the cleared bit.  A value of \ref Util::BitArray::invalidIndex is returned
+             *         if no cleared bits exist at or before the starting index.
+             */
+            Index previousClearedBit(Index startingIndex) const;
+
+            /**
+             * Method you can use to locate the first run of consecutive cleared bits at or after a specific index.
+             *
+             * \param[in] length        The required run length, in bits.  The value must be greater than zero.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.
+             *
+             * \return Returns the index of the first bit in the run.  A value of \ref Util::BitArray::invalidIndex
+             *         is returned if no run of the required length exists.
+             */
+            Index findClearRun(Index length, Index startingIndex) const;
+
+            /**
+             * Method you can use to locate the first run of consecutive set bits at or after a specific index.
+             *
+             * \param[in] length        The required run length, in bits.  The value must be greater than zero.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.
+             *
+             * \return Returns the index of the first bit in the run.  A value of \ref Util::BitArray::invalidIndex
+             *         is returned if no run of the required length exists.
+             */
+            Index findSetRun(Index length, Index startingIndex) const;
+
+            /**
+             * Method you can use to determine the number of set bits in the array.
+             *
+             * \return Returns the number of set bits.
+             */
+            Index popcount() const;
+
+            /**
+             * Method you can use to determine the number of set bits in the array, splitting the count across the
+             * global thread pool.
+             *
+             * \return Returns the number of set bits.
+             */
+            Index parallelPopcount() const;
+
+            /**
+             * Method you can use to determine the number of set bits before a given position.  The rank/select index
+             * is built on first use.
+             *
+             * \param[in] index The bit position.  Values beyond the end of the array are clamped to the array length.
+             *
+             * \return Returns the number of set bits in the range [0, index).
+             */
+            Index rank(Index index) const;
+
+            /**
+             * Method you can use to locate a set bit by its rank.  The rank/select index is built on first use.
+             *
+             * \param[in] setBitNumber The zero based rank of the desired set bit.
+             *
+             * \return Returns the index of the requested set bit.  A value of \ref Util::BitArray::invalidIndex is
+             *         returned if the array contains too few set bits.
+             */
+            Index select(Index setBitNumber) const;
+
+            /**
+             * Method you can use to combine this array with another array, in place.  The array will be extended to
+             * the length of the other array, if needed.  The shorter array is treated as if it were extended with
+             * cleared bits.
+             *
+             * \param[in] other     The array to combine with this array.
+             *
+             * \param[in] operation The operation to be performed.
+             */
+            void combine(const BitArray::Private& other, Operation operation);
+
+            /**
+             * Method you can use to invert every bit in the array, in place.
+             */
+            void invert();
+
+            /**
+             * Method that creates a new instance holding a range of bits from this instance.
+             *
+             * \param[in] startingIndex The zero based index of the first bit to be copied.
+             *
+             * \param[in] numberBits    The number of bits to be copied.  The range must be within the array.
+             *
+             * \return Returns a pointer to the newly created instance.
+             */
+            Private* slice(BitArray::Index startingIndex, BitArray::Index numberBits) const;
+
+            /**
+             * Method that creates a new instance holding the bits of this instance selected by a mask, packed in
+             * order.  Mask bits past the end of this instance select cleared bits.
+             *
+             * \param[in] mask The mask selecting the bits to keep.
+             *
+             * \return Returns a pointer to the newly created instance.  The length equals the number of set bits in
+             *         the mask.
+             */
+            Private* extract(const BitArray::Private& mask) const;
+
+            /**
+             * Method that creates a new instance by scattering consecutive bits from a value array to the positions
+             * selected by a mask.
+             *
+             * \param[in] mask   The mask selecting the destination positions.
+             *
+             * \param[in] values The values to scatter.  Missing values are treated as cleared bits.
+             *
+             * \return Returns a pointer to the newly created instance.  The length equals the mask length.
+             */
+            static Private* deposit(const BitArray::Private& mask, const BitArray::Private& values);
+
+            /**
+             * Method you can use to copy a range of bits from another instance into this instance.  The array is
+             * extended, if needed.  The source may be this instance, in which case overlapping ranges are handled
+             * correctly.
+             *
+             * \param[in] source           The instance to copy bits from.
+             *
+             * \param[in] sourceIndex      The zero based index of the first bit to be copied.
+             *
+             * \param[in] numberBits       The number of bits to be copied.
+             *
+             * \param[in] destinationIndex The zero based index in this instance to receive the first bit.
+             */
+            void copyBits(
+                const Private&  source,
+                BitArray::Index sourceIndex,
+                BitArray::Index numberBits,
+                BitArray::Index destinationIndex
+            );
+
+            /**
+             * Method you can use to move every bit towards higher indexes.  The array length is unchanged.
+             *
+             * \param[in] numberBits The number of positions to shift by.
+             */
+            void shiftLeft(BitArray::Index numberBits);
+
+            /**
+             * Method you can use to move every bit towards lower indexes.  The array length is unchanged.
+             *
+             * \param[in] numberBits The number of positions to shift by.
+             */
+            void shiftRight(BitArray::Index numberBits);
+
+            /**
+             * Method you can use to insert a range of bits.  The array grows by the number of bits inserted.
+             *
+             * \param[in] index      The zero based index where the new bits should be inserted.
+             *
+             * \param[in] numberBits The number of bits to insert.
+             *
+             * \param[in] value      The value of the inserted bits.
+             */
+            void insertBits(BitArray::Index index, BitArray::Index numberBits, bool value);
+
+            /**
+             * Method you can use to remove a range of bits.  The array shrinks by the number of bits removed.
+             *
+             * \param[in] index      The zero based index of the first bit to be removed.
+             *
+             * \param[in] numberBits The number of bits to remove.
+             */
+            void removeBits(BitArray::Index index, BitArray::Index numberBits);
+
             /**
              * Comparison operator.
              *
@@ -209,6 +702,15 @@ namespace Util {
              */
             bool operator==(const BitArray::Private& other) const;
 
+            /**
+             * Method you can use to compare two arrays, splitting the comparison across the global thread pool.
+             *
+             * \param[in] other The instance to be compared against.
+             *
+             * \return Returns true if the instances are equal.  Returns false if the instances are different.
+             */
+            bool parallelEquals(const BitArray::Private& other) const;
+
             /**
              * Comparison operator.
              *
@@ -218,7 +720,31 @@ namespace Util {
              */
             bool operator!=(const BitArray::Private& other) const;
 
+            /**
+             * Method you can use to order arrays lexicographically by bit, starting at bit zero.  An array that is a
+             * proper prefix of another array orders first.
+             *
+             * \param[in] other The instance to be compared against.
+             *
+             * \return Returns true if this array orders before the other array.  Returns false otherwise.
+             */
+            bool isLessThan(const BitArray::Private& other) const;
+
+            /**
+             * Method you can use to obtain a 64-bit hash of the array contents.  The hash is calculated on first use
+             * and cached until the array is modified.
+             *
+             * \return Returns a hash of the array contents and length.
+             */
+            std::uint64_t contentHash() const;
+
         private:
+            /**
+             * Rank/select acceleration structure.  The structure is built lazily and discarded whenever the array is
+             * modified.
+             */
+            struct RankIndex;
+
             /**
              * The allocation unit used by the bit array.
              */
@@ -234,6 +760,85 @@ namespace Util {
              */
             static constexpr AllocationUnit allOnes = static_cast<AllocationUnit>(-1);
 
+            /**
+             * The magic value at the start of every bit array file.
+             */
+            static constexpr char fileMagic[8] = { 'I', 'N', 'E', 'B', 'I', 'T', 'S', '\0' };
+
+            /**
+             * The current bit array file format version.
+             */
+            static constexpr std::uint32_t fileVersion = 1;
+
+            /**
+             * The bit array file header size, in bytes.  The header holds the magic value, the 32-bit version, 32
+             * reserved bits and the 64-bit array length, all little endian.  Array words follow the header.
+             */
+            static constexpr unsigned fileHeaderSize = 24;
+
+            /**
+             * Enumeration of record types in an encoded stream.
+             */
+            enum class RecordType {
+                /**
+                 * Indicates a run of words with every bit cleared.
+                 */
+                ZERO_FILL = 0,
+
+                /**
+                 * Indicates a run of words with every bit set.
+                 */
+                ONES_FILL = 1,
+
+                /**
+                 * Indicates a block of literal words that follow the record header.
+                 */
+                LITERAL = 2
+            };
+
+            /**
+             * The magic value at the start of every encoded stream.
+             */
+            static constexpr char streamMagic[4] = { 'I', 'B', 'A', 'S' };
+
+            /**
+             * The current encoded stream format version.
+             */
+            static constexpr std::uint16_t streamVersion = 1;
+
+            /**
+             * The encoded stream header size, in bytes.  The header holds the magic value, the 16-bit version, the
+             * 16-bit compression mode and the 64-bit array length, all little endian.
+             */
+            static constexpr unsigned streamHeaderSize = 16;
+
+            /**
+             * The largest number of words held in a single literal record.  This value bounds the size of any
+             * intermediate buffer used while encoding.
+             */
+            static constexpr unsigned long maximumLiteralWords = 8192;
+
+            /**
+             * The largest number of words held in a single fill record.  Each record header holds the record type in
+             * the upper two bits and the word count in the lower 30 bits.
+             */
+            static constexpr unsigned long maximumFillWords = (1UL << 30) - 1;
+
+            /**
+             * The shortest run of identical zero or one words that is encoded as a fill record.
+             */
+            static constexpr unsigned long minimumFillWords = 2;
+
+            /**
+             * Method that determines if a fill record should start at a given word.
+             *
+             * \param[in] unitIndex The index of the word to check.
+             *
+             * \return Returns true if a run of at least \ref Util::BitArray::Private::minimumFillWords identical zero
+             *         or one words starts at the word.
+             */
+            bool startsFill(unsigned long unitIndex) const;
+
             /**
              * Method that calculates the data length required to store a specified number of bits.
              *
@@ -243,6 +848,158 @@ namespace Util {
              */
             static unsigned long allocationDataSize(BitArray::Index bitLength);
 
+            /**
+             * Method that calculates the new capacity to use when the array must grow.  Capacity is increased
+             * geometrically so that appending bits one at a time is amortized constant time.
+             *
+             * \param[in] currentCapacity  The current capacity, in allocation units.
+             *
+             * \param[in] requiredCapacity The minimum required capacity, in allocation units.
+             *
+             * \return Returns the new capacity, in allocation units.
+             */
+            static unsigned long grownCapacity(unsigned long currentCapacity, unsigned long requiredCapacity);
+
+            /**
+             * Method that locates the n'th set bit within an allocation unit.
+             *
+             * \param[in] unit         The allocation unit to be searched.
+             *
+             * \param[in] setBitNumber The zero based rank of the set bit.  The unit must contain more set bits than
+             *                         this value.
+             *
+             * \return Returns the bit offset of the set bit within the unit.
+             */
+            static unsigned selectInUnit(AllocationUnit unit, unsigned setBitNumber);
+
+            /**
+             * The number of words scanned between checks for an early exit during parallel searches.
+             */
+            static constexpr unsigned long searchBlockUnits = 4096;
+
+            /**
+             * Method that applies a bitwise operation to a range of allocation units.
+             *
+             * \param[out] destination The destination buffer.
+             *
+             * \param[in]  first       The first source buffer.
+             *
+             * \param[in]  second      The second source buffer.
+             *
+             * \param[in]  numberUnits The number of allocation units to process.
+             *
+             * \param[in]  operation   The operation to be performed.
+             */
+            static void combineUnits(
+                AllocationUnit*       destination,
+                const AllocationUnit* first,
+                const AllocationUnit* second,
+                unsigned long         numberUnits,
+                Operation             operation
+            );
+
+            /**
+             * Method that locates the first allocation unit that differs from a fill pattern, splitting the search
+             * across the global thread pool.
+             *
+             * \param[in] fill The fill pattern.  Use 0 to locate set bits and all ones to locate cleared bits.
+             *
+             * \return Returns the index of the first allocation unit that differs from the fill pattern.  The data
+             *         length is returned if every allocation unit matches.
+             */
+            unsigned long parallelFirstUnitNotEqualTo(AllocationUnit fill) const;
+
+            /**
+             * Method that locates the last allocation unit that differs from a fill pattern, splitting the search
+             * across the global thread pool.
+             *
+             * \param[in] fill       The fill pattern.  Use 0 to locate set bits and all ones to locate cleared bits.
+             *
+             * \param[in] endingUnit The index just past the last allocation unit to be searched.
+             *
+             * \return Returns one more than the index of the last allocation unit that differs from the fill pattern.
+             *         Zero is returned if every allocation unit matches.
+             */
+            unsigned long parallelLastUnitNotEqualTo(AllocationUnit fill, unsigned long endingUnit) const;
+
+            /**
+             * Method that locates the first run of consecutive set bits in the array after the array has been
+             * exclusive ORed with a pattern.
+             *
+             * \param[in] length        The required run length, in bits.
+             *
+             * \param[in] startingIndex The starting index to perform the search at.
+             *
+             * \param[in] pattern       The pattern to apply to each allocation unit.  Use 0 to locate runs of set
+             *                          bits and all ones to locate runs of cleared bits.
+             *
+             * \return Returns the index of the first bit in the run.  A value of \ref Util::BitArray::invalidIndex
+             *         is returned if no run of the required length exists.
+             */
+            Index findRun(Index length, Index startingIndex, AllocationUnit pattern) const;
+
+            /**
+             * Method that locates the n'th set bit using the rank/select index.
+             *
+             * \param[in] setBitNumber The zero based rank of the set bit to locate.
+             *
+             * \return Returns the index of the set bit.  The value \ref Util::BitArray::invalidIndex is returned if
+             *         the array contains too few set bits.
+             */
+            Index selectIndexed(Index setBitNumber) const;
+
+            /**
+             * Method that copies a range of bits between two buffers, one destination allocation unit at a time.
+             * Source bits are gathered with funnel shifts so the source and destination need not share the same
+             * alignment.  The buffers may overlap.  Destination bits outside of the range are unchanged.
+             *
+             * \param[in] destination      The destination buffer.
+             *
+             * \param[in] destinationIndex The zero based index of the first destination bit.
+             *
+             * \param[in] source           The source buffer.
+             *
+             * \param[in] sourceIndex      The zero based index of the first source bit.
+             *
+             * \param[in] sourceLength     The source buffer length, in allocation units.
+             *
+             * \param[in] numberBits       The number of bits to copy.
+             */
+            static void copyBitRange(
+                AllocationUnit*       destination,
+                BitArray::Index       destinationIndex,
+                const AllocationUnit* source,
+                BitArray::Index       sourceIndex,
+                unsigned long         sourceLength,
+                BitArray::Index       numberBits
+            );
+
+            /**
+             * Method that obtains the rank/select index, building it if needed.  The method is safe to call from
+             * multiple threads.
+             *
+             * \return Returns the rank/select index.
+             */
+            const RankIndex* rankIndex() const;
+
+            /**
+             * Method that discards any cached acceleration structures.  This method must be called whenever the
+             * array contents change.
+             */
+            void invalidateCaches();
+
+            /**
+             * Method that must be called before the array contents are changed.  The method discards cached
+             * acceleration structures and replaces any external memory with an owned copy.
+             */
+            void prepareForUpdate();
+
+            /**
+             * Method that releases the current data buffer.  Owned buffers are deleted and mapped files are unmapped
+             * and closed.
+             */
+            void releaseData();
+
             /**
              * Method that checks a bit index and resizes the array, if needed.
              *
@@ -251,7 +1008,16 @@ namespace Util {
             void resizeToFit(BitArray::Index index);
 
             /**
-             * Data contained in the class.
+             * Method that moves the array contents into a newly allocated buffer.  Any allocation units beyond the
+             * current data length will be cleared.
+             *
+             * \param[in] newCapacity The new capacity, in allocation units.  The value must be at least as large as
+             *                        the current data length.
+             */
+            void reallocate(unsigned long newCapacity);
+
+            /**
+             * Data contained in the class.  Bits beyond the bit length, up to the capacity, are always kept cleared.
              */
             AllocationUnit* data;
 
@@ -260,10 +1026,146 @@ namespace Util {
              */
             unsigned long dataLength;
 
+            /**
+             * The size of the allocated data buffer, in allocation units.
+             */
+            unsigned long capacityLength;
+
             /**
              * The size of the bit array, in bits.
              */
             unsigned long bitLength;
+
+            /**
+             * Flag indicating if the data buffer is owned by this instance.  Buffers that are not owned reference
+             * caller memory or a mapped file and must never be written.
+             */
+            bool ownsData;
+
+            /**
+             * Flag indicating if the data buffer is borrowed from the caller.  Borrowed buffers are written in place
+             * but are never released.
+             */
+            bool borrowsData;
+
+            /**
+             * The allocator used to obtain and release owned data buffers.
+             */
+            BitArrayAllocator* allocator;
+
+            /**
+             * The file the data buffer is mapped from.  A null pointer indicates that the data buffer is not mapped.
+             */
+            QFile* mappedFile;
+
+            /**
+             * The lazily built rank/select index.  A null pointer indicates that no index is currently available.
+             */
+            mutable std::atomic<RankIndex*> currentRankIndex;
+
+            /**
+             * The cached content hash.  A value of zero indicates that no hash is currently available.
+             */
+            mutable std::atomic<std::uint64_t> currentHash;
+    };
+
+    /**
+     * Class that provides read access to the contents of a \ref Util::BitArray.  Arrays held inline are accessed
+     * through a temporary instance that borrows the inline buffer.  The temporary instance is only constructed for
+     * inline arrays so heap backed arrays are accessed without any construction cost.
+     */
+    class BitArray::Reader {
+        public:
+            /**
+             * Constructor.
+             *
+             * \param[in] array The array to be read.  The array must outlive this instance.
+             */
+            Reader(const BitArray& array);
+
+            Reader(const Reader& other) = delete;
+
+            ~Reader();
+
+            Reader& operator=(const Reader& other) = delete;
+
+            /**
+             * Member access operator.
+             *
+             * \return Returns the instance holding the array contents.
+             */
+            const BitArray::Private* operator->() const;
+
+            /**
+             * Dereference operator.
+             *
+             * \return Returns the instance holding the array contents.
+             */
+            const BitArray::Private& operator*() const;
+
+        private:
+            /**
+             * Storage for the instance used to access an inline array.  The instance is only constructed when the
+             * array is held inline.
+             */
+            alignas(BitArray::Private) unsigned char localStorage[sizeof(BitArray::Private)];
+
+            /**
+             * The instance holding the array contents.
+             */
+            const BitArray::Private* current;
+    };
+
+    /**
+     * Class that provides write access to the contents of a \ref Util::BitArray.  Shared data is detached on
+     * construction.  Arrays held inline are updated in place until they outgrow the inline buffer, in which case the
+     * contents are moved into a new shared data instance when this instance is destroyed.
+     */
+    class BitArray::Writer {
+        public:
+            /**
+             * Constructor.
+             *
+             * \param[in] array The array to be updated.  The array must outlive this instance.
+             */
+            Writer(BitArray& array);
+
+            Writer(const Writer& other) = delete;
+
+            ~Writer();
+
+            Writer& operator=(const Writer& other) = delete;
+
+            /**
+             * Member access operator.
+             *
+             * \return Returns the instance holding the array contents.
+             */
+            BitArray::Private* operator->() const;
+
+            /**
+             * Dereference operator.
+             *
+             * \return Returns the instance holding the array contents.
+             */
+            BitArray::Private& operator*() const;
+
+        private:
+            /**
+             * The array being updated.
+             */
+            BitArray& array;
+
+            /**
+             * Storage for the instance used to access an inline array.  The instance is only constructed when the
+             * array is held inline.
+             */
+            alignas(BitArray::Private) unsigned char localStorage[sizeof(BitArray::Private)];
+
+            /**
+             * The instance holding the array contents.
+             */
+            BitArray::Private* current;
     };
 }
 
@@ -59,49 +59,75 @@ namespace Util {
 
 
     int msbLocation32(std::uint32_t value) {
-        int msbLocation = 0;
+        #if (defined(_MSC_VER))
 
-        if (value) {
-            unsigned adjustment = 32;
-            std::uint32_t runningValue = value;
+            unsigned long location;
+            return _BitScanReverse(&location, value) ? static_cast<int>(location) : -1;
 
-            while (adjustment) {
-                std::uint32_t mask = ((1ULL << adjustment) - 1) << adjustment;
-                if (runningValue & mask) {
-                    runningValue >>= adjustment;
-                    msbLocation += adjustment;
-                }
+        #elif (defined(__GNUC__) || defined(__clang__))
+
+            return value != 0 ? 31 - __builtin_clz(value) : -1;
+
+        #else
+
+            int msbLocation = 0;
 
-                adjustment >>= 1;
+            if (value) {
+                unsigned adjustment = 16;
+                std::uint32_t runningValue = value;
+
+                while (adjustment) {
+                    std::uint32_t mask = ((1UL << adjustment) - 1) << adjustment;
+                    if (runningValue & mask) {
+                        runningValue >>= adjustment;
+                        msbLocation += adjustment;
+                    }
+
+                    adjustment >>= 1;
+                }
+            } else {
+                msbLocation = -1;
             }
-        } else {
-            msbLocation = -1;
-        }
 
-        return msbLocation;
+            return msbLocation;
+
+        #endif
     }
 
 
     int msbLocation64(std::uint64_t value) {
-        int msbLocation = 0;
+        #if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64)))
 
-        if (value) {
-            unsigned adjustment = 64;
-            std::uint64_t runningValue = value;
+            unsigned long location;
+            return _BitScanReverse64(&location, value) ? static_cast<int>(location) : -1;
 
-            while (adjustment) {
-                std::uint64_t mask = ((1ULL << adjustment) - 1) << adjustment;
-                if (runningValue & mask) {
-                    runningValue >>= adjustment;
-                    msbLocation += adjustment;
-                }
+        #elif (defined(__GNUC__) || defined(__clang__))
+
+            return value != 0 ? 63 - __builtin_clzll(value) : -1;
+
+        #else
+
+            int msbLocation = 0;
 
-                adjustment >>= 1;
+            if (value) {
+                unsigned adjustment = 32;
+                std::uint64_t runningValue = value;
+
+                while (adjustment) {
+                    std::uint64_t mask = ((1ULL << adjustment) - 1) << adjustment;
+                    if (runningValue & mask) {
+                        runningValue >>= adjustment;
+                        msbLocation += adjustment;
+                    }
+
+                    adjustment >>= 1;
+                }
+            } else {
+                msbLocation = -1;
             }
-        } else {
-            msbLocation = -1;
-        }
 
-        return msbLocation;
+            return msbLocation;
+
+        #endif
     }
 }
@@ -0,0 +1,986 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the word-parallel bit kernels.
+***********************************************************************************************************************/
+
+#include <cstdint>
+#include <cstring>
+
+#include "util_common.h"
+#include "util_bit_functions.h"
+#include "util_bit_kernels.h"
+
+#if (defined(__x86_64__) || defined(_M_X64))
+
+    #define UTIL_BIT_KERNELS_X86_64
+
+    #include <immintrin.h>
+
+    #if (defined(_MSC_VER))
+
+        #include <intrin.h>
+
+    #endif
+
+#endif
+
+#if (defined(UTIL_BIT_KERNELS_X86_64) && (defined(__GNUC__) || defined(__clang__)))
+
+    #define UTIL_TARGET_AVX2   __attribute__((target("avx2")))
+    #define UTIL_TARGET_AVX512 __attribute__((target("avx512f")))
+    #define UTIL_TARGET_POPCNT __attribute__((target("popcnt")))
+    #define UTIL_TARGET_BMI2   __attribute__((target("bmi2,popcnt")))
+
+#else
+
+    #define UTIL_TARGET_AVX2
+    #define UTIL_TARGET_AVX512
+    #define UTIL_TARGET_POPCNT
+    #define UTIL_TARGET_BMI2
+
+#endif
+
+namespace Util {
+    /**
+     * Operation used by the AND kernels.
+     */
+    struct AndOperation {
+        static inline std::uint64_t scalar(std::uint64_t a, std::uint64_t b) {
+            return a & b;
+        }
+
+        #if (defined(UTIL_BIT_KERNELS_X86_64))
+
+            static inline UTIL_TARGET_AVX2 __m256i avx2(__m256i a, __m256i b) {
+                return _mm256_and_si256(a, b);
+            }
+
+            static inline UTIL_TARGET_AVX512 __m512i avx512(__m512i a, __m512i b) {
+                return _mm512_and_si512(a, b);
+            }
+
+        #endif
+    };
+
+    /**
+     * Operation used by the OR kernels.
+     */
+    struct OrOperation {
+        static inline std::uint64_t scalar(std::uint64_t a, std::uint64_t b) {
+            return a | b;
+        }
+
+        #if (defined(UTIL_BIT_KERNELS_X86_64))
+
+            static inline UTIL_TARGET_AVX2 __m256i avx2(__m256i a, __m256i b) {
+                return _mm256_or_si256(a, b);
+            }
+
+            static inline UTIL_TARGET_AVX512 __m512i avx512(__m512i a, __m512i b) {
+                return _mm512_or_si512(a, b);
+            }
+
+        #endif
+    };
+
+    /**
+     * Operation used by the exclusive OR kernels.
+     */
+    struct XorOperation {
+        static inline std::uint64_t scalar(std::uint64_t a, std::uint64_t b) {
+            return a ^ b;
+        }
+
+        #if (defined(UTIL_BIT_KERNELS_X86_64))
+
+            static inline UTIL_TARGET_AVX2 __m256i avx2(__m256i a, __m256i b) {
+                return _mm256_xor_si256(a, b);
+            }
+
+            static inline UTIL_TARGET_AVX512 __m512i avx512(__m512i a, __m512i b) {
+                return _mm512_xor_si512(a, b);
+            }
+
+        #endif
+    };
+
+    /**
+     * Operation used by the AND NOT kernels.
+     */
+    struct AndNotOperation {
+        static inline std::uint64_t scalar(std::uint64_t a, std::uint64_t b) {
+            return a & ~b;
+        }
+
+        #if (defined(UTIL_BIT_KERNELS_X86_64))
+
+            static inline UTIL_TARGET_AVX2 __m256i avx2(__m256i a, __m256i b) {
+                return _mm256_andnot_si256(b, a);
+            }
+
+            static inline UTIL_TARGET_AVX512 __m512i avx512(__m512i a, __m512i b) {
+                // 0x30 selects a & ~b.  _mm512_andnot_si512 is avoided as GCC reports its internal undefined
+                // vector as possibly uninitialized.
+                return _mm512_ternarylogic_epi64(a, b, b, 0x30);
+            }
+
+        #endif
+    };
+
+    /**
+     * Type used to represent a binary kernel.
+     */
+    typedef void (*BinaryKernel)(std::uint64_t*, const std::uint64_t*, const std::uint64_t*, unsigned long);
+
+    /**
+     * Type used to represent a unary kernel.
+     */
+    typedef void (*UnaryKernel)(std::uint64_t*, const std::uint64_t*, unsigned long);
+
+    /**
+     * Type used to represent a reduction kernel.
+     */
+    typedef unsigned long (*ReductionKernel)(const std::uint64_t*, unsigned long);
+
+    /**
+     * Type used to represent a kernel that tests two arrays against each other.
+     */
+    typedef bool (*PredicateKernel)(const std::uint64_t*, const std::uint64_t*, unsigned long);
+
+    /**
+     * Type used to represent a bit extraction kernel.
+     */
+    typedef unsigned long (*ExtractKernel)(std::uint64_t*, const std::uint64_t*, const std::uint64_t*, unsigned long);
+
+    /**
+     * Type used to represent a bit deposit kernel.
+     */
+    typedef void (*DepositKernel)(std::uint64_t*, const std::uint64_t*, const std::uint64_t*, unsigned long);
+
+    /**
+     * Type used to represent a byte packing kernel.
+     */
+    typedef void (*PackKernel)(std::uint64_t*, const std::uint8_t*, unsigned long);
+
+    /**
+     * Type used to represent a byte unpacking kernel.
+     */
+    typedef void (*UnpackKernel)(std::uint8_t*, const std::uint64_t*, unsigned long);
+
+    /**
+     * Table of kernels selected for this processor.
+     */
+    struct BitKernelTable {
+        BitKernelInstructionSet instructionSet;
+        BinaryKernel            andKernel;
+        BinaryKernel            orKernel;
+        BinaryKernel            xorKernel;
+        BinaryKernel            andNotKernel;
+        UnaryKernel             notKernel;
+        ReductionKernel         populationCountKernel;
+        PredicateKernel         intersectsKernel;
+        ExtractKernel           extractKernel;
+        DepositKernel           depositKernel;
+        PackKernel              packKernel;
+        UnpackKernel            unpackKernel;
+    };
+
+    /**
+     * Class that appends variable length bit fields to a word array.
+     */
+    class BitFieldWriter {
+        public:
+            /**
+             * Constructor.
+             *
+             * \param[in] destination The array to write to.
+             */
+            inline BitFieldWriter(std::uint64_t* destination) {
+                currentWord = destination;
+                accumulator = 0;
+                usedBits    = 0;
+            }
+
+            /**
+             * Method that appends a field.
+             *
+             * \param[in] value       The field value.  Bits at and above the field width must be cleared.
+             *
+             * \param[in] numberBits  The field width, in bits.
+             */
+            inline void append(std::uint64_t value, unsigned numberBits) {
+                accumulator |= value << usedBits;
+                usedBits    += numberBits;
+
+                if (usedBits >= 64) {
+                    *currentWord = accumulator;
+                    ++currentWord;
+
+                    usedBits    -= 64;
+                    accumulator  = usedBits > 0 ? value >> (numberBits - usedBits) : 0;
+                }
+            }
+
+            /**
+             * Method that writes any partially filled word.
+             */
+            inline void flush() {
+                if (usedBits > 0) {
+                    *currentWord = accumulator;
+                }
+            }
+
+        private:
+            /**
+             * The next word to be written.
+             */
+            std::uint64_t* currentWord;
+
+            /**
+             * The bits not yet written.
+             */
+            std::uint64_t accumulator;
+
+            /**
+             * The number of valid bits in the accumulator.  The value is always less than 64.
+             */
+            unsigned usedBits;
+    };
+
+    /**
+     * Class that reads consecutive variable length bit fields from a word array.
+     */
+    class BitFieldReader {
+        public:
+            /**
+             * Constructor.
+             *
+             * \param[in] source The array to read from.
+             */
+            inline BitFieldReader(const std::uint64_t* source) {
+                this->source = source;
+                position     = 0;
+            }
+
+            /**
+             * Method that reads the next field.
+             *
+             * \param[in] numberBits The field width, in bits.
+             *
+             * \return Returns the field value in the low bits.  Bits above the field width are undefined.
+             */
+            inline std::uint64_t next(unsigned numberBits) {
+                std::uint64_t result = 0;
+
+                if (numberBits > 0) {
+                    unsigned long wordIndex = position / 64;
+                    unsigned      offset    = position % 64;
+
+                    result = source[wordIndex] >> offset;
+                    if (offset + numberBits > 64) {
+                        result |= source[wordIndex + 1] << (64 - offset);
+                    }
+
+                    position += numberBits;
+                }
+
+                return result;
+            }
+
+        private:
+            /**
+             * The array being read.
+             */
+            const std::uint64_t* source;
+
+            /**
+             * The index of the next bit to be read.
+             */
+            unsigned long position;
+    };
+
+    template<typename O> static void binaryScalar(
+            std::uint64_t*       destination,
+            const std::uint64_t* source1,
+            const std::uint64_t* source2,
+            unsigned long        numberWords
+        ) {
+        for (unsigned long index=0 ; index<numberWords ; ++index) {
+            destination[index] = O::scalar(source1[index], source2[index]);
+        }
+    }
+
+
+    static void notScalar(std::uint64_t* destination, const std::uint64_t* source, unsigned long numberWords) {
+        for (unsigned long index=0 ; index<numberWords ; ++index) {
+            destination[index] = ~source[index];
+        }
+    }
+
+    static unsigned long populationCountScalar(const std::uint64_t* source, unsigned long numberWords) {
+        unsigned long result = 0;
+        for (unsigned long index=0 ; index<numberWords ; ++index) {
+            result += numberOnes64(source[index]);
+        }
+
+        return result;
+    }
+
+
+    static bool intersectsScalar(
+            const std::uint64_t* source1,
+            const std::uint64_t* source2,
+            unsigned long        numberWords
+        ) {
+        unsigned long index = 0;
+        while (index < numberWords && (source1[index] & source2[index]) == 0) {
+            ++index;
+        }
+
+        return index < numberWords;
+    }
+
+
+    static unsigned long extractScalar(
+            std::uint64_t*       destination,
+            const std::uint64_t* source,
+            const std::uint64_t* mask,
+            unsigned long        numberWords
+        ) {
+        BitFieldWriter writer(destination);
+        unsigned long  result = 0;
+
+        for (unsigned long index=0 ; index<numberWords ; ++index) {
+            std::uint64_t maskWord = mask[index];
+            if (maskWord == static_cast<std::uint64_t>(-1)) {
+                writer.append(source[index], 64);
+                result += 64;
+            } else if (maskWord != 0) {
+                std::uint64_t value    = source[index];
+                std::uint64_t field    = 0;
+                unsigned      fieldBit = 0;
+
+                do {
+                    std::uint64_t lowest = maskWord & (0 - maskWord);
+                    if ((value & lowest) != 0) {
+                        field |= static_cast<std::uint64_t>(1) << fieldBit;
+                    }
+
+                    maskWord ^= lowest;
+                    ++fieldBit;
+                } while (maskWord != 0);
+
+                writer.append(field, fieldBit);
+                result += fieldBit;
+            }
+        }
+
+        writer.flush();
+        return result;
+    }
+
+
+    static void depositScalar(
+            std::uint64_t*       destination,
+            const std::uint64_t* source,
+            const std::uint64_t* mask,
+            unsigned long        numberWords
+        ) {
+        BitFieldReader reader(source);
+
+        for (unsigned long index=0 ; index<numberWords ; ++index) {
+            std::uint64_t maskWord = mask[index];
+            std::uint64_t value    = 0;
+
+            if (maskWord == static_cast<std::uint64_t>(-1)) {
+                value = reader.next(64);
+            } else if (maskWord != 0) {
+                std::uint64_t field = reader.next(numberOnes64(maskWord));
+
+                do {
+                    std::uint64_t lowest = maskWord & (0 - maskWord);
+                    if ((field & 1) != 0) {
+                        value |= lowest;
+                    }
+
+                    maskWord ^= lowest;
+                    field   >>= 1;
+                } while (maskWord != 0);
+            }
+
+            destination[index] = value;
+        }
+    }
+
+
+    /**
+     * Function that reduces each byte of a word to 1 if the byte is non-zero and 0 if the byte is zero.
+     *
+     * \param[in] bytes The bytes to be reduced.
+     *
+     * \return Returns a word holding one flag in the low bit of each byte.
+     */
+    static inline std::uint64_t nonZeroBytes(std::uint64_t bytes) {
+        // Adding 0x7F to the low seven bits carries into the top bit of any byte with a low bit set.
+
+        std::uint64_t lowBits = 0x7F7F7F7F7F7F7F7FULL;
+        return ((((bytes & lowBits) + lowBits) | bytes) >> 7) & 0x0101010101010101ULL;
+    }
+
+
+    static void packScalar(std::uint64_t* destination, const std::uint8_t* source, unsigned long numberBits) {
+        unsigned long numberWords = numberBits / 64;
+
+        for (unsigned long wordIndex=0 ; wordIndex<numberWords ; ++wordIndex) {
+            std::uint64_t word = 0;
+            for (unsigned group=0 ; group<8 ; ++group) {
+                std::uint64_t bytes;
+                std::memcpy(&bytes, source + wordIndex * 64 + group * 8, sizeof(bytes));
+
+                // The multiply gathers the low bit of byte n into bit 56 + n.
+
+                word |= ((nonZeroBytes(bytes) * 0x0102040810204080ULL) >> 56) << (8 * group);
+            }
+
+            destination[wordIndex] = word;
+        }
+
+        unsigned remainingBits = static_cast<unsigned>(numberBits % 64);
+        if (remainingBits > 0) {
+            const std::uint8_t* remaining = source + numberWords * 64;
+            std::uint64_t       word      = 0;
+
+            for (unsigned index=0 ; index<remainingBits ; ++index) {
+                word |= static_cast<std::uint64_t>(remaining[index] != 0) << index;
+            }
+
+            destination[numberWords] = word;
+        }
+    }
+
+
+    static void unpackScalar(std::uint8_t* destination, const std::uint64_t* source, unsigned long numberBits) {
+        unsigned long numberGroups = numberBits / 8;
+
+        for (unsigned long group=0 ; group<numberGroups ; ++group) {
+            // Copy the group into every byte, keep bit n in byte n, then reduce each byte to a flag.
+
+            std::uint64_t bits   = (source[group / 8] >> (8 * (group % 8))) & 0xFF;
+            std::uint64_t spread = (bits * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+            std::uint64_t flags  = nonZeroBytes(spread);
+
+            std::memcpy(destination + group * 8, &flags, sizeof(flags));
+        }
+
+        for (unsigned long index=numberGroups*8 ; index<numberBits ; ++index) {
+            destination[index] = static_cast<std::uint8_t>((source[index / 64] >> (index % 64)) & 1);
+        }
+    }
+
+    #if (defined(UTIL_BIT_KERNELS_X86_64))
+
+        static UTIL_TARGET_POPCNT unsigned long populationCountPopcnt(
+                const std::uint64_t* source,
+                unsigned long        numberWords
+            ) {
+            // Four independent accumulators keep the POPCNT units busy.
+
+            std::uint64_t count0 = 0;
+            std::uint64_t count1 = 0;
+            std::uint64_t count2 = 0;
+            std::uint64_t count3 = 0;
+
+            unsigned long index = 0;
+            while (index + 4 <= numberWords) {
+                count0 += static_cast<std::uint64_t>(_mm_popcnt_u64(source[index]));
+                count1 += static_cast<std::uint64_t>(_mm_popcnt_u64(source[index + 1]));
+                count2 += static_cast<std::uint64_t>(_mm_popcnt_u64(source[index + 2]));
+                count3 += static_cast<std::uint64_t>(_mm_popcnt_u64(source[index + 3]));
+                index += 4;
+            }
+
+            while (index < numberWords) {
+                count0 += static_cast<std::uint64_t>(_mm_popcnt_u64(source[index]));
+                ++index;
+            }
+
+            return static_cast<unsigned long>(count0 + count1 + count2 + count3);
+        }
+
+
+        template<typename O> static UTIL_TARGET_AVX2 void binaryAvx2(
+                std::uint64_t*       destination,
+                const std::uint64_t* source1,
+                const std::uint64_t* source2,
+                unsigned long        numberWords
+            ) {
+            unsigned long index = 0;
+            while (index + 8 <= numberWords) {
+                __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source1 + index));
+                __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source1 + index + 4));
+                __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source2 + index));
+                __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source2 + index + 4));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + index), O::avx2(a0, b0));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + index + 4), O::avx2(a1, b1));
+
+                index += 8;
+            }
+
+            while (index < numberWords) {
+                destination[index] = O::scalar(source1[index], source2[index]);
+                ++index;
+            }
+        }
+
+
+        static UTIL_TARGET_AVX2 void notAvx2(
+                std::uint64_t*       destination,
+                const std::uint64_t* source,
+                unsigned long        numberWords
+            ) {
+            __m256i       ones  = _mm256_set1_epi64x(-1);
+            unsigned long index = 0;
+            while (index + 4 <= numberWords) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + index));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + index), _mm256_xor_si256(a, ones));
+                index += 4;
+            }
+
+            while (index < numberWords) {
+                destination[index] = ~source[index];
+                ++index;
+            }
+        }
+
+
+        static UTIL_TARGET_AVX2 bool intersectsAvx2(
+                const std::uint64_t* source1,
+                const std::uint64_t* source2,
+                unsigned long        numberWords
+            ) {
+            bool          result = false;
+            unsigned long index  = 0;
+
+            while (!result && index + 4 <= numberWords) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source1 + index));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source2 + index));
+
+                result  = _mm256_testz_si256(a, b) == 0;
+                index  += 4;
+            }
+
+            return result || intersectsScalar(source1 + index, source2 + index, numberWords - index);
+        }
+
+
+        static UTIL_TARGET_AVX2 void packAvx2(
+                std::uint64_t*      destination,
+                const std::uint8_t* source,
+                unsigned long       numberBits
+            ) {
+            __m256i       zero        = _mm256_setzero_si256();
+            unsigned long numberWords = numberBits / 64;
+
+            for (unsigned long index=0 ; index<numberWords ; ++index) {
+                __m256i lowBytes  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + index * 64));
+                __m256i highBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + index * 64 + 32));
+                __m256i lowMask   = _mm256_cmpeq_epi8(lowBytes, zero);
+                __m256i highMask  = _mm256_cmpeq_epi8(highBytes, zero);
+
+                std::uint32_t lowZero  = static_cast<std::uint32_t>(_mm256_movemask_epi8(lowMask));
+                std::uint32_t highZero = static_cast<std::uint32_t>(_mm256_movemask_epi8(highMask));
+
+                destination[index] = ~((static_cast<std::uint64_t>(highZero) << 32) | lowZero);
+            }
+
+            packScalar(destination + numberWords, source + numberWords * 64, numberBits % 64);
+        }
+
+
+        static UTIL_TARGET_AVX2 void unpackAvx2(
+                std::uint8_t*        destination,
+                const std::uint64_t* source,
+                unsigned long        numberBits
+            ) {
+            // Each 32-bit half word is broadcast, byte n of the half word is copied to bytes 8n to 8n + 7, and each
+            // byte is then compared against the bit it represents.
+
+            __m256i shuffle = _mm256_setr_epi8(
+                0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+            );
+            __m256i bitMask = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ULL));
+            __m256i one     = _mm256_set1_epi8(1);
+
+            unsigned long numberWords = numberBits / 64;
+            for (unsigned long index=0 ; index<numberWords ; ++index) {
+                std::uint64_t word = source[index];
+
+                for (unsigned half=0 ; half<2 ; ++half) {
+                    int     bits   = static_cast<int>(static_cast<std::uint32_t>(word >> (32 * half)));
+                    __m256i spread = _mm256_and_si256(_mm256_shuffle_epi8(_mm256_set1_epi32(bits), shuffle), bitMask);
+                    __m256i flags  = _mm256_and_si256(_mm256_cmpeq_epi8(spread, bitMask), one);
+
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + index * 64 + half * 32), flags);
+                }
+            }
+
+            unpackScalar(destination + numberWords * 64, source + numberWords, numberBits % 64);
+        }
+
+
+        template<typename O> static UTIL_TARGET_AVX512 void binaryAvx512(
+                std::uint64_t*       destination,
+                const std::uint64_t* source1,
+                const std::uint64_t* source2,
+                unsigned long        numberWords
+            ) {
+            unsigned long index = 0;
+            while (index + 16 <= numberWords) {
+                __m512i a0 = _mm512_loadu_si512(source1 + index);
+                __m512i a1 = _mm512_loadu_si512(source1 + index + 8);
+                __m512i b0 = _mm512_loadu_si512(source2 + index);
+                __m512i b1 = _mm512_loadu_si512(source2 + index + 8);
+
+                _mm512_storeu_si512(destination + index, O::avx512(a0, b0));
+                _mm512_storeu_si512(destination + index + 8, O::avx512(a1, b1));
+
+                index += 16;
+            }
+
+            while (index < numberWords) {
+                destination[index] = O::scalar(source1[index], source2[index]);
+                ++index;
+            }
+        }
+
+
+        static UTIL_TARGET_AVX512 void notAvx512(
+                std::uint64_t*       destination,
+                const std::uint64_t* source,
+                unsigned long        numberWords
+            ) {
+            __m512i       ones  = _mm512_set1_epi64(-1);
+            unsigned long index = 0;
+            while (index + 8 <= numberWords) {
+                __m512i a = _mm512_loadu_si512(source + index);
+                _mm512_storeu_si512(destination + index, _mm512_xor_si512(a, ones));
+                index += 8;
+            }
+
+            while (index < numberWords) {
+                destination[index] = ~source[index];
+                ++index;
+            }
+        }
+
+
+        static UTIL_TARGET_BMI2 unsigned long extractBmi2(
+                std::uint64_t*       destination,
+                const std::uint64_t* source,
+                const std::uint64_t* mask,
+                unsigned long        numberWords
+            ) {
+            BitFieldWriter writer(destination);
+            unsigned long  result = 0;
+
+            for (unsigned long index=0 ; index<numberWords ; ++index) {
+                std::uint64_t maskWord = mask[index];
+                if (maskWord != 0) {
+                    unsigned fieldBits = static_cast<unsigned>(_mm_popcnt_u64(maskWord));
+                    writer.append(_pext_u64(source[index], maskWord), fieldBits);
+                    result += fieldBits;
+                }
+            }
+
+            writer.flush();
+            return result;
+        }
+
+
+        static UTIL_TARGET_BMI2 void depositBmi2(
+                std::uint64_t*       destination,
+                const std::uint64_t* source,
+                const std::uint64_t* mask,
+                unsigned long        numberWords
+            ) {
+            BitFieldReader reader(source);
+
+            for (unsigned long index=0 ; index<numberWords ; ++index) {
+                std::uint64_t maskWord  = mask[index];
+                unsigned      fieldBits = static_cast<unsigned>(_mm_popcnt_u64(maskWord));
+
+                destination[index] = _pdep_u64(reader.next(fieldBits), maskWord);
+            }
+        }
+
+
+        static bool detectPopcnt() {
+            #if (defined(_MSC_VER))
+
+                int registers[4];
+                __cpuid(registers, 1);
+                return (registers[2] & (1 << 23)) != 0;
+
+            #else
+
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("popcnt");
+
+            #endif
+        }
+
+
+        static bool detectBmi2() {
+            #if (defined(_MSC_VER))
+
+                int registers[4];
+                __cpuid(registers, 0);
+                bool result = false;
+                if (registers[0] >= 7) {
+                    __cpuidex(registers, 7, 0);
+                    result = (registers[1] & (1 << 8)) != 0;
+                }
+
+                return result && detectPopcnt();
+
+            #else
+
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt");
+
+            #endif
+        }
+
+
+        static BitKernelInstructionSet detectInstructionSet() {
+            BitKernelInstructionSet result = BitKernelInstructionSet::SCALAR;
+
+            #if (defined(_MSC_VER))
+
+                int registers[4];
+                __cpuid(registers, 0);
+                int maximumLeaf = registers[0];
+
+                if (maximumLeaf >= 7) {
+                    __cpuid(registers, 1);
+                    bool osSavesYmm = false;
+                    bool osSavesZmm = false;
+                    if ((registers[2] & (1 << 27)) != 0) {
+                        unsigned long long xcr0 = _xgetbv(0);
+                        osSavesYmm = (xcr0 & 0x06) == 0x06;
+                        osSavesZmm = (xcr0 & 0xE6) == 0xE6;
+                    }
+
+                    __cpuidex(registers, 7, 0);
+                    if (osSavesZmm && (registers[1] & (1 << 16)) != 0) {
+                        result = BitKernelInstructionSet::AVX512;
+                    } else if (osSavesYmm && (registers[1] & (1 << 5)) != 0) {
+                        result = BitKernelInstructionSet::AVX2;
+                    }
+                }
+
+            #else
+
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f")) {
+                    result = BitKernelInstructionSet::AVX512;
+                } else if (__builtin_cpu_supports("avx2")) {
+                    result = BitKernelInstructionSet::AVX2;
+                }
+
+            #endif
+
+            return result;
+        }
+
+    #else
+
+        static bool detectPopcnt() {
+            return false;
+        }
+
+
+        static bool detectBmi2() {
+            return false;
+        }
+
+
+        static BitKernelInstructionSet detectInstructionSet() {
+            return BitKernelInstructionSet::SCALAR;
+        }
+
+    #endif
+
+    static BitKernelTable buildKernelTable() {
+        BitKernelTable table;
+
+        table.instructionSet = detectInstructionSet();
+        table.andKernel      = &binaryScalar<AndOperation>;
+        table.orKernel       = &binaryScalar<OrOperation>;
+        table.xorKernel      = &binaryScalar<XorOperation>;
+        table.andNotKernel   = &binaryScalar<AndNotOperation>;
+        table.notKernel      = &notScalar;
+
+        table.populationCountKernel = &populationCountScalar;
+        table.intersectsKernel      = &intersectsScalar;
+        table.extractKernel         = &extractScalar;
+        table.depositKernel         = &depositScalar;
+        table.packKernel            = &packScalar;
+        table.unpackKernel          = &unpackScalar;
+
+        #if (defined(UTIL_BIT_KERNELS_X86_64))
+
+            if (detectPopcnt()) {
+                table.populationCountKernel = &populationCountPopcnt;
+            }
+
+            if (detectBmi2()) {
+                table.extractKernel = &extractBmi2;
+                table.depositKernel = &depositBmi2;
+            }
+
+            if (table.instructionSet == BitKernelInstructionSet::AVX512) {
+                table.andKernel        = &binaryAvx512<AndOperation>;
+                table.orKernel         = &binaryAvx512<OrOperation>;
+                table.xorKernel        = &binaryAvx512<XorOperation>;
+                table.andNotKernel     = &binaryAvx512<AndNotOperation>;
+                table.notKernel        = &notAvx512;
+                table.intersectsKernel = &intersectsAvx2;
+                table.packKernel       = &packAvx2;
+                table.unpackKernel     = &unpackAvx2;
+            } else if (table.instructionSet == BitKernelInstructionSet::AVX2) {
+                table.andKernel        = &binaryAvx2<AndOperation>;
+                table.orKernel         = &binaryAvx2<OrOperation>;
+                table.xorKernel        = &binaryAvx2<XorOperation>;
+                table.andNotKernel     = &binaryAvx2<AndNotOperation>;
+                table.notKernel        = &notAvx2;
+                table.intersectsKernel = &intersectsAvx2;
+                table.packKernel       = &packAvx2;
+                table.unpackKernel     = &unpackAvx2;
+            }
+
+        #endif
+
+        return table;
+    }
+
+
+    static const BitKernelTable& kernels() {
+        static const BitKernelTable table = buildKernelTable();
+        return table;
+    }
+
+
+    BitKernelInstructionSet bitKernelInstructionSet() {
+        return kernels().instructionSet;
+    }
+
+
+    void bitwiseAnd(
+            std::uint64_t*       destination,
+            const std::uint64_t* source1,
+            const std::uint64_t* source2,
+            unsigned long        numberWords
+        ) {
+        kernels().andKernel(destination, source1, source2, numberWords);
+    }
+
+
+    void bitwiseOr(
+            std::uint64_t*       destination,
+            const std::uint64_t* source1,
+            const std::uint64_t* source2,
+            unsigned long        numberWords
+        ) {
+        kernels().orKernel(destination, source1, source2, numberWords);
+    }
+
+
+    void bitwiseXor(
+            std::uint64_t*       destination,
+            const std::uint64_t* source1,
+            const std::uint64_t* source2,
+            unsigned long        numberWords
+        ) {
+        kernels().xorKernel(destination, source1, source2, numberWords);
+    }
+
+
+    void bitwiseAndNot(
+            std::uint64_t*       destination,
+            const std::uint64_t* source1,
+            const std::uint64_t* source2,
+            unsigned long        numberWords
+        ) {
+        kernels().andNotKernel(destination, source1, source2, numberWords);
+    }
+
+
+    void bitwiseNot(std::uint64_t* destination, const std::uint64_t* source, unsigned long numberWords) {
+        kernels().notKernel(destination, source, numberWords);
+    }
+
+
+    unsigned long populationCount(const std::uint64_t* source, unsigned long numberWords) {
+        return kernels().populationCountKernel(source, numberWords);
+    }
+
+
+    bool bitwiseIntersects(const std::uint64_t* source1, const std::uint64_t* source2, unsigned long numberWords) {
+        return kernels().intersectsKernel(source1, source2, numberWords);
+    }
+
+
+    unsigned long extractBits(
+            std::uint64_t*       destination,
+            const std::uint64_t* source,
+            const std::uint64_t* mask,
+            unsigned long        numberWords
+        ) {
+        return kernels().extractKernel(destination, source, mask, numberWords);
+    }
+
+
+    void depositBits(
+            std::uint64_t*       destination,
+            const std::uint64_t* source,
+            const std::uint64_t* mask,
+            unsigned long        numberWords
+        ) {
+        kernels().depositKernel(destination, source, mask, numberWords);
+    }
+
+
+    void packBytes(std::uint64_t* destination, const std::uint8_t* source, unsigned long numberBits) {
+        kernels().packKernel(destination, source, numberBits);
+    }
+
+
+    void unpackBytes(std::uint8_t* destination, const std::uint64_t* source, unsigned long numberBits) {
+        kernels().unpackKernel(destination, source, numberBits);
+    }
+}
@@ -0,0 +1,242 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines a small collection of word-parallel kernels used by the bit container classes.  Kernels are
+* selected at run time based on the capabilities of the processor.
+***********************************************************************************************************************/
+
+/* .. sphinx-project ineutil */
+
+#ifndef UTIL_BIT_KERNELS_H
+#define UTIL_BIT_KERNELS_H
+
+#include <cstdint>
+
+#include "util_common.h"
+
+namespace Util {
+    /**
+     * Enumeration of instruction set extensions the bit kernels can be built around.
+     */
+    enum class BitKernelInstructionSet {
+        /**
+         * Indicates portable scalar kernels.
+         */
+        SCALAR,
+
+        /**
+         * Indicates kernels built around the AVX2 instruction set extensions.
+         */
+        AVX2,
+
+        /**
+         * Indicates kernels built around the AVX-512 foundation instruction set extensions.
+         */
+        AVX512
+    };
+
+    /**
+     * Function you can use to determine which kernels were selected for this processor.
+     *
+     * \return Returns the instruction set used by the bit kernels.
+     */
+    BitKernelInstructionSet bitKernelInstructionSet();
+
+    /**
+     * Function that calculates the bitwise AND of two word arrays.  The destination may alias either source.
+     *
+     * \param[out] destination The destination array.
+     *
+     * \param[in]  source1     The first source array.
+     *
+     * \param[in]  source2     The second source array.
+     *
+     * \param[in]  numberWords The number of words to process.
+     */
+    void bitwiseAnd(
+        std::uint64_t*       destination,
+        const std::uint64_t* source1,
+        const std::uint64_t* source2,
+        unsigned long        numberWords
+    );
+
+    /**
+     * Function that calculates the bitwise OR of two word arrays.  The destination may alias either source.
+     *
+     * \param[out] destination The destination array.
+     *
+     * \param[in]  source1     The first source array.
+     *
+     * \param[in]  source2     The second source array.
+     *
+     * \param[in]  numberWords The number of words to process.
+     */
+    void bitwiseOr(
+        std::uint64_t*       destination,
+        const std::uint64_t* source1,
+        const std::uint64_t* source2,
+        unsigned long        numberWords
+    );
+
+    /**
+     * Function that calculates the bitwise exclusive OR of two word arrays.  The destination may alias either source.
+     *
+     * \param[out] destination The destination array.
+     *
+     * \param[in]  source1     The first source array.
+     *
+     * \param[in]  source2     The second source array.
+     *
+     * \param[in]  numberWords The number of words to process.
+     */
+    void bitwiseXor(
+        std::uint64_t*       destination,
+        const std::uint64_t* source1,
+        const std::uint64_t* source2,
+        unsigned long        numberWords
+    );
+
+    /**
+     * Function that calculates source1 AND NOT source2 for two word arrays.  The destination may alias either source.
+     *
+     * \param[out] destination The destination array.
+     *
+     * \param[in]  source1     The first source array.
+     *
+     * \param[in]  source2     The second source array.  Bits set in this array are cleared in the result.
+     *
+     * \param[in]  numberWords The number of words to process.
+     */
+    void bitwiseAndNot(
+        std::uint64_t*       destination,
+        const std::uint64_t* source1,
+        const std::uint64_t* source2,
+        unsigned long        numberWords
+    );
+
+    /**
+     * Function that calculates the bitwise complement of a word array.  The destination may alias the source.
+     *
+     * \param[out] destination The destination array.
+     *
+     * \param[in]  source      The source array.
+     *
+     * \param[in]  numberWords The number of words to process.
+     */
+    void bitwiseNot(std::uint64_t* destination, const std::uint64_t* source, unsigned long numberWords);
+
+    /**
+     * Function that counts the number of set bits in a word array.  The POPCNT instruction is used when the processor
+     * supports it.
+     *
+     * \param[in] source      The source array.
+     *
+     * \param[in] numberWords The number of words to process.
+     *
+     * \return Returns the number of set bits.
+     */
+    unsigned long populationCount(const std::uint64_t* source, unsigned long numberWords);
+
+    /**
+     * Function that determines if two word arrays have any set bit in common.  The function stops at the first
+     * common bit.
+     *
+     * \param[in] source1     The first source array.
+     *
+     * \param[in] source2     The second source array.
+     *
+     * \param[in] numberWords The number of words to process.
+     *
+     * \return Returns true if the bitwise AND of the arrays is non-zero.
+     */
+    bool bitwiseIntersects(const std::uint64_t* source1, const std::uint64_t* source2, unsigned long numberWords);
+
+    /**
+     * Function that gathers the source bits selected by a mask and packs them, in order, starting at bit zero of
+     * the destination.  The BMI2 PEXT instruction is used when the processor supports it.
+     *
+     * \param[out] destination The destination array.  The array must hold at least as many bits as are set in the
+     *                         mask.  Words past the last extracted bit are not written.
+     *
+     * \param[in]  source      The source array.
+     *
+     * \param[in]  mask        The mask selecting the bits to gather.
+     *
+     * \param[in]  numberWords The number of source and mask words to process.
+     *
+     * \return Returns the number of bits written to the destination.
+     */
+    unsigned long extractBits(
+        std::uint64_t*       destination,
+        const std::uint64_t* source,
+        const std::uint64_t* mask,
+        unsigned long        numberWords
+    );
+
+    /**
+     * Function that scatters consecutive source bits, starting at bit zero, to the positions selected by a mask.
+     * Destination bits not selected by the mask are cleared.  The BMI2 PDEP instruction is used when the processor
+     * supports it.
+     *
+     * \param[out] destination The destination array.
+     *
+     * \param[in]  source      The source array.  The array must hold at least as many bits as are set in the mask.
+     *
+     * \param[in]  mask        The mask selecting the destination bits.
+     *
+     * \param[in]  numberWords The number of destination and mask words to process.
+     */
+    void depositBits(
+        std::uint64_t*       destination,
+        const std::uint64_t* source,
+        const std::uint64_t* mask,
+        unsigned long        numberWords
+    );
+
+    /**
+     * Function that packs an array of bytes into bits, one bit per byte.  A bit is set if its byte is non-zero.  Bits
+     * past the last byte are cleared in the final destination word.
+     *
+     * \param[out] destination The destination array.  The array must hold (numberBits + 63) / 64 words.
+     *
+     * \param[in]  source      The source bytes.
+     *
+     * \param[in]  numberBits  The number of bytes to pack.
+     */
+    void packBytes(std::uint64_t* destination, const std::uint8_t* source, unsigned long numberBits);
+
+    /**
+     * Function that unpacks bits into an array of bytes, one byte per bit.  Each byte is set to 1 if its bit is set
+     * and 0 if its bit is cleared.
+     *
+     * \param[out] destination The destination bytes.
+     *
+     * \param[in]  source      The source array.
+     *
+     * \param[in]  numberBits  The number of bits to unpack.
+     */
+    void unpackBytes(std::uint8_t* destination, const std::uint64_t* source, unsigned long numberBits);
+}
+
+#endif
@@ -0,0 +1,602 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref Util::BitMatrix class.
+***********************************************************************************************************************/
+
+#include <QList>
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "util_common.h"
+#include "util_bit_array.h"
+#include "util_bit_array_allocator.h"
+#include "util_bit_functions.h"
+#include "util_bit_kernels.h"
+#include "util_parallel_word_range.h"
+#include "util_bit_matrix.h"
+
+namespace Util {
+    /**
+     * The number of source rows combined by each Four Russians lookup table.
+     */
+    static constexpr unsigned rowsPerTable = 8;
+
+    /**
+     * The number of entries in each Four Russians lookup table.
+     */
+    static constexpr unsigned entriesPerTable = 1U << rowsPerTable;
+
+    /**
+     * Function that transposes a 64 by 64 bit block in place.  Bit c of word r is exchanged with bit r of word c.
+     *
+     * \param[in,out] block The 64 words of the block.
+     */
+    static void transposeBlock(std::uint64_t* block) {
+        // Swap the off-diagonal quadrants then repeat within each quadrant, halving the quadrant size on each pass.
+
+        std::uint64_t mask = 0x00000000FFFFFFFFULL;
+        for (unsigned width=32 ; width!=0 ; width >>= 1, mask ^= mask << width) {
+            for (unsigned index=0 ; index<64 ; index = ((index | width) + 1) & ~width) {
+                std::uint64_t swapped = ((block[index] >> width) ^ block[index | width]) & mask;
+
+                block[index]         ^= swapped << width;
+                block[index | width] ^= swapped;
+            }
+        }
+    }
+
+
+    /**
+     * Function that builds the Four Russians lookup tables for a block of up to 64 consecutive source rows.  Entry e
+     * of table t holds the OR of the source rows selected by the bits of e, counting from source row
+     * firstRow + t * rowsPerTable.
+     *
+     * \param[out] tables      Vector to receive the tables.
+     *
+     * \param[in]  rows        The words of the source matrix.
+     *
+     * \param[in]  wordsPerRow The number of words in each source row.
+     *
+     * \param[in]  firstRow    The first source row in the block.
+     *
+     * \param[in]  numberRows  The number of source rows in the block.
+     */
+    static void buildTables(
+            std::vector<std::uint64_t>& tables,
+            const std::uint64_t*        rows,
+            unsigned long               wordsPerRow,
+            unsigned long               firstRow,
+            unsigned                    numberRows
+        ) {
+        unsigned numberTables = (numberRows + rowsPerTable - 1) / rowsPerTable;
+        tables.resize(numberTables * entriesPerTable * wordsPerRow);
+
+        for (unsigned table=0 ; table<numberTables ; ++table) {
+            unsigned             tableRows = std::min(rowsPerTable, numberRows - table * rowsPerTable);
+            const std::uint64_t* source    = rows + (firstRow + table * rowsPerTable) * wordsPerRow;
+            std::uint64_t*       entries   = tables.data() + table * entriesPerTable * wordsPerRow;
+
+            // Each entry extends an earlier entry by its lowest selected row.  Entries selecting rows past the end of
+            // the block are never used and are left unset.
+
+            std::fill(entries, entries + wordsPerRow, 0);
+            for (unsigned entry=1 ; entry<(1U << tableRows) ; ++entry) {
+                bitwiseOr(
+                    entries + entry * wordsPerRow,
+                    entries + (entry & (entry - 1)) * wordsPerRow,
+                    source + lsbLocation32(entry) * wordsPerRow,
+                    wordsPerRow
+                );
+            }
+        }
+    }
+
+
+    /**
+     * Function that ORs Four Russians table entries into a range of destination rows.  One word of each selector row
+     * picks the source rows to be ORed into the matching destination row.
+     *
+     * \param[in,out] destination           The words of the destination matrix.
+     *
+     * \param[in]     destinationWordsPerRow The number of words in each destination row.
+     *
+     * \param[in]     selectors             The words of the selector matrix.  The matrix may be the destination
+     *                                      matrix.
+     *
+     * \param[in]     selectorWordsPerRow   The number of words in each selector row.
+     *
+     * \param[in]     selectorWord          The index of the selector word within each selector row.
+     *
+     * \param[in]     tables                The lookup tables.
+     *
+     * \param[in]     startingRow           The first row to be updated.
+     *
+     * \param[in]     endingRow             The row just past the last row to be updated.
+     */
+    static void accumulateRows(
+            std::uint64_t*       destination,
+            unsigned long        destinationWordsPerRow,
+            const std::uint64_t* selectors,
+            unsigned long        selectorWordsPerRow,
+            unsigned long        selectorWord,
+            const std::uint64_t* tables,
+            unsigned long        startingRow,
+            unsigned long        endingRow
+        ) {
+        for (unsigned long row=startingRow ; row<endingRow ; ++row) {
+            std::uint64_t  selector = selectors[row * selectorWordsPerRow + selectorWord];
+            std::uint64_t* rowWords = destination + row * destinationWordsPerRow;
+
+            unsigned table = 0;
+            while (selector != 0) {
+                unsigned entry = static_cast<unsigned>(selector & (entriesPerTable - 1));
+                if (entry != 0) {
+                    bitwiseOr(
+                        rowWords,
+                        rowWords,
+                        tables + (table * entriesPerTable + entry) * destinationWordsPerRow,
+                        destinationWordsPerRow
+                    );
+                }
+
+                selector >>= rowsPerTable;
+                ++table;
+            }
+        }
+    }
+
+
+    /**
+     * Function that ORs Four Russians table entries into every destination row, spreading the rows across the global
+     * thread pool.
+     *
+     * \param[in,out] destination           The words of the destination matrix.
+     *
+     * \param[in]     destinationWordsPerRow The number of words in each destination row.
+     *
+     * \param[in]     numberRows            The number of destination rows.
+     *
+     * \param[in]     selectors             The words of the selector matrix.  The matrix may be the destination
+     *                                      matrix.
+     *
+     * \param[in]     selectorWordsPerRow   The number of words in each selector row.
+     *
+     * \param[in]     selectorWord          The index of the selector word within each selector row.
+     *
+     * \param[in]     tables                The lookup tables.
+     */
+    static void accumulateBlock(
+            std::uint64_t*       destination,
+            unsigned long        destinationWordsPerRow,
+            unsigned long        numberRows,
+            const std::uint64_t* selectors,
+            unsigned long        selectorWordsPerRow,
+            unsigned long        selectorWord,
+            const std::uint64_t* tables
+        ) {
+        ParallelWordRange(0, numberRows * destinationWordsPerRow).run(
+            [=](unsigned, unsigned long startingWord, unsigned long endingWord) {
+                // A row belongs to the chunk holding its first word so each row is updated by exactly one thread.
+
+                accumulateRows(
+                    destination,
+                    destinationWordsPerRow,
+                    selectors,
+                    selectorWordsPerRow,
+                    selectorWord,
+                    tables,
+                    (startingWord + destinationWordsPerRow - 1) / destinationWordsPerRow,
+                    (endingWord + destinationWordsPerRow - 1) / destinationWordsPerRow
+                );
+            }
+        );
+    }
+
+
+    BitMatrix::BitMatrix():currentNumberRows(0),currentNumberColumns(0),currentWordsPerRow(0) {}
+
+
+    BitMatrix::BitMatrix(
+            BitMatrix::Index   numberRows,
+            BitMatrix::Index   numberColumns,
+            bool               value,
+            BitArrayAllocator* allocator
+        ):bits(
+            numberRows * ((numberColumns + 63) / 64) * 64,
+            value,
+            allocator
+        ),currentNumberRows(
+            numberRows
+        ),currentNumberColumns(
+            numberColumns
+        ),currentWordsPerRow(
+            (numberColumns + 63) / 64
+        ) {
+        unsigned unusedBits = static_cast<unsigned>(currentWordsPerRow * 64 - numberColumns);
+        if (value && unusedBits > 0 && numberRows > 0) {
+            // Bits past the last column are kept cleared so that whole words can be compared and counted.
+
+            BitArray::Mutator mutator(bits);
+            std::uint64_t*    words = mutator.words();
+            std::uint64_t     mask  = static_cast<std::uint64_t>(-1) >> unusedBits;
+
+            for (Index row=0 ; row<numberRows ; ++row) {
+                words[(row + 1) * currentWordsPerRow - 1] &= mask;
+            }
+        }
+    }
+
+
+    BitMatrix::BitMatrix(
+            const QList<BitArray>& rows
+        ):currentNumberRows(
+            static_cast<Index>(rows.size())
+        ),currentNumberColumns(
+            0
+        ) {
+        for (const BitArray& row : rows) {
+            currentNumberColumns = std::max(currentNumberColumns, row.size());
+        }
+
+        currentWordsPerRow = (currentNumberColumns + 63) / 64;
+        bits               = BitArray(currentNumberRows * currentWordsPerRow * 64);
+
+        if (currentWordsPerRow > 0) {
+            BitArray::Mutator mutator(bits);
+            std::uint64_t*    words = mutator.words();
+
+            for (Index row=0 ; row<currentNumberRows ; ++row) {
+                const BitArray& source = rows.at(static_cast<int>(row));
+                std::copy(
+                    source.constData(),
+                    source.constData() + (source.size() + 63) / 64,
+                    words + row * currentWordsPerRow
+                );
+            }
+        }
+    }
+
+
+    BitMatrix::BitMatrix(
+            const BitMatrix& other
+        ):bits(
+            other.bits
+        ),currentNumberRows(
+            other.currentNumberRows
+        ),currentNumberColumns(
+            other.currentNumberColumns
+        ),currentWordsPerRow(
+            other.currentWordsPerRow
+        ) {}
+
+
+    BitMatrix::BitMatrix(
+            BitMatrix&& other
+        ):bits(
+            std::move(other.bits)
+        ),currentNumberRows(
+            other.currentNumberRows
+        ),currentNumberColumns(
+            other.currentNumberColumns
+        ),currentWordsPerRow(
+            other.currentWordsPerRow
+        ) {
+        other.currentNumberRows    = 0;
+        other.currentNumberColumns = 0;
+        other.currentWordsPerRow   = 0;
+    }
+
+
+    BitMatrix::~BitMatrix() {}
+
+
+    BitMatrix BitMatrix::identity(BitMatrix::Index size, BitArrayAllocator* allocator) {
+        BitMatrix result(size, size, false, allocator);
+        for (Index index=0 ; index<size ; ++index) {
+            result.setBit(index, index);
+        }
+
+        return result;
+    }
+
+
+    BitMatrix::Index BitMatrix::numberRows() const {
+        return currentNumberRows;
+    }
+
+
+    BitMatrix::Index BitMatrix::numberColumns() const {
+        return currentNumberColumns;
+    }
+
+
+    bool BitMatrix::isEmpty() const {
+        return currentNumberRows == 0 || currentNumberColumns == 0;
+    }
+
+
+    BitMatrix::Index BitMatrix::wordsPerRow() const {
+        return currentWordsPerRow;
+    }
+
+
+    const std::uint64_t* BitMatrix::rowData(BitMatrix::Index row) const {
+        assert(row < currentNumberRows);
+        return bits.constData() + row * currentWordsPerRow;
+    }
+
+
+    BitMatrix::Index BitMatrix::popcount() const {
+        return bits.popcount();
+    }
+
+
+    BitMatrix::Index BitMatrix::rowPopcount(BitMatrix::Index row) const {
+        return populationCount(rowData(row), currentWordsPerRow);
+    }
+
+
+    bool BitMatrix::isSet(BitMatrix::Index row, BitMatrix::Index column) const {
+        assert(row < currentNumberRows && column < currentNumberColumns);
+        return bits.isSet(row * currentWordsPerRow * 64 + column);
+    }
+
+
+    void BitMatrix::setBit(BitMatrix::Index row, BitMatrix::Index column, bool nowSet) {
+        assert(row < currentNumberRows && column < currentNumberColumns);
+        bits.setBit(row * currentWordsPerRow * 64 + column, nowSet);
+    }
+
+
+    void BitMatrix::clearBit(BitMatrix::Index row, BitMatrix::Index column) {
+        setBit(row, column, false);
+    }
+
+
+    BitArray BitMatrix::row(BitMatrix::Index row) const {
+        return BitArray(rowData(row), currentNumberColumns);
+    }
+
+
+    void BitMatrix::setRow(BitMatrix::Index row, const BitArray& rowBits) {
+        assert(row < currentNumberRows && rowBits.size() <= currentNumberColumns);
+
+        BitArray::Mutator mutator(bits);
+        std::uint64_t*    rowWords    = mutator.words() + row * currentWordsPerRow;
+        unsigned long     sourceWords = (rowBits.size() + 63) / 64;
+
+        std::copy(rowBits.constData(), rowBits.constData() + sourceWords, rowWords);
+        std::fill(rowWords + sourceWords, rowWords + currentWordsPerRow, 0);
+    }
+
+
+    QList<BitArray> BitMatrix::toRows() const {
+        QList<BitArray> result;
+        for (Index index=0 ; index<currentNumberRows ; ++index) {
+            result.append(row(index));
+        }
+
+        return result;
+    }
+
+
+    void BitMatrix::orRow(BitMatrix::Index destinationRow, BitMatrix::Index sourceRow) {
+        assert(destinationRow < currentNumberRows && sourceRow < currentNumberRows);
+
+        BitArray::Mutator mutator(bits);
+        std::uint64_t*    destination = mutator.words() + destinationRow * currentWordsPerRow;
+
+        bitwiseOr(destination, destination, mutator.words() + sourceRow * currentWordsPerRow, currentWordsPerRow);
+    }
+
+
+    void BitMatrix::orRow(BitMatrix::Index destinationRow, const BitArray& rowBits) {
+        assert(destinationRow < currentNumberRows && rowBits.size() <= currentNumberColumns);
+
+        BitArray::Mutator mutator(bits);
+        std::uint64_t*    destination = mutator.words() + destinationRow * currentWordsPerRow;
+
+        bitwiseOr(destination, destination, rowBits.constData(), (rowBits.size() + 63) / 64);
+    }
+
+
+    void BitMatrix::andRow(BitMatrix::Index destinationRow, BitMatrix::Index sourceRow) {
+        assert(destinationRow < currentNumberRows && sourceRow < currentNumberRows);
+
+        BitArray::Mutator mutator(bits);
+        std::uint64_t*    destination = mutator.words() + destinationRow * currentWordsPerRow;
+
+        bitwiseAnd(destination, destination, mutator.words() + sourceRow * currentWordsPerRow, currentWordsPerRow);
+    }
+
+
+    void BitMatrix::andRow(BitMatrix::Index destinationRow, const BitArray& rowBits) {
+        assert(destinationRow < currentNumberRows && rowBits.size() <= currentNumberColumns);
+
+        BitArray::Mutator mutator(bits);
+        std::uint64_t*    destination = mutator.words() + destinationRow * currentWordsPerRow;
+        unsigned long     sourceWords = (rowBits.size() + 63) / 64;
+
+        bitwiseAnd(destination, destination, rowBits.constData(), sourceWords);
+        std::fill(destination + sourceWords, destination + currentWordsPerRow, 0);
+    }
+
+
+    BitMatrix BitMatrix::transposed() const {
+        BitMatrix result(currentNumberColumns, currentNumberRows, false, bits.allocator());
+
+        if (!result.isEmpty()) {
+            BitArray::Mutator    mutator(result.bits);
+            std::uint64_t*       destination = mutator.words();
+            const std::uint64_t* source      = bits.constData();
+            std::uint64_t        block[64];
+
+            for (Index rowWord=0 ; rowWord<result.currentWordsPerRow ; ++rowWord) {
+                Index firstRow        = rowWord * 64;
+                Index numberBlockRows = std::min(currentNumberRows - firstRow, Index(64));
+
+                for (Index columnWord=0 ; columnWord<currentWordsPerRow ; ++columnWord) {
+                    Index firstColumn        = columnWord * 64;
+                    Index numberBlockColumns = std::min(currentNumberColumns - firstColumn, Index(64));
+
+                    for (Index index=0 ; index<numberBlockRows ; ++index) {
+                        block[index] = source[(firstRow + index) * currentWordsPerRow + columnWord];
+                    }
+
+                    std::fill(block + numberBlockRows, block + 64, 0);
+                    transposeBlock(block);
+
+                    for (Index index=0 ; index<numberBlockColumns ; ++index) {
+                        destination[(firstColumn + index) * result.currentWordsPerRow + rowWord] = block[index];
+                    }
+                }
+            }
+        }
+
+        return result;
+    }
+
+
+    BitMatrix BitMatrix::multiplied(const BitMatrix& other) const {
+        assert(currentNumberColumns == other.currentNumberRows);
+
+        BitMatrix result(currentNumberRows, other.currentNumberColumns, false, bits.allocator());
+
+        if (!result.isEmpty()) {
+            BitArray::Mutator          mutator(result.bits);
+            std::vector<std::uint64_t> tables;
+
+            // Each word of a row of this matrix selects up to 64 rows of the other matrix.  Those rows are combined
+            // into lookup tables once and then shared by every row of the result.
+
+            for (Index word=0 ; word<currentWordsPerRow ; ++word) {
+                Index    firstSource   = word * 64;
+                unsigned numberSources = static_cast<unsigned>(std::min(currentNumberColumns - firstSource, Index(64)));
+
+                buildTables(tables, other.bits.constData(), other.currentWordsPerRow, firstSource, numberSources);
+                accumulateBlock(
+                    mutator.words(),
+                    result.currentWordsPerRow,
+                    currentNumberRows,
+                    bits.constData(),
+                    currentWordsPerRow,
+                    word,
+                    tables.data()
+                );
+            }
+        }
+
+        return result;
+    }
+
+
+    BitMatrix BitMatrix::transitiveClosure() const {
+        assert(currentNumberRows == currentNumberColumns);
+
+        BitMatrix result(*this);
+
+        if (!result.isEmpty()) {
+            BitArray::Mutator          mutator(result.bits);
+            std::uint64_t*             words = mutator.words();
+            std::vector<std::uint64_t> tables;
+
+            // Warshall's algorithm is applied 64 pivots at a time.  The pivot rows are first brought up to date with
+            // respect to each other.  Each pivot row then holds everything reachable through the block's pivots, so
+            // every row can be updated by ORing in the pivot rows it selects, using Four Russians lookup tables.
+
+            for (Index word=0 ; word<currentWordsPerRow ; ++word) {
+                Index    firstPivot   = word * 64;
+                unsigned numberPivots = static_cast<unsigned>(std::min(currentNumberRows - firstPivot, Index(64)));
+
+                for (unsigned pivot=0 ; pivot<numberPivots ; ++pivot) {
+                    const std::uint64_t* pivotWords = words + (firstPivot + pivot) * currentWordsPerRow;
+
+                    for (unsigned row=0 ; row<numberPivots ; ++row) {
+                        std::uint64_t* rowWords = words + (firstPivot + row) * currentWordsPerRow;
+                        if (row != pivot && ((rowWords[word] >> pivot) & 1) != 0) {
+                            bitwiseOr(rowWords, rowWords, pivotWords, currentWordsPerRow);
+                        }
+                    }
+                }
+
+                buildTables(tables, words, currentWordsPerRow, firstPivot, numberPivots);
+                accumulateBlock(
+                    words,
+                    currentWordsPerRow,
+                    currentNumberRows,
+                    words,
+                    currentWordsPerRow,
+                    word,
+                    tables.data()
+                );
+            }
+        }
+
+        return result;
+    }
+
+
+    BitMatrix& BitMatrix::operator=(const BitMatrix& other) {
+        bits                 = other.bits;
+        currentNumberRows    = other.currentNumberRows;
+        currentNumberColumns = other.currentNumberColumns;
+        currentWordsPerRow   = other.currentWordsPerRow;
+
+        return *this;
+    }
+
+
+    BitMatrix& BitMatrix::operator=(BitMatrix&& other) {
+        bits = std::move(other.bits);
+        std::swap(currentNumberRows, other.currentNumberRows);
+        std::swap(currentNumberColumns, other.currentNumberColumns);
+        std::swap(currentWordsPerRow, other.currentWordsPerRow);
+
+        return *this;
+    }
+
+
+    bool BitMatrix::operator==(const BitMatrix& other) const {
+        return (
+               currentNumberRows == other.currentNumberRows
+            && currentNumberColumns == other.currentNumberColumns
+            && bits == other.bits
+        );
+    }
+
+
+    bool BitMatrix::operator!=(const BitMatrix& other) const {
+        return !operator==(other);
+    }
+
+
+    BitMatrix BitMatrix::operator*(const BitMatrix& other) const {
+        return multiplied(other);
+    }
+}
@@ -28,12 +28,15 @@
 #include <QString>
 #include <QHash>
 #include <QList>
+#include <QVector>
 
 #include <cstdint>
 #include <algorithm>
+#include <limits>
 
 #include "util_bit_functions.h"
 #include "util_hash_functions.h"
+#include "util_bit_kernels.h"
 #include "util_bit_set.h"
 
 /***********************************************************************************************************************
@@ -41,9 +44,84 @@
  */
 
 namespace Util {
+    constexpr unsigned BitSet::Handle::invalidBitIndex;
+
+    /**
+     * Function that determines if every word in a range is zero.
+     *
+     * \param[in] words       The first word in the range.
+     *
+     * \param[in] numberWords The number of words in the range.
+     *
+     * \return Returns true if every word is zero.
+     */
+    static bool allZero(const std::uint64_t* words, unsigned numberWords) {
+        return std::all_of(words, words + numberWords, [](std::uint64_t word) { return word == 0; });
+    }
+
+
+    BitSet::BitNameHash::BitNameHash() {}
+
+
+    BitSet::BitNameHash::~BitNameHash() {}
+
+
+    BitSet::BitNameHash::iterator BitSet::BitNameHash::insert(const QString& bitName, unsigned bitIndex) {
+        remove(bitName);
+
+        Q_ASSERT(bitIndex < static_cast<unsigned>(std::numeric_limits<int>::max()));
+        int tableIndex = static_cast<int>(bitIndex);
+        if (tableIndex >= bitNamesByIndex.size()) {
+            bitNamesByIndex.resize(tableIndex + 1);
+        }
+
+        bitNamesByIndex[tableIndex] = bitName;
+        return QHash<QString, unsigned>::insert(bitName, bitIndex);
+    }
+
+
+    int BitSet::BitNameHash::remove(const QString& bitName) {
+        int result;
+
+        if (contains(bitName)) {
+            take(bitName);
+            result = 1;
+        } else {
+            result = 0;
+        }
+
+        return result;
+    }
+
+
+    unsigned BitSet::BitNameHash::take(const QString& bitName) {
+        unsigned bitIndex = QHash<QString, unsigned>::take(bitName);
+
+        if (bitIndex < static_cast<unsigned>(bitNamesByIndex.size())
+            && bitNamesByIndex.at(static_cast<int>(bitIndex)) == bitName) {
+            bitNamesByIndex[static_cast<int>(bitIndex)] = QString();
+        }
+
+        return bitIndex;
+    }
+
+
+    void BitSet::BitNameHash::clear() {
+        QHash<QString, unsigned>::clear();
+        bitNamesByIndex.clear();
+    }
+
+
+    QString BitSet::BitNameHash::bitName(unsigned bitIndex) const {
+        return   bitIndex < static_cast<unsigned>(bitNamesByIndex.size())
+               ? bitNamesByIndex.at(static_cast<int>(bitIndex))
+               : QString();
+    }
+
+
     BitSet::BitSet(BitSet::BitNameHash* bitHash) {
         bitNames = bitHash;
-        bitArray.clear();
+        bitArray.fill(0, static_cast<int>(requiredWords()));
     }
 
 
@@ -80,33 +158,35 @@ namespace Util {
     }
 
 
-    bool BitSet::setBit(const QString& bitName, bool isSet) {
-        bool success = false;
-
-        if (bitNames != Q_NULLPTR) {
-            unsigned bitIndex = bitNames->value(bitName, static_cast<unsigned>(-1));
+    BitSet::Handle BitSet::registerBit(BitSet::BitNameHash* bitHash, const QString& bitName) {
+        Q_ASSERT(bitHash != Q_NULLPTR);
 
-            if (bitIndex != static_cast<unsigned>(-1)) {
-                unsigned wordIndex = bitIndex / bitsPerEntry;
-                unsigned bitOffset = bitIndex % bitsPerEntry;
+        unsigned bitIndex = bitHash->value(bitName, Handle::invalidBitIndex);
+        if (bitIndex == Handle::invalidBitIndex) {
+            bitIndex = static_cast<unsigned>(bitHash->size());
+            bitHash->insert(bitName, bitIndex);
+        }
 
-                while (wordIndex >= static_cast<unsigned>(bitArray.size())) {
-                    bitArray.append(0);
-                }
+        return Handle(bitHash, bitIndex);
+    }
 
-                ArrayType mask = static_cast<ArrayType>(1) << bitOffset;
 
-                if (isSet) {
-                    bitArray[wordIndex] |= mask;
-                } else {
-                    bitArray[wordIndex] &= ~mask;
-                }
+    BitSet::Handle BitSet::handle(const QString& bitName) const {
+        Handle result;
 
-                success = true;
+        if (bitNames != Q_NULLPTR) {
+            unsigned bitIndex = bitNames->value(bitName, Handle::invalidBitIndex);
+            if (bitIndex != Handle::invalidBitIndex) {
+                result = Handle(bitNames, bitIndex);
             }
         }
 
-        return success;
+        return result;
+    }
+
+
+    bool BitSet::setBit(const QString& bitName, bool isSet) {
+        return setBit(handle(bitName), isSet);
     }
 
 
@@ -116,21 +196,7 @@ namespace Util {
 
 
     unsigned BitSet::numberSetBits() const {
-        unsigned countBits   = 0;
-        unsigned numberWords = static_cast<unsigned>(bitArray.size());
-        for (unsigned index=0 ; index<numberWords ; ++index) {
-            ArrayType word = bitArray.at(index);
-
-            if (bitsPerEntry == 32) {
-                countBits += numberOnes32(word);
-            } else if (bitsPerEntry == 64) {
-                countBits += numberOnes64(word);
-            } else {
-                assert(false);
-            }
-        }
-
-        return countBits;
+        return static_cast<unsigned>(populationCount(bitArray.constData(), static_cast<unsigned>(bitArray.size())));
     }
 
 
@@ -145,24 +211,7 @@ namespace Util {
 
 
     bool BitSet::isSet(const QString& bitName) const {
-        bool result = false;
-
-        if (bitNames != Q_NULLPTR) {
-            unsigned bitIndex = bitNames->value(bitName, static_cast<unsigned>(-1));
-
-            if (bitIndex != static_cast<unsigned>(-1)) {
-                unsigned wordIndex = bitIndex / bitsPerEntry;
-
-                if (wordIndex < static_cast<unsigned>(bitArray.size())) {
-                    unsigned  bitOffset = bitIndex % bitsPerEntry;
-                    ArrayType mask      = static_cast<ArrayType>(1) << bitOffset;
-
-                    result = (bitArray.at(wordIndex) & mask) != 0;
-                }
-            }
-        }
-
-        return result;
+        return isSet(handle(bitName));
     }
 
 
@@ -185,11 +234,9 @@ namespace Util {
 
         BitSet combined;
         combined.bitNames = bitNames;
+        combined.bitArray.resize(static_cast<int>(numberCommonWords));
 
-        unsigned index;
-        for (index=0 ; index<numberCommonWords ; ++index) {
-            combined.bitArray.append(bitArray.at(index) & other.bitArray.at(index));
-        }
+        bitwiseAnd(combined.bitArray.data(), bitArray.constData(), other.bitArray.constData(), numberCommonWords);
 
         return combined;
     }
@@ -198,37 +245,29 @@ namespace Util {
     BitSet BitSet::unionBits(const BitSet& other) const {
         Q_ASSERT(bitNames == other.bitNames);
 
-        unsigned numberWords       = static_cast<unsigned>(bitArray.size());
-        unsigned otherNumberWords  = static_cast<unsigned>(other.bitArray.size());
-        unsigned numberCommonWords = std::min(numberWords, otherNumberWords);
+        unsigned         numberWords       = static_cast<unsigned>(bitArray.size());
+        unsigned         otherNumberWords  = static_cast<unsigned>(other.bitArray.size());
+        unsigned         numberCommonWords = std::min(numberWords, otherNumberWords);
+        unsigned         numberLongerWords = std::max(numberWords, otherNumberWords);
+        const ArrayType* longer            = (
+            numberWords > otherNumberWords ? bitArray.constData() : other.bitArray.constData()
+        );
 
         BitSet combined;
         combined.bitNames = bitNames;
+        combined.bitArray.resize(static_cast<int>(numberLongerWords));
 
-        unsigned index;
-        for (index=0 ; index<numberCommonWords ; ++index) {
-            combined.bitArray.append(bitArray.at(index) | other.bitArray.at(index));
-        }
-
-        if (numberWords < otherNumberWords) {
-            do {
-                combined.bitArray.append(other.bitArray.at(index));
-                ++index;
-            }
-            while (index < otherNumberWords);
-        } else if (numberWords > otherNumberWords) {
-            do {
-                combined.bitArray.append(bitArray.at(index));
-                ++index;
-            }
-            while (index < numberWords);
-        }
+        ArrayType* combinedWords = combined.bitArray.data();
+        bitwiseOr(combinedWords, bitArray.constData(), other.bitArray.constData(), numberCommonWords);
+        std::copy(longer + numberCommonWords, longer + numberLongerWords, combinedWords + numberCommonWords);
 
         return combined;
     }
 
 
     bool BitSet::intersects(const BitSet& other) const {
+        bool result = false;
+
         if (bitNames != Q_NULLPTR && other.bitNames != Q_NULLPTR) {
             Q_ASSERT(bitNames == other.bitNames);
 
@@ -236,78 +275,43 @@ namespace Util {
             unsigned otherNumberWords  = static_cast<unsigned>(other.bitArray.size());
             unsigned numberCommonWords = std::min(numberWords, otherNumberWords);
 
-            for (unsigned index=0 ; index<numberCommonWords ; ++index) {
-                if (bitArray.at(index) & other.bitArray.at(index)) {
-                    return true;
-                }
-            }
+            result = bitwiseIntersects(bitArray.constData(), other.bitArray.constData(), numberCommonWords);
         }
 
-        return false;
+        return result;
     }
 
 
     bool BitSet::sameAs(const BitSet& other) const {
-        if (bitNames != other.bitNames) {
-            return false;
-        } else {
-            unsigned numberWords       = static_cast<unsigned>(bitArray.size());
-            unsigned otherNumberWords  = static_cast<unsigned>(other.bitArray.size());
-            unsigned numberCommonWords = std::min(numberWords, otherNumberWords);
+        bool result = false;
 
-            unsigned index;
-            for (index=0 ; index<numberCommonWords ; ++index) {
-                if (bitArray.at(index) != other.bitArray.at(index)) {
-                    return false;
-                }
-            }
+        if (bitNames == other.bitNames) {
+            unsigned         numberWords       = static_cast<unsigned>(bitArray.size());
+            unsigned         otherNumberWords  = static_cast<unsigned>(other.bitArray.size());
+            unsigned         numberCommonWords = std::min(numberWords, otherNumberWords);
+            const ArrayType* words             = bitArray.constData();
+            const ArrayType* otherWords        = other.bitArray.constData();
 
-            if (numberWords < otherNumberWords) {
-                do {
-                    if (other.bitArray.at(index) != 0) {
-                        return false;
-                    }
-
-                    ++index;
-                } while (index < otherNumberWords);
-            } else if (numberWords > otherNumberWords) {
-                do {
-                    if (bitArray.at(index) != 0) {
-                        return false;
-                    }
-
-                    ++index;
-                } while (index < numberWords);
-            }
+            // Sets sized at different times may differ in length, the extra words must then be zero.
 
-            return true;
+            result = (
+                   std::equal(words, words + numberCommonWords, otherWords)
+                && allZero(words + numberCommonWords, numberWords - numberCommonWords)
+                && allZero(otherWords + numberCommonWords, otherNumberWords - numberCommonWords)
+            );
         }
+
+        return result;
     }
 
 
     bool BitSet::isEmpty() const {
-        unsigned  numberWords = static_cast<unsigned>(bitArray.size());
-
-        for (unsigned index=0 ; index<numberWords ; ++index) {
-            if (bitArray.at(index) != 0) {
-                return false;
-            }
-        }
-
-        return true;
+        return allZero(bitArray.constData(), static_cast<unsigned>(bitArray.size()));
     }
 
 
     bool BitSet::isNotEmpty() const {
-        unsigned  numberWords = static_cast<unsigned>(bitArray.size());
-
-        for (unsigned index=0 ; index<numberWords ; ++index) {
-            if (bitArray.at(index) != 0) {
-                return true;
-            }
-        }
-
-        return false;
+        return !isEmpty();
     }
 
 
@@ -326,11 +330,11 @@ namespace Util {
         QList<QString> setNames;
 
         if (bitNames != Q_NULLPTR) {
-            QList<QString> allNames = bitNames->keys();
-            for (QList<QString>::const_iterator it=allNames.constBegin(),end=allNames.constEnd() ; it!=end ; ++it) {
-                if (isSet(*it)) {
-                    setNames.append(*it);
-                }
+            QList<unsigned> setIndexes = setBitIndexes();
+
+            setNames.reserve(setIndexes.size());
+            for (unsigned bitIndex : setIndexes) {
+                setNames.append(bitNames->bitName(bitIndex));
             }
         }
 
@@ -338,6 +342,22 @@ namespace Util {
     }
 
 
+    QList<unsigned> BitSet::setBitIndexes() const {
+        QList<unsigned> setIndexes;
+
+        unsigned numberWords = static_cast<unsigned>(bitArray.size());
+        for (unsigned wordIndex=0 ; wordIndex<numberWords ; ++wordIndex) {
+            ArrayType word = bitArray.at(static_cast<int>(wordIndex));
+            while (word != 0) {
+                setIndexes.append(wordIndex * bitsPerEntry + static_cast<unsigned>(lsbLocation64(word)));
+                word &= word - 1;
+            }
+        }
+
+        return setIndexes;
+    }
+
+
     BitSet BitSet::fullSet() const {
         BitSet result;
 
@@ -345,20 +365,13 @@ namespace Util {
             result.bitNames = bitNames;
 
             unsigned numberBits  = static_cast<unsigned>(bitNames->size());
-            unsigned numberWords = (numberBits + bitsPerEntry - 1) / bitsPerEntry;
+            unsigned numberWords = requiredWords();
 
-            if (numberBits > 0) {
-                for (unsigned index=1 ; index<numberWords ; ++index) {
-                    result.bitArray.push_back(static_cast<ArrayType>(-1));
-                }
+            result.bitArray.fill(static_cast<ArrayType>(-1), static_cast<int>(numberWords));
 
-                unsigned remainingBits = numberBits - bitsPerEntry * (numberWords - 1);
-                if (remainingBits == bitsPerEntry) {
-                    result.bitArray.push_back(static_cast<ArrayType>(-1));
-                } else if (remainingBits > 0) {
-                    ArrayType mask = static_cast<ArrayType>((static_cast<ArrayType>(1) << remainingBits) - 1);
-                    result.bitArray.push_back(mask);
-                }
+            unsigned remainingBits = numberBits % bitsPerEntry;
+            if (remainingBits > 0) {
+                result.bitArray[numberWords - 1] = (static_cast<ArrayType>(1) << remainingBits) - 1;
             }
         }
 
@@ -369,30 +382,28 @@ namespace Util {
     BitSet BitSet::complement() const {
         BitSet result = fullSet();
 
-        unsigned numberWords = static_cast<unsigned>(bitArray.size());
-        for (unsigned index=0 ; index<numberWords ; ++index) {
-            ArrayType fullValue = result.bitArray.at(index);
-            ArrayType thisValue = bitArray.at(index);
-            ArrayType newValue  = fullValue & (~thisValue);
+        unsigned numberWords = std::min(
+            static_cast<unsigned>(bitArray.size()),
+            static_cast<unsigned>(result.bitArray.size())
+        );
 
-            result.bitArray[index] = newValue;
-        }
+        ArrayType* resultWords = result.bitArray.data();
+        bitwiseAndNot(resultWords, resultWords, bitArray.constData(), numberWords);
 
         return result;
     }
 
 
     HashResult BitSet::hash(HashSeed seed) const {
-        QList<ArrayType>::const_iterator it        = bitArray.constBegin();
-        QList<ArrayType>::const_iterator end       = bitArray.constEnd();
-        ArrayType                        hashInput = 0;
+        // Trailing zero words are ignored so that equal sets with different array lengths produce the same hash.
 
-        while (it != end) {
-            hashInput += *it;
-            ++it;
+        unsigned numberWords = static_cast<unsigned>(bitArray.size());
+        while (numberWords > 0 && bitArray.at(static_cast<int>(numberWords - 1)) == 0) {
+            --numberWords;
         }
 
-        return qHash(hashInput, seed);
+        std::uint64_t result = hashWords(bitArray.constData(), numberWords, seed);
+        return static_cast<HashResult>(result ^ (result >> 32));
     }
 
 
@@ -514,12 +525,11 @@ namespace Util {
         unsigned numberCommonWords = std::min(numberWords, otherNumberWords);
 
         if (numberWords > numberCommonWords) {
-            bitArray.erase(bitArray.begin() + numberCommonWords, bitArray.end());
+            bitArray.resize(static_cast<int>(numberCommonWords));
         }
 
-        for (unsigned index=0 ; index<numberCommonWords ; ++index) {
-            bitArray[index] &= other.bitArray[index];
-        }
+        ArrayType* words = bitArray.data();
+        bitwiseAnd(words, words, other.bitArray.constData(), numberCommonWords);
 
         return *this;
     }
@@ -528,22 +538,30 @@ namespace Util {
     BitSet& BitSet::operator|=(const BitSet& other) {
         Q_ASSERT(bitNames == other.bitNames);
 
-        unsigned numberWords       = static_cast<unsigned>(bitArray.size());
-        unsigned otherNumberWords  = static_cast<unsigned>(other.bitArray.size());
-        unsigned numberCommonWords = std::min(numberWords, otherNumberWords);
+        unsigned numberWords      = static_cast<unsigned>(bitArray.size());
+        unsigned otherNumberWords = static_cast<unsigned>(other.bitArray.size());
 
-        unsigned index;
-        for (index=0 ; index<numberCommonWords ; ++index) {
-            bitArray[index] |= other.bitArray[index];
+        if (otherNumberWords > numberWords) {
+            bitArray.resize(static_cast<int>(otherNumberWords));
         }
 
-        while (index < otherNumberWords) {
-            bitArray.push_back(other.bitArray[index]);
-            ++index;
-        }
+        ArrayType* words = bitArray.data();
+        bitwiseOr(words, words, other.bitArray.constData(), otherNumberWords);
 
         return *this;
     }
+
+
+    unsigned BitSet::requiredWords() const {
+        return bitNames != Q_NULLPTR ? (static_cast<unsigned>(bitNames->size()) + bitsPerEntry - 1) / bitsPerEntry : 0;
+    }
+
+
+    void BitSet::growToHold(unsigned wordIndex) {
+        // The bit was added to the hash after this set was sized, grow to fit the whole hash at once.
+
+        bitArray.resize(static_cast<int>(std::max(wordIndex + 1, requiredWords())));
+    }
 }
 
 /***********************************************************************************************************************
@@ -555,6 +573,7 @@ namespace Util {
         workingBitSet = Q_NULLPTR;
         workingValue  = 0;
         currentWord   = 0;
+        reportedWord  = static_cast<unsigned>(-1);
     }
 
 
@@ -562,33 +581,20 @@ namespace Util {
         workingBitSet = &bitSet;
         workingValue  = 0;
         currentWord   = 0;
+        reportedWord  = static_cast<unsigned>(-1);
 
-        const QList<BitSet::ArrayType>& workingArray     = workingBitSet->bitArray;
-        unsigned                        workingArraySize = static_cast<unsigned>(workingArray.size());
+        const QVector<BitSet::ArrayType>& workingArray     = workingBitSet->bitArray;
+        unsigned                          workingArraySize = static_cast<unsigned>(workingArray.size());
 
-        if (workingArraySize > 0) {
-            unsigned index = 0;
-            while (index < workingArraySize && workingArray.at(index) == 0) {
-                reportedValue.bitArray.push_back(0);
-                ++index;
-            }
-
-            if (index < workingArraySize) {
-                workingValue           = workingArray.at(index);
-                currentWord            = index;
-                BitSet::ArrayType mask = maskLsbOne(workingValue);
-                reportedValue.bitArray.push_back(mask);
-
-                ++index;
-            }
-
-            while (index < workingArraySize) {
-                reportedValue.bitArray.push_back(0);
-                ++index;
-            }
+        unsigned index = 0;
+        while (index < workingArraySize && workingArray.at(index) == 0) {
+            ++index;
         }
 
-        reportedValue.bitNames = bitSet.bitNames;
+        if (index < workingArraySize) {
+            workingValue = workingArray.at(index);
+            currentWord  = index;
+        }
     }
 
 
@@ -597,6 +603,7 @@ namespace Util {
         workingValue  = other.workingValue;
         currentWord   = other.currentWord;
         reportedValue = other.reportedValue;
+        reportedWord  = other.reportedWord;
     }
 
 
@@ -614,15 +621,13 @@ namespace Util {
 
 
     BitSetForwardIterator& BitSetForwardIterator::operator++() {
-        const QList<BitSet::ArrayType>& workingArray     = workingBitSet->bitArray;
-        unsigned                        workingArraySize = static_cast<unsigned>(workingArray.size());
+        const QVector<BitSet::ArrayType>& workingArray     = workingBitSet->bitArray;
+        unsigned                          workingArraySize = static_cast<unsigned>(workingArray.size());
 
         if (currentWord < workingArraySize) {
-            BitSet::ArrayType mask = reportedValue.bitArray.at(currentWord);
-            workingValue &= ~mask;
+            workingValue &= workingValue - 1;
 
             if (workingValue == 0) {
-                reportedValue.bitArray[currentWord] = 0;
                 ++currentWord;
 
                 while (currentWord < workingArraySize && workingArray.at(currentWord) == 0) {
@@ -631,12 +636,7 @@ namespace Util {
 
                 if (currentWord < workingArraySize) {
                     workingValue = workingArray.at(currentWord);
-                    mask         = maskLsbOne(workingValue);
-                    reportedValue.bitArray[currentWord] = mask;
                 }
-            } else {
-                mask = maskLsbOne(workingValue);
-                reportedValue.bitArray[currentWord] = mask;
             }
         }
 
@@ -653,11 +653,13 @@ namespace Util {
 
 
     const BitSet& BitSetForwardIterator::operator*() const {
+        updateReportedValue();
         return reportedValue;
     }
 
 
     const BitSet* BitSetForwardIterator::operator->() const {
+        updateReportedValue();
         return &reportedValue;
     }
 
@@ -667,6 +669,7 @@ namespace Util {
         workingValue  = other.workingValue;
         currentWord   = other.currentWord;
         reportedValue = other.reportedValue;
+        reportedWord  = other.reportedWord;
 
         return *this;
     }
@@ -687,6 +690,30 @@ namespace Util {
             || currentWord   != other.currentWord
         );
     }
+
+
+    void BitSetForwardIterator::updateReportedValue() const {
+        if (workingBitSet != Q_NULLPTR) {
+            unsigned workingArraySize = static_cast<unsigned>(workingBitSet->bitArray.size());
+
+            // Only the previously reported word needs clearing once the reported value has been sized.
+
+            if (static_cast<unsigned>(reportedValue.bitArray.size()) != workingArraySize) {
+                reportedValue.bitArray.fill(0, static_cast<int>(workingArraySize));
+            } else if (reportedWord < workingArraySize) {
+                reportedValue.bitArray[reportedWord] = 0;
+            }
+
+            reportedValue.bitNames = workingBitSet->bitNames;
+
+            if (workingValue != 0) {
+                reportedWord                        = currentWord;
+                reportedValue.bitArray[currentWord] = maskLsbOne(workingValue);
+            } else {
+                reportedWord = static_cast<unsigned>(-1);
+            }
+        }
+    }
 }
 
 /***********************************************************************************************************************
@@ -698,6 +725,7 @@ namespace Util {
         workingBitSet = Q_NULLPTR;
         workingValue  = 0;
         currentWord   = 0;
+        reportedWord  = static_cast<unsigned>(-1);
     }
 
 
@@ -705,33 +733,20 @@ namespace Util {
         workingBitSet = &bitSet;
         workingValue  = 0;
         currentWord   = 0;
+        reportedWord  = static_cast<unsigned>(-1);
 
-        const QList<BitSet::ArrayType>& workingArray     = workingBitSet->bitArray;
-        unsigned                        workingArraySize = static_cast<unsigned>(workingArray.size());
-
-        if (workingArraySize > 0) {
-            unsigned index = workingArraySize;
-            while (index > 0 && workingArray.at(index - 1) == 0) {
-                reportedValue.bitArray.push_front(0);
-                --index;
-            }
-
-            if (index > 0) {
-                workingValue           = workingArray.at(index - 1);
-                currentWord            = index;
-                BitSet::ArrayType mask = maskMsbOne(workingValue);
-                reportedValue.bitArray.push_front(mask);
+        const QVector<BitSet::ArrayType>& workingArray     = workingBitSet->bitArray;
+        unsigned                          workingArraySize = static_cast<unsigned>(workingArray.size());
 
-                --index;
-            }
-
-            while (index > 0) {
-                reportedValue.bitArray.push_front(0);
-                --index;
-            }
+        unsigned index = workingArraySize;
+        while (index > 0 && workingArray.at(index - 1) == 0) {
+            --index;
         }
 
-        reportedValue.bitNames = bitSet.bitNames;
+        if (index > 0) {
+            workingValue = workingArray.at(index - 1);
+            currentWord  = index;
+        }
     }
 
 
@@ -740,6 +755,7 @@ namespace Util {
         workingValue  = other.workingValue;
         currentWord   = other.currentWord;
         reportedValue = other.reportedValue;
+        reportedWord  = other.reportedWord;
     }
 
 
@@ -757,14 +773,12 @@ namespace Util {
 
 
     BitSetReverseIterator& BitSetReverseIterator::operator++() {
-        const QList<BitSet::ArrayType>& workingArray = workingBitSet->bitArray;
+        const QVector<BitSet::ArrayType>& workingArray = workingBitSet->bitArray;
 
         if (currentWord > 0) {
-            BitSet::ArrayType mask = reportedValue.bitArray.at(currentWord - 1);
-            workingValue &= ~mask;
+            workingValue &= ~maskMsbOne(workingValue);
 
             if (workingValue == 0) {
-                reportedValue.bitArray[currentWord - 1] = 0;
                 --currentWord;
 
                 while (currentWord > 0 && workingArray.at(currentWord - 1) == 0) {
@@ -773,12 +787,7 @@ namespace Util {
 
                 if (currentWord > 0) {
                     workingValue = workingArray.at(currentWord - 1);
-                    mask         = maskMsbOne(workingValue);
-                    reportedValue.bitArray[currentWord - 1] = mask;
                 }
-            } else {
-                mask = maskMsbOne(workingValue);
-                reportedValue.bitArray[currentWord - 1] = mask;
             }
         }
 
@@ -795,11 +804,13 @@ namespace Util {
 
 
     const BitSet& BitSetReverseIterator::operator*() const {
+        updateReportedValue();
         return reportedValue;
     }
 
 
     const BitSet* BitSetReverseIterator::operator->() const {
+        updateReportedValue();
         return &reportedValue;
     }
 
@@ -809,6 +820,7 @@ namespace Util {
         workingValue  = other.workingValue;
         currentWord   = other.currentWord;
         reportedValue = other.reportedValue;
+        reportedWord  = other.reportedWord;
 
         return *this;
     }
@@ -829,4 +841,45 @@ namespace Util {
             || currentWord   != other.currentWord
         );
     }
+
+
+    void BitSetReverseIterator::updateReportedValue() const {
+        if (workingBitSet != Q_NULLPTR) {
+            unsigned workingArraySize = static_cast<unsigned>(workingBitSet->bitArray.size());
+
+            // Only the previously reported word needs clearing once the reported value has been sized.
+
+            if (static_cast<unsigned>(reportedValue.bitArray.size()) != workingArraySize) {
+                reportedValue.bitArray.fill(0, static_cast<int>(workingArraySize));
+            } else if (reportedWord < workingArraySize) {
+                reportedValue.bitArray[reportedWord] = 0;
+            }
+
+            reportedValue.bitNames = workingBitSet->bitNames;
+
+            if (workingValue != 0) {
+                reportedWord                         = currentWord - 1;
+                reportedValue.bitArray[reportedWord] = maskMsbOne(workingValue);
+            } else {
+                reportedWord = static_cast<unsigned>(-1);
+            }
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * Util::BitSetIndexIterator
+ */
+
+namespace Util {
+    QString BitSetIndexIterator::bitName() const {
+        Q_ASSERT(workingBitSet != Q_NULLPTR && workingValue != 0);
+
+        QString result;
+        if (workingBitSet->bitNames != Q_NULLPTR) {
+            result = workingBitSet->bitNames->bitName(operator*());
+        }
+
+        return result;
+    }
 }
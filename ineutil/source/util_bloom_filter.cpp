@@ -0,0 +1,319 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref Util::BloomFilter class.
+***********************************************************************************************************************/
+
+#include <cstdint>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+
+    #include <xmmintrin.h>
+
+    #define UTIL_PREFETCH(_address) _mm_prefetch(reinterpret_cast<const char*>(_address), _MM_HINT_T0)
+
+#elif (defined(__GNUC__) || defined(__clang__))
+
+    #define UTIL_PREFETCH(_address) __builtin_prefetch(_address)
+
+#else
+
+    #define UTIL_PREFETCH(_address)
+
+#endif
+
+#include "util_common.h"
+#include "util_bit_array.h"
+#include "util_bloom_filter.h"
+
+namespace Util {
+    /**
+     * Multiplier of the linear congruential sequence used to derive probe positions from a key hash.
+     */
+    static constexpr std::uint64_t probeMultiplier = 0x5851F42D4C957F2DULL;
+
+    /**
+     * Increment of the linear congruential sequence used to derive probe positions from a key hash.
+     */
+    static constexpr std::uint64_t probeIncrement = 0x14057B7EF767814FULL;
+
+    constexpr unsigned BloomFilter::bitsPerBlock;
+    constexpr unsigned BloomFilter::maximumNumberHashes;
+
+
+    BloomFilter::BloomFilter():numberBlocks(0),currentNumberHashes(1) {}
+
+
+    BloomFilter::BloomFilter(
+            unsigned long      numberBits,
+            unsigned           numberHashes,
+            BitArrayAllocator* allocator
+        ):numberBlocks(
+            (numberBits + bitsPerBlock - 1) / bitsPerBlock
+        ),currentNumberHashes(
+            std::min(std::max(numberHashes, 1U), maximumNumberHashes)
+        ) {
+        bits = BitArray(numberBlocks * bitsPerBlock, false, allocator);
+    }
+
+
+    BloomFilter::BloomFilter(
+            const BloomFilter& other
+        ):bits(
+            other.bits
+        ),numberBlocks(
+            other.numberBlocks
+        ),currentNumberHashes(
+            other.currentNumberHashes
+        ) {}
+
+
+    BloomFilter::~BloomFilter() {}
+
+
+    BloomFilter BloomFilter::forCapacity(unsigned long expectedKeys, double falsePositiveRate) {
+        unsigned long numberBits = optimalNumberBits(expectedKeys, falsePositiveRate);
+        return BloomFilter(numberBits, optimalNumberHashes(numberBits, expectedKeys));
+    }
+
+
+    unsigned long BloomFilter::optimalNumberBits(unsigned long expectedKeys, double falsePositiveRate) {
+        assert(falsePositiveRate > 0 && falsePositiveRate < 1);
+
+        unsigned long result = bitsPerBlock;
+
+        if (expectedKeys > 0) {
+            // Start from the classic estimate and grow until the blocked estimate meets the target.
+
+            double        ln2          = std::log(2.0);
+            double        classicBits  = -static_cast<double>(expectedKeys) * std::log(falsePositiveRate) / (ln2 * ln2);
+            unsigned long numberBlocks = static_cast<unsigned long>(std::ceil(classicBits / bitsPerBlock));
+
+            numberBlocks = std::max(numberBlocks, 1UL);
+            result       = numberBlocks * bitsPerBlock;
+
+            unsigned iteration = 0;
+            while (iteration < 64
+                   && estimatedFalsePositiveRate(
+                          result,
+                          optimalNumberHashes(result, expectedKeys),
+                          expectedKeys
+                      ) > falsePositiveRate) {
+                numberBlocks += numberBlocks / 32 + 1;
+                result        = numberBlocks * bitsPerBlock;
+                ++iteration;
+            }
+        }
+
+        return result;
+    }
+
+
+    unsigned BloomFilter::optimalNumberHashes(unsigned long numberBits, unsigned long expectedKeys) {
+        unsigned result = 1;
+
+        if (expectedKeys > 0) {
+            double optimal = std::round(std::log(2.0) * numberBits / expectedKeys);
+            result = static_cast<unsigned>(std::min(std::max(optimal, 1.0), static_cast<double>(maximumNumberHashes)));
+        }
+
+        return result;
+    }
+
+
+    double BloomFilter::estimatedFalsePositiveRate(
+            unsigned long numberBits,
+            unsigned      numberHashes,
+            unsigned long numberKeys
+        ) {
+        double        result       = numberKeys > 0 ? 1.0 : 0.0;
+        unsigned long numberBlocks = (numberBits + bitsPerBlock - 1) / bitsPerBlock;
+
+        if (numberBlocks > 0 && numberKeys > 0) {
+            // Sum the per-block false positive rate over the likely block loads, weighted by the Poisson
+            // probability of each load.  Probabilities are calculated in log space to avoid underflow.
+
+            double        lambda     = static_cast<double>(numberKeys) / numberBlocks;
+            double        spread     = 12.0 * std::sqrt(lambda) + 12.0;
+            unsigned long firstLoad  = static_cast<unsigned long>(std::max(lambda - spread, 0.0));
+            unsigned long lastLoad   = static_cast<unsigned long>(lambda + spread);
+            double        logLambda  = lambda > 0 ? std::log(lambda) : 0;
+            double        logMissing = std::log1p(-1.0 / bitsPerBlock);
+
+            result = 0;
+            for (unsigned long load=firstLoad ; load<=lastLoad ; ++load) {
+                double logProbability = -lambda + load * logLambda - std::lgamma(load + 1.0);
+                double bitSet         = -std::expm1(load * numberHashes * logMissing);
+
+                result += std::exp(logProbability) * std::pow(bitSet, numberHashes);
+            }
+
+            result = std::min(result, 1.0);
+        }
+
+        return result;
+    }
+
+
+    unsigned long BloomFilter::numberBits() const {
+        return numberBlocks * bitsPerBlock;
+    }
+
+
+    unsigned BloomFilter::numberHashes() const {
+        return currentNumberHashes;
+    }
+
+
+    double BloomFilter::fillRatio() const {
+        return numberBlocks > 0 ? static_cast<double>(bits.popcount()) / (numberBlocks * bitsPerBlock) : 0;
+    }
+
+
+    void BloomFilter::insert(std::uint64_t keyHash) {
+        assert(numberBlocks > 0);
+
+        BitArray::Mutator mutator(bits);
+        setProbes(mutator.words() + blockWordIndex(keyHash), keyHash);
+    }
+
+
+    void BloomFilter::insert(const std::uint64_t* keyHashes, unsigned long numberHashes) {
+        assert(numberBlocks > 0 || numberHashes == 0);
+
+        if (numberHashes > 0) {
+            BitArray::Mutator mutator(bits);
+            std::uint64_t*    words = mutator.words();
+
+            for (unsigned long index=0 ; index<numberHashes ; ++index) {
+                if (index + prefetchDistance < numberHashes) {
+                    UTIL_PREFETCH(words + blockWordIndex(keyHashes[index + prefetchDistance]));
+                }
+
+                setProbes(words + blockWordIndex(keyHashes[index]), keyHashes[index]);
+            }
+        }
+    }
+
+
+    bool BloomFilter::mightContain(std::uint64_t keyHash) const {
+        return numberBlocks > 0 && testProbes(bits.constData() + blockWordIndex(keyHash), keyHash);
+    }
+
+
+    unsigned long BloomFilter::mightContain(
+            const std::uint64_t* keyHashes,
+            unsigned long        numberHashes,
+            bool*                results
+        ) const {
+        unsigned long result = 0;
+
+        if (numberBlocks > 0) {
+            const std::uint64_t* words = bits.constData();
+
+            for (unsigned long index=0 ; index<numberHashes ; ++index) {
+                if (index + prefetchDistance < numberHashes) {
+                    UTIL_PREFETCH(words + blockWordIndex(keyHashes[index + prefetchDistance]));
+                }
+
+                bool present = testProbes(words + blockWordIndex(keyHashes[index]), keyHashes[index]);
+
+                results[index]  = present;
+                result         += present ? 1 : 0;
+            }
+        } else {
+            std::fill(results, results + numberHashes, false);
+        }
+
+        return result;
+    }
+
+
+    bool BloomFilter::unite(const BloomFilter& other) {
+        bool success = (numberBlocks == other.numberBlocks && currentNumberHashes == other.currentNumberHashes);
+
+        if (success) {
+            bits |= other.bits;
+        }
+
+        return success;
+    }
+
+
+    void BloomFilter::clear() {
+        // Clearing a range on an empty array would grow it to hold the range so empty filters are left untouched.
+
+        if (bits.size() > 0) {
+            bits.clearBits(0, bits.size() - 1);
+        }
+    }
+
+
+    BloomFilter& BloomFilter::operator=(const BloomFilter& other) {
+        bits                = other.bits;
+        numberBlocks        = other.numberBlocks;
+        currentNumberHashes = other.currentNumberHashes;
+
+        return *this;
+    }
+
+
+    inline unsigned long BloomFilter::blockWordIndex(std::uint64_t keyHash) const {
+        // Multiply-shift range reduction maps the upper half of the hash onto the blocks without a division.
+
+        return static_cast<unsigned long>(((keyHash >> 32) * numberBlocks) >> 32) * wordsPerBlock;
+    }
+
+
+    inline void BloomFilter::setProbes(std::uint64_t* block, std::uint64_t keyHash) const {
+        std::uint64_t state = keyHash;
+
+        for (unsigned probe=0 ; probe<currentNumberHashes ; ++probe) {
+            state = state * probeMultiplier + probeIncrement;
+
+            unsigned bitIndex = static_cast<unsigned>((state ^ (state >> 29)) >> 55);
+            block[bitIndex / 64] |= static_cast<std::uint64_t>(1) << (bitIndex % 64);
+        }
+    }
+
+
+    inline bool BloomFilter::testProbes(const std::uint64_t* block, std::uint64_t keyHash) const {
+        std::uint64_t state   = keyHash;
+        bool          present = true;
+
+        unsigned probe = 0;
+        while (present && probe < currentNumberHashes) {
+            state = state * probeMultiplier + probeIncrement;
+
+            unsigned bitIndex = static_cast<unsigned>((state ^ (state >> 29)) >> 55);
+            present = (block[bitIndex / 64] & (static_cast<std::uint64_t>(1) << (bitIndex % 64))) != 0;
+            ++probe;
+        }
+
+        return present;
+    }
+}
@@ -0,0 +1,198 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref Util::CompressedBitArray class.
+***********************************************************************************************************************/
+
+#include <QSharedDataPointer>
+#include <QSharedData>
+
+#include "util_bit_array.h"
+#include "util_compressed_bit_array_private.h"
+#include "util_compressed_bit_array.h"
+
+namespace Util {
+    constexpr CompressedBitArray::Index CompressedBitArray::invalidIndex;
+
+    CompressedBitArray::CompressedBitArray() : impl(new CompressedBitArray::Private) {}
+
+
+    CompressedBitArray::CompressedBitArray(
+            CompressedBitArray::Index numberBits
+        ) : impl(
+            new CompressedBitArray::Private(numberBits)
+        ) {}
+
+
+    CompressedBitArray::CompressedBitArray(
+            const BitArray& bitArray
+        ) : impl(
+            new CompressedBitArray::Private(bitArray)
+        ) {}
+
+
+    CompressedBitArray::CompressedBitArray(const CompressedBitArray& other) {
+        impl = other.impl;
+    }
+
+
+    CompressedBitArray::~CompressedBitArray() {}
+
+
+    BitArray CompressedBitArray::toBitArray() const {
+        return impl->toBitArray();
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::size() const {
+        return impl->length();
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::length() const {
+        return impl->length();
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::popcount() const {
+        return impl->popcount();
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::memoryUsage() const {
+        return impl->memoryUsage();
+    }
+
+
+    void CompressedBitArray::clear() {
+        impl->clear();
+    }
+
+
+    void CompressedBitArray::resize(CompressedBitArray::Index newLength) {
+        impl->resize(newLength);
+    }
+
+
+    void CompressedBitArray::optimize() {
+        impl->optimize();
+    }
+
+
+    void CompressedBitArray::setBit(CompressedBitArray::Index bitIndex, bool nowSet) {
+        impl->setBit(bitIndex, nowSet);
+    }
+
+
+    void CompressedBitArray::clearBit(CompressedBitArray::Index bitIndex, bool nowCleared) {
+        impl->setBit(bitIndex, !nowCleared);
+    }
+
+
+    bool CompressedBitArray::isSet(CompressedBitArray::Index bitIndex) const {
+        return impl->isSet(bitIndex);
+    }
+
+
+    bool CompressedBitArray::isClear(CompressedBitArray::Index bitIndex) const {
+        return !impl->isSet(bitIndex);
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::firstSetBit(CompressedBitArray::Index startingIndex) const {
+        return impl->firstSetBit(startingIndex);
+    }
+
+
+    CompressedBitArray CompressedBitArray::intersectionBits(const CompressedBitArray& other) const {
+        CompressedBitArray result;
+        result.impl = new Private(*impl, *other.impl, Private::Operation::AND);
+
+        return result;
+    }
+
+
+    CompressedBitArray CompressedBitArray::unionBits(const CompressedBitArray& other) const {
+        CompressedBitArray result;
+        result.impl = new Private(*impl, *other.impl, Private::Operation::OR);
+
+        return result;
+    }
+
+
+    CompressedBitArray CompressedBitArray::symmetricDifferenceBits(const CompressedBitArray& other) const {
+        CompressedBitArray result;
+        result.impl = new Private(*impl, *other.impl, Private::Operation::XOR);
+
+        return result;
+    }
+
+
+    CompressedBitArray CompressedBitArray::differenceBits(const CompressedBitArray& other) const {
+        CompressedBitArray result;
+        result.impl = new Private(*impl, *other.impl, Private::Operation::AND_NOT);
+
+        return result;
+    }
+
+
+    CompressedBitArray& CompressedBitArray::andNot(const CompressedBitArray& other) {
+        impl->combine(*other.impl, Private::Operation::AND_NOT);
+        return *this;
+    }
+
+
+    CompressedBitArray& CompressedBitArray::operator=(const CompressedBitArray& other) {
+        impl = other.impl;
+        return *this;
+    }
+
+
+    bool CompressedBitArray::operator==(const CompressedBitArray& other) const {
+        return impl == other.impl || *impl == *other.impl;
+    }
+
+
+    bool CompressedBitArray::operator!=(const CompressedBitArray& other) const {
+        return !operator==(other);
+    }
+
+
+    CompressedBitArray& CompressedBitArray::operator&=(const CompressedBitArray& other) {
+        impl->combine(*other.impl, Private::Operation::AND);
+        return *this;
+    }
+
+
+    CompressedBitArray& CompressedBitArray::operator|=(const CompressedBitArray& other) {
+        impl->combine(*other.impl, Private::Operation::OR);
+        return *this;
+    }
+
+
+    CompressedBitArray& CompressedBitArray::operator^=(const CompressedBitArray& other) {
+        impl->combine(*other.impl, Private::Operation::XOR);
+        return *this;
+    }
+}
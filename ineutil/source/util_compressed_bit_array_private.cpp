@@ -0,0 +1,1004 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref Util::CompressedBitArray::Private class.
+***********************************************************************************************************************/
+
+#include <QSharedData>
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#include "util_bit_functions.h"
+#include "util_bit_array.h"
+#include "util_bit_kernels.h"
+#include "util_compressed_bit_array.h"
+#include "util_compressed_bit_array_private.h"
+
+namespace Util {
+    /**
+     * Function that sets an inclusive range of bits in a bitmap.
+     *
+     * \param[in,out] words The bitmap to update.
+     *
+     * \param[in]     first The first bit to set.
+     *
+     * \param[in]     last  The last bit to set.
+     */
+    static void setBitmapRange(std::uint64_t* words, unsigned first, unsigned last) {
+        unsigned      firstWord = first / 64;
+        unsigned      lastWord  = last / 64;
+        std::uint64_t firstMask = static_cast<std::uint64_t>(-1) << (first % 64);
+        std::uint64_t lastMask  = static_cast<std::uint64_t>(-1) >> (63 - last % 64);
+
+        if (firstWord == lastWord) {
+            words[firstWord] |= firstMask & lastMask;
+        } else {
+            words[firstWord] |= firstMask;
+            for (unsigned wordIndex=firstWord + 1 ; wordIndex<lastWord ; ++wordIndex) {
+                words[wordIndex] = static_cast<std::uint64_t>(-1);
+            }
+            words[lastWord] |= lastMask;
+        }
+    }
+
+
+    /**
+     * Function that locates the next set or cleared bit in a bitmap.
+     *
+     * \param[in] words       The bitmap to search.
+     *
+     * \param[in] numberWords The bitmap length, in words.
+     *
+     * \param[in] offset      The bit to start the search at.
+     *
+     * \param[in] findSet     If true, the next set bit is located.  If false, the next cleared bit is located.
+     *
+     * \return Returns the located bit.  The bitmap length, in bits, is returned if no bit was found.
+     */
+    static unsigned nextInBitmap(const std::uint64_t* words, unsigned numberWords, unsigned offset, bool findSet) {
+        unsigned result = 64 * numberWords;
+
+        if (offset < result) {
+            std::uint64_t invert    = findSet ? 0 : static_cast<std::uint64_t>(-1);
+            unsigned      wordIndex = offset / 64;
+            std::uint64_t word      = (words[wordIndex] ^ invert) & (static_cast<std::uint64_t>(-1) << (offset % 64));
+
+            while (word == 0 && ++wordIndex < numberWords) {
+                word = words[wordIndex] ^ invert;
+            }
+
+            if (word != 0) {
+                result = 64 * wordIndex + lsbLocation64(word);
+            }
+        }
+
+        return result;
+    }
+
+
+    /**
+     * Function that expands a sorted array of offsets into a bitmap.
+     *
+     * \param[out] words       The bitmap to receive the offsets.  The entire bitmap is overwritten.
+     *
+     * \param[in]  numberWords The bitmap length, in words.
+     *
+     * \param[in]  values      The offsets to be set.
+     */
+    static void arrayToBitmap(std::uint64_t* words, unsigned numberWords, const std::vector<std::uint16_t>& values) {
+        std::memset(words, 0, numberWords * sizeof(std::uint64_t));
+        for (std::uint16_t value : values) {
+            words[value / 64] |= static_cast<std::uint64_t>(1) << (value % 64);
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * Util::CompressedBitArray::Private::Container
+ */
+
+namespace Util {
+    bool CompressedBitArray::Private::Container::contains(std::uint16_t offset) const {
+        bool result;
+
+        switch (type) {
+            case ContainerType::ARRAY: {
+                result = std::binary_search(values.begin(), values.end(), offset);
+                break;
+            }
+
+            case ContainerType::BITMAP: {
+                result = ((bitmap[offset / 64] >> (offset % 64)) & 1) != 0;
+                break;
+            }
+
+            case ContainerType::RUN: {
+                std::vector<Run>::const_iterator it = std::upper_bound(
+                    runs.begin(),
+                    runs.end(),
+                    offset,
+                    [](std::uint16_t value, const Run& run) {
+                        return value < run.first;
+                    }
+                );
+
+                result = (it != runs.begin() && offset <= (it - 1)->last);
+                break;
+            }
+
+            default: {
+                assert(false);
+                result = false;
+                break;
+            }
+        }
+
+        return result;
+    }
+
+
+    void CompressedBitArray::Private::Container::add(std::uint16_t offset) {
+        switch (type) {
+            case ContainerType::ARRAY: {
+                std::vector<std::uint16_t>::iterator it = std::lower_bound(values.begin(), values.end(), offset);
+                if (it == values.end() || *it != offset) {
+                    values.insert(it, offset);
+                    ++cardinality;
+
+                    if (cardinality > maximumArrayEntries) {
+                        bitmap.resize(bitmapWords);
+                        arrayToBitmap(bitmap.data(), bitmapWords, values);
+
+                        std::vector<std::uint16_t>().swap(values);
+                        type = ContainerType::BITMAP;
+                    }
+                }
+
+                break;
+            }
+
+            case ContainerType::BITMAP: {
+                std::uint64_t mask = static_cast<std::uint64_t>(1) << (offset % 64);
+                if ((bitmap[offset / 64] & mask) == 0) {
+                    bitmap[offset / 64] |= mask;
+                    ++cardinality;
+                }
+
+                break;
+            }
+
+            case ContainerType::RUN: {
+                std::vector<Run>::iterator next = std::upper_bound(
+                    runs.begin(),
+                    runs.end(),
+                    offset,
+                    [](std::uint16_t value, const Run& run) {
+                        return value < run.first;
+                    }
+                );
+
+                if (next == runs.begin() || offset > (next - 1)->last) {
+                    bool extendsPrevious = (next != runs.begin() && (next - 1)->last + 1 == offset);
+                    bool extendsNext     = (next != runs.end() && offset + 1 == next->first);
+
+                    if (extendsPrevious && extendsNext) {
+                        (next - 1)->last = next->last;
+                        runs.erase(next);
+                    } else if (extendsPrevious) {
+                        (next - 1)->last = offset;
+                    } else if (extendsNext) {
+                        next->first = offset;
+                    } else {
+                        Run run;
+                        run.first = offset;
+                        run.last  = offset;
+
+                        runs.insert(next, run);
+                    }
+
+                    ++cardinality;
+                    convertFragmentedRuns();
+                }
+
+                break;
+            }
+
+            default: {
+                assert(false);
+                break;
+            }
+        }
+    }
+
+
+    void CompressedBitArray::Private::Container::remove(std::uint16_t offset) {
+        switch (type) {
+            case ContainerType::ARRAY: {
+                std::vector<std::uint16_t>::iterator it = std::lower_bound(values.begin(), values.end(), offset);
+                if (it != values.end() && *it == offset) {
+                    values.erase(it);
+                    --cardinality;
+                }
+
+                break;
+            }
+
+            case ContainerType::BITMAP: {
+                std::uint64_t mask = static_cast<std::uint64_t>(1) << (offset % 64);
+                if ((bitmap[offset / 64] & mask) != 0) {
+                    bitmap[offset / 64] &= ~mask;
+                    --cardinality;
+
+                    if (cardinality <= maximumArrayEntries) {
+                        values.reserve(cardinality);
+                        for (unsigned wordIndex=0 ; wordIndex<bitmapWords ; ++wordIndex) {
+                            std::uint64_t word = bitmap[wordIndex];
+                            while (word != 0) {
+                                values.push_back(static_cast<std::uint16_t>(64 * wordIndex + lsbLocation64(word)));
+                                word &= word - 1;
+                            }
+                        }
+
+                        std::vector<std::uint64_t>().swap(bitmap);
+                        type = ContainerType::ARRAY;
+                    }
+                }
+
+                break;
+            }
+
+            case ContainerType::RUN: {
+                std::vector<Run>::iterator next = std::upper_bound(
+                    runs.begin(),
+                    runs.end(),
+                    offset,
+                    [](std::uint16_t value, const Run& run) {
+                        return value < run.first;
+                    }
+                );
+
+                if (next != runs.begin() && offset <= (next - 1)->last) {
+                    Run& run = *(next - 1);
+
+                    if (run.first == run.last) {
+                        runs.erase(next - 1);
+                    } else if (offset == run.first) {
+                        ++run.first;
+                    } else if (offset == run.last) {
+                        --run.last;
+                    } else {
+                        Run upper;
+                        upper.first = offset + 1;
+                        upper.last  = run.last;
+
+                        run.last = offset - 1;
+                        runs.insert(next, upper);
+                    }
+
+                    --cardinality;
+                    convertFragmentedRuns();
+                }
+
+                break;
+            }
+
+            default: {
+                assert(false);
+                break;
+            }
+        }
+    }
+
+
+    void CompressedBitArray::Private::Container::convertFragmentedRuns() {
+        assert(type == ContainerType::RUN);
+
+        unsigned long arrayBytes  = cardinality * sizeof(std::uint16_t);
+        unsigned long bitmapBytes = bitmapWords * sizeof(std::uint64_t);
+        unsigned long runBytes    = runs.size() * sizeof(Run);
+
+        if (runBytes >= std::min(arrayBytes, bitmapBytes)) {
+            std::uint64_t buffer[bitmapWords];
+            toBitmap(buffer);
+
+            *this = fromBitmap(key, buffer, false);
+        }
+    }
+
+
+    long CompressedBitArray::Private::Container::next(unsigned offset) const {
+        long result = -1;
+
+        switch (type) {
+            case ContainerType::ARRAY: {
+                std::vector<std::uint16_t>::const_iterator it = std::lower_bound(
+                    values.begin(),
+                    values.end(),
+                    offset,
+                    [](std::uint16_t value, unsigned target) {
+                        return value < target;
+                    }
+                );
+
+                if (it != values.end()) {
+                    result = *it;
+                }
+
+                break;
+            }
+
+            case ContainerType::BITMAP: {
+                unsigned located = nextInBitmap(bitmap.data(), bitmapWords, offset, true);
+                if (located < chunkSize) {
+                    result = located;
+                }
+
+                break;
+            }
+
+            case ContainerType::RUN: {
+                std::vector<Run>::const_iterator it = std::lower_bound(
+                    runs.begin(),
+                    runs.end(),
+                    offset,
+                    [](const Run& run, unsigned target) {
+                        return run.last < target;
+                    }
+                );
+
+                if (it != runs.end()) {
+                    result = std::max(static_cast<unsigned>(it->first), offset);
+                }
+
+                break;
+            }
+
+            default: {
+                assert(false);
+                break;
+            }
+        }
+
+        return result;
+    }
+
+
+    void CompressedBitArray::Private::Container::toBitmap(std::uint64_t* words) const {
+        switch (type) {
+            case ContainerType::ARRAY: {
+                arrayToBitmap(words, bitmapWords, values);
+                break;
+            }
+
+            case ContainerType::BITMAP: {
+                std::memcpy(words, bitmap.data(), bitmapWords * sizeof(std::uint64_t));
+                break;
+            }
+
+            case ContainerType::RUN: {
+                std::memset(words, 0, bitmapWords * sizeof(std::uint64_t));
+                for (const Run& run : runs) {
+                    setBitmapRange(words, run.first, run.last);
+                }
+
+                break;
+            }
+
+            default: {
+                assert(false);
+                break;
+            }
+        }
+    }
+
+
+    void CompressedBitArray::Private::Container::truncate(unsigned limit) {
+        switch (type) {
+            case ContainerType::ARRAY: {
+                values.erase(
+                    std::lower_bound(
+                        values.begin(),
+                        values.end(),
+                        limit,
+                        [](std::uint16_t value, unsigned target) {
+                            return value < target;
+                        }
+                    ),
+                    values.end()
+                );
+
+                cardinality = static_cast<unsigned>(values.size());
+                break;
+            }
+
+            case ContainerType::BITMAP: {
+                std::uint64_t words[bitmapWords];
+                toBitmap(words);
+
+                if (limit % 64 != 0) {
+                    words[limit / 64] &= (static_cast<std::uint64_t>(1) << (limit % 64)) - 1;
+                    std::memset(words + limit / 64 + 1, 0, (bitmapWords - limit / 64 - 1) * sizeof(std::uint64_t));
+                } else {
+                    std::memset(words + limit / 64, 0, (bitmapWords - limit / 64) * sizeof(std::uint64_t));
+                }
+
+                *this = fromBitmap(key, words, false);
+                break;
+            }
+
+            case ContainerType::RUN: {
+                while (!runs.empty() && runs.back().first >= limit) {
+                    runs.pop_back();
+                }
+
+                if (!runs.empty() && runs.back().last >= limit) {
+                    runs.back().last = static_cast<std::uint16_t>(limit - 1);
+                }
+
+                cardinality = 0;
+                for (const Run& run : runs) {
+                    cardinality += run.last - run.first + 1U;
+                }
+
+                break;
+            }
+
+            default: {
+                assert(false);
+                break;
+            }
+        }
+    }
+
+
+    unsigned long CompressedBitArray::Private::Container::memoryUsage() const {
+        return (
+              sizeof(Container)
+            + values.capacity() * sizeof(std::uint16_t)
+            + bitmap.capacity() * sizeof(std::uint64_t)
+            + runs.capacity() * sizeof(Run)
+        );
+    }
+
+
+    bool CompressedBitArray::Private::Container::sameContents(const Container& other) const {
+        bool result;
+
+        if (key != other.key || cardinality != other.cardinality) {
+            result = false;
+        } else if (type == ContainerType::ARRAY && other.type == ContainerType::ARRAY) {
+            result = (values == other.values);
+        } else if (type == ContainerType::BITMAP && other.type == ContainerType::BITMAP) {
+            result = (bitmap == other.bitmap);
+        } else {
+            std::uint64_t thisWords[bitmapWords];
+            std::uint64_t otherWords[bitmapWords];
+
+            toBitmap(thisWords);
+            other.toBitmap(otherWords);
+
+            result = (std::memcmp(thisWords, otherWords, sizeof(thisWords)) == 0);
+        }
+
+        return result;
+    }
+
+
+    CompressedBitArray::Private::Container CompressedBitArray::Private::Container::fromBitmap(
+            CompressedBitArray::Index key,
+            const std::uint64_t*      words,
+            bool                      allowRuns
+        ) {
+        Container result;
+        result.key         = key;
+        result.cardinality = static_cast<unsigned>(populationCount(words, bitmapWords));
+
+        unsigned numberRuns = 0;
+        if (allowRuns && result.cardinality != 0) {
+            std::uint64_t carry = 0;
+            for (unsigned wordIndex=0 ; wordIndex<bitmapWords ; ++wordIndex) {
+                std::uint64_t word = words[wordIndex];
+                numberRuns += numberOnes64(word & ~((word << 1) | carry));
+                carry       = word >> 63;
+            }
+        }
+
+        unsigned long arrayBytes  = result.cardinality * sizeof(std::uint16_t);
+        unsigned long bitmapBytes = bitmapWords * sizeof(std::uint64_t);
+        unsigned long runBytes    = numberRuns * sizeof(Run);
+
+        if (allowRuns && result.cardinality != 0 && runBytes < std::min(arrayBytes, bitmapBytes)) {
+            result.type = ContainerType::RUN;
+            result.runs.reserve(numberRuns);
+
+            unsigned first = nextInBitmap(words, bitmapWords, 0, true);
+            while (first < chunkSize) {
+                unsigned end = nextInBitmap(words, bitmapWords, first, false);
+
+                Run run;
+                run.first = static_cast<std::uint16_t>(first);
+                run.last  = static_cast<std::uint16_t>(end - 1);
+                result.runs.push_back(run);
+
+                first = nextInBitmap(words, bitmapWords, end, true);
+            }
+        } else if (result.cardinality <= maximumArrayEntries) {
+            result.type = ContainerType::ARRAY;
+            result.values.reserve(result.cardinality);
+
+            for (unsigned wordIndex=0 ; wordIndex<bitmapWords ; ++wordIndex) {
+                std::uint64_t word = words[wordIndex];
+                while (word != 0) {
+                    result.values.push_back(static_cast<std::uint16_t>(64 * wordIndex + lsbLocation64(word)));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            result.type = ContainerType::BITMAP;
+            result.bitmap.assign(words, words + bitmapWords);
+        }
+
+        return result;
+    }
+}
+
+/***********************************************************************************************************************
+ * Util::CompressedBitArray::Private
+ */
+
+namespace Util {
+    CompressedBitArray::Private::Private() {
+        bitLength = 0;
+    }
+
+
+    CompressedBitArray::Private::Private(CompressedBitArray::Index numberBits) {
+        bitLength = numberBits;
+    }
+
+
+    CompressedBitArray::Private::Private(const BitArray& bitArray) {
+        bitLength = bitArray.size();
+
+        const std::uint64_t* words       = bitArray.constData();
+        unsigned long        numberWords = bitArray.wordCount();
+
+        for (unsigned long chunkStart=0 ; chunkStart<numberWords ; chunkStart+=bitmapWords) {
+            unsigned long chunkWords = std::min(static_cast<unsigned long>(bitmapWords), numberWords - chunkStart);
+            unsigned long wordIndex  = 0;
+
+            while (wordIndex < chunkWords && words[chunkStart + wordIndex] == 0) {
+                ++wordIndex;
+            }
+
+            if (wordIndex < chunkWords) {
+                Index key = chunkStart / bitmapWords;
+
+                if (chunkWords == bitmapWords) {
+                    containers.push_back(Container::fromBitmap(key, words + chunkStart, true));
+                } else {
+                    std::uint64_t buffer[bitmapWords];
+                    std::memcpy(buffer, words + chunkStart, chunkWords * sizeof(std::uint64_t));
+                    std::memset(buffer + chunkWords, 0, (bitmapWords - chunkWords) * sizeof(std::uint64_t));
+
+                    containers.push_back(Container::fromBitmap(key, buffer, true));
+                }
+            }
+        }
+    }
+
+
+    CompressedBitArray::Private::Private(const CompressedBitArray::Private& other):QSharedData(other) {
+        containers = other.containers;
+        bitLength  = other.bitLength;
+    }
+
+
+    CompressedBitArray::Private::Private(
+            const CompressedBitArray::Private& first,
+            const CompressedBitArray::Private& second,
+            CompressedBitArray::Private::Operation operation
+        ) {
+        bitLength = std::max(first.bitLength, second.bitLength);
+
+        unsigned long firstSize   = first.containers.size();
+        unsigned long secondSize  = second.containers.size();
+        unsigned long firstIndex  = 0;
+        unsigned long secondIndex = 0;
+
+        while (firstIndex < firstSize || secondIndex < secondSize) {
+            if (secondIndex >= secondSize                                                                       ||
+                (firstIndex < firstSize && first.containers[firstIndex].key < second.containers[secondIndex].key)) {
+                if (operation != Operation::AND) {
+                    containers.push_back(first.containers[firstIndex]);
+                }
+
+                ++firstIndex;
+            } else if (firstIndex >= firstSize                                                        ||
+                       second.containers[secondIndex].key < first.containers[firstIndex].key) {
+                if (operation == Operation::OR || operation == Operation::XOR) {
+                    containers.push_back(second.containers[secondIndex]);
+                }
+
+                ++secondIndex;
+            } else {
+                Container container = combineContainers(
+                    first.containers[firstIndex],
+                    second.containers[secondIndex],
+                    operation
+                );
+
+                if (container.cardinality != 0) {
+                    containers.push_back(std::move(container));
+                }
+
+                ++firstIndex;
+                ++secondIndex;
+            }
+        }
+    }
+
+
+    CompressedBitArray::Private::~Private() {}
+
+
+    BitArray CompressedBitArray::Private::toBitArray() const {
+        BitArray result;
+
+        if (bitLength > 0) {
+            unsigned long              numberWords = (bitLength + 63) / 64;
+            std::vector<std::uint64_t> words(numberWords, 0);
+            std::uint64_t              buffer[bitmapWords];
+
+            for (const Container& container : containers) {
+                unsigned long base       = container.key * bitmapWords;
+                unsigned long chunkWords = std::min(static_cast<unsigned long>(bitmapWords), numberWords - base);
+
+                container.toBitmap(buffer);
+                std::memcpy(words.data() + base, buffer, chunkWords * sizeof(std::uint64_t));
+            }
+
+            result = BitArray(words.data(), bitLength);
+        }
+
+        return result;
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::Private::length() const {
+        return bitLength;
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::Private::popcount() const {
+        Index result = 0;
+        for (const Container& container : containers) {
+            result += container.cardinality;
+        }
+
+        return result;
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::Private::memoryUsage() const {
+        Index result = sizeof(Private) + (containers.capacity() - containers.size()) * sizeof(Container);
+        for (const Container& container : containers) {
+            result += container.memoryUsage();
+        }
+
+        return result;
+    }
+
+
+    void CompressedBitArray::Private::clear() {
+        std::vector<Container>().swap(containers);
+        bitLength = 0;
+    }
+
+
+    void CompressedBitArray::Private::resize(CompressedBitArray::Index newLength) {
+        if (newLength < bitLength) {
+            Index         lastKey  = newLength / chunkSize;
+            unsigned      limit    = static_cast<unsigned>(newLength % chunkSize);
+            unsigned long position = lowerBound(lastKey);
+
+            if (position < containers.size() && containers[position].key == lastKey && limit > 0) {
+                containers[position].truncate(limit);
+                if (containers[position].cardinality != 0) {
+                    ++position;
+                }
+            }
+
+            containers.erase(containers.begin() + position, containers.end());
+        }
+
+        bitLength = newLength;
+    }
+
+
+    void CompressedBitArray::Private::optimize() {
+        std::uint64_t buffer[bitmapWords];
+
+        for (Container& container : containers) {
+            container.toBitmap(buffer);
+            container = Container::fromBitmap(container.key, buffer, true);
+        }
+
+        containers.shrink_to_fit();
+    }
+
+
+    void CompressedBitArray::Private::setBit(CompressedBitArray::Index bitIndex, bool nowSet) {
+        if (bitIndex >= bitLength) {
+            bitLength = bitIndex + 1;
+        }
+
+        Index         key      = bitIndex / chunkSize;
+        std::uint16_t offset   = static_cast<std::uint16_t>(bitIndex % chunkSize);
+        unsigned long position = lowerBound(key);
+        bool          found    = (position < containers.size() && containers[position].key == key);
+
+        if (nowSet) {
+            if (found) {
+                containers[position].add(offset);
+            } else {
+                Container container;
+                container.key         = key;
+                container.type        = ContainerType::ARRAY;
+                container.cardinality = 1;
+                container.values.push_back(offset);
+
+                containers.insert(containers.begin() + position, std::move(container));
+            }
+        } else if (found) {
+            containers[position].remove(offset);
+            if (containers[position].cardinality == 0) {
+                containers.erase(containers.begin() + position);
+            }
+        }
+    }
+
+
+    bool CompressedBitArray::Private::isSet(CompressedBitArray::Index bitIndex) const {
+        bool result = false;
+
+        if (bitIndex < bitLength) {
+            Index         key      = bitIndex / chunkSize;
+            unsigned long position = lowerBound(key);
+
+            if (position < containers.size() && containers[position].key == key) {
+                result = containers[position].contains(static_cast<std::uint16_t>(bitIndex % chunkSize));
+            }
+        }
+
+        return result;
+    }
+
+
+    CompressedBitArray::Index CompressedBitArray::Private::firstSetBit(CompressedBitArray::Index startingIndex) const {
+        Index result = invalidIndex;
+
+        if (startingIndex < bitLength) {
+            Index         key      = startingIndex / chunkSize;
+            unsigned long position = lowerBound(key);
+
+            if (position < containers.size() && containers[position].key == key) {
+                long offset = containers[position].next(static_cast<unsigned>(startingIndex % chunkSize));
+                if (offset >= 0) {
+                    result = key * chunkSize + offset;
+                } else {
+                    ++position;
+                }
+            }
+
+            if (result == invalidIndex && position < containers.size()) {
+                result = containers[position].key * chunkSize + containers[position].next(0);
+            }
+        }
+
+        return result;
+    }
+
+
+    void CompressedBitArray::Private::combine(
+            const CompressedBitArray::Private&     other,
+            CompressedBitArray::Private::Operation operation
+        ) {
+        Private result(*this, other, operation);
+
+        containers.swap(result.containers);
+        bitLength = result.bitLength;
+    }
+
+
+    bool CompressedBitArray::Private::operator==(const CompressedBitArray::Private& other) const {
+        bool isEqual = (bitLength == other.bitLength && containers.size() == other.containers.size());
+
+        unsigned long numberContainers = containers.size();
+        unsigned long position         = 0;
+        while (isEqual && position < numberContainers) {
+            isEqual = containers[position].sameContents(other.containers[position]);
+            ++position;
+        }
+
+        return isEqual;
+    }
+
+
+    CompressedBitArray::Private::Container CompressedBitArray::Private::combineContainers(
+            const CompressedBitArray::Private::Container& first,
+            const CompressedBitArray::Private::Container& second,
+            CompressedBitArray::Private::Operation        operation
+        ) {
+        Container result;
+        result.key = first.key;
+
+        if (first.type == ContainerType::ARRAY && second.type == ContainerType::ARRAY) {
+            std::back_insert_iterator<std::vector<std::uint16_t>> out(result.values);
+
+            switch (operation) {
+                case Operation::AND: {
+                    std::set_intersection(
+                        first.values.begin(),
+                        first.values.end(),
+                        second.values.begin(),
+                        second.values.end(),
+                        out
+                    );
+
+                    break;
+                }
+
+                case Operation::OR: {
+                    std::set_union(
+                        first.values.begin(),
+                        first.values.end(),
+                        second.values.begin(),
+                        second.values.end(),
+                        out
+                    );
+
+                    break;
+                }
+
+                case Operation::XOR: {
+                    std::set_symmetric_difference(
+                        first.values.begin(),
+                        first.values.end(),
+                        second.values.begin(),
+                        second.values.end(),
+                        out
+                    );
+
+                    break;
+                }
+
+                case Operation::AND_NOT: {
+                    std::set_difference(
+                        first.values.begin(),
+                        first.values.end(),
+                        second.values.begin(),
+                        second.values.end(),
+                        out
+                    );
+
+                    break;
+                }
+
+                default: {
+                    assert(false);
+                    break;
+                }
+            }
+
+            result.type        = ContainerType::ARRAY;
+            result.cardinality = static_cast<unsigned>(result.values.size());
+
+            if (result.cardinality > maximumArrayEntries) {
+                std::uint64_t words[bitmapWords];
+                arrayToBitmap(words, bitmapWords, result.values);
+
+                result = Container::fromBitmap(first.key, words, false);
+            }
+        } else if (first.type == ContainerType::ARRAY                           &&
+                   (operation == Operation::AND || operation == Operation::AND_NOT)) {
+            bool keepContained = (operation == Operation::AND);
+
+            result.type = ContainerType::ARRAY;
+            for (std::uint16_t value : first.values) {
+                if (second.contains(value) == keepContained) {
+                    result.values.push_back(value);
+                }
+            }
+
+            result.cardinality = static_cast<unsigned>(result.values.size());
+        } else if (second.type == ContainerType::ARRAY && operation == Operation::AND) {
+            result.type = ContainerType::ARRAY;
+            for (std::uint16_t value : second.values) {
+                if (first.contains(value)) {
+                    result.values.push_back(value);
+                }
+            }
+
+            result.cardinality = static_cast<unsigned>(result.values.size());
+        } else {
+            std::uint64_t firstWords[bitmapWords];
+            std::uint64_t secondWords[bitmapWords];
+
+            first.toBitmap(firstWords);
+            second.toBitmap(secondWords);
+
+            switch (operation) {
+                case Operation::AND: {
+                    bitwiseAnd(firstWords, firstWords, secondWords, bitmapWords);
+                    break;
+                }
+
+                case Operation::OR: {
+                    bitwiseOr(firstWords, firstWords, secondWords, bitmapWords);
+                    break;
+                }
+
+                case Operation::XOR: {
+                    bitwiseXor(firstWords, firstWords, secondWords, bitmapWords);
+                    break;
+                }
+
+                case Operation::AND_NOT: {
+                    bitwiseAndNot(firstWords, firstWords, secondWords, bitmapWords);
+                    break;
+                }
+
+                default: {
+                    assert(false);
+                    break;
+                }
+            }
+
+            bool allowRuns = (first.type == ContainerType::RUN || second.type == ContainerType::RUN);
+            result = Container::fromBitmap(first.key, firstWords, allowRuns);
+        }
+
+        return result;
+    }
+
+
+    unsigned long CompressedBitArray::Private::lowerBound(CompressedBitArray::Index key) const {
+        std::vector<Container>::const_iterator it = std::lower_bound(
+            containers.begin(),
+            containers.end(),
+            key,
+            [](const Container& container, Index target) {
+                return container.key < target;
+            }
+        );
+
+        return static_cast<unsigned long>(it - containers.begin());
+    }
+}
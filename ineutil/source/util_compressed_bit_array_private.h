@@ -0,0 +1,405 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the Util::CompressedBitArray::Private class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project ineutil */
+
+#ifndef UTIL_COMPRESSED_BIT_ARRAY_PRIVATE_H
+#define UTIL_COMPRESSED_BIT_ARRAY_PRIVATE_H
+
+#include <QSharedData>
+
+#include <cstdint>
+#include <vector>
+
+#include "util_common.h"
+#include "util_bit_array.h"
+#include "util_compressed_bit_array.h"
+
+namespace Util {
+    /**
+     * Private implementation class that can be used to maintain a compressed, searchable array of bits.
+     */
+    class UTIL_PUBLIC_API CompressedBitArray::Private:public QSharedData {
+        public:
+            /**
+             * Enumeration of supported bitwise operations between arrays.
+             */
+            enum class Operation {
+                /**
+                 * Indicates a bitwise AND operation.
+                 */
+                AND,
+
+                /**
+                 * Indicates a bitwise OR operation.
+                 */
+                OR,
+
+                /**
+                 * Indicates a bitwise exclusive OR operation.
+                 */
+                XOR,
+
+                /**
+                 * Indicates a bitwise AND operation against the complement of the second array.
+                 */
+                AND_NOT
+            };
+
+            /**
+             * Enumeration of supported chunk containers.
+             */
+            enum class ContainerType {
+                /**
+                 * Indicates a sorted array of 16-bit offsets.  Used for chunks holding up to
+                 * \ref Util::CompressedBitArray::Private::maximumArrayEntries set bits.
+                 */
+                ARRAY,
+
+                /**
+                 * Indicates a bitmap of \ref Util::CompressedBitArray::Private::bitmapWords words.
+                 */
+                BITMAP,
+
+                /**
+                 * Indicates a sorted array of runs of set bits.
+                 */
+                RUN
+            };
+
+            /**
+             * The largest number of entries held in an array container.  Above this the bitmap is smaller.
+             */
+            static constexpr unsigned maximumArrayEntries = 4096;
+
+            /**
+             * The number of 64-bit words in a bitmap container.
+             */
+            static constexpr unsigned bitmapWords = chunkSize / 64;
+
+            /**
+             * Structure used to represent a run of set bits within a chunk.
+             */
+            struct Run {
+                /**
+                 * The offset of the first set bit in the run.
+                 */
+                std::uint16_t first;
+
+                /**
+                 * The offset of the last set bit in the run.
+                 */
+                std::uint16_t last;
+            };
+
+            /**
+             * Structure used to hold the set bits for a single, non-empty, chunk.
+             */
+            struct Container {
+                /**
+                 * Method you can use to determine if an offset is set in this container.
+                 *
+                 * \param[in] offset The offset within the chunk.
+                 *
+                 * \return Returns true if the offset is set.
+                 */
+                bool contains(std::uint16_t offset) const;
+
+                /**
+                 * Method you can use to set an offset in this container.  Array containers are converted to bitmap
+                 * containers when they become too large.  Run containers are converted to array or bitmap containers
+                 * when they no longer provide the smallest representation.
+                 *
+                 * \param[in] offset The offset within the chunk.
+                 */
+                void add(std::uint16_t offset);
+
+                /**
+                 * Method you can use to clear an offset in this container.  Bitmap containers are converted to array
+                 * containers when they become small enough.  Run containers are converted to array or bitmap
+                 * containers when they no longer provide the smallest representation.
+                 *
+                 * \param[in] offset The offset within the chunk.
+                 */
+                void remove(std::uint16_t offset);
+
+                /**
+                 * Method that converts a run container to an array or bitmap container if the runs have become
+                 * fragmented enough that they are no longer the smallest representation.
+                 */
+                void convertFragmentedRuns();
+
+                /**
+                 * Method you can use to locate the first set offset at or after a given offset.
+                 *
+                 * \param[in] offset The offset to start the search at.
+                 *
+                 * \return Returns the located offset.  A value of -1 is returned if there are no further set offsets.
+                 */
+                long next(unsigned offset) const;
+
+                /**
+                 * Method you can use to expand this container into a bitmap.
+                 *
+                 * \param[out] words Buffer of \ref Util::CompressedBitArray::Private::bitmapWords words to receive the
+                 *                   bitmap.  The entire buffer is overwritten.
+                 */
+                void toBitmap(std::uint64_t* words) const;
+
+                /**
+                 * Method you can use to discard every offset at or above a limit.
+                 *
+                 * \param[in] limit The first offset to be discarded.
+                 */
+                void truncate(unsigned limit);
+
+                /**
+                 * Method you can use to determine the number of bytes used by this container.
+                 *
+                 * \return Returns the approximate container size, in bytes.
+                 */
+                unsigned long memoryUsage() const;
+
+                /**
+                 * Method you can use to compare the contents of two containers, regardless of container type.
+                 *
+                 * \param[in] other The container to compare against.
+                 *
+                 * \return Returns true if the containers hold the same offsets.
+                 */
+                bool sameContents(const Container& other) const;
+
+                /**
+                 * Method that creates the smallest container for a bitmap.
+                 *
+                 * \param[in] key       The chunk index.
+                 *
+                 * \param[in] words     The bitmap, \ref Util::CompressedBitArray::Private::bitmapWords words in length.
+                 *
+                 * \param[in] allowRuns If true, a run container will be used when it is the smallest representation.
+                 *
+                 * \return Returns the new container.  The container will have a cardinality of zero if the bitmap is
+                 *         empty.
+                 */
+                static Container fromBitmap(Index key, const std::uint64_t* words, bool allowRuns);
+
+                /**
+                 * The chunk index.  The container holds bits key * chunkSize through (key + 1) * chunkSize - 1.
+                 */
+                Index key;
+
+                /**
+                 * The container type.
+                 */
+                ContainerType type;
+
+                /**
+                 * The number of set bits in this container.
+                 */
+                unsigned cardinality;
+
+                /**
+                 * The sorted offsets, used by array containers.
+                 */
+                std::vector<std::uint16_t> values;
+
+                /**
+                 * The bitmap, used by bitmap containers.
+                 */
+                std::vector<std::uint64_t> bitmap;
+
+                /**
+                 * The sorted, non-adjacent, runs, used by run containers.
+                 */
+                std::vector<Run> runs;
+            };
+
+            /**
+             * Default constructor.
+             */
+            Private();
+
+            /**
+             * Constructor, constructs an empty array of bits of a fixed sized.
+             *
+             * \param[in] numberBits The desired initial length of the array, in bits.
+             */
+            Private(Index numberBits);
+
+            /**
+             * Constructor, constructs a compressed array from a dense array.
+             *
+             * \param[in] bitArray The dense array to be compressed.
+             */
+            Private(const BitArray& bitArray);
+
+            /**
+             * Copy constructor.
+             *
+             * \param[in] other The instance to be copied.
+             */
+            Private(const Private& other);
+
+            /**
+             * Constructor, constructs an array by combining two arrays.
+             *
+             * \param[in] first     The first array to combine.
+             *
+             * \param[in] second    The second array to combine.
+             *
+             * \param[in] operation The operation used to combine the arrays.
+             */
+            Private(const Private& first, const Private& second, Operation operation);
+
+            ~Private();
+
+            /**
+             * Method you can use to convert this array to a dense array.
+             *
+             * \return Returns a dense array holding the same bits.
+             */
+            BitArray toBitArray() const;
+
+            /**
+             * Method you can use to determine the size of the array, in bits.
+             *
+             * \return Returns the array size, in bits.
+             */
+            Index length() const;
+
+            /**
+             * Method you can use to determine the number of set bits in the array.
+             *
+             * \return Returns the number of set bits.
+             */
+            Index popcount() const;
+
+            /**
+             * Method you can use to determine the approximate number of bytes used to hold the array contents.
+             *
+             * \return Returns the approximate storage used, in bytes.
+             */
+            Index memoryUsage() const;
+
+            /**
+             * Method you can use to clear the array contents.
+             */
+            void clear();
+
+            /**
+             * Method you can use to resize the array.
+             *
+             * \param[in] newLength The new array length, in bits.
+             */
+            void resize(Index newLength);
+
+            /**
+             * Method you can use to convert every chunk to its smallest container.
+             */
+            void optimize();
+
+            /**
+             * Method you can use to set or clear a bit.  The array will be extended, if needed.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be updated.
+             *
+             * \param[in] nowSet   If true, the bit will be set.  If false, the bit will be cleared.
+             */
+            void setBit(Index bitIndex, bool nowSet);
+
+            /**
+             * Method you can use to determine if a bit is set.
+             *
+             * \param[in] bitIndex The zero based index of the bit to be checked.
+             *
+             * \return Returns true if the bit is set.
+             */
+            bool isSet(Index bitIndex) const;
+
+            /**
+             * Method you can use to locate the first set bit.
+             *
+             * \param[in] startingIndex The zero based index to start the search at.
+             *
+             * \return Returns the zero based index of the first set bit.
+             */
+            Index firstSetBit(Index startingIndex) const;
+
+            /**
+             * Method you can use to combine another array into this array.
+             *
+             * \param[in] other     The array to combine with this array.
+             *
+             * \param[in] operation The operation used to combine the arrays.
+             */
+            void combine(const Private& other, Operation operation);
+
+            /**
+             * Comparison operator.
+             *
+             * \param[in] other The instance to be compared against.
+             *
+             * \return Returns true if the arrays are equal.
+             */
+            bool operator==(const Private& other) const;
+
+        private:
+            /**
+             * Method that combines two containers holding the same chunk.
+             *
+             * \param[in] first     The first container.
+             *
+             * \param[in] second    The second container.
+             *
+             * \param[in] operation The operation used to combine the containers.
+             *
+             * \return Returns the resulting container.  The container will have a cardinality of zero if it is empty.
+             */
+            static Container combineContainers(const Container& first, const Container& second, Operation operation);
+
+            /**
+             * Method that locates the position of the first container at or after a chunk.
+             *
+             * \param[in] key The chunk index to locate.
+             *
+             * \return Returns the position of the first container with a key at or above the requested key.
+             */
+            unsigned long lowerBound(Index key) const;
+
+            /**
+             * The non-empty containers, sorted by key.
+             */
+            std::vector<Container> containers;
+
+            /**
+             * The current array length, in bits.
+             */
+            Index bitLength;
+    };
+}
+
+#endif
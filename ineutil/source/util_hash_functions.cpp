@@ -37,7 +37,78 @@
 #include "util_common.h"
 #include "util_hash_functions.h"
 
+#if (defined(_MSC_VER) && defined(_M_X64))
+
+    #include <intrin.h>
+
+#endif
+
 namespace Util {
+    /**
+     * Constants used to mix values in \ref Util::hashWords.
+     */
+    static constexpr std::uint64_t hashSecret0 = 0xA0761D6478BD642FULL;
+    static constexpr std::uint64_t hashSecret1 = 0xE7037ED1A0B428DBULL;
+    static constexpr std::uint64_t hashSecret2 = 0x8EBC6AF09C88C6E3ULL;
+    static constexpr std::uint64_t hashSecret3 = 0x589965CC75374CC3ULL;
+
+    /**
+     * Function that mixes two values by folding the 128-bit product of the values.
+     *
+     * \param[in] a The first value.
+     *
+     * \param[in] b The second value.
+     *
+     * \return Returns the exclusive OR of the high and low halves of the product.
+     */
+    static inline std::uint64_t hashMix(std::uint64_t a, std::uint64_t b) {
+        #if (defined(__SIZEOF_INT128__))
+
+            unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+
+        #elif (defined(_MSC_VER) && defined(_M_X64))
+
+            std::uint64_t high;
+            std::uint64_t low = _umul128(a, b, &high);
+
+            return low ^ high;
+
+        #else
+
+            std::uint64_t aLow   = a & 0xFFFFFFFFULL;
+            std::uint64_t aHigh  = a >> 32;
+            std::uint64_t bLow   = b & 0xFFFFFFFFULL;
+            std::uint64_t bHigh  = b >> 32;
+            std::uint64_t lowLow = aLow * bLow;
+            std::uint64_t middle = aHigh * bLow + (lowLow >> 32);
+            std::uint64_t cross  = aLow * bHigh + (middle & 0xFFFFFFFFULL);
+            std::uint64_t high   = aHigh * bHigh + (middle >> 32) + (cross >> 32);
+            std::uint64_t low    = (cross << 32) | (lowLow & 0xFFFFFFFFULL);
+
+            return low ^ high;
+
+        #endif
+    }
+
+
+    std::uint64_t hashWords(const std::uint64_t* words, unsigned long numberWords, std::uint64_t seed) {
+        std::uint64_t state     = hashMix(seed ^ hashSecret0, hashSecret1);
+        unsigned long wordIndex = 0;
+
+        while (wordIndex + 2 <= numberWords) {
+            state = hashMix(words[wordIndex] ^ hashSecret1, words[wordIndex + 1] ^ state);
+            wordIndex += 2;
+        }
+
+        if (wordIndex < numberWords) {
+            state = hashMix(words[wordIndex] ^ hashSecret1, state ^ hashSecret2);
+        }
+
+        return hashMix(state ^ hashSecret3, static_cast<std::uint64_t>(numberWords) ^ hashSecret0);
+    }
+
+
     HashResult qHash(const QColor& color, HashSeed seed) {
         std::uint32_t colorValue;
 
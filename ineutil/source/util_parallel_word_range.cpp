@@ -0,0 +1,177 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref Util::ParallelWordRange class.
+***********************************************************************************************************************/
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "util_common.h"
+#include "util_parallel_word_range.h"
+
+namespace Util {
+    class ParallelWordRange::ChunkTask:public QRunnable {
+        public:
+            /**
+             * Constructor.
+             *
+             * \param[in] function     The function used to process the chunk.
+             *
+             * \param[in] chunkIndex   The zero based chunk index.
+             *
+             * \param[in] startingWord The index of the first word in the chunk.
+             *
+             * \param[in] endingWord   The index just past the last word in the chunk.
+             *
+             * \param[in] finished     Semaphore released once the chunk has been processed.
+             */
+            ChunkTask(
+                    const ParallelWordRange::ChunkFunction& function,
+                    unsigned                                chunkIndex,
+                    unsigned long                           startingWord,
+                    unsigned long                           endingWord,
+                    QSemaphore&                             finished
+                ):function(
+                    function
+                ),chunkIndex(
+                    chunkIndex
+                ),startingWord(
+                    startingWord
+                ),endingWord(
+                    endingWord
+                ),finished(
+                    finished
+                ) {
+                setAutoDelete(false);
+            }
+
+            /**
+             * Method that processes the chunk.
+             */
+            void run() override {
+                function(chunkIndex, startingWord, endingWord);
+                finished.release();
+            }
+
+        private:
+            /**
+             * The function used to process the chunk.
+             */
+            const ParallelWordRange::ChunkFunction& function;
+
+            /**
+             * The zero based chunk index.
+             */
+            unsigned chunkIndex;
+
+            /**
+             * The index of the first word in the chunk.
+             */
+            unsigned long startingWord;
+
+            /**
+             * The index just past the last word in the chunk.
+             */
+            unsigned long endingWord;
+
+            /**
+             * Semaphore released once the chunk has been processed.
+             */
+            QSemaphore& finished;
+    };
+}
+
+
+namespace Util {
+    ParallelWordRange::ParallelWordRange(
+            unsigned long startingWord,
+            unsigned long endingWord
+        ):startingWord(
+            startingWord
+        ),endingWord(
+            std::max(startingWord, endingWord)
+        ) {
+        baseWord = startingWord - startingWord % wordsPerCacheLine;
+
+        unsigned long spannedWords  = this->endingWord - baseWord;
+        unsigned long maximumChunks = (this->endingWord - startingWord) / minimumChunkWords;
+        unsigned long threadCount   = static_cast<unsigned long>(
+            std::max(1, QThreadPool::globalInstance()->maxThreadCount())
+        );
+
+        unsigned long desiredChunks = std::max(1UL, std::min(maximumChunks, threadCount));
+        unsigned long wordsPerChunk = (spannedWords + desiredChunks - 1) / desiredChunks;
+
+        chunkWords = std::max(
+            static_cast<unsigned long>(wordsPerCacheLine),
+            (wordsPerChunk + wordsPerCacheLine - 1) / wordsPerCacheLine * wordsPerCacheLine
+        );
+        chunkCount = static_cast<unsigned>(std::max(1UL, (spannedWords + chunkWords - 1) / chunkWords));
+    }
+
+
+    ParallelWordRange::~ParallelWordRange() {}
+
+
+    unsigned ParallelWordRange::numberChunks() const {
+        return chunkCount;
+    }
+
+
+    void ParallelWordRange::run(const ParallelWordRange::ChunkFunction& function) const {
+        if (chunkCount == 1) {
+            function(0, startingWord, endingWord);
+        } else {
+            QThreadPool* threadPool = QThreadPool::globalInstance();
+            QSemaphore   finished;
+
+            std::vector<std::unique_ptr<ChunkTask>> tasks;
+            tasks.reserve(chunkCount - 1);
+
+            for (unsigned chunkIndex=1 ; chunkIndex<chunkCount ; ++chunkIndex) {
+                unsigned long chunkStart = baseWord + chunkIndex * chunkWords;
+                unsigned long chunkEnd   = std::min(chunkStart + chunkWords, endingWord);
+
+                tasks.emplace_back(new ChunkTask(function, chunkIndex, chunkStart, chunkEnd, finished));
+                threadPool->start(tasks.back().get());
+            }
+
+            function(0, startingWord, baseWord + chunkWords);
+
+            for (const std::unique_ptr<ChunkTask>& task : tasks) {
+                if (threadPool->tryTake(task.get())) {
+                    task->run();
+                }
+            }
+
+            finished.acquire(static_cast<int>(chunkCount - 1));
+        }
+    }
+}
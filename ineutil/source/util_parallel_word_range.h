@@ -0,0 +1,126 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines a helper used to split word-parallel operations across the global thread pool.
+***********************************************************************************************************************/
+
+/* .. sphinx-project ineutil */
+
+#ifndef UTIL_PARALLEL_WORD_RANGE_H
+#define UTIL_PARALLEL_WORD_RANGE_H
+
+#include <functional>
+
+#include "util_common.h"
+
+namespace Util {
+    /**
+     * Class that splits a range of words into chunks and processes the chunks concurrently using the global thread
+     * pool.  Chunk boundaries fall on multiples of \ref Util::ParallelWordRange::wordsPerCacheLine so, for
+     * cache line aligned buffers such as those provided by \ref Util::BitArrayAllocator, no two chunks share a cache
+     * line.  Ranges too small to benefit are processed as a single chunk on the calling thread.
+     */
+    class ParallelWordRange {
+        public:
+            /**
+             * Type of function called to process a chunk.  The function receives the zero based chunk index, the
+             * index of the first word in the chunk, and the index just past the last word in the chunk.  Word indexes
+             * are relative to the start of the buffer, not the start of the range.
+             */
+            typedef std::function<void(unsigned chunkIndex, unsigned long startingWord, unsigned long endingWord)>
+                ChunkFunction;
+
+            /**
+             * The number of 64-bit words held in a cache line.
+             */
+            static constexpr unsigned long wordsPerCacheLine = 8;
+
+            /**
+             * The smallest chunk worth handing to another thread, in words.  Ranges shorter than twice this value
+             * are processed on the calling thread.
+             */
+            static constexpr unsigned long minimumChunkWords = 1UL << 16;
+
+            /**
+             * Constructor.
+             *
+             * \param[in] startingWord The index of the first word in the range.
+             *
+             * \param[in] endingWord   The index just past the last word in the range.
+             */
+            ParallelWordRange(unsigned long startingWord, unsigned long endingWord);
+
+            ~ParallelWordRange();
+
+            /**
+             * Method you can use to determine the number of chunks the range is split into.
+             *
+             * \return Returns the number of chunks.  At least one chunk is always reported.
+             */
+            unsigned numberChunks() const;
+
+            /**
+             * Method you can use to process every chunk.  One chunk is processed on the calling thread and the
+             * remaining chunks are queued on the global thread pool.  Chunks that have not started by the time the
+             * calling thread finishes its own chunk are taken back and processed on the calling thread, so the method
+             * is safe to call from a thread pool thread.  The method returns once every chunk has been processed.
+             *
+             * \param[in] function The function used to process each chunk.
+             */
+            void run(const ChunkFunction& function) const;
+
+        private:
+            /**
+             * Task used to process a single chunk on the thread pool.
+             */
+            class ChunkTask;
+
+            /**
+             * The index of the first word in the range.
+             */
+            unsigned long startingWord;
+
+            /**
+             * The index just past the last word in the range.
+             */
+            unsigned long endingWord;
+
+            /**
+             * The index of the cache line aligned word that chunk boundaries are measured from.
+             */
+            unsigned long baseWord;
+
+            /**
+             * The number of words in each chunk.  The first and last chunks may be shorter.
+             */
+            unsigned long chunkWords;
+
+            /**
+             * The number of chunks.
+             */
+            unsigned chunkCount;
+    };
+}
+
+#endif
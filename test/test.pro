@@ -32,6 +32,10 @@ CONFIG += testcase c++14
 HEADERS = test_bit_functions.h \
           test_bit_set.h \
           test_bit_array.h \
+          test_bloom_filter.h \
+          test_bit_matrix.h \
+          test_compressed_bit_array.h \
+          test_atomic_bit_array.h \
           test_page_size.h \
           test_string.h \
           test_fuzzy_search.h \
@@ -40,6 +44,10 @@ SOURCES = test_ineutil.cpp \
           test_bit_functions.cpp \
           test_bit_set.cpp \
           test_bit_array.cpp \
+          test_bloom_filter.cpp \
+          test_bit_matrix.cpp \
+          test_compressed_bit_array.cpp \
+          test_atomic_bit_array.cpp \
           test_page_size.cpp \
           test_string.cpp \
           test_fuzzy_search.cpp \
@@ -0,0 +1,253 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements tests of the AtomicBitArray class
+***********************************************************************************************************************/
+
+#include <QtGlobal>
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include <cstdint>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <util_bit_array.h>
+#include <util_atomic_bit_array.h>
+
+#include "test_atomic_bit_array.h"
+
+TestAtomicBitArray::TestAtomicBitArray() {}
+
+
+TestAtomicBitArray::~TestAtomicBitArray() {}
+
+
+void TestAtomicBitArray::initTestCase() {}
+
+
+void TestAtomicBitArray::testConstructor() {
+    Util::AtomicBitArray emptyArray(0);
+    QCOMPARE(emptyArray.size(), 0U);
+    QCOMPARE(emptyArray.wordCount(), 0U);
+    QCOMPARE(emptyArray.firstClearedBit(), Util::AtomicBitArray::invalidIndex);
+    QCOMPARE(emptyArray.claimFirstClearedBit(), Util::AtomicBitArray::invalidIndex);
+
+    Util::AtomicBitArray array(130);
+    QCOMPARE(array.size(), 130U);
+    QCOMPARE(array.length(), 130U);
+    QCOMPARE(array.wordCount(), 3U);
+    QCOMPARE(array.popcount(), 0U);
+
+    for (unsigned index=0 ; index<130 ; ++index) {
+        QVERIFY(array.isClear(index));
+    }
+}
+
+
+void TestAtomicBitArray::testSetClearMethods() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(1U, 10000U);
+    std::uniform_int_distribution<unsigned> randomBool(0U, 1U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 4 ; ++iteration) {
+        unsigned             bitLength = randomLength(rng);
+        Util::AtomicBitArray array(bitLength);
+        Util::BitArray       reference(bitLength);
+
+        std::uniform_int_distribution<unsigned> randomIndex(0U, bitLength - 1);
+
+        for (unsigned i=0 ; i<bitLength ; ++i) {
+            unsigned index    = randomIndex(rng);
+            bool     wasSet   = reference.isSet(index);
+            unsigned function = randomBool(rng) * 2 + randomBool(rng);
+
+            if (function == 0) {
+                QCOMPARE(array.testAndSet(index), wasSet);
+                reference.setBit(index);
+            } else if (function == 1) {
+                QCOMPARE(array.testAndClear(index), wasSet);
+                reference.clearBit(index);
+            } else if (function == 2) {
+                array.setBit(index);
+                reference.setBit(index);
+            } else {
+                array.clearBit(index);
+                reference.clearBit(index);
+            }
+        }
+
+        QCOMPARE(array.popcount(), reference.popcount());
+        for (unsigned index=0 ; index<bitLength ; ++index) {
+            QCOMPARE(array.isSet(index), reference.isSet(index));
+            QCOMPARE(array.isClear(index), reference.isClear(index));
+        }
+    }
+}
+
+
+void TestAtomicBitArray::testWordMethods() {
+    Util::AtomicBitArray array(100);
+
+    QCOMPARE(array.fetchOr(0, 0xF0F0ULL), 0ULL);
+    QCOMPARE(array.word(0), 0xF0F0ULL);
+    QCOMPARE(array.fetchAnd(0, 0xFF00ULL), 0xF0F0ULL);
+    QCOMPARE(array.word(0), 0xF000ULL);
+    QCOMPARE(array.fetchXor(0, 0xFFFFULL), 0xF000ULL);
+    QCOMPARE(array.word(0), 0x0FFFULL);
+
+    // Bits past the end of the array must never be set.
+
+    QCOMPARE(array.fetchOr(1, static_cast<std::uint64_t>(-1)), 0ULL);
+    QCOMPARE(array.word(1), (1ULL << 36) - 1);
+    QCOMPARE(array.fetchXor(1, static_cast<std::uint64_t>(-1)), (1ULL << 36) - 1);
+    QCOMPARE(array.word(1), 0ULL);
+    QCOMPARE(array.popcount(), 12U);
+}
+
+
+void TestAtomicBitArray::testRangeMethods() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(1U, 5000U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 8 ; ++iteration) {
+        unsigned             bitLength = randomLength(rng);
+        Util::AtomicBitArray array(bitLength);
+        Util::BitArray       reference(bitLength);
+
+        std::uniform_int_distribution<unsigned> randomIndex(0U, bitLength - 1);
+
+        for (unsigned i=0 ; i<20 ; ++i) {
+            unsigned first = randomIndex(rng);
+            unsigned last  = randomIndex(rng);
+            if (first > last) {
+                std::swap(first, last);
+            }
+
+            if (i % 3 == 2) {
+                array.clearBits(first, last);
+                reference.clearBits(first, last);
+            } else {
+                array.setBits(first, last);
+                reference.setBits(first, last);
+            }
+        }
+
+        QCOMPARE(array.popcount(), reference.popcount());
+        for (unsigned index=0 ; index<bitLength ; ++index) {
+            QCOMPARE(array.isSet(index), reference.isSet(index));
+        }
+
+        unsigned startingIndex = randomIndex(rng);
+        QCOMPARE(array.firstClearedBit(startingIndex), reference.firstClearedBit(startingIndex));
+    }
+}
+
+
+void TestAtomicBitArray::testClaimFirstClearedBit() {
+    Util::AtomicBitArray array(200);
+
+    for (unsigned index=0 ; index<200 ; ++index) {
+        QCOMPARE(array.claimFirstClearedBit(), static_cast<Util::AtomicBitArray::Index>(index));
+    }
+
+    QCOMPARE(array.claimFirstClearedBit(), Util::AtomicBitArray::invalidIndex);
+    QCOMPARE(array.firstClearedBit(), Util::AtomicBitArray::invalidIndex);
+
+    QVERIFY(array.testAndClear(150));
+    QVERIFY(array.testAndClear(70));
+    QVERIFY(!array.testAndClear(70));
+
+    QCOMPARE(array.claimFirstClearedBit(100), 150U);
+    QCOMPARE(array.claimFirstClearedBit(100), Util::AtomicBitArray::invalidIndex);
+    QCOMPARE(array.claimFirstClearedBit(), 70U);
+    QCOMPARE(array.popcount(), 200U);
+}
+
+
+void TestAtomicBitArray::testConcurrentClaims() {
+    const unsigned numberThreads  = 16;
+    const unsigned claimsPerRound = 200;
+    const unsigned numberRounds   = 20 * (numberIterations + 1);
+    const unsigned bitLength      = numberThreads * claimsPerRound;
+
+    Util::AtomicBitArray     array(bitLength);
+    std::atomic<unsigned>    duplicateClaims(0);
+    std::atomic<unsigned>    failedClaims(0);
+    std::vector<std::thread> threads;
+
+    std::vector<std::atomic<unsigned>> owners(bitLength);
+    for (unsigned index=0 ; index<bitLength ; ++index) {
+        owners[index].store(0);
+    }
+
+    for (unsigned threadIndex=0 ; threadIndex<numberThreads ; ++threadIndex) {
+        threads.push_back(
+            std::thread(
+                [&, threadIndex]() {
+                    std::vector<Util::AtomicBitArray::Index> claimed;
+
+                    for (unsigned round=0 ; round<numberRounds ; ++round) {
+                        for (unsigned i=0 ; i<claimsPerRound ; ++i) {
+                            Util::AtomicBitArray::Index startingIndex = (threadIndex * 37 + i) % bitLength;
+                            Util::AtomicBitArray::Index index         = array.claimFirstClearedBit(startingIndex);
+                            if (index == Util::AtomicBitArray::invalidIndex) {
+                                index = array.claimFirstClearedBit();
+                            }
+
+                            if (index == Util::AtomicBitArray::invalidIndex) {
+                                ++failedClaims;
+                            } else {
+                                if (owners[index].exchange(threadIndex + 1) != 0) {
+                                    ++duplicateClaims;
+                                }
+
+                                claimed.push_back(index);
+                            }
+                        }
+
+                        for (Util::AtomicBitArray::Index index : claimed) {
+                            owners[index].store(0);
+                            if (!array.testAndClear(index)) {
+                                ++duplicateClaims;
+                            }
+                        }
+
+                        claimed.clear();
+                    }
+                }
+            )
+        );
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    QCOMPARE(duplicateClaims.load(), 0U);
+    QCOMPARE(failedClaims.load(), 0U);
+    QCOMPARE(array.popcount(), 0U);
+}
@@ -31,12 +31,22 @@
 #include <QString>
 #include <QList>
 #include <QSet>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QByteArray>
+#include <QBuffer>
+#include <QDataStream>
+#include <QtEndian>
+#include <QHash>
+#include <QMap>
 
 #include <QDebug> // Debug
 
 #include <cstdint>
 #include <algorithm>
+#include <memory>
 #include <random>
+#include <vector>
 
 #include <util_bit_array.h>
 
@@ -343,6 +353,53 @@ void TestBitArray::testResizeMethod() {
 }
 
 
+void TestBitArray::testCapacityMethods() {
+    Util::BitArray bitArray;
+    QCOMPARE(bitArray.capacity(), 128U);
+
+    bitArray.reserve(1000);
+    QCOMPARE(bitArray.size(), 0U);
+    QVERIFY(bitArray.capacity() >= 1000U);
+
+    Util::BitArray::Index reservedCapacity = bitArray.capacity();
+    for (unsigned index=0 ; index<1000 ; ++index) {
+        bitArray.setBit(index, (index % 3) == 0);
+    }
+
+    QCOMPARE(bitArray.size(), 1000U);
+    QCOMPARE(bitArray.capacity(), reservedCapacity);
+
+    for (unsigned index=1000 ; index<100000 ; ++index) {
+        bitArray.setBit(index, (index % 3) == 0);
+    }
+
+    QCOMPARE(bitArray.size(), 100000U);
+    QVERIFY(bitArray.capacity() >= 100000U);
+
+    bitArray.resize(70);
+    QCOMPARE(bitArray.size(), 70U);
+    QVERIFY(bitArray.capacity() >= 100000U);
+
+    bitArray.shrinkToFit();
+    QCOMPARE(bitArray.capacity(), 128U);
+
+    bitArray.resize(20000);
+    for (unsigned index=0 ; index<20000 ; ++index) {
+        QCOMPARE(bitArray.isSet(index), index < 70 && (index % 3) == 0);
+    }
+
+    Util::BitArray bitArray2 = bitArray;
+    bitArray2.reserve(50000);
+    QVERIFY(bitArray2.capacity() >= 50000U);
+    QCOMPARE(bitArray2 == bitArray, true);
+
+    bitArray.clear();
+    QCOMPARE(bitArray.size(), 0U);
+    QCOMPARE(bitArray.capacity(), 128U);
+    QCOMPARE(bitArray == Util::BitArray(0), true);
+}
+
+
 void TestBitArray::testRangeSetClearMethods() {
     std::mt19937 rng;
     std::uniform_int_distribution<unsigned> randomBool(0U, 1U);
@@ -550,3 +607,1453 @@ void TestBitArray::testComparisonOperators() {
     }
 }
 
+
+void TestBitArray::testBooleanOperators() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomBool(0U, 1U);
+    std::uniform_int_distribution<unsigned> randomLength(0U, 5000U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 10 ; ++iteration) {
+        unsigned length1 = randomLength(rng);
+        unsigned length2 = randomLength(rng);
+
+        Util::BitArray bitArray1;
+        Util::BitArray bitArray2;
+
+        for (unsigned index=0 ; index<length1 ; ++index) {
+            bitArray1.setBit(index, randomBool(rng) == 1);
+        }
+
+        for (unsigned index=0 ; index<length2 ; ++index) {
+            bitArray2.setBit(index, randomBool(rng) == 1);
+        }
+
+        unsigned maximumLength = std::max(length1, length2);
+
+        Util::BitArray andArray        = bitArray1 & bitArray2;
+        Util::BitArray orArray         = bitArray1 | bitArray2;
+        Util::BitArray xorArray        = bitArray1 ^ bitArray2;
+        Util::BitArray differenceArray = bitArray1.differenceBits(bitArray2);
+        Util::BitArray complementArray = ~bitArray1;
+
+        QCOMPARE(andArray.size(), maximumLength);
+        QCOMPARE(orArray.size(), maximumLength);
+        QCOMPARE(xorArray.size(), maximumLength);
+        QCOMPARE(differenceArray.size(), maximumLength);
+        QCOMPARE(complementArray.size(), length1);
+
+        for (unsigned index=0 ; index<maximumLength ; ++index) {
+            bool value1 = bitArray1.isSet(index);
+            bool value2 = bitArray2.isSet(index);
+
+            QCOMPARE(andArray.isSet(index), value1 && value2);
+            QCOMPARE(orArray.isSet(index), value1 || value2);
+            QCOMPARE(xorArray.isSet(index), value1 != value2);
+            QCOMPARE(differenceArray.isSet(index), value1 && !value2);
+
+            if (index < length1) {
+                QCOMPARE(complementArray.isSet(index), !value1);
+            }
+        }
+
+        Util::BitArray inPlace = bitArray1;
+        inPlace &= bitArray2;
+        QCOMPARE(inPlace == andArray, true);
+
+        inPlace = bitArray1;
+        inPlace |= bitArray2;
+        QCOMPARE(inPlace == orArray, true);
+
+        inPlace = bitArray1;
+        inPlace ^= bitArray2;
+        QCOMPARE(inPlace == xorArray, true);
+
+        inPlace = bitArray1;
+        inPlace.andNot(bitArray2);
+        QCOMPARE(inPlace == differenceArray, true);
+
+        inPlace = bitArray1;
+        inPlace.invert();
+        QCOMPARE(inPlace == complementArray, true);
+
+        inPlace.invert();
+        QCOMPARE(inPlace == bitArray1, true);
+
+        inPlace &= inPlace;
+        QCOMPARE(inPlace == bitArray1, true);
+
+        inPlace ^= inPlace;
+        QCOMPARE(inPlace.size(), length1);
+        QCOMPARE(inPlace.firstSetBit(), Util::BitArray::invalidIndex);
+    }
+}
+
+
+void TestBitArray::testRankSelect() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 400000U);
+    std::uniform_int_distribution<unsigned> randomDensity(1U, 200U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 4 ; ++iteration) {
+        unsigned bitLength = randomLength(rng);
+        unsigned density   = randomDensity(rng);
+
+        std::uniform_int_distribution<unsigned> randomValue(0U, density);
+
+        Util::BitArray               bitArray(bitLength);
+        QList<Util::BitArray::Index> setIndexes;
+
+        for (unsigned index=0 ; index<bitLength ; ++index) {
+            if (randomValue(rng) == 0) {
+                bitArray.setBit(index);
+                setIndexes.append(index);
+            }
+        }
+
+        QCOMPARE(bitArray.popcount(), static_cast<Util::BitArray::Index>(setIndexes.size()));
+        QCOMPARE(bitArray.rank(bitLength + 10), static_cast<Util::BitArray::Index>(setIndexes.size()));
+
+        for (unsigned rank=0 ; rank<static_cast<unsigned>(setIndexes.size()) ; ++rank) {
+            Util::BitArray::Index index = setIndexes.at(rank);
+            QCOMPARE(bitArray.select(rank), index);
+            QCOMPARE(bitArray.rank(index), static_cast<Util::BitArray::Index>(rank));
+            QCOMPARE(bitArray.rank(index + 1), static_cast<Util::BitArray::Index>(rank + 1));
+        }
+
+        QCOMPARE(bitArray.select(setIndexes.size()), Util::BitArray::invalidIndex);
+
+        if (bitLength > 0) {
+            std::uniform_int_distribution<unsigned> randomIndex(0U, bitLength - 1);
+            unsigned              flipIndex  = randomIndex(rng);
+            bool                  wasSet     = bitArray.isSet(flipIndex);
+            Util::BitArray::Index beforeFlip = bitArray.rank(bitLength);
+
+            bitArray.setBit(flipIndex, !wasSet);
+            QCOMPARE(bitArray.rank(bitLength), wasSet ? beforeFlip - 1 : beforeFlip + 1);
+            QCOMPARE(bitArray.popcount(), wasSet ? beforeFlip - 1 : beforeFlip + 1);
+        }
+    }
+
+    Util::BitArray emptyArray;
+    QCOMPARE(emptyArray.popcount(), 0U);
+    QCOMPARE(emptyArray.rank(0), 0U);
+    QCOMPARE(emptyArray.select(0), Util::BitArray::invalidIndex);
+
+    Util::BitArray fullArray(1000, true);
+    QCOMPARE(fullArray.popcount(), 1000U);
+    QCOMPARE(fullArray.rank(500), 500U);
+    QCOMPARE(fullArray.select(999), 999U);
+}
+
+
+void TestBitArray::testSetBitEnumeration() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 20000U);
+    std::uniform_int_distribution<unsigned> randomDensity(0U, 300U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 8 ; ++iteration) {
+        unsigned bitLength = randomLength(rng);
+        unsigned density   = randomDensity(rng);
+
+        std::uniform_int_distribution<unsigned> randomValue(0U, density);
+
+        Util::BitArray               bitArray(bitLength);
+        QList<Util::BitArray::Index> setIndexes;
+        QList<Util::BitArray::Index> clearedIndexes;
+
+        for (unsigned index=0 ; index<bitLength ; ++index) {
+            bool value = (density < 150) ? (randomValue(rng) == 0) : (randomValue(rng) != 0);
+            if (value) {
+                bitArray.setBit(index);
+                setIndexes.append(index);
+            } else {
+                clearedIndexes.append(index);
+            }
+        }
+
+        QCOMPARE(bitArray.wordCount(), static_cast<Util::BitArray::Index>((bitLength + 63) / 64));
+
+        QList<Util::BitArray::Index> iteratedIndexes;
+        for (Util::BitArray::Index index : bitArray.setBitIndices()) {
+            iteratedIndexes.append(index);
+        }
+        QCOMPARE(iteratedIndexes, setIndexes);
+
+        QList<Util::BitArray::Index> visitedSetIndexes;
+        bitArray.forEachSetBit([&](Util::BitArray::Index index) {
+            visitedSetIndexes.append(index);
+        });
+        QCOMPARE(visitedSetIndexes, setIndexes);
+
+        QList<Util::BitArray::Index> visitedClearedIndexes;
+        bitArray.forEachClearBit([&](Util::BitArray::Index index) {
+            visitedClearedIndexes.append(index);
+        });
+        QCOMPARE(visitedClearedIndexes, clearedIndexes);
+    }
+
+    Util::BitArray emptyArray;
+    QVERIFY(emptyArray.setBitIndices().begin() == emptyArray.setBitIndices().end());
+
+    Util::BitArray sparseArray(100000);
+    sparseArray.setBit(3);
+    sparseArray.setBit(99999);
+
+    Util::BitArray::SetBitIterator it = sparseArray.setBitIndices().begin();
+    QCOMPARE(*it, 3U);
+    ++it;
+    QCOMPARE(*it, 99999U);
+    it++;
+    QVERIFY(it == sparseArray.setBitIndices().end());
+}
+
+
+void TestBitArray::testViewMethods() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<std::uint64_t> random64(0, static_cast<std::uint64_t>(-1));
+    std::uniform_int_distribution<unsigned>       randomLength(1U, 20000U);
+
+    QTemporaryDir temporaryDirectory;
+    QVERIFY(temporaryDirectory.isValid());
+
+    QString filename = temporaryDirectory.filePath("view.bits");
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 4 ; ++iteration) {
+        unsigned                   bitLength   = randomLength(rng);
+        unsigned                   numberWords = (bitLength + 63) / 64;
+        std::vector<std::uint64_t> words(numberWords);
+
+        for (unsigned index=0 ; index<numberWords ; ++index) {
+            words[index] = random64(rng);
+        }
+
+        if (bitLength % 64 != 0) {
+            words[numberWords - 1] &= (static_cast<std::uint64_t>(1) << (bitLength % 64)) - 1;
+        }
+
+        Util::BitArray expected(words.data(), bitLength);
+        Util::BitArray view = Util::BitArray::fromRawData(words.data(), bitLength);
+
+        QVERIFY(view.isView());
+        QCOMPARE(view.constData(), static_cast<const std::uint64_t*>(words.data()));
+        QVERIFY(view == expected);
+        QCOMPARE(view.popcount(), expected.popcount());
+
+        Util::BitArray copy = view;
+        copy.setBit(0, !view.isSet(0));
+
+        QVERIFY(view.isView());
+        QVERIFY(!copy.isView());
+        QVERIFY(view == expected);
+        QCOMPARE(copy.isSet(0), !expected.isSet(0));
+
+        std::uint64_t firstWord = words[0];
+        view.setBit(bitLength + 10);
+
+        QVERIFY(!view.isView());
+        QCOMPARE(words[0], firstWord);
+        QCOMPARE(view.size(), static_cast<Util::BitArray::Index>(bitLength + 11));
+        QVERIFY(view.isSet(bitLength + 10));
+
+        QVERIFY(expected.saveFile(filename));
+
+        Util::BitArray mapped;
+        QVERIFY(mapped.mapFile(filename));
+        QVERIFY(mapped == expected);
+        QCOMPARE(mapped.firstSetBit(), expected.firstSetBit());
+
+        mapped.invert();
+        QVERIFY(mapped == ~expected);
+
+        Util::BitArray reloaded;
+        QVERIFY(reloaded.mapFile(filename));
+        QVERIFY(reloaded == expected);
+    }
+
+    std::uint64_t dirtyWords[2] = { 0x0F, static_cast<std::uint64_t>(-1) };
+    Util::BitArray dirtyView = Util::BitArray::fromRawData(dirtyWords, 68);
+    QVERIFY(!dirtyView.isView());
+    QCOMPARE(dirtyView.popcount(), 8U);
+    QCOMPARE(dirtyView.constData()[1], 0x0FULL);
+
+    Util::BitArray emptyArray;
+    QVERIFY(emptyArray.saveFile(filename));
+
+    Util::BitArray loaded(100, true);
+    QVERIFY(loaded.mapFile(filename));
+    QCOMPARE(loaded.size(), 0U);
+
+    QFile badFile(filename);
+    QVERIFY(badFile.open(QFile::WriteOnly | QFile::Truncate));
+    badFile.write("not a bit array file", 20);
+    badFile.close();
+
+    Util::BitArray unchanged(100, true);
+    QVERIFY(!unchanged.mapFile(filename));
+    QCOMPARE(unchanged.size(), 100U);
+    QCOMPARE(unchanged.popcount(), 100U);
+
+    Util::BitArray large(1000);
+    large.setBit(999);
+    QVERIFY(large.saveFile(filename));
+    QVERIFY(QFile::resize(filename, 24 + 8));
+    QVERIFY(!unchanged.mapFile(filename));
+
+    // Headers claiming bit counts whose word counts overflow or exceed the file must be rejected.
+
+    QList<quint64> badBitCounts;
+    badBitCounts << static_cast<quint64>(-1) << static_cast<quint64>(-63) << 1001;
+    for (QList<quint64>::const_iterator it=badBitCounts.constBegin(),end=badBitCounts.constEnd() ; it!=end ; ++it) {
+        QVERIFY(large.saveFile(filename));
+
+        std::uint8_t bitCount[8];
+        qToLittleEndian<quint64>(*it, bitCount);
+
+        QFile patchedFile(filename);
+        QVERIFY(patchedFile.open(QFile::ReadWrite));
+        QVERIFY(patchedFile.seek(16));
+        QCOMPARE(patchedFile.write(reinterpret_cast<const char*>(bitCount), 8), qint64(8));
+        patchedFile.close();
+
+        if (*it == 1001) {
+            QVERIFY(QFile::resize(filename, 24 + 15 * 8 + 4));
+        }
+
+        QVERIFY(!unchanged.mapFile(filename));
+        QCOMPARE(unchanged.size(), 100U);
+    }
+    QVERIFY(!unchanged.mapFile(temporaryDirectory.filePath("missing.bits")));
+}
+
+
+/**
+ * Function that compares a bit array against a reference vector.
+ *
+ * \param[in] bitArray  The bit array to check.
+ *
+ * \param[in] reference The expected bit values.
+ *
+ * \return Returns true if the bit array matches the reference.
+ */
+static bool matches(const Util::BitArray& bitArray, const std::vector<bool>& reference) {
+    bool result = (bitArray.size() == reference.size());
+
+    Util::BitArray::Index index = 0;
+    while (result && index < reference.size()) {
+        result = (bitArray.isSet(index) == reference[index]);
+        ++index;
+    }
+
+    return result;
+}
+
+
+void TestBitArray::testBitRangeMethods() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(1U, 1000U);
+    std::uniform_int_distribution<unsigned> randomBool(0U, 1U);
+    std::uniform_int_distribution<unsigned> randomShift(0U, 300U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations * 50 ; ++iteration) {
+        unsigned          bitLength = randomLength(rng);
+        Util::BitArray    bitArray(bitLength);
+        std::vector<bool> reference(bitLength);
+
+        for (unsigned index=0 ; index<bitLength ; ++index) {
+            bool value = randomBool(rng) != 0;
+            bitArray.setBit(index, value);
+            reference[index] = value;
+        }
+
+        std::uniform_int_distribution<unsigned> randomIndex(0U, bitLength - 1);
+
+        // slice
+
+        unsigned first = randomIndex(rng);
+        unsigned last  = randomIndex(rng);
+        if (first > last) {
+            std::swap(first, last);
+        }
+
+        Util::BitArray slice = bitArray.slice(first, last);
+        QVERIFY(matches(slice, std::vector<bool>(reference.begin() + first, reference.begin() + last + 1)));
+
+        // copyBits from another array
+
+        unsigned          sourceLength = randomLength(rng);
+        Util::BitArray    source(sourceLength);
+        std::vector<bool> sourceReference(sourceLength);
+        for (unsigned index=0 ; index<sourceLength ; ++index) {
+            bool value = randomBool(rng) != 0;
+            source.setBit(index, value);
+            sourceReference[index] = value;
+        }
+
+        std::uniform_int_distribution<unsigned> randomSourceIndex(0U, sourceLength - 1);
+        unsigned sourceIndex      = randomSourceIndex(rng);
+        unsigned numberBits       = std::uniform_int_distribution<unsigned>(0U, sourceLength - sourceIndex)(rng);
+        unsigned destinationIndex = std::uniform_int_distribution<unsigned>(0U, bitLength + 100)(rng);
+
+        Util::BitArray    copied          = bitArray;
+        std::vector<bool> copiedReference = reference;
+
+        copied.copyBits(source, sourceIndex, numberBits, destinationIndex);
+        if (numberBits > 0 && destinationIndex + numberBits > copiedReference.size()) {
+            copiedReference.resize(destinationIndex + numberBits);
+        }
+
+        for (unsigned i=0 ; i<numberBits ; ++i) {
+            copiedReference[destinationIndex + i] = sourceReference[sourceIndex + i];
+        }
+
+        QVERIFY(matches(copied, copiedReference));
+        QVERIFY(matches(bitArray, reference));
+
+        // copyBits within the same array, including overlapping ranges
+
+        Util::BitArray    moved          = bitArray;
+        std::vector<bool> movedReference = reference;
+
+        sourceIndex      = randomIndex(rng);
+        destinationIndex = randomIndex(rng);
+        numberBits       = bitLength - std::max(sourceIndex, destinationIndex);
+
+        moved.copyBits(moved, sourceIndex, numberBits, destinationIndex);
+        std::vector<bool> movedBits(reference.begin() + sourceIndex, reference.begin() + sourceIndex + numberBits);
+        for (unsigned i=0 ; i<numberBits ; ++i) {
+            movedReference[destinationIndex + i] = movedBits[i];
+        }
+
+        QVERIFY(matches(moved, movedReference));
+
+        // shiftLeft and shiftRight
+
+        unsigned          shift          = randomShift(rng);
+        Util::BitArray    leftShifted    = bitArray;
+        Util::BitArray    rightShifted   = bitArray;
+        std::vector<bool> leftReference(bitLength, false);
+        std::vector<bool> rightReference(bitLength, false);
+
+        for (unsigned index=0 ; index<bitLength ; ++index) {
+            if (index + shift < bitLength) {
+                leftReference[index + shift] = reference[index];
+                rightReference[index]        = reference[index + shift];
+            }
+        }
+
+        leftShifted.shiftLeft(shift);
+        rightShifted.shiftRight(shift);
+
+        QVERIFY(matches(leftShifted, leftReference));
+        QVERIFY(matches(rightShifted, rightReference));
+
+        // insertBits and removeBits
+
+        unsigned          insertIndex     = std::uniform_int_distribution<unsigned>(0U, bitLength)(rng);
+        unsigned          insertCount     = randomShift(rng);
+        bool              insertValue     = randomBool(rng) != 0;
+        Util::BitArray    inserted        = bitArray;
+        std::vector<bool> insertReference = reference;
+
+        inserted.insertBits(insertIndex, insertCount, insertValue);
+        insertReference.insert(insertReference.begin() + insertIndex, insertCount, insertValue);
+        QVERIFY(matches(inserted, insertReference));
+
+        inserted.removeBits(insertIndex, insertCount);
+        QVERIFY(matches(inserted, reference));
+        QVERIFY(inserted == bitArray);
+
+        unsigned removeIndex = randomIndex(rng);
+        unsigned removeCount = std::uniform_int_distribution<unsigned>(0U, bitLength - removeIndex)(rng);
+
+        Util::BitArray    removed         = bitArray;
+        std::vector<bool> removeReference = reference;
+
+        removed.removeBits(removeIndex, removeCount);
+        removeReference.erase(
+            removeReference.begin() + removeIndex,
+            removeReference.begin() + removeIndex + removeCount
+        );
+
+        QVERIFY(matches(removed, removeReference));
+        QCOMPARE(removed.popcount(), static_cast<Util::BitArray::Index>(std::count(
+            removeReference.begin(),
+            removeReference.end(),
+            true
+        )));
+    }
+}
+
+
+void TestBitArray::testStreamMethods() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 5000U);
+    std::uniform_int_distribution<unsigned> randomBool(0U, 1U);
+    std::uniform_int_distribution<unsigned> randomRun(1U, 700U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations * 20 ; ++iteration) {
+        unsigned       bitLength = randomLength(rng);
+        Util::BitArray bitArray(bitLength);
+
+        unsigned index = 0;
+        bool     value = randomBool(rng) != 0;
+        while (index < bitLength) {
+            unsigned runLength = randomRun(rng);
+            unsigned endIndex  = std::min(index + runLength, bitLength);
+
+            if (randomBool(rng) != 0) {
+                bitArray.setBits(index, endIndex - 1, value);
+            } else {
+                while (index < endIndex) {
+                    bitArray.setBit(index, randomBool(rng) != 0);
+                    ++index;
+                }
+            }
+
+            index = endIndex;
+            value = !value;
+        }
+
+        QByteArray uncompressedData;
+        QBuffer    uncompressedBuffer(&uncompressedData);
+        uncompressedBuffer.open(QIODevice::WriteOnly);
+        QVERIFY(bitArray.write(&uncompressedBuffer, Util::BitArray::Compression::NONE));
+        uncompressedBuffer.close();
+
+        QByteArray compressedData;
+        QBuffer    compressedBuffer(&compressedData);
+        compressedBuffer.open(QIODevice::WriteOnly);
+        QVERIFY(bitArray.write(&compressedBuffer, Util::BitArray::Compression::RUN_LENGTH));
+        compressedBuffer.close();
+
+        QVERIFY(compressedData.size() <= uncompressedData.size());
+
+        Util::BitArray uncompressed(3, true);
+        uncompressedBuffer.open(QIODevice::ReadOnly);
+        QVERIFY(uncompressed.read(&uncompressedBuffer));
+        QVERIFY(uncompressed == bitArray);
+
+        Util::BitArray compressed;
+        compressedBuffer.open(QIODevice::ReadOnly);
+        QVERIFY(compressed.read(&compressedBuffer));
+        QVERIFY(compressed == bitArray);
+
+        if (compressedData.size() > 16) {
+            Util::BitArray original(7, true);
+            Util::BitArray truncated(original);
+
+            QByteArray truncatedData = compressedData.left(compressedData.size() - 1);
+            QBuffer    truncatedBuffer(&truncatedData);
+            truncatedBuffer.open(QIODevice::ReadOnly);
+            QVERIFY(!truncated.read(&truncatedBuffer));
+            QVERIFY(truncated == original);
+        }
+    }
+
+    Util::BitArray sparse(1000000);
+    sparse.setBit(17);
+    sparse.setBits(500000, 500099);
+
+    QByteArray sparseData;
+    QBuffer    sparseBuffer(&sparseData);
+    sparseBuffer.open(QIODevice::WriteOnly);
+    QVERIFY(sparse.write(&sparseBuffer));
+    sparseBuffer.close();
+
+    QVERIFY(sparseData.size() < 128);
+
+    Util::BitArray sparseCopy;
+    sparseBuffer.open(QIODevice::ReadOnly);
+    QVERIFY(sparseCopy.read(&sparseBuffer));
+    QVERIFY(sparseCopy == sparse);
+
+    QByteArray corruptData = sparseData;
+    corruptData[0] = 'X';
+
+    Util::BitArray corrupt(5, true);
+    QBuffer        corruptBuffer(&corruptData);
+    corruptBuffer.open(QIODevice::ReadOnly);
+    QVERIFY(!corrupt.read(&corruptBuffer));
+    QVERIFY(corrupt == Util::BitArray(5, true));
+
+    // Corrupt length prefixes and truncated payloads must fail cleanly without allocating the claimed length.
+
+    QList<quint64> badBitCounts;
+    badBitCounts << static_cast<quint64>(-1) << (static_cast<quint64>(1) << 62) << 1000001;
+    for (QList<quint64>::const_iterator it=badBitCounts.constBegin(),end=badBitCounts.constEnd() ; it!=end ; ++it) {
+        QByteArray badLengthData = sparseData;
+        qToLittleEndian<quint64>(*it, reinterpret_cast<uchar*>(badLengthData.data() + 8));
+
+        Util::BitArray badLength(5, true);
+        QBuffer        badLengthBuffer(&badLengthData);
+        badLengthBuffer.open(QIODevice::ReadOnly);
+        QVERIFY(!badLength.read(&badLengthBuffer));
+        QVERIFY(badLength == Util::BitArray(5, true));
+    }
+
+    QByteArray truncatedData = sparseData.left(sparseData.size() - 4);
+
+    Util::BitArray truncated(5, true);
+    QBuffer        truncatedBuffer(&truncatedData);
+    truncatedBuffer.open(QIODevice::ReadOnly);
+    QVERIFY(!truncated.read(&truncatedBuffer));
+    QVERIFY(truncated == Util::BitArray(5, true));
+
+    QByteArray streamData;
+    {
+        QBuffer streamBuffer(&streamData);
+        streamBuffer.open(QIODevice::WriteOnly);
+
+        QDataStream outStream(&streamBuffer);
+        outStream << sparse << Util::BitArray() << Util::BitArray(65, true);
+        QCOMPARE(outStream.status(), QDataStream::Ok);
+    }
+
+    {
+        QBuffer streamBuffer(&streamData);
+        streamBuffer.open(QIODevice::ReadOnly);
+
+        Util::BitArray first;
+        Util::BitArray second(9, true);
+        Util::BitArray third;
+
+        QDataStream inStream(&streamBuffer);
+        inStream >> first >> second >> third;
+        QCOMPARE(inStream.status(), QDataStream::Ok);
+
+        QVERIFY(first == sparse);
+        QCOMPARE(second.size(), static_cast<Util::BitArray::Index>(0));
+        QVERIFY(third == Util::BitArray(65, true));
+
+        Util::BitArray pastEnd(4);
+        inStream >> pastEnd;
+        QVERIFY(inStream.status() != QDataStream::Ok);
+        QCOMPARE(pastEnd.size(), static_cast<Util::BitArray::Index>(4));
+    }
+}
+
+
+void TestBitArray::testInlineStorage() {
+    Util::BitArray small(100, true);
+    QCOMPARE(small.capacity(), 128U);
+    QCOMPARE(small.popcount(), 100U);
+    QCOMPARE(small.rank(50), 50U);
+    QCOMPARE(small.select(99), 99U);
+    QCOMPARE(small.select(100), Util::BitArray::invalidIndex);
+
+    Util::BitArray copy(small);
+    copy.clearBit(10);
+    QVERIFY(small.isSet(10));
+    QVERIFY(copy.isClear(10));
+    QVERIFY(copy != small);
+
+    copy.setBit(127);
+    QCOMPARE(copy.size(), 128U);
+    QCOMPARE(copy.capacity(), 128U);
+
+    copy.setBit(128);
+    QCOMPARE(copy.size(), 129U);
+    QVERIFY(copy.capacity() > 128U);
+    QCOMPARE(copy.popcount(), 101U);
+    QVERIFY(copy.isSet(127));
+    QVERIFY(copy.isClear(10));
+
+    Util::BitArray shared(copy);
+    shared.resize(100);
+    QCOMPARE(copy.size(), 129U);
+    QVERIFY(shared != small);
+
+    shared.setBit(10);
+    QVERIFY(shared == small);
+
+    shared.shrinkToFit();
+    QCOMPARE(shared.capacity(), 128U);
+    QVERIFY(shared == small);
+
+    Util::BitArray aliased(small);
+    aliased ^= aliased;
+    QCOMPARE(aliased.size(), 100U);
+    QCOMPARE(aliased.popcount(), 0U);
+
+    aliased = small;
+    aliased.copyBits(aliased, 0, 100, 60);
+    QCOMPARE(aliased.size(), 160U);
+    QCOMPARE(aliased.popcount(), 160U);
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 200U);
+    std::uniform_int_distribution<unsigned> randomBool(0U, 1U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations * 100 ; ++iteration) {
+        unsigned          firstLength  = randomLength(rng);
+        unsigned          secondLength = randomLength(rng);
+        Util::BitArray    first;
+        Util::BitArray    second(secondLength);
+        std::vector<bool> firstReference(firstLength);
+        std::vector<bool> secondReference(secondLength);
+
+        for (unsigned index=0 ; index<firstLength ; ++index) {
+            bool value = randomBool(rng) != 0;
+            first.setBit(index, value);
+            firstReference[index] = value;
+        }
+
+        for (unsigned index=0 ; index<secondLength ; ++index) {
+            bool value = randomBool(rng) != 0;
+            second.setBit(index, value);
+            secondReference[index] = value;
+        }
+
+        QCOMPARE(first.size(), static_cast<Util::BitArray::Index>(firstLength));
+        QCOMPARE(first.capacity() == 128U, firstLength <= 128);
+
+        unsigned maximumLength = std::max(firstLength, secondLength);
+        Util::BitArray intersection = first & second;
+        Util::BitArray unionBits    = first | second;
+        Util::BitArray difference   = first ^ second;
+
+        QCOMPARE(intersection.size(), static_cast<Util::BitArray::Index>(maximumLength));
+        QCOMPARE(unionBits.size(), static_cast<Util::BitArray::Index>(maximumLength));
+        QCOMPARE(difference.size(), static_cast<Util::BitArray::Index>(maximumLength));
+
+        for (unsigned index=0 ; index<maximumLength ; ++index) {
+            bool firstValue  = index < firstLength && firstReference[index];
+            bool secondValue = index < secondLength && secondReference[index];
+
+            QCOMPARE(intersection.isSet(index), firstValue && secondValue);
+            QCOMPARE(unionBits.isSet(index), firstValue || secondValue);
+            QCOMPARE(difference.isSet(index), firstValue != secondValue);
+        }
+
+        Util::BitArray rebuilt(static_cast<Util::BitArray::Index>(0));
+        rebuilt.resize(firstLength);
+        for (unsigned index=0 ; index<firstLength ; ++index) {
+            rebuilt.setBit(index, firstReference[index]);
+        }
+
+        QVERIFY(rebuilt == first);
+        QCOMPARE(rebuilt.popcount(), first.popcount());
+
+        if (firstLength > 0) {
+            unsigned       endingIndex = firstLength - 1;
+            Util::BitArray sliced      = first.slice(0, endingIndex);
+            QVERIFY(sliced == first);
+        }
+
+        first.clear();
+        QCOMPARE(first.size(), 0U);
+        QVERIFY(first == Util::BitArray());
+    }
+}
+
+
+void TestBitArray::testParallelMethods() {
+    const Util::BitArray::Execution parallel   = Util::BitArray::Execution::PARALLEL;
+    const Util::BitArray::Index     bitLength  = 20000003;
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<Util::BitArray::Index> randomIndex(0, bitLength - 1);
+
+    Util::BitArray empty(bitLength);
+    QCOMPARE(empty.popcount(parallel), 0U);
+    QCOMPARE(empty.firstSetBit(parallel), Util::BitArray::invalidIndex);
+    QCOMPARE(empty.firstClearedBit(parallel), 0U);
+
+    Util::BitArray full(bitLength, true);
+    QCOMPARE(full.popcount(parallel), bitLength);
+    QCOMPARE(full.firstSetBit(parallel), 0U);
+    QCOMPARE(full.firstClearedBit(parallel), Util::BitArray::invalidIndex);
+    QVERIFY(!full.isEqualTo(empty, parallel));
+
+    for (unsigned iteration=0 ; iteration<numberIterations ; ++iteration) {
+        Util::BitArray::Index first  = randomIndex(rng);
+        Util::BitArray::Index second = randomIndex(rng);
+
+        Util::BitArray sparse(bitLength);
+        sparse.setBit(first);
+        sparse.setBit(second);
+
+        QCOMPARE(sparse.popcount(parallel), sparse.popcount());
+        QCOMPARE(sparse.firstSetBit(parallel), std::min(first, second));
+
+        Util::BitArray holes(bitLength, true);
+        holes.clearBit(first);
+        holes.clearBit(second);
+
+        QCOMPARE(holes.popcount(parallel), holes.popcount());
+        QCOMPARE(holes.firstClearedBit(parallel), std::min(first, second));
+
+        Util::BitArray copy(sparse);
+        copy.setBit(0, copy.isClear(0));
+        QVERIFY(sparse.isEqualTo(sparse, parallel));
+        QVERIFY(!copy.isEqualTo(sparse, parallel));
+
+        copy.setBit(0, copy.isClear(0));
+        QVERIFY(copy.isEqualTo(sparse, parallel));
+
+        copy.setBit(bitLength - 1, copy.isClear(bitLength - 1));
+        QVERIFY(!copy.isEqualTo(sparse, parallel));
+
+        Util::BitArray::Index startingIndex = std::min(first, second);
+        Util::BitArray::Index endingIndex   = std::max(first, second);
+
+        Util::BitArray sequentialFill(holes);
+        Util::BitArray parallelFill(holes);
+        sequentialFill.clearBits(startingIndex, endingIndex);
+        parallelFill.clearBits(startingIndex, endingIndex, true, parallel);
+        QVERIFY(parallelFill == sequentialFill);
+
+        sequentialFill.setBits(startingIndex, endingIndex + 1000, true);
+        parallelFill.setBits(startingIndex, endingIndex + 1000, true, parallel);
+        QVERIFY(parallelFill == sequentialFill);
+        QCOMPARE(parallelFill.size(), std::max(bitLength, endingIndex + 1001));
+
+        Util::BitArray shorter(bitLength / 2 + first % 1000);
+        for (unsigned index=0 ; index<1000 ; ++index) {
+            shorter.setBit(randomIndex(rng) % shorter.size());
+        }
+
+        QVERIFY(holes.intersectionBits(shorter, parallel) == (holes & shorter));
+        QVERIFY(holes.unionBits(shorter, parallel) == (holes | shorter));
+        QVERIFY(holes.symmetricDifferenceBits(shorter, parallel) == (holes ^ shorter));
+        QVERIFY(holes.differenceBits(shorter, parallel) == holes.differenceBits(shorter));
+        QVERIFY(shorter.differenceBits(holes, parallel) == shorter.differenceBits(holes));
+    }
+
+    Util::BitArray small(100);
+    small.setBit(42);
+    QCOMPARE(small.popcount(parallel), 1U);
+    QCOMPARE(small.firstSetBit(parallel), 42U);
+    QVERIFY(small.isEqualTo(small, parallel));
+}
+
+
+void TestBitArray::testReverseSearchMethods() {
+    Util::BitArray empty;
+    QCOMPARE(empty.lastSetBit(), Util::BitArray::invalidIndex);
+    QCOMPARE(empty.lastClearedBit(), Util::BitArray::invalidIndex);
+    QCOMPARE(empty.previousSetBit(10), Util::BitArray::invalidIndex);
+    QCOMPARE(empty.previousClearedBit(10), Util::BitArray::invalidIndex);
+
+    Util::BitArray full(130, true);
+    QCOMPARE(full.lastSetBit(), 129U);
+    QCOMPARE(full.lastClearedBit(), Util::BitArray::invalidIndex);
+    QCOMPARE(full.previousSetBit(1000), 129U);
+    QCOMPARE(full.previousClearedBit(1000), Util::BitArray::invalidIndex);
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(1U, 1000U);
+    std::uniform_int_distribution<unsigned> randomDensity(0U, 100U);
+    std::uniform_int_distribution<unsigned> randomPercent(0U, 99U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations * 20 ; ++iteration) {
+        unsigned          bitLength = randomLength(rng);
+        unsigned          density   = randomDensity(rng);
+        Util::BitArray    bitArray(bitLength);
+        std::vector<bool> reference(bitLength);
+
+        for (unsigned index=0 ; index<bitLength ; ++index) {
+            bool value = randomPercent(rng) < density;
+            bitArray.setBit(index, value);
+            reference[index] = value;
+        }
+
+        Util::BitArray::Index expectedLastSet     = Util::BitArray::invalidIndex;
+        Util::BitArray::Index expectedLastCleared = Util::BitArray::invalidIndex;
+        for (unsigned index=0 ; index<bitLength+10 ; ++index) {
+            if (index < bitLength) {
+                if (reference[index]) {
+                    expectedLastSet = index;
+                } else {
+                    expectedLastCleared = index;
+                }
+            }
+
+            QCOMPARE(bitArray.previousSetBit(index), expectedLastSet);
+            QCOMPARE(bitArray.previousClearedBit(index), expectedLastCleared);
+        }
+
+        QCOMPARE(bitArray.lastSetBit(), expectedLastSet);
+        QCOMPARE(bitArray.lastClearedBit(), expectedLastCleared);
+        QCOMPARE(bitArray.lastSetBit(Util::BitArray::Execution::PARALLEL), expectedLastSet);
+        QCOMPARE(bitArray.lastClearedBit(Util::BitArray::Execution::PARALLEL), expectedLastCleared);
+    }
+
+    const Util::BitArray::Index bitLength = 20000003;
+    std::uniform_int_distribution<Util::BitArray::Index> randomIndex(0, bitLength - 1);
+
+    for (unsigned iteration=0 ; iteration<numberIterations ; ++iteration) {
+        Util::BitArray::Index first  = randomIndex(rng);
+        Util::BitArray::Index second = randomIndex(rng);
+        Util::BitArray::Index lower  = std::min(first, second);
+        Util::BitArray::Index upper  = std::max(first, second);
+
+        Util::BitArray sparse(bitLength);
+        sparse.setBit(first);
+        sparse.setBit(second);
+
+        QCOMPARE(sparse.lastSetBit(), upper);
+        QCOMPARE(sparse.lastSetBit(Util::BitArray::Execution::PARALLEL), upper);
+        if (lower != upper) {
+            QCOMPARE(sparse.previousSetBit(upper - 1), lower);
+        }
+
+        Util::BitArray holes(bitLength, true);
+        holes.clearBit(first);
+        holes.clearBit(second);
+
+        QCOMPARE(holes.lastClearedBit(), upper);
+        QCOMPARE(holes.lastClearedBit(Util::BitArray::Execution::PARALLEL), upper);
+    }
+}
+
+
+static Util::BitArray::Index findRun(
+        const std::vector<bool>& reference,
+        bool                     value,
+        Util::BitArray::Index    length,
+        Util::BitArray::Index    startingIndex
+    ) {
+    Util::BitArray::Index result    = Util::BitArray::invalidIndex;
+    Util::BitArray::Index runLength = 0;
+    Util::BitArray::Index index     = startingIndex;
+
+    while (result == Util::BitArray::invalidIndex && index < reference.size()) {
+        runLength = reference[index] == value ? runLength + 1 : 0;
+        if (runLength == length) {
+            result = index + 1 - length;
+        }
+
+        ++index;
+    }
+
+    return result;
+}
+
+
+void TestBitArray::testRunSearchMethods() {
+    Util::BitArray empty;
+    QCOMPARE(empty.findClearRun(1), Util::BitArray::invalidIndex);
+    QCOMPARE(empty.findSetRun(1), Util::BitArray::invalidIndex);
+
+    Util::BitArray free(1000);
+    QCOMPARE(free.findClearRun(1000), 0U);
+    QCOMPARE(free.findClearRun(1001), Util::BitArray::invalidIndex);
+    QCOMPARE(free.findClearRun(500, 500), 500U);
+    QCOMPARE(free.findClearRun(501, 500), Util::BitArray::invalidIndex);
+    QCOMPARE(free.findSetRun(1), Util::BitArray::invalidIndex);
+
+    free.setBits(0, 99);
+    free.setBits(163, 300);
+    QCOMPARE(free.findClearRun(63), 100U);
+    QCOMPARE(free.findClearRun(64), 301U);
+    QCOMPARE(free.findSetRun(138), 163U);
+    QCOMPARE(free.findSetRun(139), Util::BitArray::invalidIndex);
+    QCOMPARE(free.findSetRun(40, 60), 60U);
+    QCOMPARE(free.findSetRun(41, 60), 163U);
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(1U, 2000U);
+    std::uniform_int_distribution<unsigned> randomPercent(0U, 99U);
+    std::uniform_int_distribution<unsigned> randomRunLength(1U, 200U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations * 20 ; ++iteration) {
+        unsigned          bitLength = randomLength(rng);
+        Util::BitArray    bitArray(bitLength);
+        std::vector<bool> reference(bitLength);
+
+        // Build a fragmented map from runs of random length so that long runs of both values exist.
+
+        unsigned index = 0;
+        while (index < bitLength) {
+            bool     value     = randomPercent(rng) < 50;
+            unsigned runLength = std::min(randomRunLength(rng), bitLength - index);
+
+            for (unsigned offset=0 ; offset<runLength ; ++offset) {
+                bitArray.setBit(index + offset, value);
+                reference[index + offset] = value;
+            }
+
+            index += runLength;
+        }
+
+        for (unsigned check=0 ; check<20 ; ++check) {
+            Util::BitArray::Index length        = randomRunLength(rng);
+            Util::BitArray::Index startingIndex = randomPercent(rng) < 50 ? 0 : randomLength(rng) % bitLength;
+
+            QCOMPARE(bitArray.findClearRun(length, startingIndex), findRun(reference, false, length, startingIndex));
+            QCOMPARE(bitArray.findSetRun(length, startingIndex), findRun(reference, true, length, startingIndex));
+        }
+    }
+}
+
+
+void TestBitArray::testMoveSemantics() {
+    Util::BitArray small(100);
+    small.setBit(3);
+    small.setBit(99);
+
+    Util::BitArray movedSmall(std::move(small));
+    QCOMPARE(movedSmall.size(), 100U);
+    QCOMPARE(movedSmall.isSet(3), true);
+    QCOMPARE(movedSmall.isSet(99), true);
+    QCOMPARE(movedSmall.popcount(), 2U);
+    QCOMPARE(small.size(), 0U);
+    QCOMPARE(small.popcount(), 0U);
+
+    Util::BitArray large(10000);
+    large.setBit(9999);
+
+    Util::BitArray movedLarge(std::move(large));
+    QCOMPARE(movedLarge.size(), 10000U);
+    QCOMPARE(movedLarge.isSet(9999), true);
+    QCOMPARE(large.size(), 0U);
+
+    large.setBit(5);
+    QCOMPARE(large.size(), 6U);
+    QCOMPARE(movedLarge.isSet(5), false);
+
+    Util::BitArray target(200, true);
+    target = std::move(movedSmall);
+    QCOMPARE(target.size(), 100U);
+    QCOMPARE(target.popcount(), 2U);
+    QCOMPARE(movedSmall.size(), 200U);
+    QCOMPARE(movedSmall.popcount(), 200U);
+
+    target = std::move(movedLarge);
+    QCOMPARE(target.size(), 10000U);
+    QCOMPARE(target.isSet(9999), true);
+    QCOMPARE(movedLarge.size(), 100U);
+    QCOMPARE(movedLarge.popcount(), 2U);
+
+    std::vector<Util::BitArray> arrays;
+    for (unsigned i=0 ; i<100 ; ++i) {
+        arrays.push_back(Util::BitArray(64 * i + 1, true));
+    }
+
+    for (unsigned i=0 ; i<100 ; ++i) {
+        QCOMPARE(arrays[i].size(), 64U * i + 1);
+        QCOMPARE(arrays[i].popcount(), 64U * i + 1);
+    }
+}
+
+
+void TestBitArray::testMutator() {
+    std::mt19937 rng;
+
+    for (Util::BitArray::Index bitLength : {0U, 1U, 100U, 128U, 129U, 5000U}) {
+        Util::BitArray    original(bitLength);
+        std::vector<bool> reference(bitLength);
+
+        Util::BitArray shared = original;
+        {
+            Util::BitArray::Mutator mutator(original);
+            QCOMPARE(mutator.size(), bitLength);
+            QCOMPARE(mutator.numberWords(), (bitLength + 63) / 64);
+
+            for (Util::BitArray::Index i=0 ; bitLength > 0 && i<bitLength * 2 ; ++i) {
+                Util::BitArray::Index index = rng() % bitLength;
+                bool                  value = (rng() & 1) != 0;
+
+                mutator.setBit(index, value);
+                reference[index] = value;
+
+                QCOMPARE(mutator.isSet(index), value);
+            }
+
+            if (bitLength > 0) {
+                mutator.setBit(0);
+                mutator.clearBit(bitLength - 1);
+                reference[0]             = true;
+                reference[bitLength - 1] = false;
+            }
+        }
+
+        QCOMPARE(shared.popcount(), 0U);
+
+        Util::BitArray::Index expectedCount = 0;
+        for (Util::BitArray::Index i=0 ; i<bitLength ; ++i) {
+            QCOMPARE(original.isSet(i), static_cast<bool>(reference[i]));
+            expectedCount += reference[i] ? 1 : 0;
+        }
+
+        QCOMPARE(original.popcount(), expectedCount);
+    }
+
+    // The rank/select index must be rebuilt after an update through a mutator.
+
+    Util::BitArray large(10000);
+    large.setBit(5000);
+    QCOMPARE(large.rank(9999), 1U);
+    {
+        Util::BitArray::Mutator mutator(large);
+        mutator.words()[0] = 0xFF;
+    }
+
+    QCOMPARE(large.rank(9999), 9U);
+    QCOMPARE(large.select(8), 5000U);
+
+    // Views must be copied before being updated.
+
+    std::uint64_t  external[100] = { 0 };
+    Util::BitArray view          = Util::BitArray::fromRawData(external, 6400);
+    {
+        Util::BitArray::Mutator mutator(view);
+        mutator.setBit(17);
+    }
+
+    QCOMPARE(view.isSet(17), true);
+    QCOMPARE(external[0], 0U);
+
+    // Bits written past the end of the array through words() must be cleared when the mutator is destroyed.
+
+    QList<Util::BitArray::Index> tailLengths;
+    tailLengths << 100 << 1000;
+    for (Util::BitArray::Index tailLength : tailLengths) {
+        Util::BitArray tail(tailLength);
+        {
+            Util::BitArray::Mutator mutator(tail);
+            for (Util::BitArray::Index wordIndex=0 ; wordIndex<mutator.numberWords() ; ++wordIndex) {
+                mutator.words()[wordIndex] = static_cast<std::uint64_t>(-1);
+            }
+        }
+
+        QCOMPARE(tail.popcount(), tailLength);
+        QVERIFY(tail == Util::BitArray(tailLength, true));
+        QCOMPARE(tail.hash(), Util::BitArray(tailLength, true).hash());
+    }
+}
+
+
+void TestBitArray::testAllocators() {
+    Util::BitArrayArena arena(1024);
+
+    QList<Util::BitArrayAllocator*> allocators;
+    allocators << Util::BitArrayAllocator::standard()
+               << Util::BitArrayAllocator::threadPool()
+               << Util::BitArrayAllocator::hugePages()
+               << &arena;
+
+    for (Util::BitArrayAllocator* allocator : allocators) {
+        for (Util::BitArray::Index bitLength : {10U, 129U, 5000U, 100000U, 30000000U}) {
+            Util::BitArray bitArray(bitLength, true, allocator);
+            QCOMPARE(bitArray.allocator(), allocator);
+            QCOMPARE(bitArray.size(), bitLength);
+            QCOMPARE(bitArray.popcount(), bitLength);
+
+            {
+                Util::BitArray::Mutator mutator(bitArray);
+                if (bitLength > 128) {
+                    // Arrays held inline do not use the allocator.
+
+                    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(mutator.words());
+                    QCOMPARE(address % Util::BitArrayAllocator::alignment, 0U);
+                }
+
+                mutator.clearBit(bitLength / 2);
+            }
+
+            Util::BitArray copy = bitArray;
+            copy.setBit(bitLength / 2);
+            QCOMPARE(copy.allocator(), allocator);
+            QCOMPARE(copy.popcount(), bitLength);
+            QCOMPARE(bitArray.popcount(), bitLength - 1);
+
+            bitArray.resize(2 * bitLength);
+            QCOMPARE(bitArray.allocator(), allocator);
+            QCOMPARE(bitArray.popcount(), bitLength - 1);
+            QCOMPARE(bitArray.lastSetBit(), bitLength - 1);
+
+            bitArray.shrinkToFit();
+            QCOMPARE(bitArray.popcount(), bitLength - 1);
+        }
+    }
+
+    // Arrays grown past the inline buffer must obtain storage from their allocator.
+
+    arena.reset();
+    QCOMPARE(arena.heldWords(), 0U);
+
+    Util::BitArray grown(0, false, &arena);
+    for (Util::BitArray::Index i=0 ; i<10000 ; i+=3) {
+        grown.setBit(i);
+    }
+
+    QCOMPARE(grown.allocator(), &arena);
+    QCOMPARE(grown.popcount(), 3334U);
+    QVERIFY(arena.heldWords() >= 10000U / 64);
+
+    grown.clear();
+    arena.reset();
+    QCOMPARE(arena.heldWords(), 0U);
+
+    // Released storage is reused by the pooled allocator.
+
+    Util::BitArrayAllocator* pool  = Util::BitArrayAllocator::threadPool();
+    std::uint64_t*           first = pool->allocate(100);
+    pool->release(first, 100);
+
+    std::uint64_t* second = pool->allocate(100);
+    QCOMPARE(second, first);
+    pool->release(second, 100);
+
+    // Arena allocations are cache line aligned and requests larger than a block receive their own block.
+
+    std::uint64_t* small = arena.allocate(3);
+    std::uint64_t* next  = arena.allocate(3);
+    QCOMPARE(next - small, 8);
+    QCOMPARE(arena.heldWords(), 1024U);
+
+    std::uint64_t* large = arena.allocate(5000);
+    QCOMPARE(reinterpret_cast<std::uintptr_t>(large) % Util::BitArrayAllocator::alignment, 0U);
+    QCOMPARE(arena.heldWords(), 1024U + 5000U);
+}
+
+
+void TestBitArray::testHashAndOrdering() {
+    // Equal arrays hash identically regardless of how they are stored.
+
+    std::uint64_t  rawData[64] = { 0 };
+    rawData[0]  = 0x0123456789ABCDEFULL;
+    rawData[1]  = 0x00000000000000FFULL;
+    rawData[40] = 0x8000000000000001ULL;
+
+    Util::BitArray inlineArray(rawData, 72);
+    Util::BitArray viewArray = Util::BitArray::fromRawData(rawData, 72);
+    QCOMPARE(inlineArray, viewArray);
+    QCOMPARE(inlineArray.hash(), viewArray.hash());
+    QCOMPARE(inlineArray.hash(17), viewArray.hash(17));
+    QCOMPARE(Util::qHash(inlineArray), inlineArray.hash());
+
+    Util::BitArray large(rawData, 4096);
+    Util::BitArray largeCopy(rawData, 4096);
+    QCOMPARE(large.hash(), largeCopy.hash());
+    QVERIFY(large.hash() != inlineArray.hash());
+
+    // Length is part of the hash, and the cached hash follows modifications.
+
+    QVERIFY(Util::BitArray(100).hash() != Util::BitArray(101).hash());
+
+    Util::HashResult original = large.hash();
+    large.setBit(2000);
+    QVERIFY(large.hash() != original);
+    large.clearBit(2000);
+    QCOMPARE(large.hash(), original);
+
+    Util::BitArray shared = large;
+    shared.setBit(3000);
+    QCOMPARE(large.hash(), original);
+    QVERIFY(shared.hash() != original);
+
+    {
+        Util::BitArray::Mutator mutator(large);
+        mutator.setBit(2500);
+    }
+
+    QVERIFY(large.hash() != original);
+
+    // Ordering is lexicographic by bit, starting at bit zero.
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 300U);
+
+    std::vector<Util::BitArray>    arrays;
+    std::vector<std::vector<bool>> references;
+    for (unsigned i=0 ; i<numberIterations * 100 ; ++i) {
+        unsigned          bitLength = randomLength(rng);
+        Util::BitArray    bitArray(bitLength);
+        std::vector<bool> reference(bitLength);
+
+        // Use few set bits so that many arrays share long common prefixes.
+
+        for (unsigned index=0 ; index<bitLength ; ++index) {
+            if (rng() % 64 == 0) {
+                bitArray.setBit(index);
+                reference[index] = true;
+            }
+        }
+
+        arrays.push_back(bitArray);
+        references.push_back(reference);
+    }
+
+    for (unsigned i=0 ; i<arrays.size() ; ++i) {
+        for (unsigned j=0 ; j<arrays.size() ; ++j) {
+            QCOMPARE(arrays[i] < arrays[j], references[i] < references[j]);
+        }
+    }
+
+    QHash<Util::BitArray, unsigned> hash;
+    QMap<Util::BitArray, unsigned>  map;
+    for (unsigned i=0 ; i<arrays.size() ; ++i) {
+        hash.insert(arrays[i], i);
+        map.insert(arrays[i], i);
+    }
+
+    for (unsigned i=0 ; i<arrays.size() ; ++i) {
+        QCOMPARE(references[hash.value(arrays[i])], references[i]);
+        QCOMPARE(references[map.value(arrays[i])], references[i]);
+    }
+}
+
+
+void TestBitArray::testExtractDeposit() {
+    Util::BitArray empty;
+    QCOMPARE(empty.extract(Util::BitArray(100)).size(), 0U);
+    QCOMPARE(Util::BitArray::deposit(Util::BitArray(100), empty), Util::BitArray(100));
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 3000U);
+    std::uniform_int_distribution<unsigned> randomDensity(0U, 4U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations * 50 ; ++iteration) {
+        unsigned sourceLength = randomLength(rng);
+        unsigned maskLength   = iteration % 4 == 0 ? randomLength(rng) : sourceLength;
+
+        // Mix sparse, dense, empty and full mask regions so that every per-word path is exercised.
+
+        Util::BitArray    source(sourceLength);
+        Util::BitArray    mask(maskLength);
+        std::vector<bool> sourceReference(sourceLength);
+        std::vector<bool> maskReference(maskLength);
+
+        for (unsigned index=0 ; index<sourceLength ; ++index) {
+            bool value = (rng() & 1) != 0;
+            source.setBit(index, value);
+            sourceReference[index] = value;
+        }
+
+        unsigned density = 0;
+        for (unsigned index=0 ; index<maskLength ; ++index) {
+            if (index % 64 == 0) {
+                density = randomDensity(rng);
+            }
+
+            bool value = density == 4 || (density > 0 && rng() % (1U << (2 * density)) == 0);
+            mask.setBit(index, value);
+            maskReference[index] = value;
+        }
+
+        std::vector<bool> extractedReference;
+        for (unsigned index=0 ; index<maskLength ; ++index) {
+            if (maskReference[index]) {
+                extractedReference.push_back(index < sourceLength && sourceReference[index]);
+            }
+        }
+
+        Util::BitArray extracted = source.extract(mask);
+        QCOMPARE(extracted.size(), static_cast<Util::BitArray::Index>(extractedReference.size()));
+        for (unsigned index=0 ; index<extractedReference.size() ; ++index) {
+            QCOMPARE(extracted.isSet(index), static_cast<bool>(extractedReference[index]));
+        }
+
+        Util::BitArray deposited = Util::BitArray::deposit(mask, extracted);
+        QCOMPARE(deposited.size(), static_cast<Util::BitArray::Index>(maskLength));
+        for (unsigned index=0 ; index<maskLength ; ++index) {
+            bool expected = maskReference[index] && index < sourceLength && sourceReference[index];
+            QCOMPARE(deposited.isSet(index), expected);
+        }
+
+        // Depositing too few values leaves the remaining selected positions cleared.
+
+        Util::BitArray::Index half    = extracted.size() / 2;
+        Util::BitArray        partial = half > 0 ? extracted.slice(0, half - 1) : Util::BitArray();
+        Util::BitArray        sparse  = Util::BitArray::deposit(mask, partial);
+        QCOMPARE(sparse.popcount(), partial.popcount());
+
+        Util::BitArray roundTrip = sparse.extract(mask);
+        QCOMPARE(roundTrip.size(), extracted.size());
+        QCOMPARE(roundTrip.popcount(), partial.popcount());
+        for (unsigned index=0 ; index<half ; ++index) {
+            QCOMPARE(roundTrip.isSet(index), partial.isSet(index));
+        }
+    }
+}
+
+
+void TestBitArray::testPackAndUnpack() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 1000U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations * 20 ; ++iteration) {
+        unsigned length = iteration < 130 ? iteration : randomLength(rng);
+
+        // Byte flags use arbitrary non-zero values so that packing must test each byte, not just its low bit.
+
+        std::unique_ptr<bool[]>         boolValues(new bool[length + 1]);
+        std::unique_ptr<std::uint8_t[]> byteValues(new std::uint8_t[length + 1]);
+        for (unsigned index=0 ; index<length ; ++index) {
+            std::uint8_t value = static_cast<std::uint8_t>(rng() & 0xFF);
+            if (iteration % 3 == 0) {
+                value = value < 0x80 ? 0 : value;
+            }
+
+            boolValues[index] = value != 0;
+            byteValues[index] = value;
+        }
+
+        Util::BitArray fromBools(boolValues.get(), length);
+        Util::BitArray fromBytes = Util::BitArray::fromBytes(byteValues.get(), length);
+
+        QCOMPARE(fromBools.size(), static_cast<Util::BitArray::Index>(length));
+        QCOMPARE(fromBytes, fromBools);
+
+        for (unsigned index=0 ; index<length ; ++index) {
+            QCOMPARE(fromBools.isSet(index), boolValues[index]);
+        }
+
+        // A sentinel past the end confirms that unpacking writes exactly one value per bit.
+
+        std::unique_ptr<bool[]>         unpackedBools(new bool[length + 1]);
+        std::unique_ptr<std::uint8_t[]> unpackedBytes(new std::uint8_t[length + 1]);
+        unpackedBools[length] = true;
+        unpackedBytes[length] = 0xA5;
+
+        fromBools.toBools(unpackedBools.get());
+        fromBools.toBytes(unpackedBytes.get());
+
+        for (unsigned index=0 ; index<length ; ++index) {
+            QCOMPARE(unpackedBools[index], boolValues[index]);
+            QCOMPARE(unpackedBytes[index], static_cast<std::uint8_t>(boolValues[index] ? 1 : 0));
+        }
+
+        QCOMPARE(unpackedBools[length], true);
+        QCOMPARE(unpackedBytes[length], static_cast<std::uint8_t>(0xA5));
+    }
+}
+
+
+void TestBitArray::testIndexLists() {
+    QCOMPARE(Util::BitArray().toIndexList().empty(), true);
+    QCOMPARE(Util::BitArray::fromIndexList(std::vector<Util::BitArray::Index>()).size(), 0UL);
+    QCOMPARE(Util::BitArray::fromIndexList(std::vector<Util::BitArray::Index>(), 70).size(), 70UL);
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(1U, 5000U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations * 20 ; ++iteration) {
+        unsigned       length = randomLength(rng);
+        unsigned       spread = 1U << (iteration % 8);
+        Util::BitArray array(length);
+
+        std::vector<Util::BitArray::Index> indexes;
+        for (unsigned index=0 ; index<length ; ++index) {
+            if (rng() % spread == 0) {
+                array.setBit(index);
+                indexes.push_back(index);
+            }
+        }
+
+        QCOMPARE(array.toIndexList() == indexes, true);
+        QCOMPARE(Util::BitArray::fromIndexList(indexes, length), array);
+
+        Util::BitArray trimmed = Util::BitArray::fromIndexList(indexes);
+        QCOMPARE(trimmed.size(), indexes.empty() ? 0UL : indexes.back() + 1);
+        QCOMPARE(trimmed.popcount(), static_cast<Util::BitArray::Index>(indexes.size()));
+
+        // Unsorted input produces the same array.
+
+        std::shuffle(indexes.begin(), indexes.end(), rng);
+        QCOMPARE(Util::BitArray::fromIndexList(indexes, length), array);
+    }
+}
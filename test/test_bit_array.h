@@ -51,9 +51,27 @@ class TestBitArray:public QObject {
         void testAssignmentOperator();
         void testBasicAccessors();
         void testResizeMethod();
+        void testCapacityMethods();
         void testRangeSetClearMethods();
         void testSearchMethods();
         void testComparisonOperators();
+        void testBooleanOperators();
+        void testRankSelect();
+        void testSetBitEnumeration();
+        void testViewMethods();
+        void testBitRangeMethods();
+        void testStreamMethods();
+        void testInlineStorage();
+        void testParallelMethods();
+        void testReverseSearchMethods();
+        void testRunSearchMethods();
+        void testMoveSemantics();
+        void testMutator();
+        void testAllocators();
+        void testHashAndOrdering();
+        void testExtractDeposit();
+        void testPackAndUnpack();
+        void testIndexLists();
 };
 
 #endif
@@ -122,6 +122,41 @@ void TestBitFunctions::testMsbLocation64() {
 }
 
 
+void TestBitFunctions::testLsbLocation32() {
+    QCOMPARE(Util::lsbLocation32(0), -1);
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned>      bitLocation(0, 31);
+    std::uniform_int_distribution<std::uint32_t> randomBits(0UL, static_cast<std::uint32_t>(-1));
+
+    for (unsigned i=0 ; i<numberIterations ; ++i) {
+        unsigned      lsbLocation = bitLocation(rng);
+        std::uint32_t lsbBit      = 1UL << lsbLocation;
+        std::uint32_t value       = lsbBit | (~((lsbBit << 1) - 1) & randomBits(rng));
+        int           location    = Util::lsbLocation32(value);
+
+        QCOMPARE(location, static_cast<int>(lsbLocation));
+    }
+}
+
+
+void TestBitFunctions::testLsbLocation64() {
+    QCOMPARE(Util::lsbLocation64(0), -1);
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned>      bitLocation(0, 63);
+    std::uniform_int_distribution<std::uint64_t> randomBits(0UL, static_cast<std::uint64_t>(-1));
+
+    for (unsigned i=0 ; i<numberIterations ; ++i) {
+        unsigned      lsbLocation = bitLocation(rng);
+        std::uint64_t lsbBit      = 1ULL << lsbLocation;
+        std::uint64_t value       = lsbBit | (~((lsbBit << 1) - 1) & randomBits(rng));
+        int           location    = Util::lsbLocation64(value);
+
+        QCOMPARE(location, static_cast<int>(lsbLocation));
+    }
+}
+
 void TestBitFunctions::testMaskLsbZero() {
     std::mt19937 rng;
     std::uniform_int_distribution<unsigned>      bitLocation(0, 63);
@@ -49,6 +49,8 @@ class TestBitFunctions:public QObject {
         void testNumberOnes64();
         void testMsbLocation32();
         void testMsbLocation64();
+        void testLsbLocation32();
+        void testLsbLocation64();
         void testMaskLsbZero();
         void testMaskLsbOne();
         void testMaskMsbZero();
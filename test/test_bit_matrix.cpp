@@ -0,0 +1,368 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements tests for the BitMatrix class.
+***********************************************************************************************************************/
+
+#include <QtGlobal>
+#include <QObject>
+#include <QList>
+#include <QtTest/QtTest>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <util_bit_array.h>
+#include <util_bit_matrix.h>
+
+#include "test_bit_matrix.h"
+
+/**
+ * Type used to hold a reference matrix, one bool per bit.
+ */
+typedef std::vector<std::vector<bool>> ReferenceMatrix;
+
+/**
+ * Function that generates a random matrix along with a matching reference matrix.
+ *
+ * \param[in]  rng           The random number generator to use.
+ *
+ * \param[in]  numberRows    The number of rows.
+ *
+ * \param[in]  numberColumns The number of columns.
+ *
+ * \param[in]  density       The probability that any given bit is set.
+ *
+ * \param[out] reference     The reference matrix.
+ *
+ * \return Returns the generated matrix.
+ */
+static Util::BitMatrix randomMatrix(
+        std::mt19937_64& rng,
+        unsigned long    numberRows,
+        unsigned long    numberColumns,
+        double           density,
+        ReferenceMatrix& reference
+    ) {
+    std::bernoulli_distribution bit(density);
+    Util::BitMatrix             result(numberRows, numberColumns);
+
+    reference.assign(numberRows, std::vector<bool>(numberColumns, false));
+    for (unsigned long row=0 ; row<numberRows ; ++row) {
+        for (unsigned long column=0 ; column<numberColumns ; ++column) {
+            if (bit(rng)) {
+                result.setBit(row, column);
+                reference[row][column] = true;
+            }
+        }
+    }
+
+    return result;
+}
+
+
+/**
+ * Function that compares a matrix against a reference matrix.
+ *
+ * \param[in] matrix    The matrix to be checked.
+ *
+ * \param[in] reference The reference matrix.
+ *
+ * \return Returns true if the matrices match.
+ */
+static bool matches(const Util::BitMatrix& matrix, const ReferenceMatrix& reference) {
+    bool          result     = (matrix.numberRows() == reference.size());
+    unsigned long row        = 0;
+    unsigned long totalCount = 0;
+
+    while (result && row < reference.size()) {
+        result = (matrix.numberColumns() == reference[row].size());
+
+        unsigned long column = 0;
+        while (result && column < reference[row].size()) {
+            result      = (matrix.isSet(row, column) == reference[row][column]);
+            totalCount += reference[row][column] ? 1 : 0;
+            ++column;
+        }
+
+        ++row;
+    }
+
+    // The population count also confirms that no bits past the last column were set.
+
+    return result && matrix.popcount() == totalCount;
+}
+
+
+TestBitMatrix::TestBitMatrix() {}
+
+
+TestBitMatrix::~TestBitMatrix() {}
+
+
+void TestBitMatrix::initTestCase() {}
+
+
+void TestBitMatrix::testConstructors() {
+    Util::BitMatrix empty;
+    QCOMPARE(empty.numberRows(), 0UL);
+    QCOMPARE(empty.numberColumns(), 0UL);
+    QCOMPARE(empty.isEmpty(), true);
+
+    Util::BitMatrix cleared(70, 130);
+    QCOMPARE(cleared.numberRows(), 70UL);
+    QCOMPARE(cleared.numberColumns(), 130UL);
+    QCOMPARE(cleared.wordsPerRow(), 3UL);
+    QCOMPARE(cleared.isEmpty(), false);
+    QCOMPARE(cleared.popcount(), 0UL);
+
+    Util::BitMatrix filled(70, 130, true);
+    QCOMPARE(filled.popcount(), 70UL * 130UL);
+    QCOMPARE(filled.rowPopcount(69), 130UL);
+    QCOMPARE(filled.rowData(5)[2], 0x3ULL);
+
+    Util::BitMatrix identity = Util::BitMatrix::identity(100);
+    QCOMPARE(identity.popcount(), 100UL);
+    for (unsigned long index=0 ; index<100 ; ++index) {
+        QCOMPARE(identity.isSet(index, index), true);
+    }
+
+    QList<Util::BitArray> rows;
+    rows.append(Util::BitArray(10, true));
+    rows.append(Util::BitArray(75, false));
+    rows.append(Util::BitArray(3, true));
+
+    Util::BitMatrix fromRows(rows);
+    QCOMPARE(fromRows.numberRows(), 3UL);
+    QCOMPARE(fromRows.numberColumns(), 75UL);
+    QCOMPARE(fromRows.popcount(), 13UL);
+    QCOMPARE(fromRows.isSet(0, 9), true);
+    QCOMPARE(fromRows.isSet(0, 10), false);
+    QCOMPARE(fromRows.isSet(2, 2), true);
+
+    QList<Util::BitArray> copiedRows = fromRows.toRows();
+    QCOMPARE(copiedRows.size(), 3);
+    QCOMPARE(copiedRows.at(0).size(), 75UL);
+    QCOMPARE(copiedRows.at(0).popcount(), 10UL);
+    QCOMPARE(copiedRows.at(2).popcount(), 3UL);
+
+    Util::BitMatrix copy(fromRows);
+    QCOMPARE(copy == fromRows, true);
+
+    copy.setBit(1, 74);
+    QCOMPARE(copy != fromRows, true);
+    QCOMPARE(fromRows.isSet(1, 74), false);
+
+    Util::BitMatrix moved(std::move(copy));
+    QCOMPARE(moved.isSet(1, 74), true);
+    QCOMPARE(copy.isEmpty(), true);
+
+    copy = std::move(moved);
+    QCOMPARE(copy.isSet(1, 74), true);
+
+    moved = fromRows;
+    QCOMPARE(moved == fromRows, true);
+    QCOMPARE(moved == Util::BitMatrix(3, 76), false);
+}
+
+
+void TestBitMatrix::testBitAccessors() {
+    std::mt19937_64 rng;
+
+    for (unsigned iteration=0 ; iteration<numberIterations ; ++iteration) {
+        ReferenceMatrix reference;
+        Util::BitMatrix matrix = randomMatrix(rng, 67, 129, 0.3, reference);
+        QVERIFY(matches(matrix, reference));
+
+        std::uniform_int_distribution<unsigned long> rowDistribution(0, 66);
+        std::uniform_int_distribution<unsigned long> columnDistribution(0, 128);
+
+        for (unsigned step=0 ; step<1000 ; ++step) {
+            unsigned long row    = rowDistribution(rng);
+            unsigned long column = columnDistribution(rng);
+            bool          value  = (step % 3) != 0;
+
+            if (value) {
+                matrix.setBit(row, column);
+            } else {
+                matrix.clearBit(row, column);
+            }
+
+            reference[row][column] = value;
+        }
+
+        QVERIFY(matches(matrix, reference));
+
+        for (unsigned long row=0 ; row<67 ; ++row) {
+            Util::BitArray rowBits = matrix.row(row);
+            QCOMPARE(rowBits.size(), 129UL);
+
+            unsigned long expectedCount = 0;
+            for (unsigned long column=0 ; column<129 ; ++column) {
+                QCOMPARE(rowBits.isSet(column), static_cast<bool>(reference[row][column]));
+                expectedCount += reference[row][column] ? 1 : 0;
+            }
+
+            QCOMPARE(matrix.rowPopcount(row), expectedCount);
+        }
+    }
+}
+
+
+void TestBitMatrix::testRowOperations() {
+    std::mt19937_64 rng;
+
+    for (unsigned iteration=0 ; iteration<numberIterations ; ++iteration) {
+        ReferenceMatrix reference;
+        Util::BitMatrix matrix = randomMatrix(rng, 20, 150, 0.5, reference);
+
+        matrix.orRow(3, 7);
+        matrix.andRow(4, 8);
+        for (unsigned long column=0 ; column<150 ; ++column) {
+            reference[3][column] = reference[3][column] || reference[7][column];
+            reference[4][column] = reference[4][column] && reference[8][column];
+        }
+
+        QVERIFY(matches(matrix, reference));
+
+        Util::BitArray shortBits(70);
+        for (unsigned long column=0 ; column<70 ; column+=3) {
+            shortBits.setBit(column);
+        }
+
+        matrix.orRow(10, shortBits);
+        matrix.andRow(11, shortBits);
+        matrix.setRow(12, shortBits);
+        for (unsigned long column=0 ; column<150 ; ++column) {
+            bool shortBit = column < 70 && column % 3 == 0;
+
+            reference[10][column] = reference[10][column] || shortBit;
+            reference[11][column] = reference[11][column] && shortBit;
+            reference[12][column] = shortBit;
+        }
+
+        QVERIFY(matches(matrix, reference));
+    }
+}
+
+
+void TestBitMatrix::testTranspose() {
+    std::mt19937_64 rng;
+
+    static const unsigned long sizes[][2] = { { 1, 1 }, { 64, 64 }, { 3, 200 }, { 130, 65 }, { 257, 191 } };
+    for (const unsigned long* size : sizes) {
+        ReferenceMatrix reference;
+        Util::BitMatrix matrix     = randomMatrix(rng, size[0], size[1], 0.4, reference);
+        Util::BitMatrix transposed = matrix.transposed();
+
+        ReferenceMatrix expected(size[1], std::vector<bool>(size[0], false));
+        for (unsigned long row=0 ; row<size[0] ; ++row) {
+            for (unsigned long column=0 ; column<size[1] ; ++column) {
+                expected[column][row] = reference[row][column];
+            }
+        }
+
+        QVERIFY(matches(transposed, expected));
+        QCOMPARE(transposed.transposed() == matrix, true);
+    }
+
+    QCOMPARE(Util::BitMatrix(0, 5).transposed().numberRows(), 5UL);
+}
+
+
+void TestBitMatrix::testMultiply() {
+    std::mt19937_64 rng;
+
+    static const unsigned long sizes[][3] = { { 1, 1, 1 }, { 10, 70, 5 }, { 65, 64, 130 }, { 100, 300, 90 } };
+    for (const unsigned long* size : sizes) {
+        for (unsigned iteration=0 ; iteration<numberIterations ; ++iteration) {
+            double          density = iteration == 0 ? 0.02 : 0.2;
+            ReferenceMatrix leftReference;
+            ReferenceMatrix rightReference;
+            Util::BitMatrix left  = randomMatrix(rng, size[0], size[1], density, leftReference);
+            Util::BitMatrix right = randomMatrix(rng, size[1], size[2], density, rightReference);
+
+            ReferenceMatrix expected(size[0], std::vector<bool>(size[2], false));
+            for (unsigned long row=0 ; row<size[0] ; ++row) {
+                for (unsigned long inner=0 ; inner<size[1] ; ++inner) {
+                    if (leftReference[row][inner]) {
+                        for (unsigned long column=0 ; column<size[2] ; ++column) {
+                            expected[row][column] = expected[row][column] || rightReference[inner][column];
+                        }
+                    }
+                }
+            }
+
+            QVERIFY(matches(left * right, expected));
+        }
+    }
+
+    ReferenceMatrix reference;
+    Util::BitMatrix matrix = randomMatrix(rng, 90, 90, 0.1, reference);
+    QCOMPARE(matrix.multiplied(Util::BitMatrix::identity(90)) == matrix, true);
+    QCOMPARE(Util::BitMatrix::identity(90).multiplied(matrix) == matrix, true);
+}
+
+
+void TestBitMatrix::testTransitiveClosure() {
+    std::mt19937_64 rng;
+
+    static const unsigned long sizes[] = { 1, 5, 64, 65, 200, 333 };
+    for (unsigned long size : sizes) {
+        for (unsigned iteration=0 ; iteration<numberIterations ; ++iteration) {
+            // Sparse graphs produce long paths, denser graphs produce large strongly connected components.
+
+            double          density = (iteration == 0 ? 1.0 : 2.0) / size;
+            ReferenceMatrix reference;
+            Util::BitMatrix matrix = randomMatrix(rng, size, size, density, reference);
+
+            for (unsigned long pivot=0 ; pivot<size ; ++pivot) {
+                for (unsigned long row=0 ; row<size ; ++row) {
+                    if (reference[row][pivot]) {
+                        for (unsigned long column=0 ; column<size ; ++column) {
+                            reference[row][column] = reference[row][column] || reference[pivot][column];
+                        }
+                    }
+                }
+            }
+
+            Util::BitMatrix closure = matrix.transitiveClosure();
+            QVERIFY(matches(closure, reference));
+            QCOMPARE(closure.transitiveClosure() == closure, true);
+        }
+    }
+
+    // A chain visits every node, crossing every pivot block in reverse order.
+
+    Util::BitMatrix chain(300, 300);
+    for (unsigned long node=1 ; node<300 ; ++node) {
+        chain.setBit(node, node - 1);
+    }
+
+    Util::BitMatrix closure = chain.transitiveClosure();
+    QCOMPARE(closure.popcount(), 300UL * 299UL / 2UL);
+    QCOMPARE(closure.isSet(299, 0), true);
+    QCOMPARE(closure.isSet(0, 299), false);
+}
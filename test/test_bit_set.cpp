@@ -31,8 +31,13 @@
 #include <QString>
 #include <QList>
 #include <QSet>
+#include <QHash>
 
 #include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <iterator>
+#include <type_traits>
 #include <random>
 
 #include <util_bit_set.h>
@@ -89,10 +94,136 @@ bool BitSet2::assignBit(const QString& bitName) {
     return success;
 }
 
+/***********************************************************************************************************************
+ * HandleBitSet
+ */
+
+HandleBitSet::BitNameHash HandleBitSet::bitNameHash;
+const HandleBitSet::Handle HandleBitSet::registeredBit = HandleBitSet::assignBit("REGISTERED");
+
+HandleBitSet::HandleBitSet():Util::BitSet(&bitNameHash) {}
+
+HandleBitSet::~HandleBitSet() {}
+
+HandleBitSet::Handle HandleBitSet::assignBit(const QString& bitName) {
+    return registerBit(&bitNameHash, bitName);
+}
+
+/***********************************************************************************************************************
+ * AdditiveHashKey
+ */
+
+AdditiveHashKey::AdditiveHashKey(const Util::BitSet& bitSet):bitSet(bitSet) {}
+
+AdditiveHashKey::~AdditiveHashKey() {}
+
+bool AdditiveHashKey::operator==(const AdditiveHashKey& other) const {
+    return bitSet == other.bitSet;
+}
+
+Util::HashResult qHash(const AdditiveHashKey& key, Util::HashSeed seed) {
+    // Matches the hash used before words were mixed: the words of the set are summed and the sum is hashed.  Each set
+    // bit contributes 2^(index mod 64) to the sum.
+
+    std::uint64_t wordSum = 0;
+    for (unsigned bitIndex : key.bitSet) {
+        wordSum += static_cast<std::uint64_t>(1) << (bitIndex % 64);
+    }
+
+    return qHash(wordSum, seed);
+}
+
+/***********************************************************************************************************************
+ * MixingHashKey
+ */
+
+MixingHashKey::MixingHashKey(const Util::BitSet& bitSet):bitSet(bitSet) {}
+
+MixingHashKey::~MixingHashKey() {}
+
+bool MixingHashKey::operator==(const MixingHashKey& other) const {
+    return bitSet == other.bitSet;
+}
+
+Util::HashResult qHash(const MixingHashKey& key, Util::HashSeed seed) {
+    return key.bitSet.hash(seed);
+}
+
 /***********************************************************************************************************************
  * TestBitSet
  */
 
+/**
+ * Function that creates the bit sets used to benchmark bit set hashes.  The sets mimic flag sets used as cache keys,
+ * each holding a few bits drawn from a 256 bit schema.
+ *
+ * \return Returns the distinct bit sets.
+ */
+static QList<Util::BitSet> hashBenchmarkSets() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomBitIndex(0U, 255U);
+    std::uniform_int_distribution<unsigned> randomBitCount(1U, 6U);
+
+    QSet<Util::BitSet> bitSets;
+    while (bitSets.size() < 4096) {
+        BitSet1  bitSet;
+        unsigned numberBits = randomBitCount(rng);
+        for (unsigned i=0 ; i<numberBits ; ++i) {
+            bitSet.setBit(QString("BIT%1").arg(randomBitIndex(rng) + 1));
+        }
+
+        bitSets.insert(bitSet);
+    }
+
+    return bitSets.values();
+}
+
+
+/**
+ * Function that determines the number of distinct hash values produced for a list of bit sets.
+ *
+ * \param[in] bitSets The bit sets to be hashed.
+ *
+ * \return Returns the number of distinct hash values.
+ */
+template<typename KeyType> static int numberDistinctHashes(const QList<Util::BitSet>& bitSets) {
+    QSet<Util::HashResult> hashes;
+    for (const Util::BitSet& bitSet : bitSets) {
+        hashes.insert(qHash(KeyType(bitSet)));
+    }
+
+    return hashes.size();
+}
+
+
+/**
+ * Function that benchmarks lookups of every benchmark bit set in a QHash keyed by a given key type.
+ */
+template<typename KeyType> static void benchmarkHashLookups() {
+    QList<Util::BitSet>      bitSets = hashBenchmarkSets();
+    QList<KeyType>           keys;
+    QHash<KeyType, unsigned> cache;
+
+    for (const Util::BitSet& bitSet : bitSets) {
+        KeyType key(bitSet);
+        cache.insert(key, static_cast<unsigned>(keys.size()));
+        keys.append(key);
+    }
+
+    unsigned numberFound = 0;
+    QBENCHMARK {
+        numberFound = 0;
+        for (const KeyType& key : keys) {
+            if (cache.contains(key)) {
+                ++numberFound;
+            }
+        }
+    }
+
+    QCOMPARE(numberFound, static_cast<unsigned>(keys.size()));
+}
+
+
 TestBitSet::TestBitSet() {}
 
 
@@ -147,6 +278,138 @@ void TestBitSet::testSingleBitSetClearMethods() {
 }
 
 
+void TestBitSet::testHandles() {
+    BitSet1 bitSet1;
+
+    for (unsigned bitIndex=0 ; bitIndex<256 ; ++bitIndex) {
+        QString              bitName   = QString("BIT%1").arg(bitIndex + 1);
+        Util::BitSet::Handle bitHandle = bitSet1.handle(bitName);
+
+        QCOMPARE(bitHandle.isValid(), true);
+        QCOMPARE(bitHandle.bitIndex(), bitIndex);
+        QCOMPARE(bitHandle == bitSet1.handle(bitName), true);
+
+        if (bitIndex % 3 == 0) {
+            QCOMPARE(bitSet1.setBit(bitHandle), true);
+        }
+    }
+
+    for (unsigned bitIndex=0 ; bitIndex<256 ; ++bitIndex) {
+        QString              bitName   = QString("BIT%1").arg(bitIndex + 1);
+        Util::BitSet::Handle bitHandle = bitSet1.handle(bitName);
+
+        QCOMPARE(bitSet1.isSet(bitHandle), bitIndex % 3 == 0);
+        QCOMPARE(bitSet1.isSet(bitName), bitIndex % 3 == 0);
+        QCOMPARE(bitSet1[bitHandle], bitIndex % 3 == 0);
+        QCOMPARE(bitSet1.isCleared(bitHandle), bitIndex % 3 != 0);
+    }
+
+    Util::BitSet::Handle bit200 = bitSet1.handle("BIT200");
+    QCOMPARE(bitSet1.clearBit(bit200), true);
+    QCOMPARE(bitSet1.isSet("BIT200"), false);
+
+    bitSet1 << bit200;
+    QCOMPARE(bitSet1.isSet("BIT200"), true);
+
+    Util::BitSet::Handle invalidHandle = bitSet1.handle("UNDEFINED");
+    QCOMPARE(invalidHandle.isValid(), false);
+    QCOMPARE(invalidHandle == Util::BitSet::Handle(), true);
+    QCOMPARE(bitSet1.setBit(invalidHandle), false);
+    QCOMPARE(bitSet1.isSet(invalidHandle), false);
+
+    // Handles registered during static initialization resolve to the same bit as the name.
+
+    HandleBitSet handleSet;
+    QCOMPARE(HandleBitSet::registeredBit.isValid(), true);
+    QCOMPARE(HandleBitSet::registeredBit == handleSet.handle("REGISTERED"), true);
+    QCOMPARE(HandleBitSet::registeredBit.bitIndex(), 0U);
+    QCOMPARE(HandleBitSet::registeredBit != HandleBitSet::assignBit("OTHER_BIT"), true);
+    QCOMPARE(HandleBitSet::assignBit("REGISTERED") == HandleBitSet::registeredBit, true);
+    QCOMPARE(handleSet.isSet(HandleBitSet::registeredBit), false);
+
+    handleSet << HandleBitSet::registeredBit;
+    QCOMPARE(handleSet.isSet("REGISTERED"), true);
+    QCOMPARE(handleSet.numberSetBits(), 1U);
+
+    // Bits added after a set was constructed can be used through handles.
+
+    HandleBitSet::assignBit("LATE_BIT");
+    Util::BitSet::Handle lateBit = handleSet.handle("LATE_BIT");
+    QCOMPARE(handleSet.isSet(lateBit), false);
+    QCOMPARE(handleSet.setBit(lateBit), true);
+    QCOMPARE(handleSet.isSet(lateBit), true);
+    QCOMPARE(handleSet.isSet(HandleBitSet::registeredBit), true);
+}
+
+
+void TestBitSet::testSetBitLists() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomBitIndex(0U, 255U);
+
+    for (unsigned iterationNumber=0 ; iterationNumber<100 ; ++iterationNumber) {
+        BitSet1        bitSet;
+        QSet<unsigned> expected;
+
+        unsigned numberBits = randomBitIndex(rng);
+        for (unsigned i=0 ; i<numberBits ; ++i) {
+            unsigned bitIndex = randomBitIndex(rng);
+            bitSet.setBit(QString("BIT%1").arg(bitIndex + 1));
+            expected.insert(bitIndex);
+        }
+
+        QList<unsigned> expectedIndexes = expected.values();
+        std::sort(expectedIndexes.begin(), expectedIndexes.end());
+
+        QList<QString> expectedNames;
+        for (unsigned bitIndex : expectedIndexes) {
+            expectedNames.append(QString("BIT%1").arg(bitIndex + 1));
+        }
+
+        QCOMPARE(bitSet.setBitIndexes(), expectedIndexes);
+        QCOMPARE(bitSet.setBits(), expectedNames);
+    }
+
+    // Names added after the reverse table was built must be reported.
+
+    HandleBitSet handleSet;
+    handleSet << HandleBitSet::registeredBit;
+    QCOMPARE(handleSet.setBits(), QList<QString>() << "REGISTERED");
+
+    HandleBitSet::assignBit("LIST_BIT");
+    handleSet.setBit("LIST_BIT");
+    QCOMPARE(handleSet.setBits(), QList<QString>() << "REGISTERED" << "LIST_BIT");
+
+    // Bit indexes need not be assigned consecutively.
+
+    class GapBitSet:public Util::BitSet {
+        public:
+            GapBitSet(BitNameHash* bitHash):Util::BitSet(bitHash) {}
+    };
+
+    Util::BitSet::BitNameHash gapNames;
+    gapNames.insert("FIRST", 0);
+    gapNames.insert("THIRD", 2);
+
+    GapBitSet gapSet(&gapNames);
+    gapSet.setBit("FIRST");
+    gapSet.setBit("THIRD");
+
+    QCOMPARE(gapSet.setBitIndexes(), QList<unsigned>() << 0 << 2);
+    QCOMPARE(gapSet.setBits(), QList<QString>() << "FIRST" << "THIRD");
+    QCOMPARE((++gapSet.begin()).bitName(), QString("THIRD"));
+
+    // Replacing a name without changing the size of the hash must be reflected in the reported names.
+
+    gapNames.remove("THIRD");
+    gapNames.insert("RENAMED", 2);
+
+    QCOMPARE(gapNames.size(), 2);
+    QCOMPARE(gapSet.setBits(), QList<QString>() << "FIRST" << "RENAMED");
+    QCOMPARE(gapNames.bitName(1), QString());
+    QCOMPARE(gapNames.bitName(3), QString());
+}
+
+
 void TestBitSet::testTemplateMethods() {
     BitSet1       bitSet;
     QSet<QString> setBits;
@@ -419,6 +682,110 @@ void TestBitSet::testOtherOperators() {
 }
 
 
+void TestBitSet::testHash() {
+    // Sets whose words sum to the same value must not collide.
+
+    BitSet1 bitSetA("BIT1", "BIT34");
+    BitSet1 bitSetB("BIT2", "BIT33");
+    QCOMPARE(bitSetA.hash() != bitSetB.hash(), true);
+    QCOMPARE(bitSetA.hash(), BitSet1("BIT34", "BIT1").hash());
+    QCOMPARE(bitSetA.hash() != bitSetA.hash(1), true);
+
+    for (unsigned i=0 ; i<64 ; ++i) {
+        for (unsigned j=i+1 ; j<64 ; ++j) {
+            BitSet1 first(QString("BIT%1").arg(i + 1), QString("BIT%1").arg(j + 65));
+            BitSet1 second(QString("BIT%1").arg(j + 1), QString("BIT%1").arg(i + 65));
+            QCOMPARE(first.hash() != second.hash(), true);
+        }
+    }
+
+    // Equal sets with different array lengths must produce the same hash.
+
+    HandleBitSet shortSet;
+    shortSet << HandleBitSet::registeredBit;
+
+    for (unsigned i=0 ; i<128 ; ++i) {
+        HandleBitSet::assignBit(QString("HASH_BIT%1").arg(i + 1));
+    }
+
+    HandleBitSet longSet;
+    longSet << HandleBitSet::registeredBit;
+
+    QCOMPARE(shortSet == longSet, true);
+    QCOMPARE(shortSet.hash(), longSet.hash());
+
+    // Sparse random sets, typical of cache keys, should have essentially no collisions.
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomBitIndex(0U, 255U);
+
+    QSet<Util::BitSet>     distinctSets;
+    QSet<Util::HashResult> distinctHashes;
+
+    for (unsigned iterationNumber=0 ; iterationNumber<10000 ; ++iterationNumber) {
+        BitSet1 bitSet;
+        for (unsigned i=0 ; i<4 ; ++i) {
+            bitSet.setBit(QString("BIT%1").arg(randomBitIndex(rng) + 1));
+        }
+
+        distinctSets.insert(bitSet);
+        distinctHashes.insert(bitSet.hash());
+    }
+
+    QVERIFY(distinctSets.size() - distinctHashes.size() <= 2);
+
+    // Single bits and shifted bit pairs, which collided under the additive hash whenever words summed to the same
+    // value, must produce distinct hashes that spread evenly across hash table buckets.
+
+    QSet<Util::HashResult> singleBitHashes;
+    for (unsigned bitIndex=0 ; bitIndex<256 ; ++bitIndex) {
+        singleBitHashes.insert(BitSet1(QString("BIT%1").arg(bitIndex + 1)).hash());
+    }
+
+    QCOMPARE(singleBitHashes.size(), 256);
+
+    const unsigned numberBuckets = 64;
+    unsigned       bucketCounts[numberBuckets] = { 0 };
+    unsigned       numberPairs                 = 0;
+
+    QSet<Util::HashResult> pairHashes;
+    for (unsigned shift=1 ; shift<=128 ; shift*=2) {
+        for (unsigned bitIndex=0 ; bitIndex+shift<256 ; ++bitIndex) {
+            BitSet1 pair(QString("BIT%1").arg(bitIndex + 1), QString("BIT%1").arg(bitIndex + shift + 1));
+
+            Util::HashResult hash = pair.hash();
+            pairHashes.insert(hash);
+            ++bucketCounts[hash % numberBuckets];
+            ++numberPairs;
+        }
+    }
+
+    QCOMPARE(static_cast<unsigned>(pairHashes.size()), numberPairs);
+
+    unsigned maximumBucketCount = *std::max_element(bucketCounts, bucketCounts + numberBuckets);
+    QVERIFY(maximumBucketCount < 2 * numberPairs / numberBuckets);
+}
+
+
+void TestBitSet::testAdditiveHashLookupBenchmark() {
+    benchmarkHashLookups<AdditiveHashKey>();
+}
+
+
+void TestBitSet::testMixingHashLookupBenchmark() {
+    // The word mixing hash must collide less often than the additive hash on the same sets.
+
+    QList<Util::BitSet> bitSets          = hashBenchmarkSets();
+    int                 additiveDistinct = numberDistinctHashes<AdditiveHashKey>(bitSets);
+    int                 mixingDistinct   = numberDistinctHashes<MixingHashKey>(bitSets);
+
+    QVERIFY(mixingDistinct > additiveDistinct);
+    QVERIFY(bitSets.size() - mixingDistinct <= 2);
+
+    benchmarkHashLookups<MixingHashKey>();
+}
+
+
 void TestBitSet::testForwardIterator() {
     BitSet1 bitSet1;
     BitSet1 bitSet2("BIT1", "BIT3", "BIT64", "BIT65", "BIT201");
@@ -543,3 +910,45 @@ void TestBitSet::testReverseIterator() {
     QCOMPARE(iterator.isEnd(), true);
     QCOMPARE(bitOrderingIterator, bitOrderingEndIterator);
 }
+
+
+void TestBitSet::testIndexIterator() {
+    QVERIFY((
+        std::is_same<
+            std::iterator_traits<Util::BitSetIndexIterator>::iterator_category,
+            std::input_iterator_tag
+        >::value
+    ));
+
+    BitSet1 emptySet;
+    QCOMPARE(emptySet.begin() == emptySet.end(), true);
+
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomBitIndex(0U, 255U);
+
+    for (unsigned iterationNumber=0 ; iterationNumber<100 ; ++iterationNumber) {
+        BitSet1 bitSet;
+
+        unsigned numberBits = randomBitIndex(rng);
+        for (unsigned i=0 ; i<numberBits ; ++i) {
+            bitSet.setBit(QString("BIT%1").arg(randomBitIndex(rng) + 1));
+        }
+
+        QList<unsigned> visitedIndexes;
+        for (unsigned bitIndex : bitSet) {
+            visitedIndexes.append(bitIndex);
+        }
+
+        QCOMPARE(visitedIndexes, bitSet.setBitIndexes());
+
+        QList<QString> visitedNames;
+        for (Util::BitSetIndexIterator it=bitSet.begin(),end=bitSet.end() ; it!=end ; it++) {
+            visitedNames.append(it.bitName());
+        }
+
+        QCOMPARE(visitedNames, bitSet.setBits());
+
+        std::vector<unsigned> copiedIndexes(bitSet.begin(), bitSet.end());
+        QCOMPARE(static_cast<unsigned>(copiedIndexes.size()), bitSet.numberSetBits());
+    }
+}
@@ -73,6 +73,46 @@ class BitSet2:public Util::BitSet {
         static BitNameHash bitNameHash;
 };
 
+class HandleBitSet:public Util::BitSet {
+    public:
+        HandleBitSet();
+
+        ~HandleBitSet();
+
+        static Handle assignBit(const QString& bitName);
+
+        static const Handle registeredBit;
+
+    private:
+        static BitNameHash bitNameHash;
+};
+
+class AdditiveHashKey {
+    public:
+        AdditiveHashKey(const Util::BitSet& bitSet);
+
+        ~AdditiveHashKey();
+
+        bool operator==(const AdditiveHashKey& other) const;
+
+        Util::BitSet bitSet;
+};
+
+Util::HashResult qHash(const AdditiveHashKey& key, Util::HashSeed seed = 0);
+
+class MixingHashKey {
+    public:
+        MixingHashKey(const Util::BitSet& bitSet);
+
+        ~MixingHashKey();
+
+        bool operator==(const MixingHashKey& other) const;
+
+        Util::BitSet bitSet;
+};
+
+Util::HashResult qHash(const MixingHashKey& key, Util::HashSeed seed = 0);
+
 class TestBitSet:public QObject {
     Q_OBJECT
 
@@ -88,14 +128,20 @@ class TestBitSet:public QObject {
         void initTestCase();
         void testConstructors();
         void testSingleBitSetClearMethods();
+        void testHandles();
+        void testSetBitLists();
         void testTemplateMethods();
         void testIntersectionMethod();
         void testUnionMethod();
         void testMethodOperators();
         void testComparisonOperators();
         void testOtherOperators();
+        void testHash();
+        void testAdditiveHashLookupBenchmark();
+        void testMixingHashLookupBenchmark();
         void testForwardIterator();
         void testReverseIterator();
+        void testIndexIterator();
 };
 
 #endif
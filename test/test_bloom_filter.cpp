@@ -0,0 +1,224 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements tests for the BloomFilter class.
+***********************************************************************************************************************/
+
+#include <QtGlobal>
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include <cstdint>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <util_bloom_filter.h>
+
+#include "test_bloom_filter.h"
+
+/**
+ * Function that generates a batch of random key hashes.
+ *
+ * \param[in] rng        The random number generator to use.
+ *
+ * \param[in] numberKeys The number of key hashes to generate.
+ *
+ * \return Returns the generated key hashes.
+ */
+static std::vector<std::uint64_t> randomKeys(std::mt19937_64& rng, unsigned long numberKeys) {
+    std::vector<std::uint64_t> result(numberKeys);
+    for (unsigned long index=0 ; index<numberKeys ; ++index) {
+        result[index] = rng();
+    }
+
+    return result;
+}
+
+
+TestBloomFilter::TestBloomFilter() {}
+
+
+TestBloomFilter::~TestBloomFilter() {}
+
+
+void TestBloomFilter::initTestCase() {}
+
+
+void TestBloomFilter::testConstructors() {
+    Util::BloomFilter empty;
+    QCOMPARE(empty.numberBits(), 0UL);
+    QCOMPARE(empty.mightContain(0x1234), false);
+
+    Util::BloomFilter filter(1000, 7);
+    QCOMPARE(filter.numberBits(), 1024UL);
+    QCOMPARE(filter.numberHashes(), 7U);
+    QCOMPARE(filter.fillRatio(), 0.0);
+
+    QCOMPARE(Util::BloomFilter(512, 0).numberHashes(), 1U);
+    QCOMPARE(Util::BloomFilter(512, 100).numberHashes(), Util::BloomFilter::maximumNumberHashes);
+
+    filter.insert(0x0123456789ABCDEFULL);
+    QCOMPARE(filter.fillRatio(), 7.0 / 1024.0);
+
+    Util::BloomFilter copy = filter;
+    copy.insert(0xFEDCBA9876543210ULL);
+    QCOMPARE(copy.mightContain(0xFEDCBA9876543210ULL), true);
+    QCOMPARE(filter.fillRatio(), 7.0 / 1024.0);
+
+    filter = copy;
+    QCOMPARE(filter.mightContain(0xFEDCBA9876543210ULL), true);
+
+    filter.clear();
+    QCOMPARE(filter.fillRatio(), 0.0);
+    QCOMPARE(filter.numberBits(), 1024UL);
+
+    Util::BloomFilter emptyFilter;
+    emptyFilter.clear();
+    QCOMPARE(emptyFilter.numberBits(), 0UL);
+    QCOMPARE(emptyFilter.fillRatio(), 0.0);
+}
+
+
+void TestBloomFilter::testSizingMethods() {
+    QCOMPARE(Util::BloomFilter::optimalNumberBits(0, 0.01), 512UL);
+    QCOMPARE(Util::BloomFilter::optimalNumberHashes(1000, 0), 1U);
+    QCOMPARE(Util::BloomFilter::optimalNumberHashes(9585, 1000), 7U);
+
+    unsigned long previousBits = 0;
+    for (double falsePositiveRate : {0.1, 0.01, 0.001, 0.0001}) {
+        unsigned long numberBits   = Util::BloomFilter::optimalNumberBits(100000, falsePositiveRate);
+        unsigned      numberHashes = Util::BloomFilter::optimalNumberHashes(numberBits, 100000);
+
+        QCOMPARE(numberBits % Util::BloomFilter::bitsPerBlock, 0UL);
+        QVERIFY(numberBits > previousBits);
+        QVERIFY(Util::BloomFilter::estimatedFalsePositiveRate(numberBits, numberHashes, 100000) <= falsePositiveRate);
+
+        previousBits = numberBits;
+    }
+
+    // Blocking costs some accuracy so the blocked estimate is never better than the classic estimate.
+
+    double classic = std::pow(1.0 - std::exp(-7.0 * 1000.0 / 9728.0), 7.0);
+    QVERIFY(Util::BloomFilter::estimatedFalsePositiveRate(9728, 7, 1000) >= classic);
+    QCOMPARE(Util::BloomFilter::estimatedFalsePositiveRate(0, 7, 1000), 1.0);
+    QCOMPARE(Util::BloomFilter::estimatedFalsePositiveRate(9728, 7, 0), 0.0);
+}
+
+
+void TestBloomFilter::testInsertAndQuery() {
+    std::mt19937_64 rng;
+
+    for (unsigned iteration=0 ; iteration<numberIterations ; ++iteration) {
+        unsigned long     numberKeys = 20000;
+        double            target     = iteration % 2 == 0 ? 0.01 : 0.001;
+        Util::BloomFilter filter     = Util::BloomFilter::forCapacity(numberKeys, target);
+
+        std::vector<std::uint64_t> keys = randomKeys(rng, numberKeys);
+        for (std::uint64_t key : keys) {
+            filter.insert(key);
+        }
+
+        for (std::uint64_t key : keys) {
+            QCOMPARE(filter.mightContain(key), true);
+        }
+
+        // Random keys are almost certainly absent so every hit is a false positive.
+
+        std::vector<std::uint64_t> probes         = randomKeys(rng, 200000);
+        unsigned long              falsePositives = 0;
+        for (std::uint64_t probe : probes) {
+            falsePositives += filter.mightContain(probe) ? 1 : 0;
+        }
+
+        double measured = static_cast<double>(falsePositives) / probes.size();
+        QVERIFY(measured < 1.5 * target);
+    }
+}
+
+
+void TestBloomFilter::testBatchMethods() {
+    std::mt19937_64 rng;
+
+    std::vector<std::uint64_t> keys   = randomKeys(rng, 5000);
+    std::vector<std::uint64_t> probes = randomKeys(rng, 5000);
+    probes.insert(probes.end(), keys.begin(), keys.end());
+
+    Util::BloomFilter single(40000, 5);
+    Util::BloomFilter batch(40000, 5);
+
+    for (std::uint64_t key : keys) {
+        single.insert(key);
+    }
+
+    batch.insert(keys.data(), keys.size());
+    QCOMPARE(batch.fillRatio(), single.fillRatio());
+
+    std::unique_ptr<bool[]> results(new bool[probes.size()]);
+    unsigned long           numberPresent = batch.mightContain(probes.data(), probes.size(), results.get());
+
+    unsigned long expectedPresent = 0;
+    for (unsigned long index=0 ; index<probes.size() ; ++index) {
+        bool expected = single.mightContain(probes[index]);
+        QCOMPARE(results[index], expected);
+        expectedPresent += expected ? 1 : 0;
+    }
+
+    QCOMPARE(numberPresent, expectedPresent);
+    QVERIFY(numberPresent >= keys.size());
+
+    Util::BloomFilter empty;
+    QCOMPARE(empty.mightContain(probes.data(), probes.size(), results.get()), 0UL);
+    QCOMPARE(results[0], false);
+}
+
+
+void TestBloomFilter::testUniteMethod() {
+    std::mt19937_64 rng;
+
+    std::vector<std::uint64_t> firstKeys  = randomKeys(rng, 1000);
+    std::vector<std::uint64_t> secondKeys = randomKeys(rng, 1000);
+
+    Util::BloomFilter first(20000, 6);
+    Util::BloomFilter second(20000, 6);
+    first.insert(firstKeys.data(), firstKeys.size());
+    second.insert(secondKeys.data(), secondKeys.size());
+
+    Util::BloomFilter combined = first;
+    QCOMPARE(combined.unite(second), true);
+
+    for (std::uint64_t key : firstKeys) {
+        QCOMPARE(combined.mightContain(key), true);
+    }
+
+    for (std::uint64_t key : secondKeys) {
+        QCOMPARE(combined.mightContain(key), true);
+    }
+
+    QVERIFY(combined.fillRatio() > first.fillRatio());
+
+    QCOMPARE(first.unite(Util::BloomFilter(40000, 6)), false);
+    QCOMPARE(first.unite(Util::BloomFilter(20000, 5)), false);
+}
@@ -0,0 +1,394 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+* 
+* This file is licensed under two licenses.
+*
+* Inesonic Commercial License, Version 1:
+*   All rights reserved.  Inesonic, LLC retains all rights to this software, including the right to relicense the
+*   software in source or binary formats under different terms.  Unauthorized use under the terms of this license is
+*   strictly prohibited.
+*
+* GNU Public License, Version 2:
+*   This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public
+*   License as published by the Free Software Foundation; either version 2 of the License, or (at your option) any later
+*   version.
+*   
+*   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+*   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+*   details.
+*   
+*   You should have received a copy of the GNU General Public License along with this program; if not, write to the Free
+*   Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements tests of the CompressedBitArray class
+***********************************************************************************************************************/
+
+#include <QtGlobal>
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include <cstdint>
+#include <algorithm>
+#include <random>
+
+#include <util_bit_array.h>
+#include <util_compressed_bit_array.h>
+
+#include "test_compressed_bit_array.h"
+
+/**
+ * Function that creates a random bit array mixing empty, sparse, dense and run heavy chunks.
+ *
+ * \param[in,out] rng       The random number generator to use.
+ *
+ * \param[in]     bitLength The desired array length.
+ *
+ * \return Returns the newly created bit array.
+ */
+static Util::BitArray randomBitArray(std::mt19937& rng, unsigned bitLength) {
+    std::uniform_int_distribution<unsigned> randomMode(0U, 3U);
+    std::uniform_int_distribution<unsigned> randomBit(0U, 65535U);
+    std::uniform_int_distribution<unsigned> randomRunLength(1U, 3000U);
+
+    Util::BitArray result(bitLength);
+
+    for (unsigned chunkStart=0 ; chunkStart<bitLength ; chunkStart+=65536) {
+        unsigned chunkLength = std::min(65536U, bitLength - chunkStart);
+        unsigned mode        = randomMode(rng);
+
+        if (mode == 1) {
+            for (unsigned i=0 ; i<200 ; ++i) {
+                unsigned offset = randomBit(rng);
+                if (offset < chunkLength) {
+                    result.setBit(chunkStart + offset);
+                }
+            }
+        } else if (mode == 2) {
+            for (unsigned i=0 ; i<30000 ; ++i) {
+                unsigned offset = randomBit(rng);
+                if (offset < chunkLength) {
+                    result.setBit(chunkStart + offset);
+                }
+            }
+        } else if (mode == 3) {
+            unsigned offset = randomBit(rng) % 512;
+            while (offset < chunkLength) {
+                unsigned runLength = randomRunLength(rng);
+                unsigned last      = std::min(offset + runLength, chunkLength) - 1;
+
+                result.setBits(chunkStart + offset, chunkStart + last);
+                offset = last + 1 + randomRunLength(rng);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+TestCompressedBitArray::TestCompressedBitArray() {}
+
+
+TestCompressedBitArray::~TestCompressedBitArray() {}
+
+
+void TestCompressedBitArray::initTestCase() {}
+
+
+void TestCompressedBitArray::testConstructors() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 500000U);
+
+    Util::CompressedBitArray array1;
+    QCOMPARE(array1.size(), 0U);
+    QCOMPARE(array1.popcount(), 0U);
+    QCOMPARE(array1.toBitArray().size(), 0U);
+
+    Util::CompressedBitArray array2(1000000);
+    QCOMPARE(array2.size(), 1000000U);
+    QCOMPARE(array2.popcount(), 0U);
+    QCOMPARE(array2.firstSetBit(), Util::CompressedBitArray::invalidIndex);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 4 ; ++iteration) {
+        unsigned                 bitLength = randomLength(rng);
+        Util::BitArray           reference = randomBitArray(rng, bitLength);
+        Util::CompressedBitArray compressed(reference);
+
+        QCOMPARE(compressed.size(), static_cast<Util::CompressedBitArray::Index>(bitLength));
+        QCOMPARE(compressed.popcount(), reference.popcount());
+        QVERIFY(compressed.toBitArray() == reference);
+
+        Util::CompressedBitArray copy(compressed);
+        QVERIFY(copy.toBitArray() == reference);
+    }
+}
+
+
+void TestCompressedBitArray::testSetClearMethods() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomIndex(0U, 300000U);
+    std::uniform_int_distribution<unsigned> randomBool(0U, 1U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations ; ++iteration) {
+        Util::BitArray           reference;
+        Util::CompressedBitArray compressed;
+
+        for (unsigned i=0 ; i<20000 ; ++i) {
+            unsigned index = randomIndex(rng);
+            bool     value = randomBool(rng) != 0;
+
+            reference.setBit(index, value);
+            compressed.setBit(index, value);
+        }
+
+        QCOMPARE(compressed.size(), reference.size());
+        QVERIFY(compressed.toBitArray() == reference);
+
+        for (unsigned i=0 ; i<2000 ; ++i) {
+            unsigned index = randomIndex(rng);
+            QCOMPARE(compressed.isSet(index), reference.isSet(index));
+            QCOMPARE(compressed.isClear(index), reference.isClear(index));
+        }
+    }
+
+    // Grow a single chunk from an array container, through a bitmap container, and back down again.
+
+    Util::CompressedBitArray compressed;
+    for (unsigned index=0 ; index<65536 ; index+=2) {
+        compressed.setBit(65536 + index);
+    }
+
+    QCOMPARE(compressed.popcount(), 32768U);
+    QVERIFY(compressed.isSet(65536 + 4000));
+    QVERIFY(compressed.isClear(65536 + 4001));
+
+    for (unsigned index=0 ; index<65536 ; index+=2) {
+        if (index % 32 != 0) {
+            compressed.clearBit(65536 + index);
+        }
+    }
+
+    QCOMPARE(compressed.popcount(), 2048U);
+    QVERIFY(compressed.isSet(65536 + 64));
+    QVERIFY(compressed.isClear(65536 + 66));
+
+    compressed.optimize();
+    for (unsigned index=0 ; index<65536 ; index+=32) {
+        compressed.clearBit(65536 + index);
+    }
+
+    QCOMPARE(compressed.popcount(), 0U);
+    QCOMPARE(compressed.firstSetBit(), Util::CompressedBitArray::invalidIndex);
+
+    // Set and clear within a run container.
+
+    Util::BitArray runReference(200000);
+    runReference.setBits(1000, 150000);
+
+    Util::CompressedBitArray runArray(runReference);
+    runArray.clearBit(5000);
+    runReference.clearBit(5000);
+    runArray.clearBit(1000);
+    runReference.clearBit(1000);
+    runArray.clearBit(65535);
+    runReference.clearBit(65535);
+    runArray.setBit(5000);
+    runReference.setBit(5000);
+    runArray.setBit(160000);
+    runReference.setBit(160000);
+    runArray.setBit(150001);
+    runReference.setBit(150001);
+
+    QVERIFY(runArray.toBitArray() == runReference);
+    QCOMPARE(runArray.popcount(), runReference.popcount());
+}
+
+
+void TestCompressedBitArray::testSearchMethods() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(1U, 500000U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 4 ; ++iteration) {
+        unsigned                 bitLength = randomLength(rng);
+        Util::BitArray           reference = randomBitArray(rng, bitLength);
+        Util::CompressedBitArray compressed(reference);
+
+        std::uniform_int_distribution<unsigned> randomIndex(0U, bitLength - 1);
+
+        QCOMPARE(compressed.firstSetBit(), reference.firstSetBit());
+
+        for (unsigned i=0 ; i<1000 ; ++i) {
+            unsigned startingIndex = randomIndex(rng);
+            QCOMPARE(compressed.firstSetBit(startingIndex), reference.firstSetBit(startingIndex));
+        }
+
+        Util::CompressedBitArray::Index index = compressed.firstSetBit();
+        Util::BitArray::Index           count = 0;
+        while (index != Util::CompressedBitArray::invalidIndex) {
+            ++count;
+            index = compressed.firstSetBit(index + 1);
+        }
+
+        QCOMPARE(count, reference.popcount());
+    }
+
+    Util::CompressedBitArray sparse;
+    sparse.setBit(10);
+    sparse.setBit(3000000000UL);
+
+    QCOMPARE(sparse.firstSetBit(11), 3000000000UL);
+    QCOMPARE(sparse.firstSetBit(3000000001UL), Util::CompressedBitArray::invalidIndex);
+    QVERIFY(sparse.memoryUsage() < 1024);
+}
+
+
+void TestCompressedBitArray::testResizeMethod() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(1U, 400000U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 4 ; ++iteration) {
+        unsigned                 bitLength = randomLength(rng);
+        Util::BitArray           reference = randomBitArray(rng, bitLength);
+        Util::CompressedBitArray compressed(reference);
+
+        std::uniform_int_distribution<unsigned> randomNewLength(0U, bitLength);
+        unsigned newLength = randomNewLength(rng);
+
+        compressed.resize(newLength);
+        reference.resize(newLength);
+
+        QCOMPARE(compressed.size(), static_cast<Util::CompressedBitArray::Index>(newLength));
+        QCOMPARE(compressed.popcount(), reference.popcount());
+        QVERIFY(compressed.toBitArray() == reference);
+
+        compressed.resize(bitLength);
+        reference.resize(bitLength);
+
+        QVERIFY(compressed.toBitArray() == reference);
+    }
+
+    Util::CompressedBitArray compressed(1000);
+    compressed.setBit(10);
+    compressed.clear();
+    QCOMPARE(compressed.size(), 0U);
+    QCOMPARE(compressed.popcount(), 0U);
+}
+
+
+void TestCompressedBitArray::testComparisonOperators() {
+    Util::BitArray reference(300000);
+    reference.setBits(100, 70000);
+    reference.setBit(200000);
+
+    Util::CompressedBitArray array1(reference);
+    Util::CompressedBitArray array2(reference.size());
+
+    for (unsigned index=100 ; index<=70000 ; ++index) {
+        array2.setBit(index);
+    }
+
+    array2.setBit(200000);
+
+    QVERIFY(array1 == array2);
+    QVERIFY(!(array1 != array2));
+
+    array2.optimize();
+    QVERIFY(array1 == array2);
+
+    array2.clearBit(5000);
+    QVERIFY(array1 != array2);
+
+    array2.setBit(5000);
+    array2.resize(300001);
+    QVERIFY(array1 != array2);
+}
+
+
+void TestCompressedBitArray::testBooleanOperators() {
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned> randomLength(0U, 500000U);
+
+    for (unsigned iteration=0 ; iteration<numberIterations + 6 ; ++iteration) {
+        Util::BitArray           reference1 = randomBitArray(rng, randomLength(rng));
+        Util::BitArray           reference2 = randomBitArray(rng, randomLength(rng));
+        Util::CompressedBitArray compressed1(reference1);
+        Util::CompressedBitArray compressed2(reference2);
+
+        if (iteration % 2 == 1) {
+            compressed1.optimize();
+        }
+
+        QVERIFY((compressed1 & compressed2).toBitArray() == (reference1 & reference2));
+        QVERIFY((compressed1 | compressed2).toBitArray() == (reference1 | reference2));
+        QVERIFY((compressed1 ^ compressed2).toBitArray() == (reference1 ^ reference2));
+        QVERIFY(compressed1.differenceBits(compressed2).toBitArray() == reference1.differenceBits(reference2));
+
+        Util::CompressedBitArray result = compressed1;
+        result &= compressed2;
+        QVERIFY(result.toBitArray() == (reference1 & reference2));
+
+        result = compressed1;
+        result |= compressed2;
+        QVERIFY(result.toBitArray() == (reference1 | reference2));
+
+        result = compressed1;
+        result ^= compressed2;
+        QVERIFY(result.toBitArray() == (reference1 ^ reference2));
+
+        result = compressed1;
+        result.andNot(compressed2);
+        QVERIFY(result.toBitArray() == reference1.differenceBits(reference2));
+
+        QVERIFY(compressed1.toBitArray() == reference1);
+    }
+}
+
+
+void TestCompressedBitArray::testOptimize() {
+    Util::BitArray reference(1048576);
+    for (unsigned index=0 ; index<1048576 ; index+=4096) {
+        reference.setBits(index, index + 2047);
+    }
+
+    Util::CompressedBitArray compressed(reference.size());
+    for (unsigned index=0 ; index<1048576 ; index+=4096) {
+        for (unsigned offset=0 ; offset<2048 ; ++offset) {
+            compressed.setBit(index + offset);
+        }
+    }
+
+    Util::CompressedBitArray::Index unoptimizedUsage = compressed.memoryUsage();
+    compressed.optimize();
+
+    QVERIFY(compressed.memoryUsage() < unoptimizedUsage / 10);
+    QVERIFY(compressed.toBitArray() == reference);
+    QCOMPARE(compressed.popcount(), reference.popcount());
+
+    // Fragmenting the runs must convert the containers back rather than growing the run lists without bound.
+
+    for (unsigned index=0 ; index<1048576 ; index+=4096) {
+        for (unsigned offset=1 ; offset<2048 ; offset+=2) {
+            compressed.clearBit(index + offset);
+            reference.clearBit(index + offset);
+        }
+    }
+
+    QVERIFY(compressed.memoryUsage() <= unoptimizedUsage);
+    QVERIFY(compressed.toBitArray() == reference);
+    QCOMPARE(compressed.popcount(), reference.popcount());
+
+    // Isolated bits added to optimized run containers must also be tracked correctly across conversions.
+
+    compressed.optimize();
+    for (unsigned index=0 ; index<1048576 ; index+=4096) {
+        for (unsigned offset=3000 ; offset<3400 ; offset+=2) {
+            compressed.setBit(index + offset);
+            reference.setBit(index + offset);
+        }
+    }
+
+    QVERIFY(compressed.toBitArray() == reference);
+    QCOMPARE(compressed.popcount(), reference.popcount());
+}
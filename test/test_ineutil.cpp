@@ -31,6 +31,10 @@
 #include "test_bit_functions.h"
 #include "test_bit_set.h"
 #include "test_bit_array.h"
+#include "test_bloom_filter.h"
+#include "test_bit_matrix.h"
+#include "test_compressed_bit_array.h"
+#include "test_atomic_bit_array.h"
 #include "test_page_size.h"
 #include "test_string.h"
 #include "test_fuzzy_search.h"
@@ -48,6 +52,10 @@ int main(int argumentCount, char** argumentValues) {
     TEST(TestBitFunctions);
     TEST(TestBitSet);
     TEST(TestBitArray);
+    TEST(TestBloomFilter);
+    TEST(TestBitMatrix);
+    TEST(TestCompressedBitArray);
+    TEST(TestAtomicBitArray);
     TEST(TestPageSize);
     TEST(TestString);
     TEST(TestFuzzySearch);